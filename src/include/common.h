@@ -18,7 +18,7 @@
 
 // Used to XOR with OtaCrcInitializer and macSeed to reduce compatibility with previous versions.
 // It should be incremented when the OTA packet structure is modified.
-#define OTA_VERSION_ID      4
+#define OTA_VERSION_ID      5
 #define UID_LEN             6
 
 typedef enum : uint8_t
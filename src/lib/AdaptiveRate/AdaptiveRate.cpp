@@ -0,0 +1,108 @@
+#include "AdaptiveRate.h"
+
+void AdaptiveRate::reset()
+{
+    lqAvg = 100 << 8;
+    settleCount = ADAPTIVE_RATE_SETTLE_REPORTS;
+    slowerCount = 0;
+    fasterCount = 0;
+}
+
+adaptive_rate_step_e AdaptiveRate::update(adaptive_rate_stats_t const &stats,
+    expresslrs_rf_pref_params_s const *curr, expresslrs_rf_pref_params_s const *faster)
+{
+    // The LQ restarts from 0 after a rate change, wait for it to mean something
+    if (settleCount)
+    {
+        --settleCount;
+        return ADAPTIVE_RATE_HOLD;
+    }
+
+    lqAvg = (3 * (uint32_t)lqAvg + ((uint32_t)stats.uplinkLq << 8)) / 4;
+    uint8_t const lq = getLqAvg();
+
+    // ============= Slower =============
+    if (stats.uplinkLq <= ADAPTIVE_RATE_LQ_CRITICAL)
+    {
+        slowerCount = ADAPTIVE_RATE_SLOWER_REPORTS;
+    }
+    else if (!stats.powerHeadroom && (lq < ADAPTIVE_RATE_LQ_SLOWER
+        || stats.rssi < curr->RXsensitivity + ADAPTIVE_RATE_RSSI_MARGIN_SLOWER
+        || (curr->DynpowerSnrThreshUp != DYNPOWER_SNR_THRESH_NONE && stats.snrScaled <= curr->DynpowerSnrThreshUp)))
+    {
+        ++slowerCount;
+    }
+    else
+    {
+        slowerCount = 0;
+    }
+
+    if (slowerCount >= ADAPTIVE_RATE_SLOWER_REPORTS)
+    {
+        slowerCount = 0;
+        fasterCount = 0;
+        return ADAPTIVE_RATE_SLOWER;
+    }
+
+    // ============= Faster =============
+    if (faster != nullptr
+        && lq >= ADAPTIVE_RATE_LQ_FASTER
+        && stats.uplinkLq >= ADAPTIVE_RATE_LQ_FASTER
+        && stats.downlinkLq >= ADAPTIVE_RATE_LQ_FASTER
+        && stats.rssi > faster->RXsensitivity + ADAPTIVE_RATE_RSSI_MARGIN_FASTER
+        && (faster->DynpowerSnrThreshDn == DYNPOWER_SNR_THRESH_NONE || stats.snrScaled >= faster->DynpowerSnrThreshDn))
+    {
+        ++fasterCount;
+    }
+    else
+    {
+        fasterCount = 0;
+    }
+
+    if (fasterCount >= ADAPTIVE_RATE_FASTER_REPORTS)
+    {
+        fasterCount = 0;
+        return ADAPTIVE_RATE_FASTER;
+    }
+
+    return ADAPTIVE_RATE_HOLD;
+}
+
+static bool onSameLadder(expresslrs_mod_settings_s const *a, expresslrs_mod_settings_s const *b)
+{
+    return a->radio_type == b->radio_type && a->PayloadLength == b->PayloadLength
+        && a->numOfSends == 1 && b->numOfSends == 1;
+}
+
+uint8_t AdaptiveRate_SlowerIndex(expresslrs_mod_settings_s const *rates, uint8_t rateCount, uint8_t currIndex)
+{
+    expresslrs_mod_settings_s const *curr = &rates[currIndex];
+    uint8_t best = currIndex;
+    for (uint8_t i = 0; i < rateCount; i++)
+    {
+        expresslrs_mod_settings_s const *rate = &rates[i];
+        if (onSameLadder(curr, rate) && rate->interval > curr->interval
+            && (best == currIndex || rate->interval < rates[best].interval))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint8_t AdaptiveRate_FasterIndex(expresslrs_mod_settings_s const *rates, uint8_t rateCount, uint8_t currIndex, uint8_t maxIndex)
+{
+    expresslrs_mod_settings_s const *curr = &rates[currIndex];
+    uint8_t best = currIndex;
+    for (uint8_t i = 0; i < rateCount; i++)
+    {
+        expresslrs_mod_settings_s const *rate = &rates[i];
+        if (onSameLadder(curr, rate) && rate->interval < curr->interval
+            && rate->interval >= rates[maxIndex].interval
+            && (best == currIndex || rate->interval > rates[best].interval))
+        {
+            best = i;
+        }
+    }
+    return best;
+}
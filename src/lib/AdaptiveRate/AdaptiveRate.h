@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include "common.h"
+
+#define ADAPTIVE_RATE_LQ_CRITICAL           50  // LQ at or below this steps to a slower rate immediately
+#define ADAPTIVE_RATE_LQ_SLOWER             80  // Average LQ below this steps to a slower rate, once there is no power left to add
+#define ADAPTIVE_RATE_LQ_FASTER             95  // Average and current LQ (up and down) must be at least this to step to a faster rate
+#define ADAPTIVE_RATE_RSSI_MARGIN_SLOWER    5   // RSSI < (Sensitivity+Slower) -> slower rate, once there is no power left to add
+#define ADAPTIVE_RATE_RSSI_MARGIN_FASTER    15  // RSSI must be > (faster rate Sensitivity+Faster) to step to a faster rate
+#define ADAPTIVE_RATE_SLOWER_REPORTS        2   // Consecutive LinkStats which must agree before stepping slower
+#define ADAPTIVE_RATE_FASTER_REPORTS        10  // Consecutive LinkStats which must agree before stepping faster
+#define ADAPTIVE_RATE_SETTLE_REPORTS        3   // LinkStats ignored after a rate change while the LQ refills
+
+typedef enum : int8_t {
+    ADAPTIVE_RATE_SLOWER = -1,
+    ADAPTIVE_RATE_HOLD = 0,
+    ADAPTIVE_RATE_FASTER = 1,
+} adaptive_rate_step_e;
+
+typedef struct {
+    uint8_t uplinkLq;       // LQ reported by the RX
+    uint8_t downlinkLq;     // LQ of the telemetry received by the TX
+    int8_t rssi;            // dBm, uplink RSSI of the active antenna
+    int8_t snrScaled;       // uplink SNR, SNR_SCALE()d
+    bool powerHeadroom;     // dynamic power can still increase the power
+} adaptive_rate_stats_t;
+
+/**
+ * @brief Decides when to step the packet rate, fed one LinkStats report at a time.
+ *
+ * Stepping slower is preferred to raising the power only when the LQ is critical,
+ * otherwise dynamic power gets to use its headroom first. Stepping faster needs a
+ * sustained run of good reports with enough RSSI/SNR margin for the faster rate.
+ */
+class AdaptiveRate
+{
+public:
+    AdaptiveRate() { reset(); }
+
+    // Call whenever the rate changes, by the adaptive rate or otherwise
+    void reset();
+
+    /**
+     * @param stats the latest LinkStats
+     * @param curr RF performance of the current rate
+     * @param faster RF performance of the next faster rate, or nullptr if there is none
+     */
+    adaptive_rate_step_e update(adaptive_rate_stats_t const &stats,
+        expresslrs_rf_pref_params_s const *curr, expresslrs_rf_pref_params_s const *faster);
+
+    uint8_t getLqAvg() const { return lqAvg >> 8; }
+
+private:
+    uint16_t lqAvg;         // 8.8 fixed point moving average of the uplink LQ
+    uint8_t settleCount;
+    uint8_t slowerCount;
+    uint8_t fasterCount;
+};
+
+/**
+ * The rate ladder is the rates using the same modulation and OTA packet size, one
+ * send per packet, ordered by packet interval. Switching along it does not change
+ * the switch mode or packet format.
+ * @return the index of the next slower rate, or currIndex if there isn't one
+ */
+uint8_t AdaptiveRate_SlowerIndex(expresslrs_mod_settings_s const *rates, uint8_t rateCount, uint8_t currIndex);
+
+/**
+ * @param maxIndex the fastest rate allowed, the rate returned is never faster than this
+ * @return the index of the next faster rate, or currIndex if there isn't one
+ */
+uint8_t AdaptiveRate_FasterIndex(expresslrs_mod_settings_s const *rates, uint8_t rateCount, uint8_t currIndex, uint8_t maxIndex);
@@ -193,6 +193,10 @@ void TxConfig::Load()
             m_config.backpackTlmMode = value8;
     }
 
+    // adaptiverate was added without incrementing the version, if not found defaults to 0 (off)
+    if (nvs_get_u8(handle, "adaptiverate", &value8) == ESP_OK)
+        m_config.adaptiveRate = value8;
+
     for(unsigned i=0; i<CONFIG_TX_MODEL_CNT; i++)
     {
         char model[10] = "model";
@@ -385,6 +389,7 @@ TxConfig::Commit()
     {
         nvs_set_u8(handle, "backpackdisable", m_config.backpackDisable);
         nvs_set_u8(handle, "backpacktlmen", m_config.backpackTlmMode);
+        nvs_set_u8(handle, "adaptiverate", m_config.adaptiveRate);
         nvs_set_u8(handle, "dvraux", m_config.dvrAux);
         nvs_set_u8(handle, "dvrstartdelay", m_config.dvrStartDelay);
         nvs_set_u8(handle, "dvrstopdelay", m_config.dvrStopDelay);
@@ -632,6 +637,16 @@ TxConfig::SetBackpackTlmMode(uint8_t mode)
     }
 }
 
+void
+TxConfig::SetAdaptiveRate(bool adaptiveRate)
+{
+    if (m_config.adaptiveRate != adaptiveRate)
+    {
+        m_config.adaptiveRate = adaptiveRate;
+        m_modified |= EVENT_CONFIG_MAIN_CHANGED;
+    }
+}
+
 void
 TxConfig::SetButtonActions(uint8_t button, tx_button_color_t *action)
 {
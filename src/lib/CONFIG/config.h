@@ -86,7 +86,8 @@ typedef struct {
     uint8_t         vtxChannel; // 0=Ch1 -> 7=Ch8
     uint8_t         vtxPower;   // 0=Do not set, else power number
     uint8_t         vtxPitmode; // Off/On/AUX1^/AUX1v/etc
-    uint8_t         powerFanThreshold:4; // Power level to enable fan if present
+    uint8_t         powerFanThreshold:4, // Power level to enable fan if present
+                    adaptiveRate:1;     // bool, step the packet rate down and back up with the link quality
     model_config_t  model_config[CONFIG_TX_MODEL_CNT];
     uint8_t         fanMode;            // some value used by thermal?
     uint8_t         motionMode:2,       // bool, but space for 2 more modes
@@ -130,6 +131,7 @@ public:
     uint8_t  GetDvrStopDelay() const { return m_config.dvrStopDelay; }
     bool     GetBackpackDisable() const { return m_config.backpackDisable; }
     uint8_t  GetBackpackTlmMode() const { return m_config.backpackTlmMode; }
+    bool     GetAdaptiveRate() const { return m_config.adaptiveRate; }
     tx_button_color_t const *GetButtonActions(uint8_t button) const { return &m_config.buttonColors[button]; }
     model_config_t const &GetModelConfig(uint8_t model) const { return m_config.model_config[model]; }
     uint8_t GetPTRStartChannel() const { return m_model->ptrStartChannel; }
@@ -160,6 +162,7 @@ public:
     void SetButtonActions(uint8_t button, tx_button_color_t actions[2]);
     void SetBackpackDisable(bool backpackDisable);
     void SetBackpackTlmMode(uint8_t mode);
+    void SetAdaptiveRate(bool adaptiveRate);
     void SetPTRStartChannel(uint8_t ptrStartChannel);
     void SetPTREnableChannel(uint8_t ptrEnableChannel);
 
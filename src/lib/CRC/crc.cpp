@@ -57,3 +57,47 @@ uint16_t ICACHE_RAM_ATTR Crc2Byte::calc(uint8_t *data, uint8_t len, uint16_t crc
     }
     return crc & _bitmask;
 }
+
+template <uint8_t BITS, uint16_t POLY>
+uint16_t ICACHE_RAM_ATTR Crc2ByteSlice4<BITS, POLY>::calc(const uint8_t *data, uint8_t len, uint16_t crc)
+{
+    crc <<= (16 - BITS);
+    while (len >= 4)
+    {
+        // The two CRC bytes line up with the first two data bytes
+        crc = T3::value[(uint8_t)(data[0] ^ (crc >> 8))] ^
+              T2::value[(uint8_t)(data[1] ^ crc)] ^
+              T1::value[data[2]] ^
+              T0::value[data[3]];
+        data += 4;
+        len -= 4;
+    }
+    while (len--)
+    {
+        crc = (crc << 8) ^ T0::value[(uint8_t)((crc >> 8) ^ *data++)];
+    }
+    return crc >> (16 - BITS);
+}
+
+template <uint8_t BITS, uint16_t POLY>
+uint16_t ICACHE_RAM_ATTR Crc2ByteNibble<BITS, POLY>::calc(const uint8_t *data, uint8_t len, uint16_t crc)
+{
+    crc <<= (16 - BITS);
+    while (len--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+        crc = (crc << 4) ^ T::value[crc >> 12];
+        crc = (crc << 4) ^ T::value[crc >> 12];
+    }
+    return crc >> (16 - BITS);
+}
+
+// OTA4 (ELRS_CRC14_POLY) and OTA8 (ELRS_CRC16_POLY) packet CRCs
+template class Crc2ByteSlice4<14, 0x2E57>;
+template class Crc2ByteSlice4<16, 0x3D65>;
+template class Crc2ByteNibble<14, 0x2E57>;
+template class Crc2ByteNibble<16, 0x3D65>;
+
+// SUMD frame CRC (SerialSUMD)
+template class Crc2ByteSlice4<16, 0x1021>;
+template class Crc2ByteNibble<16, 0x1021>;
@@ -28,3 +28,88 @@ public:
     void init(uint8_t bits, uint16_t poly);
     uint16_t calc(uint8_t *data, uint8_t len, uint16_t crc);
 };
+
+/*
+ * Fixed-polynomial 2-byte CRCs whose lookup tables are generated at compile
+ * time, so they live in flash rather than RAM and need no init(). They give
+ * the same results as Crc2Byte with the same bits/poly.
+ *
+ * Internally the CRC is computed left-aligned in 16 bits (a 14-bit CRC is a
+ * 16-bit CRC with poly and init shifted up by 2), so one table layout serves
+ * every width.
+ *
+ * Crc2ByteSlice4 processes 4 bytes per step using 4x256 entry tables (2KB per
+ * poly). Crc2ByteNibble uses a single 16 entry table (32 bytes per poly) and
+ * two lookups per byte, for targets where flash constants are copied to RAM.
+ * Crc2ByteFixed picks the best one for the target.
+ *
+ * Only the OTA and SUMD polys are instantiated, see crc.cpp.
+ */
+
+// Shift `bits` bits through a left-aligned 16-bit CRC register
+// C++11 constexpr functions are a single return, so this has to recurse
+constexpr uint16_t crc16ShiftBits(uint16_t crc, uint16_t poly, uint8_t bits)
+{
+    return bits == 0 ? crc :
+        crc16ShiftBits((crc & 0x8000) ? (uint16_t)((crc << 1) ^ poly) : (uint16_t)(crc << 1), poly, bits - 1);
+}
+
+template <uint16_t... Is> struct CrcTableIndices {};
+template <uint16_t N, uint16_t... Is> struct CrcMakeTableIndices : CrcMakeTableIndices<N - 1, N - 1, Is...> {};
+template <uint16_t... Is> struct CrcMakeTableIndices<0, Is...> { typedef CrcTableIndices<Is...> type; };
+
+// table[i] = CRC register after (i << INDEXSHIFT) is shifted through SHIFTBITS bits
+template <uint16_t POLY16, uint8_t INDEXSHIFT, uint8_t SHIFTBITS, typename INDICES> struct CrcTable;
+template <uint16_t POLY16, uint8_t INDEXSHIFT, uint8_t SHIFTBITS, uint16_t... Is>
+struct CrcTable<POLY16, INDEXSHIFT, SHIFTBITS, CrcTableIndices<Is...>>
+{
+    static constexpr uint16_t value[sizeof...(Is)] = {
+        crc16ShiftBits((uint16_t)(Is << INDEXSHIFT), POLY16, SHIFTBITS)...
+    };
+};
+template <uint16_t POLY16, uint8_t INDEXSHIFT, uint8_t SHIFTBITS, uint16_t... Is>
+constexpr uint16_t CrcTable<POLY16, INDEXSHIFT, SHIFTBITS, CrcTableIndices<Is...>>::value[sizeof...(Is)];
+
+template <uint8_t BITS, uint16_t POLY>
+class Crc2ByteSlice4
+{
+private:
+    static_assert(BITS > 8 && BITS <= 16, "Crc2ByteSlice4 is for 9 to 16 bit CRCs");
+    static constexpr uint16_t POLY16 = POLY << (16 - BITS);
+    typedef typename CrcMakeTableIndices<256>::type Indices;
+    // Tn[i] is the CRC of byte i followed by n zero bytes
+    typedef CrcTable<POLY16, 8, 8, Indices> T0;
+    typedef CrcTable<POLY16, 8, 16, Indices> T1;
+    typedef CrcTable<POLY16, 8, 24, Indices> T2;
+    typedef CrcTable<POLY16, 8, 32, Indices> T3;
+
+public:
+    static uint16_t calc(const uint8_t *data, uint8_t len, uint16_t crc);
+};
+
+template <uint8_t BITS, uint16_t POLY>
+class Crc2ByteNibble
+{
+private:
+    static_assert(BITS > 8 && BITS <= 16, "Crc2ByteNibble is for 9 to 16 bit CRCs");
+    static constexpr uint16_t POLY16 = POLY << (16 - BITS);
+    typedef CrcTable<POLY16, 12, 4, typename CrcMakeTableIndices<16>::type> T;
+
+public:
+    static uint16_t calc(const uint8_t *data, uint8_t len, uint16_t crc);
+};
+
+#if !defined(CRC_USE_SLICE4) && !defined(CRC_USE_NIBBLE)
+#if defined(PLATFORM_ESP8266)
+// ESP8266 keeps const data in RAM unless it's PROGMEM, which needs aligned reads
+#define CRC_USE_NIBBLE
+#else
+#define CRC_USE_SLICE4
+#endif
+#endif
+
+#if defined(CRC_USE_NIBBLE)
+template <uint8_t BITS, uint16_t POLY> using Crc2ByteFixed = Crc2ByteNibble<BITS, POLY>;
+#else
+template <uint8_t BITS, uint16_t POLY> using Crc2ByteFixed = Crc2ByteSlice4<BITS, POLY>;
+#endif
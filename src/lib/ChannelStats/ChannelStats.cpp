@@ -0,0 +1,101 @@
+#include "ChannelStats.h"
+
+typedef struct {
+    uint32_t received;  // ring of packets, bit 0 the latest
+    uint32_t crcError;
+    uint8_t count;
+    int16_t rssi;       // dBm * 16, moving average
+    int16_t snr;        // * 16
+} channel_history_t;
+
+static channel_history_t history[CHANNEL_STATS_MAX_CHANNELS];
+static uint8_t channelCount;
+static volatile uint8_t resetChannelCount = CHANNEL_STATS_NONE;
+
+// The packet in progress
+static uint8_t currChannel = CHANNEL_STATS_NONE;
+static bool currReceived;
+static bool currCrcError;
+
+static uint8_t countBits(uint32_t bits)
+{
+    uint8_t count = 0;
+    for (; bits; bits &= bits - 1)
+        ++count;
+    return count;
+}
+
+void ChannelStats_Reset(uint8_t count)
+{
+    resetChannelCount = (count < CHANNEL_STATS_MAX_CHANNELS) ? count : CHANNEL_STATS_MAX_CHANNELS;
+}
+
+uint8_t ChannelStats_ChannelCount()
+{
+    return channelCount;
+}
+
+void ICACHE_RAM_ATTR ChannelStats_NextPacket(uint8_t channel)
+{
+    if (resetChannelCount != CHANNEL_STATS_NONE)
+    {
+        memset(history, 0, sizeof(history));
+        channelCount = resetChannelCount;
+        resetChannelCount = CHANNEL_STATS_NONE;
+        currChannel = CHANNEL_STATS_NONE;
+    }
+
+    if (currChannel < channelCount)
+    {
+        channel_history_t *h = &history[currChannel];
+        h->received = (h->received << 1) | currReceived;
+        h->crcError = (h->crcError << 1) | currCrcError;
+        if (h->count < CHANNEL_STATS_HISTORY)
+            ++h->count;
+    }
+
+    currChannel = channel;
+    currReceived = false;
+    currCrcError = false;
+}
+
+void ICACHE_RAM_ATTR ChannelStats_Received(int8_t rssi, int8_t snr)
+{
+    if (currChannel >= channelCount || currReceived)
+        return;
+    currReceived = true;
+
+    channel_history_t *h = &history[currChannel];
+    // Nothing received in the ring, start the averages from this packet
+    if (h->received == 0)
+    {
+        h->rssi = rssi * 16;
+        h->snr = snr * 16;
+    }
+    else
+    {
+        h->rssi += (rssi * 16 - h->rssi) / 8;
+        h->snr += (snr * 16 - h->snr) / 8;
+    }
+}
+
+void ICACHE_RAM_ATTR ChannelStats_CrcError()
+{
+    currCrcError = true;
+}
+
+void ChannelStats_Get(uint8_t channel, channel_stats_t *out)
+{
+    if (channel >= channelCount)
+    {
+        memset(out, 0, sizeof(channel_stats_t));
+        return;
+    }
+
+    channel_history_t const *h = &history[channel];
+    out->count = h->count;
+    out->received = countBits(h->received);
+    out->crcErrors = countBits(h->crcError);
+    out->rssi = out->received ? h->rssi / 16 : 0;
+    out->snr = out->received ? h->snr / 16 : 0;
+}
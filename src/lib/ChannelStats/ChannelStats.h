@@ -0,0 +1,51 @@
+#pragma once
+
+#include "targets.h"
+#include "FHSS.h"
+
+/**
+ * Link quality of each FHSS channel, to find the frequencies which are bad because of
+ * interference or an antenna null. The RX tracks the uplink packets and the TX the
+ * telemetry, each by the channel the packet was expected on.
+ *
+ * Each channel keeps a ring of the last CHANNEL_STATS_HISTORY packets expected on it, one
+ * bit each for received and for CRC error, and a moving average of the RSSI and SNR of
+ * the packets it received. Results can be read from the web UI (/channelstats) and on
+ * the TX over MSP (MSP_ELRS_GET_CHANNEL_STATS).
+ */
+
+#define CHANNEL_STATS_MAX_CHANNELS  (FHSS_BLACKLIST_BYTES * 8)
+#define CHANNEL_STATS_HISTORY       32
+// Pass to ChannelStats_NextPacket() for a packet which is not to be counted
+#define CHANNEL_STATS_NONE          0xFF
+
+typedef struct {
+    uint8_t count;      // packets expected, up to CHANNEL_STATS_HISTORY
+    uint8_t received;   // of those, received with a good CRC
+    uint8_t crcErrors;  // of those, one arrived with a bad CRC
+    int8_t rssi;        // dBm, mean of the received packets
+    int8_t snr;         // RADIO_SNR_SCALE units, mean of the received packets
+} channel_stats_t;
+
+/**
+ * @brief Clear the stats and set the number of channels, done by the next
+ * ChannelStats_NextPacket() so it is safe to call outside of the ISR.
+ */
+void ChannelStats_Reset(uint8_t channelCount);
+uint8_t ChannelStats_ChannelCount();
+
+/**
+ * @brief Record the outcome of the packet before and start on the next one, expected on
+ * `channel`. Called where the LQ period is incremented.
+ */
+void ChannelStats_NextPacket(uint8_t channel);
+// The packet expected has been received
+void ChannelStats_Received(int8_t rssi, int8_t snr);
+// A packet arrived with a bad CRC
+void ChannelStats_CrcError();
+
+/**
+ * @brief Copy the stats of a channel, zeros for a channel past the end. The channel
+ * is not locked against the ISR updating it.
+ */
+void ChannelStats_Get(uint8_t channel, channel_stats_t *out);
@@ -0,0 +1,81 @@
+#include "CycleStats.h"
+
+#if defined(DEBUG_CYCLE_STATS)
+
+static cycle_stats_t stats[CYCLE_STATS_SECTION_COUNT];
+static volatile bool resetPending[CYCLE_STATS_SECTION_COUNT];
+
+static const char *sectionNames[CYCLE_STATS_SECTION_COUNT] = {
+    "RXdoneISR",
+    "TXdoneISR",
+    "timerCallback",
+    "Tick",
+    "Tock",
+    "ProcessRFPacket",
+};
+
+void ICACHE_RAM_ATTR CycleStats_Record(cycleStatsSection_e section, uint32_t cycles)
+{
+    cycle_stats_t *s = &stats[section];
+    if (resetPending[section])
+    {
+        memset(s, 0, sizeof(cycle_stats_t));
+        resetPending[section] = false;
+    }
+
+    if (s->count == 0 || cycles < s->min)
+        s->min = cycles;
+    if (cycles > s->max)
+        s->max = cycles;
+    s->total += cycles;
+    ++s->count;
+
+    // Not __builtin_clz(), on the ESP8266 that is a libgcc call which lives in flash
+    uint8_t bucket = 0;
+    while ((cycles >>= 1) != 0 && bucket < CYCLE_STATS_BUCKETS - 1)
+        ++bucket;
+    ++s->histogram[bucket];
+}
+
+const char *CycleStats_SectionName(cycleStatsSection_e section)
+{
+    return sectionNames[section];
+}
+
+uint32_t CycleStats_CyclesPerUs()
+{
+#if defined(TARGET_NATIVE)
+    return 1000;
+#else
+    return ESP.getCpuFreqMHz();
+#endif
+}
+
+void CycleStats_Get(cycleStatsSection_e section, cycle_stats_t *out)
+{
+    if (resetPending[section])
+        memset(out, 0, sizeof(cycle_stats_t));
+    else
+        memcpy(out, &stats[section], sizeof(cycle_stats_t));
+}
+
+void CycleStats_Reset()
+{
+    for (uint8_t i = 0; i < CYCLE_STATS_SECTION_COUNT; i++)
+        resetPending[i] = true;
+}
+
+void CycleStats_Format(cycleStatsSection_e section, char *buf, size_t len)
+{
+    cycle_stats_t s;
+    CycleStats_Get(section, &s);
+    if (s.count == 0)
+    {
+        snprintf(buf, len, "-");
+        return;
+    }
+    uint32_t const cyclesPerUs = CycleStats_CyclesPerUs();
+    snprintf(buf, len, "%u/%uus", (unsigned)(s.total / s.count / cyclesPerUs), (unsigned)(s.max / cyclesPerUs));
+}
+
+#endif
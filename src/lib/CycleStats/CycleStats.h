@@ -0,0 +1,92 @@
+#pragma once
+
+#include "targets.h"
+
+/**
+ * Cycle count instrumentation for the hot paths, the radio ISRs and timer callbacks.
+ * Define DEBUG_CYCLE_STATS to enable it, otherwise CYCLE_STATS_SCOPE() compiles to nothing.
+ *
+ * Each section records the count, min, max, total and a log2 histogram of the CPU
+ * cycles spent in it. Results can be read from the web UI (/cyclestats), the LUA
+ * "Cycle Stats" folder, and on the TX over MSP (MSP_ELRS_GET_CYCLE_STATS).
+ */
+
+typedef enum : uint8_t {
+    CYCLE_STATS_RXDONE,         // RXdoneISR()
+    CYCLE_STATS_TXDONE,         // TXdoneISR()
+    CYCLE_STATS_TIMER,          // timerCallback() (TX)
+    CYCLE_STATS_TICK,           // HWtimerCallbackTick() (RX)
+    CYCLE_STATS_TOCK,           // HWtimerCallbackTock() (RX)
+    CYCLE_STATS_PROCESS_PACKET, // ProcessRFPacket() (RX)
+    CYCLE_STATS_SECTION_COUNT
+} cycleStatsSection_e;
+
+// Bucket n counts durations of [2^n, 2^(n+1)) cycles, the last bucket also counts anything longer
+#define CYCLE_STATS_BUCKETS 20
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[CYCLE_STATS_BUCKETS];
+} cycle_stats_t;
+
+#if defined(DEBUG_CYCLE_STATS)
+
+#if defined(TARGET_NATIVE)
+#include <chrono>
+// No cycle counter, count nanoseconds instead
+static inline uint32_t CycleStats_Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#else
+__attribute__((always_inline)) static inline uint32_t CycleStats_Now()
+{
+    return ESP.getCycleCount();
+}
+#endif
+
+void CycleStats_Record(cycleStatsSection_e section, uint32_t cycles);
+
+// Always inlined so it can't end up in flash when used in an ICACHE_RAM_ATTR function
+class CycleStatsScope
+{
+public:
+    __attribute__((always_inline)) explicit CycleStatsScope(cycleStatsSection_e section) : section(section), start(CycleStats_Now()) {}
+    __attribute__((always_inline)) ~CycleStatsScope() { CycleStats_Record(section, CycleStats_Now() - start); }
+
+private:
+    cycleStatsSection_e const section;
+    uint32_t const start;
+};
+
+// Record the cycles from here to the end of the enclosing scope against `section`
+#define CYCLE_STATS_SCOPE(section) CycleStatsScope cycleStatsScope_(section)
+
+const char *CycleStats_SectionName(cycleStatsSection_e section);
+uint32_t CycleStats_CyclesPerUs();
+
+/**
+ * @brief Copy the stats of a section. The section is not locked against the ISR
+ * updating it, so the copy can very occasionally be inconsistent.
+ */
+void CycleStats_Get(cycleStatsSection_e section, cycle_stats_t *out);
+
+/**
+ * @brief Clear the stats of all sections, done by the next CycleStats_Record() of
+ * each section so it is safe to call outside of the ISR.
+ */
+void CycleStats_Reset();
+
+/**
+ * @brief Format the mean and max of a section as "mean/max us"
+ */
+void CycleStats_Format(cycleStatsSection_e section, char *buf, size_t len);
+
+#else
+
+#define CYCLE_STATS_SCOPE(section)
+
+#endif
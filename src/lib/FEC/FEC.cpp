@@ -1,43 +1,202 @@
 #include "FEC.h"
 
+/**
+ * Transpose an 8x8 bit matrix, held as rows 0-3 in lo and rows 4-7 in hi
+ * (row n in byte n%4, column m in bit m). Afterwards bit m of row n holds
+ * what was bit n of row m. Swaps 2x2 blocks, then 4x4 blocks within each
+ * word, then the off-diagonal 4x4 blocks between the words (Hacker's Delight
+ * 7-3, using 32-bit words which suit the ESP targets better than one uint64).
+ */
+static inline void transpose8x8(uint32_t &lo, uint32_t &hi)
+{
+    uint32_t t;
+    t = (lo ^ (lo >> 7)) & 0x00AA00AA;
+    lo ^= t ^ (t << 7);
+    t = (hi ^ (hi >> 7)) & 0x00AA00AA;
+    hi ^= t ^ (t << 7);
+
+    t = (lo ^ (lo >> 14)) & 0x0000CCCC;
+    lo ^= t ^ (t << 14);
+    t = (hi ^ (hi >> 14)) & 0x0000CCCC;
+    hi ^= t ^ (t << 14);
+
+    t = (lo & 0x0F0F0F0F) | ((hi & 0x0F0F0F0F) << 4);
+    hi = (hi & 0xF0F0F0F0) | ((lo >> 4) & 0x0F0F0F0F);
+    lo = t;
+}
+
+static inline uint32_t hammingEncode2(uint8_t data)
+{
+    return HammingTableEncode(data & 0x0F) | (HammingTableEncode(data >> 4) << 8);
+}
+
 void FECEncode(uint8_t *incomingData, uint8_t *FECBuffer)
 {
-    // Encode Hamming(7,4) 
-    uint8_t encodedBuffer[8 * 2] = {0};
-    for (uint8_t i = 0; i < 8; i++)
+    // Hamming(7,4) each nibble, the codewords of the first 4 bytes form one
+    // 8x8 bit matrix and the last 4 bytes the other, one codeword per row
+    uint32_t evenLo = hammingEncode2(incomingData[0]) | (hammingEncode2(incomingData[1]) << 16);
+    uint32_t evenHi = hammingEncode2(incomingData[2]) | (hammingEncode2(incomingData[3]) << 16);
+    uint32_t oddLo  = hammingEncode2(incomingData[4]) | (hammingEncode2(incomingData[5]) << 16);
+    uint32_t oddHi  = hammingEncode2(incomingData[6]) | (hammingEncode2(incomingData[7]) << 16);
+
+    // Interleaving, bit i of every codeword goes into byte i*2 (first matrix)
+    // or i*2+1 (second matrix). Row 7 is always 0 so it isn't sent
+    transpose8x8(evenLo, evenHi);
+    transpose8x8(oddLo, oddHi);
+    for (uint8_t i = 0; i < 4; i++)
     {
-        encodedBuffer[i * 2 + 0] = HammingTableEncode(incomingData[i] & 0x0F);  // LSB nibble
-        encodedBuffer[i * 2 + 1] = HammingTableEncode(incomingData[i] >> 4);    // MSB nibble
+        FECBuffer[i * 2 + 0] |= evenLo >> (i * 8);
+        FECBuffer[i * 2 + 1] |= oddLo >> (i * 8);
     }
-
-    // Interleaving
-    for (uint8_t i = 0; i < (14 / 2); i++)
+    for (uint8_t i = 4; i < (14 / 2); i++)
     {
-        for (uint8_t j = 0; j < 8; j++)
-        {
-            FECBuffer[i * 2 + 0] |= ((encodedBuffer[j + 0] >> i) & 0x01) << j; 
-            FECBuffer[i * 2 + 1] |= ((encodedBuffer[j + 8] >> i) & 0x01) << j; 
-        }
+        FECBuffer[i * 2 + 0] |= evenHi >> ((i - 4) * 8);
+        FECBuffer[i * 2 + 1] |= oddHi >> ((i - 4) * 8);
     }
 }
 
+/**
+ * De-interleave a 14B FECBuffer back into 16 codewords, codeword n ends up in
+ * byte n%4 of codewords[n/4]. De-interleaving is the same transpose as the
+ * interleave, with the 8th row being 0
+ */
+static inline void FECDeinterleave(uint8_t *incomingFECBuffer, uint32_t codewords[4])
+{
+    uint32_t evenLo = incomingFECBuffer[0] | (incomingFECBuffer[2] << 8) | (incomingFECBuffer[4] << 16) | ((uint32_t)incomingFECBuffer[6] << 24);
+    uint32_t evenHi = incomingFECBuffer[8] | (incomingFECBuffer[10] << 8) | (incomingFECBuffer[12] << 16);
+    uint32_t oddLo  = incomingFECBuffer[1] | (incomingFECBuffer[3] << 8) | (incomingFECBuffer[5] << 16) | ((uint32_t)incomingFECBuffer[7] << 24);
+    uint32_t oddHi  = incomingFECBuffer[9] | (incomingFECBuffer[11] << 8) | (incomingFECBuffer[13] << 16);
+    transpose8x8(evenLo, evenHi);
+    transpose8x8(oddLo, oddHi);
+    codewords[0] = evenLo;
+    codewords[1] = evenHi;
+    codewords[2] = oddLo;
+    codewords[3] = oddHi;
+}
+
+static inline uint8_t FECCodeword(uint32_t const codewords[4], uint8_t n)
+{
+    return codewords[n / 4] >> ((n % 4) * 8);
+}
+
+static inline bool HammingSyndrome(uint8_t code, uint8_t decoded)
+{
+    return HammingTableEncode(decoded) != code;
+}
+
 void FECDecode(uint8_t *incomingFECBuffer, uint8_t *outgoingData)
 {
-    // Interleaving
-    uint8_t encodedBuffer[16] = {0};
+    uint32_t codewords[4];
+    FECDeinterleave(incomingFECBuffer, codewords);
+
+    // Decode Hamming(7,4), codewords are LSB nibble then MSB nibble
     for (uint8_t i = 0; i < 8; i++)
     {
-        for (uint8_t j = 0; j < 7; j++)
+        outgoingData[i] =  HammingTableDecode(FECCodeword(codewords, i * 2 + 0));         // LSB nibble
+        outgoingData[i] |= HammingTableDecode(FECCodeword(codewords, i * 2 + 1)) << 4;    // MSB nibble
+    }
+}
+
+static FECConfidence_e FECConfidence(FECDecodeStatus_s const *status)
+{
+    if (status->unreliable)
+        return FEC_UNRELIABLE;
+    if (status->corrected)
+        return FEC_CORRECTED;
+    return FEC_CLEAN;
+}
+
+FECConfidence_e FECDecodeWithStatus(uint8_t *incomingFECBuffer, uint8_t *outgoingData, FECDecodeStatus_s *status)
+{
+    uint32_t codewords[4];
+    FECDeinterleave(incomingFECBuffer, codewords);
+
+    status->corrected = 0;
+    status->unreliable = 0;
+    for (uint8_t n = 0; n < 16; n++)
+    {
+        uint8_t const code = FECCodeword(codewords, n);
+        uint8_t const decoded = HammingTableDecode(code);
+        if (HammingSyndrome(code, decoded))
+            status->corrected |= 1 << n;
+
+        if (n % 2 == 0)
+            outgoingData[n / 2] = decoded;
+        else
+            outgoingData[n / 2] |= decoded << 4;
+    }
+
+    return FECConfidence(status);
+}
+
+/**
+ * Combine two receptions of one codeword, returns the data nibble and
+ * updates the status bit for codeword n
+ */
+static uint8_t HammingCombine(uint8_t a, uint8_t b, uint8_t n, FECDecodeStatus_s *status)
+{
+    uint8_t const decodedA = HammingTableDecode(a);
+    uint8_t const decodedB = HammingTableDecode(b);
+    bool const syndromeA = HammingSyndrome(a, decodedA);
+    bool const syndromeB = HammingSyndrome(b, decodedB);
+
+    if (!syndromeA && !syndromeB)
+    {
+        // Two valid codewords which differ means the copies weren't the same,
+        // e.g. the nonce in the CRC, go with the later copy
+        if (decodedA != decodedB)
+            status->unreliable |= 1 << n;
+        return decodedB;
+    }
+    if (!syndromeA)
+        return decodedA;
+    if (!syndromeB)
+        return decodedB;
+
+    // Both damaged, take the codeword nearest to both copies, which is the
+    // most likely one sent. Where the copies disagree this fills in up to two
+    // erased bits, if the bits they agree on are damaged there may be a tie
+    status->corrected |= 1 << n;
+    uint8_t best = 0;
+    uint8_t bestDistance = 0xFF;
+    bool tied = false;
+    for (uint8_t data = 0; data < DATA_VALUES; data++)
+    {
+        uint8_t const code = HammingTableEncode(data);
+        uint8_t const distance = __builtin_popcount(code ^ a) + __builtin_popcount(code ^ b);
+        if (distance < bestDistance)
+        {
+            best = data;
+            bestDistance = distance;
+            tied = false;
+        }
+        else if (distance == bestDistance)
         {
-            encodedBuffer[i + 0] |= ((incomingFECBuffer[j * 2 + 0] >> i) & 0x01) << j; 
-            encodedBuffer[i + 8] |= ((incomingFECBuffer[j * 2 + 1] >> i) & 0x01) << j; 
+            tied = true;
         }
     }
+    if (tied)
+        status->unreliable |= 1 << n;
+    return best;
+}
 
-    // Decode Hamming(7,4) 
-    for (uint8_t i = 0; i < 8; i++)
+FECConfidence_e FECDecodeCombine(uint8_t *firstFECBuffer, uint8_t *secondFECBuffer, uint8_t *outgoingData, FECDecodeStatus_s *status)
+{
+    uint32_t first[4];
+    uint32_t second[4];
+    FECDeinterleave(firstFECBuffer, first);
+    FECDeinterleave(secondFECBuffer, second);
+
+    status->corrected = 0;
+    status->unreliable = 0;
+    for (uint8_t n = 0; n < 16; n++)
     {
-        outgoingData[i] =  HammingTableDecode(encodedBuffer[i * 2 + 0]);         // LSB nibble
-        outgoingData[i] |= HammingTableDecode(encodedBuffer[i * 2 + 1]) << 4;    // MSB nibble
+        uint8_t const decoded = HammingCombine(FECCodeword(first, n), FECCodeword(second, n), n, status);
+        if (n % 2 == 0)
+            outgoingData[n / 2] = decoded;
+        else
+            outgoingData[n / 2] |= decoded << 4;
     }
+
+    return FECConfidence(status);
 }
@@ -20,3 +20,33 @@
 
 void FECEncode(uint8_t *incomingData, uint8_t *FECBuffer);
 void FECDecode(uint8_t *incomingFECBuffer, uint8_t *outgoingData);
+
+/**
+ * @brief Syndrome reporting and DVDA combining
+ *
+ * Hamming(7,4) is a perfect code, every 7b word is within one bit of a
+ * codeword, so a plain decode can't tell a corrected single bit error from
+ * a miscorrected double. What it can tell is which codewords had a non-zero
+ * syndrome, which is reported as a bitmask (bit n = codeword n, the LSB
+ * nibble of byte n/2 for even n, the MSB nibble for odd n).
+ *
+ * With two receptions of the same packet (DVDA) the codewords are combined
+ * individually. A copy with a zero syndrome is taken as-is, otherwise the
+ * codeword with the smallest total distance to both copies is used, which
+ * recovers the data when the bits the copies disagree on are the damaged
+ * ones. Codewords which can't be resolved (two different valid codewords,
+ * or a tie) are flagged as unreliable.
+ */
+typedef struct {
+    uint16_t corrected;     // codewords which had a non-zero syndrome
+    uint16_t unreliable;    // codewords where the copies could not be reconciled
+} FECDecodeStatus_s;
+
+typedef enum {
+    FEC_CLEAN,              // every codeword had a zero syndrome
+    FEC_CORRECTED,          // some codewords were corrected, the packet CRC decides
+    FEC_UNRELIABLE,         // some codewords are likely wrong
+} FECConfidence_e;
+
+FECConfidence_e FECDecodeWithStatus(uint8_t *incomingFECBuffer, uint8_t *outgoingData, FECDecodeStatus_s *status);
+FECConfidence_e FECDecodeCombine(uint8_t *firstFECBuffer, uint8_t *secondFECBuffer, uint8_t *outgoingData, FECDecodeStatus_s *status);
@@ -1,4 +1,5 @@
 #include "FHSS.h"
+#include "helpers.h"
 #include "logging.h"
 #include "options.h"
 #include <string.h>
@@ -42,6 +43,8 @@ const fhss_config_t domains[] = {
 };
 #endif
 
+const uint8_t FHSSdomainCount = ARRAY_SIZE(domains);
+
 // Our table of FHSS frequencies. Define a regulatory domain to select the correct set for your location and radio
 const fhss_config_t *FHSSconfig;
 const fhss_config_t *FHSSconfigDualBand;
@@ -72,9 +75,222 @@ bool FHSSuseDualBand = false;
 uint16_t primaryBandCount;
 uint16_t secondaryBandCount;
 
+// Precalculated hop frequencies (register units), the set in use and the one a new blacklist
+// is built in. FHSSswapBlacklist() changes to FHSSnextTables once FHSSblacklistReady
+uint16_t FHSSsequenceCount;
+static uint32_t FHSSfreqTables[2][FHSS_SEQUENCE_LEN];
+static uint32_t FHSSgeminiFreqTables[2][FHSS_SEQUENCE_LEN];
+static uint8_t FHSSblacklists[2][FHSS_BLACKLIST_BYTES];
+uint32_t *FHSSfreqs = FHSSfreqTables[0];
+uint32_t *FHSSgeminiFreqs = FHSSgeminiFreqTables[0];
+const uint8_t *FHSSblacklist = FHSSblacklists[0];
+static volatile uint8_t FHSSactiveTables;
+static volatile uint8_t FHSSnextTables;
+static volatile bool FHSSblacklistReady;
+
+// FreqCorrection only applies to the primary band, the other band hops with a correction of 0
+static const int32_t noFreqCorrection = 0;
+const int32_t *FHSSfreqCorrection = &noFreqCorrection;
+const int32_t *FHSSgeminiFreqCorrection = &noFreqCorrection;
+
+static uint32_t FHSSchannelFreq(const fhss_config_t *config, uint32_t spread, uint8_t channel)
+{
+    return config->freq_start + (spread * channel / FREQ_SPREAD_SCALE);
+}
+
+// The Gemini channel is offset by half of the domain frequency range
+static uint8_t FHSSgeminiChannel(const fhss_config_t *config, uint8_t channel)
+{
+    return (channel + (config->freq_count / 2)) % config->freq_count;
+}
+
+/**
+ * Move the hops on blacklisted channels of the primary band to the other channels in turn,
+ * so they are spread evenly, skipping any which would be the same as the hop before or after
+ */
+static void FHSSapplyBlacklist(uint8_t set)
+{
+    const uint8_t * const blacklist = FHSSblacklists[set];
+    uint8_t goodChannels[FHSS_BLACKLIST_BYTES * 8];
+    uint8_t goodCount = 0;
+    for (uint8_t ch = 0; ch < FHSSconfig->freq_count; ch++)
+    {
+        if (!FHSSisBlacklisted(blacklist, ch))
+        {
+            goodChannels[goodCount++] = ch;
+        }
+    }
+    if (goodCount == FHSSconfig->freq_count)
+    {
+        return;
+    }
+
+    uint8_t goodIdx = 0;
+    uint8_t prevChannel = FHSSsequence[FHSSsequenceCount - 1];
+    for (uint16_t i = 0; i < FHSSsequenceCount; i++)
+    {
+        uint8_t channel = FHSSsequence[i];
+        if (FHSSisBlacklisted(blacklist, channel))
+        {
+            uint8_t const nextChannel = FHSSsequence[(i + 1) % FHSSsequenceCount];
+            for (uint8_t tries = 0; tries < goodCount; tries++)
+            {
+                channel = goodChannels[goodIdx];
+                goodIdx = (goodIdx + 1) % goodCount;
+                if (channel != prevChannel && channel != nextChannel)
+                {
+                    break;
+                }
+            }
+
+            FHSSfreqTables[set][i] = FHSSchannelFreq(FHSSconfig, freq_spread, channel);
+            if (!FHSSuseDualBand)
+            {
+                FHSSgeminiFreqTables[set][i] = FHSSchannelFreq(FHSSconfig, freq_spread, FHSSgeminiChannel(FHSSconfig, channel));
+            }
+        }
+        prevChannel = channel;
+    }
+}
+
+static void FHSSbuildFreqTables(uint8_t set)
+{
+    uint32_t * const freqs = FHSSfreqTables[set];
+    uint32_t * const geminiFreqs = FHSSgeminiFreqTables[set];
+    for (uint16_t i = 0; i < FHSSsequenceCount; i++)
+    {
+        if (FHSSusePrimaryFreqBand)
+        {
+            freqs[i] = FHSSchannelFreq(FHSSconfig, freq_spread, FHSSsequence[i]);
+        }
+        else
+        {
+            freqs[i] = FHSSchannelFreq(FHSSconfigDualBand, freq_spread_DualBand, FHSSsequence_DualBand[i]);
+        }
+
+        if (FHSSuseDualBand)
+        {
+            // When using Dual Band there is no need to calculate an offset frequency. Unlike Gemini with 2 frequencies in the same band.
+            geminiFreqs[i] = FHSSchannelFreq(FHSSconfigDualBand, freq_spread_DualBand, FHSSsequence_DualBand[i]);
+        }
+        else if (FHSSusePrimaryFreqBand)
+        {
+            geminiFreqs[i] = FHSSchannelFreq(FHSSconfig, freq_spread, FHSSgeminiChannel(FHSSconfig, FHSSsequence[i]));
+        }
+        else
+        {
+            geminiFreqs[i] = FHSSchannelFreq(FHSSconfigDualBand, freq_spread_DualBand, FHSSgeminiChannel(FHSSconfigDualBand, FHSSsequence_DualBand[i]));
+        }
+    }
+
+    // The other band is not blacklisted, it is applied again on changing back
+    if (FHSSusePrimaryFreqBand)
+    {
+        FHSSapplyBlacklist(set);
+    }
+}
+
+static void FHSSbuildAllFreqTables()
+{
+    FHSSsequenceCount = FHSSgetSequenceCount();
+
+    // A blacklist waiting to be swapped in is rebuilt for the new band mode too
+    bool const ready = FHSSblacklistReady;
+    FHSSblacklistReady = false;
+    FHSSbuildFreqTables(FHSSactiveTables);
+    if (ready)
+    {
+        FHSSbuildFreqTables(FHSSnextTables);
+        FHSSblacklistReady = true;
+    }
+
+    FHSSfreqCorrection = FHSSusePrimaryFreqBand ? &FreqCorrection : &noFreqCorrection;
+    FHSSgeminiFreqCorrection = (FHSSusePrimaryFreqBand && !FHSSuseDualBand) ? &FreqCorrection_2 : &noFreqCorrection;
+}
+
+void FHSSsetBandMode(const bool usePrimaryFreqBand, const bool useDualBand)
+{
+    FHSSusePrimaryFreqBand = usePrimaryFreqBand;
+    FHSSuseDualBand = useDualBand;
+    FHSSbuildAllFreqTables();
+}
+
+uint8_t ICACHE_RAM_ATTR FHSSgetBlacklistMax()
+{
+    return FHSSconfig->freq_count / 4;
+}
+
+/**
+ * The blacklist is cleaned up the same way on both ends: the sync channel and anything
+ * past the end of the band are dropped and it is cut to FHSSgetBlacklistMax() channels.
+ * The hops are rebuilt from the sequence in the set of tables not in use, so both ends
+ * get the same hops whatever blacklist they had before, and can change to them from
+ * their timer ISR on the same nonce with FHSSswapBlacklist().
+ */
+void FHSSprepareBlacklist(const uint8_t *blacklist)
+{
+    // Not to be swapped in while it is being built
+    FHSSblacklistReady = false;
+    uint8_t const set = FHSSactiveTables ^ 1;
+
+    uint8_t * const cleaned = FHSSblacklists[set];
+    memset(cleaned, 0, FHSS_BLACKLIST_BYTES);
+    if (blacklist)
+    {
+        uint8_t count = 0;
+        for (uint8_t ch = 0; ch < FHSSconfig->freq_count && count < FHSSgetBlacklistMax(); ch++)
+        {
+            if (ch != sync_channel && FHSSisBlacklisted(blacklist, ch))
+            {
+                cleaned[ch / 8] |= 1 << (ch % 8);
+                ++count;
+            }
+        }
+    }
+
+    FHSSbuildFreqTables(set);
+    FHSSnextTables = set;
+    FHSSblacklistReady = true;
+}
+
+bool ICACHE_RAM_ATTR FHSSswapBlacklist()
+{
+    if (!FHSSblacklistReady)
+    {
+        return false;
+    }
+
+    // loop() and the ISR can both get here for the same tables, which only sets them twice
+    uint8_t const set = FHSSnextTables;
+    FHSSfreqs = FHSSfreqTables[set];
+    FHSSgeminiFreqs = FHSSgeminiFreqTables[set];
+    FHSSblacklist = FHSSblacklists[set];
+    FHSSactiveTables = set;
+    FHSSblacklistReady = false;
+    return true;
+}
+
+void FHSSsetBlacklist(const uint8_t *blacklist)
+{
+    FHSSprepareBlacklist(blacklist);
+    FHSSswapBlacklist();
+}
+
+uint8_t ICACHE_RAM_ATTR FHSSgetCurrChannel()
+{
+    // Nothing is blacklisted in the other band
+    if (!FHSSusePrimaryFreqBand)
+    {
+        return FHSSsequence_DualBand[FHSSptr];
+    }
+    return ((FHSSfreqs[FHSSptr] - FHSSconfig->freq_start) * FREQ_SPREAD_SCALE + freq_spread / 2) / freq_spread;
+}
+
 void FHSSrandomiseFHSSsequence(const uint32_t seed)
 {
     FHSSconfig = &domains[firmwareOptions.domain];
+    FHSSblacklistReady = false;
+    memset(FHSSblacklists[FHSSactiveTables], 0, FHSS_BLACKLIST_BYTES);
     sync_channel = FHSSconfig->freq_count / 2;
     freq_spread = (FHSSconfig->freq_stop - FHSSconfig->freq_start) * FREQ_SPREAD_SCALE / (FHSSconfig->freq_count - 1);
     primaryBandCount = (FHSS_SEQUENCE_LEN / FHSSconfig->freq_count) * FHSSconfig->freq_count;
@@ -99,6 +315,8 @@ void FHSSrandomiseFHSSsequence(const uint32_t seed)
     FHSSrandomiseFHSSsequenceBuild(seed, FHSSconfigDualBand->freq_count, sync_channel_DualBand, FHSSsequence_DualBand);
     FHSSusePrimaryFreqBand = true;
 #endif
+
+    FHSSbuildAllFreqTables();
 }
 
 /**
@@ -50,10 +50,48 @@ extern uint8_t FHSSsequence_DualBand[];
 extern uint_fast8_t sync_channel_DualBand;
 extern const fhss_config_t *FHSSconfigDualBand;
 
+// Register values for every hop in the sequence for the current band mode, before
+// FreqCorrection. Rebuilt by FHSSrandomiseFHSSsequence() and FHSSsetBandMode(), and
+// there are two sets so a new blacklist can be built in the one not in use
+extern uint16_t FHSSsequenceCount;
+extern uint32_t *FHSSfreqs;
+extern uint32_t *FHSSgeminiFreqs;
+extern const int32_t *FHSSfreqCorrection;
+extern const int32_t *FHSSgeminiFreqCorrection;
+
+// The number of regulatory domains firmwareOptions.domain can select from
+extern const uint8_t FHSSdomainCount;
+
+// Channels of the primary band for the hops to avoid, one bit per channel. A hop on a
+// blacklisted channel goes to one of the others instead, so the sequence and sync channel
+// stay as they are and both ends only need to have the same blacklist
+#define FHSS_BLACKLIST_BYTES 10     // the 80 channels of ISM2G4
+extern const uint8_t *FHSSblacklist;
+
 // create and randomise an FHSS sequence
 void FHSSrandomiseFHSSsequence(uint32_t seed);
 void FHSSrandomiseFHSSsequenceBuild(uint32_t seed, uint32_t freqCount, uint_fast8_t sync_channel, uint8_t *sequence);
 
+// select the band(s) to hop in and rebuild the hop frequency tables to match
+void FHSSsetBandMode(bool usePrimaryFreqBand, bool useDualBand);
+
+// build the hop frequency tables for a new set of channels to avoid (nullptr for none) in the set not in use
+void FHSSprepareBlacklist(const uint8_t *blacklist);
+// change to the tables FHSSprepareBlacklist() built, only swaps pointers so it can be called from an ISR,
+// false if there are none
+bool FHSSswapBlacklist();
+// prepare and change to a new blacklist straight away
+void FHSSsetBlacklist(const uint8_t *blacklist);
+// the most channels the blacklist can hold, a quarter of the primary band
+uint8_t FHSSgetBlacklistMax();
+// the channel of the current hop in the band being hopped, after the blacklist
+uint8_t FHSSgetCurrChannel();
+
+static inline bool FHSSisBlacklisted(const uint8_t *blacklist, uint8_t channel)
+{
+    return blacklist[channel / 8] & (1 << (channel % 8));
+}
+
 static inline uint32_t FHSSgetMinimumFreq(void)
 {
     return FHSSconfig->freq_start;
@@ -137,22 +175,21 @@ static inline uint8_t FHSSonSyncChannel()
 // Set the sequence pointer, used by RX on SYNC
 static inline void FHSSsetCurrIndex(const uint8_t value)
 {
-    FHSSptr = value % FHSSgetSequenceCount();
+    FHSSptr = value % FHSSsequenceCount;
 }
 
 // Advance the pointer to the next hop and return the frequency of that channel
 static inline uint32_t FHSSgetNextFreq()
 {
-    FHSSptr = (FHSSptr + 1) % FHSSgetSequenceCount();
-
-    if (FHSSusePrimaryFreqBand)
+    // FHSSsequenceCount is at least 128 so this is the same as a modulo
+    uint_fast16_t next = FHSSptr + 1;
+    if (next >= FHSSsequenceCount)
     {
-        return FHSSconfig->freq_start + (freq_spread * FHSSsequence[FHSSptr] / FREQ_SPREAD_SCALE) - FreqCorrection;
-    }
-    else
-    {
-        return FHSSconfigDualBand->freq_start + (freq_spread_DualBand * FHSSsequence_DualBand[FHSSptr] / FREQ_SPREAD_SCALE);
+        next -= FHSSsequenceCount;
     }
+    FHSSptr = next;
+
+    return FHSSfreqs[next] - *FHSSfreqCorrection;
 }
 
 static inline const char *FHSSgetRegulatoryDomain()
@@ -186,24 +223,11 @@ static inline uint32_t FHSSGeminiFreq(uint8_t FHSSsequenceIdx)
     return freq;
 }
 
+// Get the frequency for the second radio on the current hop, either the Gemini
+// offset frequency or the DualBand frequency
 static inline uint32_t FHSSgetGeminiFreq()
 {
-    if (FHSSuseDualBand)
-    {
-        // When using Dual Band there is no need to calculate an offset frequency. Unlike Gemini with 2 frequencies in the same band.
-        return FHSSconfigDualBand->freq_start + (FHSSsequence_DualBand[FHSSptr] * freq_spread_DualBand / FREQ_SPREAD_SCALE);
-    }
-    else
-    {
-        if (FHSSusePrimaryFreqBand)
-        {
-            return FHSSGeminiFreq(FHSSsequence[FHSSgetCurrIndex()]);
-        }
-        else
-        {
-            return FHSSGeminiFreq(FHSSsequence_DualBand[FHSSgetCurrIndex()]);
-        }
-    }
+    return FHSSgeminiFreqs[FHSSptr] - *FHSSgeminiFreqCorrection;
 }
 
 static inline uint32_t FHSSgetInitialGeminiFreq()
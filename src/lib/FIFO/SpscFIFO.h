@@ -0,0 +1,192 @@
+#pragma once
+
+#include "targets.h"
+#include <atomic>
+#include <cstring>
+
+/**
+ * @brief A lock-free byte FIFO for exactly one producer and one consumer, e.g.
+ * the main loop filling a buffer which the radio ISR drains, or vice versa.
+ *
+ * Unlike `FIFO` no locking is needed: the producer only writes `tail` and the
+ * consumer only writes `head`, both free running and published with release
+ * ordering. Bulk transfers are at most two memcpy's, one each side of the wrap.
+ *
+ * Differences from `FIFO` to be aware of when converting a caller:
+ * - pushBytes()/popBytes() are all-or-nothing and return false rather than
+ *   flushing the FIFO, the producer can't flush a buffer it doesn't own the
+ *   head of.
+ * - flush() belongs to the consumer, only call it from the producer side when
+ *   the consumer is known to be idle.
+ *
+ * @tparam FIFO_SIZE size of the FIFO in bytes, must be a power of two
+ */
+template <uint32_t FIFO_SIZE>
+class SpscFIFO
+{
+    static_assert(FIFO_SIZE > 0 && (FIFO_SIZE & (FIFO_SIZE - 1)) == 0, "SpscFIFO size must be a power of two");
+    static_assert(FIFO_SIZE <= 0x8000, "SpscFIFO sizes are reported as uint16_t");
+
+private:
+    uint8_t buffer[FIFO_SIZE] = {0};
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> tail {0};
+
+public:
+    /**
+     * @brief (producer) push a single byte
+     * @return false if the FIFO is full
+     */
+    ICACHE_RAM_ATTR bool push(const uint8_t data)
+    {
+        uint32_t const t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == FIFO_SIZE)
+        {
+            return false;
+        }
+        buffer[t & (FIFO_SIZE - 1)] = data;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief (producer) push all `len` bytes, or none if they will not all fit
+     * @return false if the bytes did not fit
+     */
+    ICACHE_RAM_ATTR bool pushBytes(const uint8_t *data, uint16_t len)
+    {
+        uint32_t const t = tail.load(std::memory_order_relaxed);
+        if (FIFO_SIZE - (t - head.load(std::memory_order_acquire)) < len)
+        {
+            return false;
+        }
+        uint32_t const offset = t & (FIFO_SIZE - 1);
+        uint32_t const first = len < FIFO_SIZE - offset ? len : FIFO_SIZE - offset;
+        memcpy(&buffer[offset], data, first);
+        memcpy(&buffer[0], data + first, len - first);
+        tail.store(t + len, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief (producer) get the contiguous free space at the tail, to be filled in place
+     * and then published with commitWrite()
+     *
+     * @param span set to the start of the free space
+     * @return number of bytes which can be written at `span`
+     */
+    ICACHE_RAM_ATTR uint16_t writeSpan(uint8_t **span)
+    {
+        uint32_t const t = tail.load(std::memory_order_relaxed);
+        uint32_t const offset = t & (FIFO_SIZE - 1);
+        uint32_t const freeBytes = FIFO_SIZE - (t - head.load(std::memory_order_acquire));
+        *span = &buffer[offset];
+        return freeBytes < FIFO_SIZE - offset ? freeBytes : FIFO_SIZE - offset;
+    }
+
+    /**
+     * @brief (producer) publish `len` bytes written to the span from writeSpan()
+     */
+    ICACHE_RAM_ATTR void commitWrite(uint16_t len)
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+    /**
+     * @brief (consumer) pop a single byte
+     * @return the byte, or 0 if the FIFO is empty
+     */
+    ICACHE_RAM_ATTR uint8_t pop()
+    {
+        uint32_t const h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h)
+        {
+            return 0;
+        }
+        uint8_t const data = buffer[h & (FIFO_SIZE - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return data;
+    }
+
+    /**
+     * @brief (consumer) pop exactly `len` bytes, or none if there are not that many
+     * @return false if there were not enough bytes
+     */
+    ICACHE_RAM_ATTR bool popBytes(uint8_t *data, uint16_t len)
+    {
+        uint32_t const h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) - h < len)
+        {
+            return false;
+        }
+        uint32_t const offset = h & (FIFO_SIZE - 1);
+        uint32_t const first = len < FIFO_SIZE - offset ? len : FIFO_SIZE - offset;
+        memcpy(data, &buffer[offset], first);
+        memcpy(data + first, &buffer[0], len - first);
+        head.store(h + len, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief (consumer) return the first byte without removing it
+     * @return the byte, or 0 if the FIFO is empty
+     */
+    ICACHE_RAM_ATTR uint8_t peek()
+    {
+        uint32_t const h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h)
+        {
+            return 0;
+        }
+        return buffer[h & (FIFO_SIZE - 1)];
+    }
+
+    /**
+     * @brief (consumer) get the contiguous data at the head without copying it,
+     * release it with consume() when done
+     *
+     * @param span set to the start of the data
+     * @return number of bytes readable at `span`, if the data wraps the rest
+     * is returned by the next call after consume()
+     */
+    ICACHE_RAM_ATTR uint16_t peekSpan(const uint8_t **span)
+    {
+        uint32_t const h = head.load(std::memory_order_relaxed);
+        uint32_t const offset = h & (FIFO_SIZE - 1);
+        uint32_t const used = tail.load(std::memory_order_acquire) - h;
+        *span = &buffer[offset];
+        return used < FIFO_SIZE - offset ? used : FIFO_SIZE - offset;
+    }
+
+    /**
+     * @brief (consumer) remove `len` bytes from the head
+     */
+    ICACHE_RAM_ATTR void consume(uint16_t len)
+    {
+        head.store(head.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+    /**
+     * @brief (consumer) reset the FIFO back to empty
+     */
+    ICACHE_RAM_ATTR void flush()
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    /**
+     * @brief return the number of bytes in the FIFO
+     */
+    ICACHE_RAM_ATTR uint16_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief return the number of bytes free in the FIFO
+     */
+    ICACHE_RAM_ATTR uint16_t free() const
+    {
+        return FIFO_SIZE - size();
+    }
+};
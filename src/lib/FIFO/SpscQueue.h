@@ -0,0 +1,102 @@
+#pragma once
+
+#include "targets.h"
+#include <atomic>
+
+/**
+ * @brief A lock-free queue of fixed size items for passing data from exactly one
+ * producer (e.g. an ISR) to exactly one consumer (e.g. the main loop).
+ *
+ * The producer only writes `tail` and the consumer only writes `head`, each
+ * publishing its slot with release ordering, so no locking is needed even when
+ * the two sides run on different cores.
+ *
+ * Slots are filled and drained in place: the producer calls reserve() to get a
+ * free slot to write into followed by commit(), the consumer calls front() to
+ * read the oldest item followed by pop().
+ *
+ * @tparam T type of the items, should be trivially copyable
+ * @tparam N number of slots, must be a power of two
+ */
+template <typename T, uint32_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head {0};  // next slot to read, free running
+    std::atomic<uint32_t> tail {0};  // next slot to write, free running
+
+public:
+    /**
+     * @brief (producer) get the next free slot to fill
+     * @return pointer to the slot, or nullptr if the queue is full
+     */
+    ICACHE_RAM_ATTR T *reserve()
+    {
+        uint32_t const t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= N)
+            return nullptr;
+        return &slots[t & (N - 1)];
+    }
+
+    /**
+     * @brief (producer) publish the slot returned by reserve()
+     */
+    ICACHE_RAM_ATTR void commit()
+    {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief (producer) copy an item into the queue
+     * @return false if the queue is full
+     */
+    ICACHE_RAM_ATTR bool push(const T &item)
+    {
+        T *slot = reserve();
+        if (slot == nullptr)
+            return false;
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    /**
+     * @brief (consumer) get the oldest item in the queue without removing it
+     * @return pointer to the item, or nullptr if the queue is empty
+     */
+    ICACHE_RAM_ATTR T *front()
+    {
+        uint32_t const h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots[h & (N - 1)];
+    }
+
+    /**
+     * @brief (consumer) release the item returned by front()
+     */
+    ICACHE_RAM_ATTR void pop()
+    {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief (consumer) discard everything in the queue
+     */
+    void flush()
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() >= N; }
+    static constexpr uint32_t capacity() { return N; }
+};
@@ -11,17 +11,12 @@ volatile bool hwTimer::isTick = false;
 volatile uint32_t hwTimer::HWtimerInterval = TimerIntervalUSDefault;
 volatile int32_t hwTimer::PhaseShift = 0;
 volatile int32_t hwTimer::FreqOffset = 0;
+int32_t hwTimer::FreqOffsetResidue = 0;
 
 // Internal implementation specific variables
 static hw_timer_t *timer = NULL;
 static portMUX_TYPE isrMutex = portMUX_INITIALIZER_UNLOCKED;
 
-#if defined(TARGET_RX)
-#define HWTIMER_TICKS_PER_US 5
-#else
-#define HWTIMER_TICKS_PER_US 1
-#endif
-
 void ICACHE_RAM_ATTR hwTimer::init(void (*callbackTick)(), void (*callbackTock)())
 {
 
@@ -97,7 +92,7 @@ void ICACHE_RAM_ATTR hwTimer::callback(void)
 #if defined(TARGET_TX)
         callbackTock();
 #else
-        uint32_t NextInterval = (HWtimerInterval >> 1) + FreqOffset;
+        uint32_t NextInterval = (HWtimerInterval >> 1) + hwTimerFreqOffsetUnits(FreqOffset, HWTIMER_TICKS_PER_US, FreqOffsetResidue);
         if (hwTimer::isTick)
         {
             timerAlarmWrite(timer, NextInterval, true);
@@ -10,11 +10,11 @@ volatile bool hwTimer::isTick = false;
 volatile uint32_t hwTimer::HWtimerInterval = TimerIntervalUSDefault;
 volatile int32_t hwTimer::PhaseShift = 0;
 volatile int32_t hwTimer::FreqOffset = 0;
+int32_t hwTimer::FreqOffsetResidue = 0;
 
 // Internal implementation specific variables
 static uint32_t NextTimeout;
 
-#define HWTIMER_TICKS_PER_US 5
 #define HWTIMER_PRESCALER (clockCyclesPerMicrosecond() / HWTIMER_TICKS_PER_US)
 
 void hwTimer::init(void (*callbackTick)(), void (*callbackTock)())
@@ -82,7 +82,7 @@ void ICACHE_RAM_ATTR hwTimer::callback()
         timer0_write(NextTimeout);
         callbackTock();
 #else
-        NextTimeout += (HWtimerInterval >> 1) + (FreqOffset * HWTIMER_PRESCALER);
+        NextTimeout += (HWtimerInterval >> 1) + hwTimerFreqOffsetUnits(FreqOffset, HWTIMER_TICKS_PER_US * HWTIMER_PRESCALER, FreqOffsetResidue);
         if (hwTimer::isTick)
         {
             timer0_write(NextTimeout);
@@ -9,6 +9,30 @@
 #define TimerIntervalUSDefault 20000
 #endif
 
+// Resolution of the timer, the internal interval and PhaseShift are in these units
+#if defined(PLATFORM_ESP32) && defined(TARGET_TX)
+#define HWTIMER_TICKS_PER_US 1
+#else
+#define HWTIMER_TICKS_PER_US 5
+#endif
+
+// FreqOffset is in 1/256us, accumulated so the fraction of a tick is not lost
+#define HWTIMER_FREQ_OFFSET_FRAC_BITS 8
+
+/**
+ * @brief Get the whole timer units of a fractional FreqOffset to add to the next
+ * half interval, carrying the remainder over in `residue`
+ * @param freqOffset in 1/256us
+ * @param unitsPerUs timer units per microsecond
+ * @param residue fraction of a timer unit left over from the last call, [0, 256)
+ */
+static inline ICACHE_RAM_ATTR int32_t hwTimerFreqOffsetUnits(int32_t freqOffset, uint32_t unitsPerUs, int32_t &residue)
+{
+    int32_t const acc = residue + freqOffset * (int32_t)unitsPerUs;
+    residue = acc & ((1 << HWTIMER_FREQ_OFFSET_FRAC_BITS) - 1);
+    return acc >> HWTIMER_FREQ_OFFSET_FRAC_BITS;
+}
+
 /**
  * @brief Hardware abstraction for the hardware timer to provide precise timing
  *
@@ -16,8 +40,9 @@
  * interval each.
  *
  * The timer includes a built-in frequency offset to adjust for differences in actual
- * timing rates between 2 timers. The offset can be incremented, decremented or reset
- * to 0.
+ * timing rates between 2 timers. The offset can be set, incremented, decremented or reset
+ * to 0. It has a resolution of 1/256us per half interval, the fraction of a timer tick
+ * is carried from one half interval to the next so the average rate is exact.
  *
  * The `phaseShift` function can be used to provide a one-time adjustment to shift the
  * phase of the timer so two timers can be aligned on their tock phase.
@@ -60,16 +85,22 @@ public:
     /**
      * @brief Reset the frequency offset to zero microseconds
      */
-    static ICACHE_RAM_ATTR void inline resetFreqOffset() { FreqOffset = 0; }
+    static ICACHE_RAM_ATTR void inline resetFreqOffset() { FreqOffset = 0; FreqOffsetResidue = 0; }
+
+    /**
+     * @brief Set the frequency offset, in 1/256us added to each half of the interval.
+     * Takes effect from the next tick or tock.
+     */
+    static ICACHE_RAM_ATTR void inline setFreqOffset(int32_t newFreqOffset) { FreqOffset = newFreqOffset; }
 
     /**
-     * @brief Increment the frequency offset by one microsecond
+     * @brief Increment the frequency offset by 1/256us
      */
     static ICACHE_RAM_ATTR void inline incFreqOffset() { FreqOffset++; }
 
 
     /**
-     * @brief Decrement the frequency offset by one microsecond
+     * @brief Decrement the frequency offset by 1/256us
      */
     static ICACHE_RAM_ATTR void inline decFreqOffset() { FreqOffset--; }
 
@@ -103,4 +134,5 @@ private:
     static volatile uint32_t HWtimerInterval;
     static volatile int32_t PhaseShift;
     static volatile int32_t FreqOffset;
+    static int32_t FreqOffsetResidue;
 };
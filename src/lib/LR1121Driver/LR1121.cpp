@@ -25,6 +25,8 @@ LR1121Driver::LR1121Driver(): SX12xxDriverCommon()
     lastSuccessfulPacketRadio = SX12XX_Radio_1;
     fallBackMode = LR1121_MODE_FS;
     useFEC = false;
+    FECBufferKeptValid = false;
+    rxBufferAddrRadios = SX12XX_Radio_NONE;
 }
 
 void LR1121Driver::End()
@@ -123,6 +125,7 @@ void LR1121Driver::Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t regfreq,
                           SX12XX_Radio_Number_t radioNumber)
 {
     PayloadLength = _PayloadLength;
+    rxBufferAddrRadios &= ~radioNumber;
 
     bool isSubGHz = regfreq < 1000000000;
 
@@ -150,6 +153,7 @@ void LR1121Driver::Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t regfreq,
     hal.WriteCommand(LR11XX_RADIO_SET_PKT_TYPE_OC, buf, sizeof(buf), radioNumber);
 
     useFEC = false;
+    FECBufferKeptValid = false;
     if (useFSK)
     {
         DBGLN("Config FSK");
@@ -619,35 +623,69 @@ void ICACHE_RAM_ATTR LR1121Driver::TXnb(uint8_t * data, uint8_t size, SX12XX_Rad
 #endif
 }
 
-bool ICACHE_RAM_ATTR LR1121Driver::RXnbISR(SX12XX_Radio_Number_t radioNumber)
+// 7.2.11 GetRxBufferStatus
+uint8_t ICACHE_RAM_ATTR LR1121Driver::GetRxBufferAddr(SX12XX_Radio_Number_t radioNumber)
 {
-    // 7.2.11 GetRxBufferStatus
-    uint8_t buf[3] = {0};
-    hal.WriteCommand(LR11XX_RADIO_GET_RXBUFFER_STATUS_OC, radioNumber);
-    hal.ReadCommand(buf, sizeof(buf), radioNumber);
-
-    uint8_t const PayloadLengthRX = buf[1];
-    uint8_t const RxStartBufferPointer = buf[2];
+    uint8_t const idx = (radioNumber == SX12XX_Radio_1) ? 0 : 1;
+    if (!(rxBufferAddrRadios & radioNumber))
+    {
+        uint8_t buf[3] = {0};
+        hal.WriteCommand(LR11XX_RADIO_GET_RXBUFFER_STATUS_OC, radioNumber);
+        hal.ReadCommand(buf, sizeof(buf), radioNumber);
+        rxBufferAddr[idx] = buf[2]; // RxStartBufferPointer
+        rxBufferAddrRadios |= radioNumber;
+    }
+    return rxBufferAddr[idx];
+}
 
-    // 3.7.5 ReadBuffer8
+bool ICACHE_RAM_ATTR LR1121Driver::RXnbISR(SX12XX_Radio_Number_t radioNumber)
+{
+    // 3.7.5 ReadBuffer8, the packets are all PayloadLength
     uint8_t inbuf[2];
-    inbuf[0] = RxStartBufferPointer;
-    inbuf[1] = PayloadLengthRX;
+    inbuf[0] = GetRxBufferAddr(radioNumber);
+    inbuf[1] = PayloadLength;
 
-    uint8_t payloadbuf[PayloadLengthRX + 1] = {0};
+    uint8_t payloadbuf[PayloadLength + 1] = {0};
     hal.WriteCommand(LR11XX_REGMEM_READ_BUFFER8_OC, inbuf, sizeof(inbuf), radioNumber);
     hal.ReadCommand(payloadbuf, sizeof(payloadbuf), radioNumber);
 
+    rx_status status = SX12XX_RX_OK;
     if (useFEC)
     {
-        FECDecode(payloadbuf + 1, RXdataBuffer);
+        memcpy(FECBuffer, payloadbuf + 1, sizeof(FECBuffer));
+        if (FECDecodeWithStatus(FECBuffer, RXdataBuffer, &FECStatus) != FEC_CLEAN)
+        {
+            status = SX12XX_RX_FEC_CORRECTED;
+        }
     }
     else
     {
-        memcpy(RXdataBuffer, payloadbuf + 1, PayloadLengthRX);
+        memcpy(RXdataBuffer, payloadbuf + 1, PayloadLength);
     }
 
-    return RXdoneCallback(SX12XX_RX_OK);
+    return RXdoneCallback(status);
+}
+
+void ICACHE_RAM_ATTR LR1121Driver::FECKeepForCombining()
+{
+    memcpy(FECBufferKept, FECBuffer, sizeof(FECBufferKept));
+    FECBufferKeptValid = true;
+}
+
+/***
+ * @brief: Combine the codewords of the last packet with those of the kept copy
+ * and decode the result into RXdataBuffer. The kept copy is used up
+ * @return: false if there was no kept copy
+ ***/
+bool ICACHE_RAM_ATTR LR1121Driver::FECCombineWithKept()
+{
+    if (!FECBufferKeptValid)
+    {
+        return false;
+    }
+    FECBufferKeptValid = false;
+    FECDecodeCombine(FECBufferKept, FECBuffer, RXdataBuffer, &FECStatus);
+    return true;
 }
 
 void ICACHE_RAM_ATTR LR1121Driver::RXnb(lr11xx_RadioOperatingModes_t rxMode)
@@ -686,20 +724,12 @@ void ICACHE_RAM_ATTR LR1121Driver::GetLastPacketStats()
         uint32_t secondIrqStatus = instance->GetIrqStatus(radio[secondRadioIdx]);
         if(secondIrqStatus & LR1121_IRQ_RX_DONE)
         {
-            // 7.2.11 GetRxBufferStatus
-            uint8_t buf[3] = {0};
-            hal.WriteCommand(LR11XX_RADIO_GET_RXBUFFER_STATUS_OC, radio[secondRadioIdx]);
-            hal.ReadCommand(buf, sizeof(buf), radio[secondRadioIdx]);
-
-            uint8_t const PayloadLengthRX = buf[1];
-            uint8_t const RxStartBufferPointer = buf[2];
-
             // 3.7.5 ReadBuffer8
             uint8_t inbuf[2];
-            inbuf[0] = RxStartBufferPointer;
-            inbuf[1] = PayloadLengthRX;
+            inbuf[0] = GetRxBufferAddr(radio[secondRadioIdx]);
+            inbuf[1] = PayloadLength;
 
-            WORD_ALIGNED_ATTR uint8_t RXdataBuffer_second[PayloadLengthRX + 1] = {0};
+            WORD_ALIGNED_ATTR uint8_t RXdataBuffer_second[PayloadLength + 1] = {0};
 
             hal.WriteCommand(LR11XX_REGMEM_READ_BUFFER8_OC, inbuf, sizeof(inbuf), radio[secondRadioIdx]);
             hal.ReadCommand(RXdataBuffer_second, sizeof(RXdataBuffer_second), radio[secondRadioIdx]);
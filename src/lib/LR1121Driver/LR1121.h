@@ -46,9 +46,16 @@ public:
     uint32_t GetIrqStatus(SX12XX_Radio_Number_t radioNumber);
     void ClearIrqStatus(SX12XX_Radio_Number_t radioNumber);
 
+    uint8_t GetRxBufferAddr(SX12XX_Radio_Number_t radioNumber);
     int8_t GetRssiInst(SX12XX_Radio_Number_t radioNumber);
     void GetLastPacketStats();
 
+    // FEC combining of DVDA copies, see FECDecodeCombine()
+    bool FECEnabled() const { return useFEC; }
+    void FECKeepForCombining();
+    bool FECCombineWithKept();
+    FECDecodeStatus_s FECStatus;
+
 private:
     // constant used for no power change pending
     // must not be a valid power register value
@@ -66,6 +73,12 @@ private:
     bool radio2isSubGHz;
     lr11xx_RadioOperatingModes_t fallBackMode;
     bool useFEC;
+    uint8_t FECBuffer[14];      // raw payload of the last packet received
+    uint8_t FECBufferKept[14];  // raw payload of an earlier copy which failed the CRC
+    bool FECBufferKeptValid;
+    // Each packet is received at the same place, so GetRxBufferAddr() only reads it once per Config()
+    uint8_t rxBufferAddr[2];
+    uint8_t rxBufferAddrRadios;
 
     void SetMode(lr11xx_RadioOperatingModes_t OPmode, SX12XX_Radio_Number_t radioNumber);
 
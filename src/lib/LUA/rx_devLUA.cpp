@@ -566,6 +566,9 @@ static void registerLuaParameters()
     sendLuaCommandResponse(&luaBindMode, arg < 5 ? lcsExecuting : lcsIdle, arg < 5 ? "Entering..." : "");
   });
 
+#if defined(DEBUG_CYCLE_STATS)
+  luadevRegisterCycleStats();
+#endif
   registerLUAParameter(&luaModelNumber);
   registerLUAParameter(&luaELRSversion);
   registerLUAParameter(nullptr);
@@ -646,6 +649,15 @@ static int event()
 static int timeout()
 {
   luaHandleUpdateParameter();
+#if defined(DEBUG_CYCLE_STATS)
+  static uint32_t lastCycleStatsUpdate;
+  uint32_t const now = millis();
+  if (now - lastCycleStatsUpdate >= 1000)
+  {
+    luadevUpdateCycleStats();
+    lastCycleStatsUpdate = now;
+  }
+#endif
   // Receivers can only `UpdateParamReq == true` every 4th packet due to the transmitter cadence in 1:2
   // Channels, Downlink Telemetry Slot, Uplink Telemetry (the write command), Downlink Telemetry Slot...
   // (interval * 4 / 1000) or 1 second if not connected
@@ -1,5 +1,6 @@
 #include "rxtx_devLua.h"
 #include "POWERMGNT.h"
+#include "CycleStats.h"
 
 char strPowerLevels[] = "10;25;50;100;250;500;1000;2000;MatchTX ";
 const char STR_EMPTYSPACE[] = { 0 };
@@ -41,3 +42,38 @@ void luadevGeneratePowerOpts(luaItem_selection *luaPower)
     strcat(strPowerLevels, ";MatchTX ");
 #endif
 }
+
+#if defined(DEBUG_CYCLE_STATS)
+static struct luaItem_folder luaCycleStatsFolder = {
+    {"Cycle Stats", CRSF_FOLDER},
+};
+
+static char luaCycleStatsValues[CYCLE_STATS_SECTION_COUNT][16];
+static struct luaItem_string luaCycleStats[CYCLE_STATS_SECTION_COUNT];
+
+void luadevRegisterCycleStats()
+{
+  registerLUAParameter(&luaCycleStatsFolder);
+  for (uint8_t i = 0; i < CYCLE_STATS_SECTION_COUNT; i++)
+  {
+    luaCycleStats[i].common.name = CycleStats_SectionName((cycleStatsSection_e)i);
+    luaCycleStats[i].common.type = CRSF_INFO;
+    luaCycleStats[i].value = luaCycleStatsValues[i];
+    registerLUAParameter(&luaCycleStats[i], nullptr, luaCycleStatsFolder.common.id);
+  }
+  luadevUpdateCycleStats();
+}
+
+void luadevUpdateCycleStats()
+{
+  for (uint8_t i = 0; i < CYCLE_STATS_SECTION_COUNT; i++)
+  {
+    CycleStats_Format((cycleStatsSection_e)i, luaCycleStatsValues[i], sizeof(luaCycleStatsValues[i]));
+    // Sections which never run on this target stay hidden
+    if (luaCycleStatsValues[i][0] == '-')
+      LUA_FIELD_HIDE(luaCycleStats[i])
+    else
+      LUA_FIELD_SHOW(luaCycleStats[i])
+  }
+}
+#endif
@@ -8,6 +8,10 @@
 
 // Common functions
 void luadevGeneratePowerOpts(luaItem_selection *luaPower);
+#if defined(DEBUG_CYCLE_STATS)
+void luadevRegisterCycleStats();
+void luadevUpdateCycleStats();
+#endif
 
 // Common Lua storage (mutable)
 extern char strPowerLevels[];
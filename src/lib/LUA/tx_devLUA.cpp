@@ -43,7 +43,7 @@ static const char tlmRatios[] = "Std;Off;1:128;1:64;1:32;1:16;1:8;1:4;1:2;Race";
 static const char tlmRatiosMav[] = ";;;;;;;;1:2;";
 static const char switchmodeOpts4ch[] = "Wide;Hybrid";
 static const char switchmodeOpts4chMav[] = ";Hybrid";
-static const char switchmodeOpts8ch[] = "8ch;16ch Rate/2;12ch Mixed";
+static const char switchmodeOpts8ch[] = "8ch;16ch Rate/2;12ch Mixed;16ch Delta";
 static const char switchmodeOpts8chMav[] = ";16ch Rate/2;";
 static const char antennamodeOpts[] = "Gemini;Ant 1;Ant 2;Switch";
 static const char linkModeOpts[] = "Normal;MAVLink";
@@ -70,6 +70,13 @@ static struct luaItem_selection luaTlmRate = {
     tlmBandwidth
 };
 
+static struct luaItem_selection luaAdaptiveRate = {
+    {"Adaptive Rate", CRSF_TEXT_SELECTION},
+    0, // value
+    luastrOffOn,
+    STR_EMPTYSPACE
+};
+
 //----------------------------POWER------------------
 static struct luaItem_folder luaPowerFolder = {
     {"TX Power", CRSF_FOLDER},pwrFolderDynamicName
@@ -540,6 +547,9 @@ static void luadevUpdateBadGood()
   itoa(CRSFHandset::BadPktsCountResult, luaBadGoodString, 10);
   strcat(luaBadGoodString, "/");
   itoa(CRSFHandset::GoodPktsCountResult, luaBadGoodString + strlen(luaBadGoodString), 10);
+#if defined(DEBUG_CYCLE_STATS)
+  luadevUpdateCycleStats();
+#endif
 }
 
 /***
@@ -591,7 +601,7 @@ static void recalculatePacketRateOptions(int minInterval)
 
 uint8_t adjustSwitchModeForAirRate(OtaSwitchMode_e eSwitchMode, uint8_t packetSize)
 {
-  // Only the fullres modes have 3 switch modes, so reset the switch mode if outside the
+  // Only the fullres modes have more than 2 switch modes, so reset the switch mode if outside the
   // range for 4ch mode
   if (packetSize == OTA4_PACKET_SIZE)
   {
@@ -643,6 +653,9 @@ static void registerLuaParameters()
         }
       }
     });
+    registerLUAParameter(&luaAdaptiveRate, [](struct luaPropertiesCommon *item, uint8_t arg) {
+      config.SetAdaptiveRate(arg);
+    });
     if (!firmwareOptions.is_airport)
     {
       registerLUAParameter(&luaSwitch, [](struct luaPropertiesCommon *item, uint8_t arg) {
@@ -810,6 +823,9 @@ static void registerLuaParameters()
     registerLUAParameter(&luaBind, &luahandSimpleSendCmd);
   }
 
+#if defined(DEBUG_CYCLE_STATS)
+  luadevRegisterCycleStats();
+#endif
   registerLUAParameter(&luaInfo);
   if (strlen(version) < 21) {
     strlcpy(version_domain, version, 21);
@@ -837,6 +853,7 @@ static int event()
 
   setLuaTextSelectionValue(&luaTlmRate, config.GetTlm());
   luaTlmRate.options = isMavlinkMode ? tlmRatiosMav : tlmRatios;
+  setLuaTextSelectionValue(&luaAdaptiveRate, (uint8_t)config.GetAdaptiveRate());
 
   setLuaTextSelectionValue(&luaSwitch, config.GetSwitchMode());
   if (isMavlinkMode)
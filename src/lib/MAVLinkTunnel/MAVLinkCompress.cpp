@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <cstring>
+#include "MAVLinkCompress.h"
+#include "MAVLinkTunnel.h"
+
+#define NO_REPEAT_SLOT -1
+
+typedef struct {
+    uint8_t msgId;
+    uint8_t crcExtra;
+    int8_t repeatSlot;
+} mavlink_compress_msg_t;
+
+// The index in this table is what goes over the air, only ever add to the end
+static const mavlink_compress_msg_t compressMsgs[] = {
+    {0, 50, 0},                 // HEARTBEAT
+    {1, 124, 1},                // SYS_STATUS
+    {2, 137, NO_REPEAT_SLOT},   // SYSTEM_TIME
+    {22, 220, NO_REPEAT_SLOT},  // PARAM_VALUE
+    {24, 24, NO_REPEAT_SLOT},   // GPS_RAW_INT
+    {27, 144, NO_REPEAT_SLOT},  // RAW_IMU
+    {29, 115, NO_REPEAT_SLOT},  // SCALED_PRESSURE
+    {30, 39, NO_REPEAT_SLOT},   // ATTITUDE
+    {31, 246, NO_REPEAT_SLOT},  // ATTITUDE_QUATERNION
+    {32, 185, NO_REPEAT_SLOT},  // LOCAL_POSITION_NED
+    {33, 104, NO_REPEAT_SLOT},  // GLOBAL_POSITION_INT
+    {35, 244, NO_REPEAT_SLOT},  // RC_CHANNELS_RAW
+    {36, 222, NO_REPEAT_SLOT},  // SERVO_OUTPUT_RAW
+    {42, 28, 2},                // MISSION_CURRENT
+    {44, 221, NO_REPEAT_SLOT},  // MISSION_COUNT
+    {47, 153, NO_REPEAT_SLOT},  // MISSION_ACK
+    {51, 196, NO_REPEAT_SLOT},  // MISSION_REQUEST_INT
+    {62, 183, NO_REPEAT_SLOT},  // NAV_CONTROLLER_OUTPUT
+    {65, 118, NO_REPEAT_SLOT},  // RC_CHANNELS
+    {73, 38, NO_REPEAT_SLOT},   // MISSION_ITEM_INT
+    {74, 20, NO_REPEAT_SLOT},   // VFR_HUD
+    {77, 143, NO_REPEAT_SLOT},  // COMMAND_ACK
+    {111, 34, NO_REPEAT_SLOT},  // TIMESYNC
+    {116, 76, NO_REPEAT_SLOT},  // SCALED_IMU2
+    {125, 203, 3},              // POWER_STATUS
+    {147, 154, NO_REPEAT_SLOT}, // BATTERY_STATUS
+    {152, 208, NO_REPEAT_SLOT}, // MEMINFO (ArduPilot)
+    {163, 127, NO_REPEAT_SLOT}, // AHRS (ArduPilot)
+    {165, 21, 4},               // HWSTATUS (ArduPilot)
+    {178, 47, NO_REPEAT_SLOT},  // AHRS2 (ArduPilot)
+    {193, 71, 5},               // EKF_STATUS_REPORT (ArduPilot)
+    {241, 90, NO_REPEAT_SLOT},  // VIBRATION
+};
+static_assert(sizeof(compressMsgs) / sizeof(compressMsgs[0]) <= 32, "The index must fit the 5 bits of the tag");
+
+static int8_t compressMsgIndex(uint32_t msgId)
+{
+    for (uint8_t i = 0; i < sizeof(compressMsgs) / sizeof(compressMsgs[0]); ++i)
+    {
+        if (compressMsgs[i].msgId == msgId)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief: The CRC-16/MCRF4XX (X.25) MAVLink uses
+ ***/
+uint16_t MAVLinkCrc(uint8_t const *data, uint16_t len, uint16_t crc)
+{
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        uint8_t tmp = data[i] ^ (uint8_t)crc;
+        tmp ^= tmp << 4;
+        crc = (crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4);
+    }
+    return crc;
+}
+
+void MAVLinkCompressState::reset()
+{
+    sourceValid = false;
+    for (mavlink_compress_repeat_t &repeat : repeats)
+    {
+        repeat.valid = false;
+    }
+}
+
+// A frame record went over the link, both ends update their state the same way
+void MAVLinkCompressState::recordFrame(uint8_t index, uint8_t sysId, uint8_t compId, uint8_t len, uint8_t const *payload)
+{
+    sourceValid = true;
+    sourceSysId = sysId;
+    sourceCompId = compId;
+
+    int8_t const slot = compressMsgs[index].repeatSlot;
+    if (slot != NO_REPEAT_SLOT)
+    {
+        mavlink_compress_repeat_t &repeat = repeats[slot];
+        repeat.valid = len <= MAVLINK_COMPRESS_REPEAT_MAX_LEN;
+        repeat.sysId = sysId;
+        repeat.compId = compId;
+        repeat.len = len;
+        if (repeat.valid)
+        {
+            memcpy(repeat.payload, payload, len);
+        }
+    }
+}
+
+/**
+ * @brief: The table index of a frame which can be sent as a record, or -1
+ ***/
+int8_t MAVLinkCompressor::compressibleIndex(uint8_t const *frame, uint16_t frameLen)
+{
+    // Unsigned v2 with no flags only, the header must be all the frame has besides the payload
+    if (frame[0] != MAVLINK_TUNNEL_STX_V2 || frame[2] != 0 || frame[3] != 0 || frameLen != 10 + frame[1] + 2)
+    {
+        return -1;
+    }
+
+    int8_t const index = compressMsgIndex(MAVLinkTunnel::frameMsgId(frame));
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    // The TX recalculates the CRC, so only a frame which had the right one can go
+    uint16_t const crc = MAVLinkCrc(&frame[1], 9 + frame[1], 0xFFFF);
+    uint16_t const expected = MAVLinkCrc(&compressMsgs[index].crcExtra, 1, crc);
+    if ((frame[frameLen - 2] | (frame[frameLen - 1] << 8)) != expected)
+    {
+        return -1;
+    }
+    return index;
+}
+
+/**
+ * @brief: Encode a whole frame as it would go over the link
+ * @returns: bytes in out, at most frameLen
+ ***/
+uint16_t MAVLinkCompressor::encode(uint8_t const *frame, uint16_t frameLen, uint8_t *out) const
+{
+    int8_t const index = compressibleIndex(frame, frameLen);
+    if (index < 0)
+    {
+        memcpy(out, frame, frameLen);
+        return frameLen;
+    }
+
+    uint8_t const len = frame[1];
+    uint8_t const sysId = frame[5];
+    uint8_t const compId = frame[6];
+    uint8_t const *payload = &frame[10];
+
+    int8_t const slot = compressMsgs[index].repeatSlot;
+    if (slot != NO_REPEAT_SLOT)
+    {
+        mavlink_compress_repeat_t const &repeat = repeats[slot];
+        if (repeat.valid && repeat.sysId == sysId && repeat.compId == compId && repeat.len == len &&
+            memcmp(repeat.payload, payload, len) == 0)
+        {
+            out[0] = MAVLINK_COMPRESS_TAG_REPEAT | index;
+            return 1;
+        }
+    }
+
+    bool const newSource = !sourceValid || sourceSysId != sysId || sourceCompId != compId;
+    uint16_t pos = 0;
+    out[pos++] = MAVLINK_COMPRESS_TAG_FRAME | (index << 1) | (newSource ? 1 : 0);
+    if (newSource)
+    {
+        out[pos++] = sysId;
+        out[pos++] = compId;
+    }
+    out[pos++] = len;
+    memcpy(&out[pos], payload, len);
+    return pos + len;
+}
+
+/**
+ * @brief: Update the state for a frame encode()d and sent
+ ***/
+void MAVLinkCompressor::commit(uint8_t const *frame, uint16_t frameLen)
+{
+    int8_t const index = compressibleIndex(frame, frameLen);
+    if (index >= 0)
+    {
+        recordFrame(index, frame[5], frame[6], frame[1], &frame[10]);
+    }
+}
+
+void MAVLinkDecompressor::reset()
+{
+    MAVLinkCompressState::reset();
+    sourceCount = 0;
+    sourceNext = 0;
+    rawPos = 0;
+    rawLen = 0;
+    recordLen = 0;
+}
+
+uint8_t MAVLinkDecompressor::nextSeq(uint8_t sysId, uint8_t compId)
+{
+    for (uint8_t i = 0; i < sourceCount; ++i)
+    {
+        if (sources[i].sysId == sysId && sources[i].compId == compId)
+        {
+            return ++sources[i].seq;
+        }
+    }
+    observeSeq(sysId, compId, 0);
+    return 0;
+}
+
+void MAVLinkDecompressor::observeSeq(uint8_t sysId, uint8_t compId, uint8_t seq)
+{
+    for (uint8_t i = 0; i < sourceCount; ++i)
+    {
+        if (sources[i].sysId == sysId && sources[i].compId == compId)
+        {
+            sources[i].seq = seq;
+            return;
+        }
+    }
+
+    // Replace the oldest once the table is full
+    uint8_t i = sourceCount;
+    if (sourceCount < MAVLINK_COMPRESS_SOURCES)
+    {
+        ++sourceCount;
+    }
+    else
+    {
+        i = sourceNext;
+        sourceNext = (sourceNext + 1) % MAVLINK_COMPRESS_SOURCES;
+    }
+    sources[i] = {sysId, compId, seq};
+}
+
+uint16_t MAVLinkDecompressor::buildFrame(uint8_t index, uint8_t sysId, uint8_t compId, uint8_t len, uint8_t const *payload, uint8_t *out)
+{
+    uint8_t const msgId = compressMsgs[index].msgId;
+    uint8_t const header[10] = {MAVLINK_TUNNEL_STX_V2, len, 0, 0, nextSeq(sysId, compId), sysId, compId, msgId, 0, 0};
+    memcpy(out, header, sizeof(header));
+    memcpy(&out[10], payload, len);
+    uint16_t const crc = MAVLinkCrc(&compressMsgs[index].crcExtra, 1, MAVLinkCrc(&out[1], 9 + len));
+    out[10 + len] = crc;
+    out[11 + len] = crc >> 8;
+    return 12 + len;
+}
+
+/**
+ * @brief: The length of the record so far, or -1 if more is needed to know
+ ***/
+int16_t MAVLinkDecompressor::recordLength() const
+{
+    uint8_t const tag = record[0];
+    if ((tag & MAVLINK_COMPRESS_TAG_MASK) == MAVLINK_COMPRESS_TAG_REPEAT)
+    {
+        return 1;
+    }
+    uint8_t const lenPos = (tag & 1) ? 3 : 1;
+    if (recordLen <= lenPos)
+    {
+        return -1;
+    }
+    return lenPos + 1 + record[lenPos];
+}
+
+uint16_t MAVLinkDecompressor::decodeRecord(uint8_t *out, uint16_t space)
+{
+    uint8_t const tag = record[0];
+    if ((tag & MAVLINK_COMPRESS_TAG_MASK) == MAVLINK_COMPRESS_TAG_REPEAT)
+    {
+        uint8_t const index = tag & 0x1F;
+        int8_t const slot = (index < sizeof(compressMsgs) / sizeof(compressMsgs[0])) ? compressMsgs[index].repeatSlot : NO_REPEAT_SLOT;
+        // A repeat of something this end never got, since the last reset
+        if (slot == NO_REPEAT_SLOT || !repeats[slot].valid)
+        {
+            return 0;
+        }
+        mavlink_compress_repeat_t const &repeat = repeats[slot];
+        if (12 + repeat.len > space)
+        {
+            return 0;
+        }
+        return buildFrame(index, repeat.sysId, repeat.compId, repeat.len, repeat.payload, out);
+    }
+
+    uint8_t const index = (tag >> 1) & 0x1F;
+    if (index >= sizeof(compressMsgs) / sizeof(compressMsgs[0]))
+    {
+        return 0;
+    }
+    uint8_t pos = 1;
+    uint8_t sysId = sourceSysId;
+    uint8_t compId = sourceCompId;
+    if (tag & 1)
+    {
+        sysId = record[pos++];
+        compId = record[pos++];
+    }
+    else if (!sourceValid)
+    {
+        return 0;
+    }
+    uint8_t const len = record[pos++];
+    recordFrame(index, sysId, compId, len, &record[pos]);
+    if (12 + len > space)
+    {
+        return 0;
+    }
+    return buildFrame(index, sysId, compId, len, &record[pos], out);
+}
+
+/**
+ * @brief: Decode the bytes of a transfer, raw frames pass straight through
+ * @returns: bytes in out, never more than MAVLINK_COMPRESS_MAX_DECODED. Anything past
+ * that is dropped, which a transfer from MAVLinkTunnel::popChunk() never needs
+ ***/
+uint16_t MAVLinkDecompressor::decode(uint8_t const *in, uint16_t len, uint8_t *out)
+{
+    uint16_t outLen = 0;
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        uint8_t const c = in[i];
+        if (rawLen == 0 && recordLen == 0)
+        {
+            if (c == MAVLINK_TUNNEL_STX_V1 || c == MAVLINK_TUNNEL_STX_V2)
+            {
+                rawPos = 0;
+                rawLen = MAVLINK_TUNNEL_MAX_FRAME; // until the header says
+            }
+            else if ((c & MAVLINK_COMPRESS_TAG_MASK) != MAVLINK_COMPRESS_TAG_FRAME &&
+                     (c & MAVLINK_COMPRESS_TAG_MASK) != MAVLINK_COMPRESS_TAG_REPEAT)
+            {
+                // Not the start of anything, pass it on for the GCS to make sense of
+                if (outLen < MAVLINK_COMPRESS_MAX_DECODED)
+                {
+                    out[outLen++] = c;
+                }
+                continue;
+            }
+        }
+
+        if (rawLen)
+        {
+            if (outLen < MAVLINK_COMPRESS_MAX_DECODED)
+            {
+                out[outLen++] = c;
+            }
+            if (rawPos < sizeof(rawHeader))
+            {
+                rawHeader[rawPos] = c;
+            }
+            ++rawPos;
+            bool const isV1 = rawHeader[0] == MAVLINK_TUNNEL_STX_V1;
+            if (rawPos == (isV1 ? 2U : 3U))
+            {
+                rawLen = MAVLinkTunnel::frameLength(rawHeader);
+            }
+            // The sequence of the source, frames built from records carry on from it
+            if (rawPos == (isV1 ? 5U : 7U))
+            {
+                observeSeq(rawHeader[rawPos - 2], rawHeader[rawPos - 1], rawHeader[rawPos - 3]);
+            }
+            if (rawPos == rawLen)
+            {
+                rawLen = 0;
+            }
+            continue;
+        }
+
+        record[recordLen++] = c;
+        int16_t const expected = recordLength();
+        if (expected > 0 && recordLen == expected)
+        {
+            outLen += decodeRecord(&out[outLen], MAVLINK_COMPRESS_MAX_DECODED - outLen);
+            recordLen = 0;
+        }
+    }
+    return outLen;
+}
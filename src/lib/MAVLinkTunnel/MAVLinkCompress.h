@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Link-local compression of the MAVLink downlink, transparent to the GCS.
+ *
+ * MAVLinkCompressor runs on the RX as frames are packed into each transfer by
+ * MAVLinkTunnel::popChunk(), MAVLinkDecompressor on the TX rebuilds the frames
+ * before they go to the USB / backpack. Unsigned v2 frames of the messages in the
+ * table (the telemetry streams, params and missions) with a good CRC go as a record:
+ *
+ *   MAVLINK_COMPRESS_TAG_FRAME | index << 1 | newSource, [sysId, compId], len, payload
+ *
+ * which leaves out the STX, flags, sequence, message ID and CRC: 2 bytes instead of 12.
+ * The source is only sent when it differs from the last record. The TX numbers the
+ * frames of each source on from the last sequence it saw and recalculates the CRC.
+ * A message which repeats (HEARTBEAT, SYS_STATUS ...) with the same payload as its
+ * last record is only the one byte MAVLINK_COMPRESS_TAG_REPEAT | index.
+ *
+ * Anything else is sent as the raw frame, which can't be mistaken for a record as it
+ * starts with an STX (0xFD/0xFE). Both ends keep state, so the RX only compresses
+ * after the TX has asked with MSP_ELRS_MAVLINK_COMPRESS, and both start from a reset:
+ * the RX resets the compressor on the request and stops compressing when it loses the
+ * connection, the TX resets the decompressor and asks again when it sees a new RX
+ * session in LINKSTATS.
+ */
+
+// The version of the format the TX asks for in MSP_ELRS_MAVLINK_COMPRESS
+#define MAVLINK_COMPRESS_VERSION        1
+
+#define MAVLINK_COMPRESS_TAG_FRAME      0x80
+#define MAVLINK_COMPRESS_TAG_REPEAT     0xC0
+#define MAVLINK_COMPRESS_TAG_MASK       0xC0
+#define MAVLINK_COMPRESS_REPEAT_SLOTS   6
+#define MAVLINK_COMPRESS_REPEAT_MAX_LEN 56
+#define MAVLINK_COMPRESS_SOURCES        4
+// Decoded bytes in each transfer, so the TX can keep the one byte length
+#define MAVLINK_COMPRESS_MAX_DECODED    255
+
+uint16_t MAVLinkCrc(uint8_t const *data, uint16_t len, uint16_t crc = 0xFFFF);
+
+typedef struct {
+    bool valid;
+    uint8_t sysId;
+    uint8_t compId;
+    uint8_t len;
+    uint8_t payload[MAVLINK_COMPRESS_REPEAT_MAX_LEN];
+} mavlink_compress_repeat_t;
+
+// The state both ends keep in step
+class MAVLinkCompressState
+{
+public:
+    MAVLinkCompressState() { reset(); }
+    void reset();
+
+protected:
+    bool sourceValid;
+    uint8_t sourceSysId;
+    uint8_t sourceCompId;
+    mavlink_compress_repeat_t repeats[MAVLINK_COMPRESS_REPEAT_SLOTS];
+
+    void recordFrame(uint8_t index, uint8_t sysId, uint8_t compId, uint8_t len, uint8_t const *payload);
+};
+
+class MAVLinkCompressor : public MAVLinkCompressState
+{
+public:
+    uint16_t encode(uint8_t const *frame, uint16_t frameLen, uint8_t *out) const;
+    void commit(uint8_t const *frame, uint16_t frameLen);
+
+private:
+    static int8_t compressibleIndex(uint8_t const *frame, uint16_t frameLen);
+};
+
+class MAVLinkDecompressor : public MAVLinkCompressState
+{
+public:
+    MAVLinkDecompressor() { reset(); }
+    void reset();
+    uint16_t decode(uint8_t const *in, uint16_t len, uint8_t *out);
+
+private:
+    typedef struct {
+        uint8_t sysId;
+        uint8_t compId;
+        uint8_t seq;
+    } source_seq_t;
+    source_seq_t sources[MAVLINK_COMPRESS_SOURCES];
+    uint8_t sourceCount;
+    uint8_t sourceNext;
+    // A raw frame being passed through, its header kept for the source and sequence
+    uint16_t rawPos;
+    uint16_t rawLen;
+    uint8_t rawHeader[10];
+    // The record being received
+    uint8_t record[4 + 255];
+    uint16_t recordLen;
+
+    uint8_t nextSeq(uint8_t sysId, uint8_t compId);
+    void observeSeq(uint8_t sysId, uint8_t compId, uint8_t seq);
+    int16_t recordLength() const;
+    uint16_t decodeRecord(uint8_t *out, uint16_t space);
+    uint16_t buildFrame(uint8_t index, uint8_t sysId, uint8_t compId, uint8_t len, uint8_t const *payload, uint8_t *out);
+};
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include "MAVLinkTunnel.h"
+#include "MAVLinkCompress.h"
+
+// Messages sent as periodic streams, where only the latest of each one matters
+static const uint8_t streamMsgIds[] = {
+    1,   // SYS_STATUS
+    2,   // SYSTEM_TIME
+    24,  // GPS_RAW_INT
+    27,  // RAW_IMU
+    29,  // SCALED_PRESSURE
+    30,  // ATTITUDE
+    31,  // ATTITUDE_QUATERNION
+    32,  // LOCAL_POSITION_NED
+    33,  // GLOBAL_POSITION_INT
+    34,  // RC_CHANNELS_SCALED
+    35,  // RC_CHANNELS_RAW
+    36,  // SERVO_OUTPUT_RAW
+    62,  // NAV_CONTROLLER_OUTPUT
+    65,  // RC_CHANNELS
+    69,  // MANUAL_CONTROL
+    70,  // RC_CHANNELS_OVERRIDE
+    74,  // VFR_HUD
+    116, // SCALED_IMU2
+    125, // POWER_STATUS
+    147, // BATTERY_STATUS
+    163, // AHRS (ArduPilot)
+    165, // HWSTATUS (ArduPilot)
+    178, // AHRS2 (ArduPilot)
+    193, // EKF_STATUS_REPORT (ArduPilot)
+    241, // VIBRATION
+};
+
+MAVLinkTunnel::MAVLinkTunnel()
+{
+    reset();
+}
+
+void MAVLinkTunnel::reset()
+{
+    queueLen = 0;
+    frontPartial = 0;
+    frameLen = 0;
+    frameExpected = 0;
+    merged = 0;
+    dropped = 0;
+}
+
+/**
+ * @brief: The length of the whole frame from its first 3 bytes
+ ***/
+uint16_t MAVLinkTunnel::frameLength(uint8_t const *header)
+{
+    if (header[0] == MAVLINK_TUNNEL_STX_V1)
+    {
+        return 6 + header[1] + 2;
+    }
+    // Bit 0 of the incompat flags is MAVLINK_IFLAG_SIGNED
+    return 10 + header[1] + 2 + ((header[2] & 0x01) ? 13 : 0);
+}
+
+uint32_t MAVLinkTunnel::frameMsgId(uint8_t const *frame)
+{
+    if (frame[0] == MAVLINK_TUNNEL_STX_V1)
+    {
+        return frame[5];
+    }
+    return frame[7] | (frame[8] << 8) | ((uint32_t)frame[9] << 16);
+}
+
+bool MAVLinkTunnel::isStreamMsg(uint32_t msgId)
+{
+    return msgId <= 0xFF && std::binary_search(std::begin(streamMsgIds), std::end(streamMsgIds), (uint8_t)msgId);
+}
+
+// The same message from the same system and component
+static bool isSameStream(uint8_t const *a, uint8_t const *b)
+{
+    if (a[0] != b[0] || MAVLinkTunnel::frameMsgId(a) != MAVLinkTunnel::frameMsgId(b))
+    {
+        return false;
+    }
+    uint8_t const sysIdOffset = (a[0] == MAVLINK_TUNNEL_STX_V1) ? 3 : 5;
+    return a[sysIdOffset] == b[sysIdOffset] && a[sysIdOffset + 1] == b[sysIdOffset + 1];
+}
+
+/**
+ * @brief: Parse bytes from the serial port, each whole frame is queued
+ ***/
+void MAVLinkTunnel::pushBytes(uint8_t const *data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        uint8_t const c = data[i];
+        if (frameLen == 0)
+        {
+            // Hunt for the start of a frame
+            if (c != MAVLINK_TUNNEL_STX_V1 && c != MAVLINK_TUNNEL_STX_V2)
+            {
+                continue;
+            }
+            frameExpected = 0;
+        }
+
+        frame[frameLen++] = c;
+        if (frameExpected == 0 && frameLen == ((frame[0] == MAVLINK_TUNNEL_STX_V1) ? 2 : 3))
+        {
+            frameExpected = frameLength(frame);
+        }
+        if (frameLen == frameExpected)
+        {
+            queueFrame();
+            frameLen = 0;
+        }
+    }
+}
+
+void MAVLinkTunnel::queueFrame()
+{
+    if (queueLen > MAVLINK_TUNNEL_MERGE_THRESHOLD && mergeFrame())
+    {
+        ++merged;
+        return;
+    }
+
+    while (free() < frameLen && evictStreamFrame())
+    {
+        ++dropped;
+    }
+    if (free() < frameLen)
+    {
+        ++dropped;
+        return;
+    }
+
+    memcpy(&queue[queueLen], frame, frameLen);
+    queueLen += frameLen;
+}
+
+/**
+ * @brief: Replace a queued frame of the same stream with the one just parsed,
+ * in the same place in the queue
+ ***/
+bool MAVLinkTunnel::mergeFrame()
+{
+    if (!isStreamMsg(frameMsgId(frame)))
+    {
+        return false;
+    }
+
+    for (uint16_t offset = frontPartial; offset < queueLen; )
+    {
+        uint16_t const len = frameLength(&queue[offset]);
+        if (isSameStream(&queue[offset], frame))
+        {
+            if (queueLen - len + frameLen > MAVLINK_TUNNEL_QUEUE_LEN)
+            {
+                return false;
+            }
+            // v2 truncates trailing zeros from the payload, so the length can differ
+            memmove(&queue[offset + frameLen], &queue[offset + len], queueLen - offset - len);
+            memcpy(&queue[offset], frame, frameLen);
+            queueLen = queueLen - len + frameLen;
+            return true;
+        }
+        offset += len;
+    }
+    return false;
+}
+
+// Drop the oldest queued stream message
+bool MAVLinkTunnel::evictStreamFrame()
+{
+    for (uint16_t offset = frontPartial; offset < queueLen; )
+    {
+        uint16_t const len = frameLength(&queue[offset]);
+        if (isStreamMsg(frameMsgId(&queue[offset])))
+        {
+            removeBytes(offset, len);
+            return true;
+        }
+        offset += len;
+    }
+    return false;
+}
+
+void MAVLinkTunnel::removeBytes(uint16_t offset, uint16_t len)
+{
+    memmove(&queue[offset], &queue[offset + len], queueLen - offset - len);
+    queueLen -= len;
+}
+
+/**
+ * @brief: Copy as many whole frames from the front of the queue as fit in maxLen.
+ * A frame longer than maxLen is split over as many chunks as it takes.
+ * With a compressor, the frames are encoded and as many go as fit encoded, up to
+ * MAVLINK_COMPRESS_MAX_DECODED bytes once decoded.
+ * @returns: bytes copied to dest
+ ***/
+uint8_t MAVLinkTunnel::popChunk(uint8_t *dest, uint8_t maxLen, MAVLinkCompressor *compressor)
+{
+    // The rest of a frame split by the last chunk goes first
+    uint16_t count = std::min(frontPartial, (uint16_t)maxLen);
+    uint16_t partial = frontPartial - count;
+    memcpy(dest, queue, count);
+    uint16_t consumed = count;
+    if (partial == 0)
+    {
+        uint8_t encoded[MAVLINK_TUNNEL_MAX_FRAME];
+        while (consumed < queueLen)
+        {
+            uint8_t const *frame = &queue[consumed];
+            uint16_t const len = frameLength(frame);
+            uint16_t const encodedLen = compressor ? compressor->encode(frame, len, encoded) : len;
+            if (count + encodedLen > maxLen || consumed + len > MAVLINK_COMPRESS_MAX_DECODED)
+            {
+                break;
+            }
+            if (compressor)
+            {
+                memcpy(&dest[count], encoded, encodedLen);
+                compressor->commit(frame, len);
+            }
+            else
+            {
+                memcpy(&dest[count], frame, len);
+            }
+            count += encodedLen;
+            consumed += len;
+        }
+        if (consumed == 0 && queueLen > 0)
+        {
+            count = maxLen;
+            consumed = maxLen;
+            partial = frameLength(queue) - maxLen;
+            memcpy(dest, queue, count);
+        }
+    }
+
+    removeBytes(0, consumed);
+    frontPartial = partial;
+    return count;
+}
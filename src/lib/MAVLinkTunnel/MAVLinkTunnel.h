@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#define MAVLINK_TUNNEL_QUEUE_LEN    1024
+// A v2 frame: 10 byte header, 255 byte payload, CRC and the 13 byte signature
+#define MAVLINK_TUNNEL_MAX_FRAME    (10 + 255 + 2 + 13)
+// Above this many bytes queued the high rate stream messages are merged
+#define MAVLINK_TUNNEL_MERGE_THRESHOLD (MAVLINK_TUNNEL_QUEUE_LEN / 2)
+
+#define MAVLINK_TUNNEL_STX_V1       0xFE
+#define MAVLINK_TUNNEL_STX_V2       0xFD
+
+class MAVLinkCompressor;
+
+/**
+ * Frames the raw MAVLink byte stream going over the link, so each stubborn transfer
+ * carries whole frames rather than whatever was in the serial buffer.
+ *
+ * Bytes from the serial port are parsed into frames (v1 and v2, signed or not, the
+ * CRC is left to the other end) and queued. Bytes outside of a frame are dropped.
+ * Once the queue is over MAVLINK_TUNNEL_MERGE_THRESHOLD, a stream message (ATTITUDE,
+ * VFR_HUD ...) replaces a queued one of the same message and source in place instead
+ * of being queued again. When the queue is full queued stream messages are dropped to
+ * make room, mission, parameter and command traffic is only dropped if there are none.
+ */
+class MAVLinkTunnel
+{
+public:
+    MAVLinkTunnel();
+    void reset();
+    void pushBytes(uint8_t const *data, uint16_t len);
+    uint8_t popChunk(uint8_t *dest, uint8_t maxLen, MAVLinkCompressor *compressor = nullptr);
+    uint16_t size() const { return queueLen; }
+    uint16_t free() const { return MAVLINK_TUNNEL_QUEUE_LEN - queueLen; }
+    uint32_t getMerged() const { return merged; }
+    uint32_t getDropped() const { return dropped; }
+
+    static uint16_t frameLength(uint8_t const *header);
+    static uint32_t frameMsgId(uint8_t const *frame);
+    static bool isStreamMsg(uint32_t msgId);
+
+private:
+    uint8_t queue[MAVLINK_TUNNEL_QUEUE_LEN];
+    uint16_t queueLen;
+    uint16_t frontPartial; // the rest of a frame split by popChunk(), at the start of the queue
+    // The frame being parsed
+    uint8_t frame[MAVLINK_TUNNEL_MAX_FRAME];
+    uint16_t frameLen;
+    uint16_t frameExpected;
+    uint32_t merged;
+    uint32_t dropped;
+
+    void queueFrame();
+    bool mergeFrame();
+    bool evictStreamFrame();
+    void removeBytes(uint16_t offset, uint16_t len);
+};
@@ -30,6 +30,12 @@
 
 #define MSP_ELRS_POWER_CALI_GET             0x20
 #define MSP_ELRS_POWER_CALI_SET             0x21
+#define MSP_ELRS_GET_CYCLE_STATS            0x22    // DEBUG_CYCLE_STATS only
+#define MSP_ELRS_FHSS_BLACKLIST             0x23    // TX->RX version, generation, channel bitmask. RX->TX version, generation to confirm, then the TX announces the switch in SYNC
+#define MSP_ELRS_FHSS_BLACKLIST_VERSION     2
+#define MSP_ELRS_GET_CHANNEL_STATS          0x24    // first channel, see OnGetChannelStats()
+#define MSP_ELRS_TELEMETRY_BATCH            0x25    // TX->RX TELEMETRY_BATCH_VERSION, CRSF_ADDRESS_CRSF_TRANSMITTER
+#define MSP_ELRS_MAVLINK_COMPRESS           0x26    // TX->RX MAVLINK_COMPRESS_VERSION, CRSF_ADDRESS_CRSF_TRANSMITTER
 
 #define MSP_ELRS_MAVLINK_TLM                0xFD
 
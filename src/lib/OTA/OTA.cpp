@@ -20,7 +20,8 @@ uint16_t OtaCrcInitializer;
 OtaSwitchMode_e OtaSwitchModeCurrent;
 
 // CRC
-static Crc2Byte ota_crc;
+typedef Crc2ByteFixed<14, ELRS_CRC14_POLY> OtaCrc14;
+typedef Crc2ByteFixed<16, ELRS_CRC16_POLY> OtaCrc16;
 ValidatePacketCrc_t OtaValidatePacketCrc;
 GeneratePacketCrc_t OtaGeneratePacketCrc;
 
@@ -42,6 +43,34 @@ static inline uint8_t ICACHE_RAM_ATTR HybridWideNonceToSwitchIndex(uint8_t const
     return ((nonce & 0b111) + ((nonce >> 3) & 0b1)) % 8;
 }
 
+/******** sm16chDelta state, mirrored by the TX and RX ********/
+#define DELTA_NUM_CHANNELS  16
+#define DELTA_RESIDUAL_MAX  7       // residuals are 4 bit, -7 to +7
+#define DELTA_ESCAPE        0b1000  // the -8 code, the channel holds its value
+#define DELTA_PREV_GAP_MAX  7
+
+typedef struct {
+    uint16_t ref[DELTA_NUM_CHANNELS];   // the 10 bit value the RX holds
+    int16_t vel[DELTA_NUM_CHANNELS];    // the change of ref in the last packet
+    uint16_t validMask;                 // RX only, channels ref is known for
+    uint8_t refreshNext;                // TX only, next channel in the refresh rotation
+    uint8_t escapeNext;                 // TX only, where to look for the next escaped channel to refresh
+    uint8_t lastNonce;                  // nonce of the previous RC packet
+} OtaDeltaState_t;
+
+// Constant velocity prediction, so sticks moving smoothly have residuals near 0
+static inline int32_t ICACHE_RAM_ATTR DeltaPredict(OtaDeltaState_t const * const st, unsigned const ch)
+{
+    int32_t const pred = st->ref[ch] + st->vel[ch];
+    return constrain(pred, 0, 1023);
+}
+
+static inline void ICACHE_RAM_ATTR DeltaUpdate(OtaDeltaState_t * const st, unsigned const ch, uint32_t const val)
+{
+    st->vel[ch] = val - st->ref[ch];
+    st->ref[ch] = val;
+}
+
 #if defined(TARGET_TX) || defined(UNIT_TEST)
 
 #include "handset.h"            // need access to handset data for arming
@@ -52,50 +81,47 @@ PackChannelData_t OtaPackChannelData;
 static uint32_t packetCnt;
 #endif
 
-/******** Decimate 11bit to 10bit functions ********/
-typedef uint32_t (*Decimate11to10_fn)(uint32_t ch11bit);
-
-static uint32_t ICACHE_RAM_ATTR Decimate11to10_Limit(uint32_t ch11bit)
+/***
+ * @brief: Pack 4x 10-bit channels into a 4x 10 bit channel struct
+ * @desc: Values are packed little-endianish such that bits A987654321 -> 87654321, 000000A9
+ *        which is compatible with the 10-bit CRSF subset RC frame structure (0x17) in
+ *        Betaflight. The first 32 bits are built as one word and the last byte is the
+ *        top of ch3, 64-bit shifts are several instructions each on the 32-bit Xtensa.
+ *        Every byte of destChannels4x10 is written, the struct is not required to be zeroed
+ ***/
+static inline void ICACHE_RAM_ATTR PackChannels4x10(OTA_Channels_4x10 * const destChannels4x10,
+    uint32_t const ch0, uint32_t const ch1, uint32_t const ch2, uint32_t const ch3)
 {
-    // Limit 10-bit result to the range CRSF_CHANNEL_VALUE_MIN/MAX
-    return CRSF_to_UINT10(constrain(ch11bit, CRSF_CHANNEL_VALUE_MIN, CRSF_CHANNEL_VALUE_MAX));
+    uint32_t const lo = ch0 | (ch1 << 10) | (ch2 << 20) | (ch3 << 30);
+    // Bytewise as the channels are unaligned in the packet
+    uint8_t * const dest = destChannels4x10->raw;
+    dest[0] = lo;
+    dest[1] = lo >> 8;
+    dest[2] = lo >> 16;
+    dest[3] = lo >> 24;
+    dest[4] = ch3 >> 2;
 }
 
-static uint32_t ICACHE_RAM_ATTR Decimate11to10_Div2(uint32_t ch11bit)
+/***
+ * @brief: Pack 4x 11-bit channels limited to 988us-2012us into 10 bits, for the Hybrid/Wide modes
+ * @desc: CRSF input is 11bit and OTA will carry only 10bit. Discard the Extended Limits (E.Limits)
+ *        range and use the full 10bits to carry only 998us - 2012us
+ ***/
+static void ICACHE_RAM_ATTR PackUInt11ToChannels4x10Limit(uint32_t const * const src, OTA_Channels_4x10 * const destChannels4x10)
 {
-    // Simple divide-by-2 to discard the bit
-    return ch11bit >> 1;
+    uint32_t ch[4];
+    for (unsigned i=0; i<4; ++i)
+        ch[i] = CRSF_to_UINT10(constrain(src[i], CRSF_CHANNEL_VALUE_MIN, CRSF_CHANNEL_VALUE_MAX));
+    PackChannels4x10(destChannels4x10, ch[0], ch[1], ch[2], ch[3]);
 }
 
 /***
- * @brief: Pack 4x 11-bit channel array into 4x 10 bit channel struct
- * @desc: Values are packed little-endianish such that bits A987654321 -> 87654321, 000000A9
- *        which is compatible with the 10-bit CRSF subset RC frame structure (0x17) in
- *        Betaflight, but depends on which decimate function is used if it is legacy or CRSFv3 10-bit
- *        destChannels4x10 must be zeroed before this call, the channels are ORed into it
+ * @brief: Pack 4x 11-bit channels by discarding the low bit, for the full res modes
  ***/
-static void ICACHE_RAM_ATTR PackUInt11ToChannels4x10(uint32_t const * const src, OTA_Channels_4x10 * const destChannels4x10, Decimate11to10_fn decimate)
+static void ICACHE_RAM_ATTR PackUInt11ToChannels4x10Div2(uint32_t const * const src, OTA_Channels_4x10 * const destChannels4x10)
 {
-    const unsigned DEST_PRECISION = 10; // number of bits for each dest, must be <SRC
-    uint8_t *dest = (uint8_t *)destChannels4x10;
-    *dest = 0;
-    unsigned destShift = 0;
-    for (unsigned ch=0; ch<4; ++ch)
-    {
-        // Convert to DEST_PRECISION value
-        unsigned chVal = decimate(src[ch]);
-
-        // Put the low bits in any remaining dest capacity
-        *dest++ |= chVal << destShift;
-
-        // Shift the high bits down and place them into the next dest byte
-        unsigned srcBitsLeft = DEST_PRECISION - 8 + destShift;
-        *dest = chVal >> (DEST_PRECISION - srcBitsLeft);
-        // Next dest should be shifted up by the bits consumed
-        // if destShift == 8 then everything should reset for another set
-        // but this code only expects to do the 4 channels -> 5 bytes evenly
-        destShift = srcBitsLeft;
-    }
+    PackChannels4x10(destChannels4x10,
+        (src[0] >> 1) & 0x3FF, (src[1] >> 1) & 0x3FF, (src[2] >> 1) & 0x3FF, (src[3] >> 1) & 0x3FF);
 }
 
 static void ICACHE_RAM_ATTR PackChannelDataHybridCommon(OTA_Packet4_s * const ota4, const uint32_t *channelData)
@@ -105,9 +131,7 @@ static void ICACHE_RAM_ATTR PackChannelDataHybridCommon(OTA_Packet4_s * const ot
     // Incremental packet counter for verification on the RX side, 32 bits shoved into CH1-CH4
     ota4->dbg_linkstats.packetNum = packetCnt++;
 #else
-    // CRSF input is 11bit and OTA will carry only 10bit. Discard the Extended Limits (E.Limits)
-    // range and use the full 10bits to carry only 998us - 2012us
-    PackUInt11ToChannels4x10(&channelData[0], &ota4->rc.ch, &Decimate11to10_Limit);
+    PackUInt11ToChannels4x10Limit(&channelData[0], &ota4->rc.ch);
 
     // send armed status to receiver
     #if defined(UNIT_TEST)
@@ -219,7 +243,8 @@ void ICACHE_RAM_ATTR GenerateChannelDataHybridWide(OTA_Packet_s * const otaPktPt
     ota4->rc.switches = value;
 }
 
-static void ICACHE_RAM_ATTR GenerateChannelData8ch12ch(OTA_Packet8_s * const ota8, const uint32_t *channelData, bool const TelemetryStatus, bool const isHighAux)
+static void ICACHE_RAM_ATTR GenerateChannelDataFullRes(OTA_Packet8_s * const ota8, const uint32_t *channelData, bool const TelemetryStatus,
+                                                       bool const isHighAux, uint8_t const chSrcLow, uint8_t const chSrcHigh)
 {
     // All channel data is 10 bit apart from AUX1 which is 1 bit
     ota8->rc.packetType = PACKET_TYPE_RCDATA;
@@ -236,36 +261,11 @@ static void ICACHE_RAM_ATTR GenerateChannelData8ch12ch(OTA_Packet8_s * const ota
 #if defined(DEBUG_RCVR_LINKSTATS)
     // Incremental packet counter for verification on the RX side, 32 bits shoved into CH1-CH4
     ota8->dbg_linkstats.packetNum = packetCnt++;
+    (void)chSrcLow;
+    (void)chSrcHigh;
 #else
-    // Sources:
-    // 8ch always: low=0 high=5
-    // 12ch isHighAux=false: low=0 high=5
-    // 12ch isHighAux=true:  low=0 high=9
-    // 16ch isHighAux=false: low=0 high=4
-    // 16ch isHighAux=true:  low=8 high=12
-    uint8_t chSrcLow;
-    uint8_t chSrcHigh;
-    if (OtaSwitchModeCurrent == smHybridOr16ch)
-    {
-        // 16ch mode
-        if (isHighAux)
-        {
-            chSrcLow = 8;
-            chSrcHigh = 12;
-        }
-        else
-        {
-            chSrcLow = 0;
-            chSrcHigh = 4;
-        }
-    }
-    else
-    {
-        chSrcLow = 0;
-        chSrcHigh = isHighAux ? 8 : 4;
-    }
-    PackUInt11ToChannels4x10(&channelData[chSrcLow], &ota8->rc.chLow, &Decimate11to10_Div2);
-    PackUInt11ToChannels4x10(&channelData[chSrcHigh], &ota8->rc.chHigh, &Decimate11to10_Div2);
+    PackUInt11ToChannels4x10Div2(&channelData[chSrcLow], &ota8->rc.chLow);
+    PackUInt11ToChannels4x10Div2(&channelData[chSrcHigh], &ota8->rc.chHigh);
 #endif
 }
 
@@ -273,7 +273,8 @@ static void ICACHE_RAM_ATTR GenerateChannelData8ch(OTA_Packet_s * const otaPktPt
 {
     (void)tlmDenom;
 
-    GenerateChannelData8ch12ch((OTA_Packet8_s * const)otaPktPtr, channelData, TelemetryStatus, false);
+    // CH1-CH8 in every packet
+    GenerateChannelDataFullRes((OTA_Packet8_s * const)otaPktPtr, channelData, TelemetryStatus, false, 0, 4);
 }
 
 static bool FullResIsHighAux;
@@ -287,9 +288,108 @@ static void ICACHE_RAM_ATTR GenerateChannelData12ch(OTA_Packet_s * const otaPktP
     // Every time this function is called, the opposite high Aux channels are sent
     // This tries to ensure a fair split of high and low aux channels packets even
     // at 1:2 ratio and around sync packets
-    GenerateChannelData8ch12ch((OTA_Packet8_s * const)otaPktPtr, channelData, TelemetryStatus, FullResIsHighAux);
+    // CH1-CH4 in every packet, with CH5-CH8 or CH9-CH12
+    uint8_t const chSrcHigh = FullResIsHighAux ? 8 : 4;
+    GenerateChannelDataFullRes((OTA_Packet8_s * const)otaPktPtr, channelData, TelemetryStatus, FullResIsHighAux, 0, chSrcHigh);
+    FullResIsHighAux = !FullResIsHighAux;
+}
+
+static void ICACHE_RAM_ATTR GenerateChannelData16ch(OTA_Packet_s * const otaPktPtr, const uint32_t *channelData, bool const TelemetryStatus, uint8_t const tlmDenom)
+{
+    (void)tlmDenom;
+
+    // Alternates CH1-CH8 and CH9-CH16, the same fair split as 12ch
+    uint8_t const chSrcLow = FullResIsHighAux ? 8 : 0;
+    GenerateChannelDataFullRes((OTA_Packet8_s * const)otaPktPtr, channelData, TelemetryStatus, FullResIsHighAux, chSrcLow, chSrcLow + 4);
     FullResIsHighAux = !FullResIsHighAux;
 }
+
+static OtaDeltaState_t DeltaTx;
+
+/**
+ * 16ch delta encoding for sending over the air, all 16 channels in every packet
+ *
+ * Each channel is sent as a 4 bit residual from the value predicted from the last two
+ * the RX has, in 10 bit units. A residual outside -7 to +7 is sent as the escape code
+ * and the channel holds its value on the RX. One channel per packet is sent in full,
+ * its nibble holds the low 4 bits and refreshHigh the rest. An escaped channel is
+ * refreshed first so a single jump still arrives in this packet, otherwise the channels
+ * are refreshed in turn so the RX recovers all of them within 16 packets of losing one
+ * (plus one for every packet an escape takes the refresh).
+ *
+ * prevGap lets the RX check it got the previous RC packet, which the residuals follow on from
+ */
+static void ICACHE_RAM_ATTR GenerateChannelDataDelta(OTA_Packet_s * const otaPktPtr, const uint32_t *channelData, bool const TelemetryStatus, uint8_t const tlmDenom)
+{
+    (void)tlmDenom;
+
+    OTA_Packet8_s * const ota8 = (OTA_Packet8_s * const)otaPktPtr;
+    ota8->delta.packetType = PACKET_TYPE_RCDATA;
+    ota8->delta.telemetryStatus = TelemetryStatus;
+    // uplinkPower has 8 items but only 3 bits, but 0 is 0 power which we never use, shift 1-8 -> 0-7
+    ota8->delta.uplinkPower = constrain(CRSF::LinkStatistics.uplink_TX_Power, 1, 8) - 1;
+    #if defined(UNIT_TEST)
+    ota8->delta.isArmed = CRSF_to_BIT(channelData[4]);
+    #else
+    ota8->delta.isArmed = handset->IsArmed();
+    #endif
+#if defined(DEBUG_RCVR_LINKSTATS)
+    // Incremental packet counter for verification on the RX side, 32 bits shoved into CH1-CH4
+    ota8->dbg_linkstats.packetNum = packetCnt++;
+#else
+    uint8_t const gap = OtaNonce - DeltaTx.lastNonce;
+    DeltaTx.lastNonce = OtaNonce;
+    ota8->delta.prevGap = (gap <= DELTA_PREV_GAP_MAX) ? gap : 0;
+
+    uint16_t escaped = 0;
+    for (unsigned ch=0; ch<DELTA_NUM_CHANNELS; ++ch)
+    {
+        uint32_t const val = (channelData[ch] >> 1) & 0x3FF;
+        int32_t const residual = (int32_t)val - DeltaPredict(&DeltaTx, ch);
+        uint8_t code;
+        if (residual >= -DELTA_RESIDUAL_MAX && residual <= DELTA_RESIDUAL_MAX)
+        {
+            code = residual & 0b1111;
+            DeltaUpdate(&DeltaTx, ch, val);
+        }
+        else
+        {
+            code = DELTA_ESCAPE;
+            DeltaTx.vel[ch] = 0;
+            escaped |= 1 << ch;
+        }
+
+        if (ch % 2 == 0)
+            ota8->delta.residuals[ch / 2] = code;
+        else
+            ota8->delta.residuals[ch / 2] |= code << 4;
+    }
+
+    // Escaped channels take turns so none is starved, without moving the rotation on
+    uint8_t refreshCh;
+    if (escaped)
+    {
+        refreshCh = DeltaTx.escapeNext;
+        while (!(escaped & (1 << refreshCh)))
+            refreshCh = (refreshCh + 1) % DELTA_NUM_CHANNELS;
+        DeltaTx.escapeNext = (refreshCh + 1) % DELTA_NUM_CHANNELS;
+    }
+    else
+    {
+        refreshCh = DeltaTx.refreshNext;
+        DeltaTx.refreshNext = (refreshCh + 1) % DELTA_NUM_CHANNELS;
+    }
+
+    uint32_t const refreshVal = (channelData[refreshCh] >> 1) & 0x3FF;
+    DeltaTx.ref[refreshCh] = refreshVal;
+    DeltaTx.vel[refreshCh] = 0;
+    uint8_t * const nibbles = &ota8->delta.residuals[refreshCh / 2];
+    uint8_t const nibbleShift = (refreshCh % 2) * 4;
+    *nibbles = (*nibbles & ~(0b1111 << nibbleShift)) | ((refreshVal & 0b1111) << nibbleShift);
+    ota8->delta.refreshCh = refreshCh;
+    ota8->delta.refreshHigh = refreshVal >> 4;
+#endif
+}
 #endif
 
 
@@ -305,32 +405,39 @@ UnpackChannelData_t OtaUnpackChannelData;
 uint32_t debugRcvrLinkstatsPacketId;
 #else
 
-static void UnpackChannels4x10ToUInt11(OTA_Channels_4x10 const * const srcChannels4x10, uint32_t * const dest)
+/***
+ * @brief: The first 32 bits of a 4x 10 bit channel struct, ch0-ch2 and the low 2 bits of ch3
+ ***/
+static inline uint32_t ICACHE_RAM_ATTR Channels4x10LowWord(OTA_Channels_4x10 const * const srcChannels4x10)
 {
-    uint8_t const * const payload = (uint8_t const * const)srcChannels4x10;
-    constexpr unsigned numOfChannels = 4;
-    constexpr unsigned srcBits = 10;
-    constexpr unsigned dstBits = 11;
-    constexpr unsigned inputChannelMask = (1 << srcBits) - 1;
-    constexpr unsigned precisionShift = dstBits - srcBits;
+    // Bytewise as the channels are unaligned in the packet
+    uint8_t const * const src = srcChannels4x10->raw;
+    return src[0] | (src[1] << 8) | (src[2] << 16) | ((uint32_t)src[3] << 24);
+}
 
-    // code from BetaFlight rx/crsf.cpp / bitpacker_unpack
-    uint8_t bitsMerged = 0;
-    uint32_t readValue = 0;
-    unsigned readByteIndex = 0;
-    for (uint8_t n = 0; n < numOfChannels; n++)
-    {
-        while (bitsMerged < srcBits)
-        {
-            uint8_t readByte = payload[readByteIndex++];
-            readValue |= ((uint32_t) readByte) << bitsMerged;
-            bitsMerged += 8;
-        }
-        //printf("rv=%x(%x) bm=%u\n", readValue, (readValue & channelMask), bitsMerged);
-        dest[n] = (readValue & inputChannelMask) << precisionShift;
-        readValue >>= srcBits;
-        bitsMerged -= srcBits;
-    }
+/***
+ * @brief: Unpack 4x 10 bit channels covering the full CRSF range to 11 bit, for the full res modes
+ * @desc: The 10 to 11 bit << 1 is folded into each channel's shift and mask
+ ***/
+static void ICACHE_RAM_ATTR UnpackChannels4x10ToUInt11(OTA_Channels_4x10 const * const srcChannels4x10, uint32_t * const dest)
+{
+    uint32_t const lo = Channels4x10LowWord(srcChannels4x10);
+    dest[0] = (lo << 1) & 0x7FE;
+    dest[1] = (lo >> 9) & 0x7FE;
+    dest[2] = (lo >> 19) & 0x7FE;
+    dest[3] = ((lo >> 29) & 0x6) | ((uint32_t)srcChannels4x10->raw[4] << 3);
+}
+
+/***
+ * @brief: Unpack 4x 10 bit channels limited to 988us-2012us to the CRSF range, for the Hybrid/Wide modes
+ ***/
+static void ICACHE_RAM_ATTR UnpackChannels4x10ToCrsf(OTA_Channels_4x10 const * const srcChannels4x10, uint32_t * const dest)
+{
+    uint32_t const lo = Channels4x10LowWord(srcChannels4x10);
+    dest[0] = UINT10_to_CRSF(lo & 0x3FF);
+    dest[1] = UINT10_to_CRSF((lo >> 10) & 0x3FF);
+    dest[2] = UINT10_to_CRSF((lo >> 20) & 0x3FF);
+    dest[3] = UINT10_to_CRSF((lo >> 30) | (srcChannels4x10->raw[4] << 2));
 }
 #endif /* !DEBUG_RCVR_LINKSTATS */
 
@@ -342,14 +449,7 @@ static void ICACHE_RAM_ATTR UnpackChannelDataHybridCommon(OTA_Packet4_s const *
     debugRcvrLinkstatsPacketId = ota4->dbg_linkstats.packetNum;
 #else
     // The analog channels, encoded as 10bit where 0 = 998us and 1023 = 2012us
-    UnpackChannels4x10ToUInt11(&ota4->rc.ch, &channelData[0]);
-    // The unpacker simply does a << 1 to convert 10 to 11bit, but Hybrid/Wide modes
-    // only pack a subset of the full range CRSF data, so properly expand it
-    // This is ~80 bytes less code than passing an 10-to-11 expander fn to the unpacker
-    for (unsigned ch=0; ch<4; ++ch)
-    {
-        channelData[ch] = UINT10_to_CRSF(channelData[ch] >> 1);
-    }
+    UnpackChannels4x10ToCrsf(&ota4->rc.ch, &channelData[0]);
     channelData[4] = BIT_to_CRSF(isArmed);
 #endif
 }
@@ -444,38 +544,16 @@ bool ICACHE_RAM_ATTR UnpackChannelDataHybridWide(OTA_Packet_s const * const otaP
     return TelemetryStatus;
 }
 
-bool ICACHE_RAM_ATTR UnpackChannelData8ch(OTA_Packet_s const * const otaPktPtr, uint32_t *channelData, uint8_t const tlmDenom)
+static bool ICACHE_RAM_ATTR UnpackChannelDataFullRes(OTA_Packet8_s const * const ota8, uint32_t *channelData,
+                                                     uint8_t const chDstLow, uint8_t const chDstHigh)
 {
-    (void)tlmDenom;
-
-    OTA_Packet8_s const * const ota8 = (OTA_Packet8_s const * const)otaPktPtr;
-
     isArmed = ota8->rc.isArmed;
 
 #if defined(DEBUG_RCVR_LINKSTATS)
     debugRcvrLinkstatsPacketId = ota8->dbg_linkstats.packetNum;
+    (void)chDstLow;
+    (void)chDstHigh;
 #else
-    uint8_t chDstLow;
-    uint8_t chDstHigh;
-    if (OtaSwitchModeCurrent == smHybridOr16ch)
-    {
-        if (ota8->rc.isHighAux)
-        {
-            chDstLow = 8;
-            chDstHigh = 12;
-        }
-        else
-        {
-            chDstLow = 0;
-            chDstHigh = 4;
-        }
-    }
-    else
-    {
-        chDstLow = 0;
-        chDstHigh = (ota8->rc.isHighAux) ? 8 : 4;
-    }
-
     // Analog channels packed 10bit covering the entire CRSF extended range (i.e. not just 988-2012)
     // ** Different than the 10bit encoding in Hybrid/Wide mode **
     UnpackChannels4x10ToUInt11(&ota8->rc.chLow, &channelData[chDstLow]);
@@ -488,12 +566,91 @@ bool ICACHE_RAM_ATTR UnpackChannelData8ch(OTA_Packet_s const * const otaPktPtr,
     CRSF::updateUplinkPower(ota8->rc.uplinkPower + 1);
     return ota8->rc.telemetryStatus;
 }
+
+/**
+ * 8ch and 12ch decoding, CH1-CH4 in every packet with CH5-CH8 or CH9-CH12
+ * (isHighAux is never set by an 8ch TX)
+ */
+static bool ICACHE_RAM_ATTR UnpackChannelData8ch12ch(OTA_Packet_s const * const otaPktPtr, uint32_t *channelData, uint8_t const tlmDenom)
+{
+    (void)tlmDenom;
+
+    OTA_Packet8_s const * const ota8 = (OTA_Packet8_s const * const)otaPktPtr;
+    uint8_t const chDstHigh = (ota8->rc.isHighAux) ? 8 : 4;
+    return UnpackChannelDataFullRes(ota8, channelData, 0, chDstHigh);
+}
+
+/**
+ * 16ch decoding, CH1-CH8 or CH9-CH16
+ */
+static bool ICACHE_RAM_ATTR UnpackChannelData16ch(OTA_Packet_s const * const otaPktPtr, uint32_t *channelData, uint8_t const tlmDenom)
+{
+    (void)tlmDenom;
+
+    OTA_Packet8_s const * const ota8 = (OTA_Packet8_s const * const)otaPktPtr;
+    uint8_t const chDstLow = (ota8->rc.isHighAux) ? 8 : 0;
+    return UnpackChannelDataFullRes(ota8, channelData, chDstLow, chDstLow + 4);
+}
+
+static OtaDeltaState_t DeltaRx;
+
+/**
+ * 16ch delta decoding, see GenerateChannelDataDelta
+ *
+ * The residuals only follow on from the previous RC packet, if it was lost every channel
+ * holds its last value until it is refreshed
+ */
+static bool ICACHE_RAM_ATTR UnpackChannelDataDelta(OTA_Packet_s const * const otaPktPtr, uint32_t *channelData, uint8_t const tlmDenom)
+{
+    (void)tlmDenom;
+
+    OTA_Packet8_s const * const ota8 = (OTA_Packet8_s const * const)otaPktPtr;
+
+    isArmed = ota8->delta.isArmed;
+
+#if defined(DEBUG_RCVR_LINKSTATS)
+    debugRcvrLinkstatsPacketId = ota8->dbg_linkstats.packetNum;
+#else
+    uint8_t const gap = OtaNonce - DeltaRx.lastNonce;
+    DeltaRx.lastNonce = OtaNonce;
+    if (ota8->delta.prevGap == 0 || ota8->delta.prevGap != gap)
+        DeltaRx.validMask = 0;
+
+    uint8_t const refreshCh = ota8->delta.refreshCh;
+    for (unsigned ch=0; ch<DELTA_NUM_CHANNELS; ++ch)
+    {
+        if (ch == refreshCh || !(DeltaRx.validMask & (1 << ch)))
+            continue;
+
+        uint8_t const code = (ota8->delta.residuals[ch / 2] >> ((ch % 2) * 4)) & 0b1111;
+        if (code == DELTA_ESCAPE)
+            DeltaRx.vel[ch] = 0;
+        else
+            DeltaUpdate(&DeltaRx, ch, DeltaPredict(&DeltaRx, ch) + ((int8_t)(code << 4) >> 4));
+    }
+
+    uint8_t const refreshLow = (ota8->delta.residuals[refreshCh / 2] >> ((refreshCh % 2) * 4)) & 0b1111;
+    DeltaRx.ref[refreshCh] = (ota8->delta.refreshHigh << 4) | refreshLow;
+    DeltaRx.vel[refreshCh] = 0;
+    DeltaRx.validMask |= 1 << refreshCh;
+
+    // Channels which are not known hold their last value
+    for (unsigned ch=0; ch<DELTA_NUM_CHANNELS; ++ch)
+    {
+        if (DeltaRx.validMask & (1 << ch))
+            channelData[ch] = DeltaRx.ref[ch] << 1;
+    }
+#endif
+    // Restore the uplink_TX_Power range 0-7 -> 1-8
+    CRSF::updateUplinkPower(ota8->delta.uplinkPower + 1);
+    return ota8->delta.telemetryStatus;
+}
 #endif
 
 bool ICACHE_RAM_ATTR ValidatePacketCrcFull(OTA_Packet_s * const otaPktPtr)
 {
     uint16_t const calculatedCRC =
-        ota_crc.calc((uint8_t*)otaPktPtr, OTA8_CRC_CALC_LEN, OtaCrcInitializer);
+        OtaCrc16::calc((uint8_t*)otaPktPtr, OTA8_CRC_CALC_LEN, OtaCrcInitializer);
     return otaPktPtr->full.crc == calculatedCRC;
 }
 
@@ -515,7 +672,7 @@ bool ICACHE_RAM_ATTR ValidatePacketCrcStd(OTA_Packet_s * const otaPktPtr)
         otaPktPtr->std.crcHigh = 0;
     }
     uint16_t const calculatedCRC =
-        ota_crc.calc((uint8_t*)otaPktPtr, OTA4_CRC_CALC_LEN, OtaCrcInitializer);
+        OtaCrc14::calc((uint8_t*)otaPktPtr, OTA4_CRC_CALC_LEN, OtaCrcInitializer);
 
     otaPktPtr->std.crcHigh = backupCrcHigh;
     
@@ -524,7 +681,7 @@ bool ICACHE_RAM_ATTR ValidatePacketCrcStd(OTA_Packet_s * const otaPktPtr)
 
 void ICACHE_RAM_ATTR GeneratePacketCrcFull(OTA_Packet_s * const otaPktPtr)
 {
-    otaPktPtr->full.crc = ota_crc.calc((uint8_t*)otaPktPtr, OTA8_CRC_CALC_LEN, OtaCrcInitializer);
+    otaPktPtr->full.crc = OtaCrc16::calc((uint8_t*)otaPktPtr, OTA8_CRC_CALC_LEN, OtaCrcInitializer);
 }
 
 void ICACHE_RAM_ATTR GeneratePacketCrcStd(OTA_Packet_s * const otaPktPtr)
@@ -536,7 +693,7 @@ void ICACHE_RAM_ATTR GeneratePacketCrcStd(OTA_Packet_s * const otaPktPtr)
         otaPktPtr->std.crcHigh = (OtaNonce % ExpressLRS_currAirRate_Modparams->FHSShopInterval) + 1;
     }
 #endif
-    uint16_t crc = ota_crc.calc((uint8_t*)otaPktPtr, OTA4_CRC_CALC_LEN, OtaCrcInitializer);
+    uint16_t crc = OtaCrc14::calc((uint8_t*)otaPktPtr, OTA4_CRC_CALC_LEN, OtaCrcInitializer);
     otaPktPtr->std.crcHigh = (crc >> 8);
     otaPktPtr->std.crcLow  = crc;
 }
@@ -549,16 +706,28 @@ void OtaUpdateSerializers(OtaSwitchMode_e const switchMode, uint8_t packetSize)
     {
         OtaValidatePacketCrc = &ValidatePacketCrcFull;
         OtaGeneratePacketCrc = &GeneratePacketCrcFull;
-        ota_crc.init(16, ELRS_CRC16_POLY);
 
+        // Each mode gets its own serializers so the channel placement is not decided per packet
         #if defined(TARGET_TX) || defined(UNIT_TEST)
         if (switchMode == smWideOr8ch)
             OtaPackChannelData = &GenerateChannelData8ch;
+        else if (switchMode == smHybridOr16ch)
+            OtaPackChannelData = &GenerateChannelData16ch;
+        else if (switchMode == sm16chDelta)
+            OtaPackChannelData = &GenerateChannelDataDelta;
         else
             OtaPackChannelData = &GenerateChannelData12ch;
+        // Start over with the RX not knowing any channel
+        memset(&DeltaTx, 0, sizeof(DeltaTx));
         #endif
         #if defined(TARGET_RX) || defined(UNIT_TEST)
-        OtaUnpackChannelData = &UnpackChannelData8ch;
+        if (switchMode == smHybridOr16ch)
+            OtaUnpackChannelData = &UnpackChannelData16ch;
+        else if (switchMode == sm16chDelta)
+            OtaUnpackChannelData = &UnpackChannelDataDelta;
+        else
+            OtaUnpackChannelData = &UnpackChannelData8ch12ch;
+        memset(&DeltaRx, 0, sizeof(DeltaRx));
         #endif
     } // is8ch
 
@@ -566,7 +735,6 @@ void OtaUpdateSerializers(OtaSwitchMode_e const switchMode, uint8_t packetSize)
     {
         OtaValidatePacketCrc = &ValidatePacketCrcStd;
         OtaGeneratePacketCrc = &GeneratePacketCrcStd;
-        ota_crc.init(14, ELRS_CRC14_POLY);
 
         if (switchMode == smWideOr8ch)
         {
@@ -592,11 +760,30 @@ void OtaUpdateSerializers(OtaSwitchMode_e const switchMode, uint8_t packetSize)
     OtaSwitchModeCurrent = switchMode;
 }
 
-void OtaPackAirportData(OTA_Packet_s * const otaPktPtr, FIFO<AP_MAX_BUF_LEN> *inputBuffer)
+void ICACHE_RAM_ATTR OtaSetSyncSwitchMode(OTA_Packet_s * const otaPktPtr, uint8_t const switchMode)
+{
+    if (OtaIsFullRes)
+    {
+        otaPktPtr->full.sync.sync.switchEncMode = switchMode;
+        otaPktPtr->full.sync.switchEncModeHigh = switchMode >> 1;
+    }
+    else
+    {
+        otaPktPtr->std.sync.switchEncMode = switchMode;
+    }
+}
+
+uint8_t ICACHE_RAM_ATTR OtaGetSyncSwitchMode(OTA_Packet_s const * const otaPktPtr)
+{
+    if (OtaIsFullRes)
+        return otaPktPtr->full.sync.sync.switchEncMode | (otaPktPtr->full.sync.switchEncModeHigh << 1);
+    return otaPktPtr->std.sync.switchEncMode;
+}
+
+void OtaPackAirportData(OTA_Packet_s * const otaPktPtr, SpscFIFO<AP_MAX_BUF_LEN> *inputBuffer)
 {
     otaPktPtr->std.type = PACKET_TYPE_DATA;
 
-    inputBuffer->lock();
     uint8_t count = inputBuffer->size();
     if (OtaIsFullRes)
     {
@@ -610,19 +797,18 @@ void OtaPackAirportData(OTA_Packet_s * const otaPktPtr, FIFO<AP_MAX_BUF_LEN> *in
         otaPktPtr->std.airport.count = count;
         inputBuffer->popBytes(otaPktPtr->std.airport.payload, count);
     }
-    inputBuffer->unlock();
 }
 
-void OtaUnpackAirportData(OTA_Packet_s const * const otaPktPtr, FIFO<AP_MAX_BUF_LEN> *outputBuffer)
+void OtaUnpackAirportData(OTA_Packet_s const * const otaPktPtr, SpscFIFO<AP_MAX_BUF_LEN> *outputBuffer)
 {
     if (OtaIsFullRes)
     {
         uint8_t count = otaPktPtr->full.airport.count;
-        outputBuffer->atomicPushBytes(otaPktPtr->full.airport.payload, count);
+        outputBuffer->pushBytes(otaPktPtr->full.airport.payload, count);
     }
     else
     {
         uint8_t count = otaPktPtr->std.airport.count;
-        outputBuffer->atomicPushBytes(otaPktPtr->std.airport.payload, count);
+        outputBuffer->pushBytes(otaPktPtr->std.airport.payload, count);
     }
 }
@@ -8,6 +8,7 @@
 #include "crsf_protocol.h"
 #include "telemetry_protocol.h"
 #include "FIFO.h"
+#include "SpscFIFO.h"
 
 #if TARGET_RX 
 extern bool isArmed;
@@ -29,6 +30,14 @@ extern bool isArmed;
 // Mask used to XOR the ModelId into the SYNC packet for ModelMatch
 #define MODELMATCH_MASK 0x3f
 
+// A SYNC with rateSwitch set announces rfRateEnum as the rate both ends change to
+// when OtaNonce next reaches a multiple of this
+#define OTA_RATE_SWITCH_NONCE_ALIGN 64
+static inline uint8_t OtaRateSwitchNonce(uint8_t const nonce)
+{
+    return (nonce | (OTA_RATE_SWITCH_NONCE_ALIGN - 1)) + 1;
+}
+
 typedef struct {
     uint8_t fhssIndex;
     uint8_t nonce;
@@ -37,7 +46,7 @@ typedef struct {
             newTlmRatio:3,
             geminiMode:1,
             otaProtocol:2,
-            free:1;
+            rateSwitch:1;
     uint8_t UID4;
     uint8_t UID5;
 } PACKED OTA_Sync_s;
@@ -50,10 +59,11 @@ typedef struct {
     uint8_t lq:7,
             tlmConfirm:1;
     int8_t SNR;
+    uint8_t rxSession;  // changes each time the RX connects, so the TX sees it reconnect
 } PACKED OTA_LinkStats_s;
 
 typedef struct {
-    uint8_t raw[5]; // 4x 10-bit channels, see PackUInt11ToChannels4x10 for encoding
+    uint8_t raw[5]; // 4x 10-bit channels, see PackChannels4x10 for encoding
 } PACKED OTA_Channels_4x10;
 
 typedef struct {
@@ -88,7 +98,6 @@ typedef struct {
             union {
                 struct {
                     OTA_LinkStats_s stats;
-                    uint8_t free;
                 } PACKED ul_link_stats;
                 uint8_t payload[ELRS4_TELEMETRY_BYTES_PER_CALL];
             };
@@ -118,6 +127,20 @@ typedef struct {
             OTA_Channels_4x10 chLow;    // CH0-CH3
             OTA_Channels_4x10 chHigh;   // AUX2-5 or AUX6-9
         } PACKED rc;
+        /** PACKET_TYPE_RCDATA in sm16chDelta, see GenerateChannelDataDelta for encoding **/
+        struct {
+            uint8_t packetType: 2,
+                    telemetryStatus: 1,
+                    uplinkPower: 3,
+                    free: 1,
+                    isArmed: 1;
+            uint8_t residuals[8];       // 16x 4-bit, CH1 in the low nibble of the first byte
+            uint8_t refreshCh: 4,       // channel sent in full, its nibble has the low 4 bits of the value
+                    prevGap: 3,         // nonces since the previous RC packet, 0 if more than 7
+                    free2: 1;
+            uint8_t refreshHigh: 6,     // high 6 bits of the refreshed channel's 10 bit value
+                    free3: 2;
+        } PACKED delta;
         struct {
             uint8_t packetType; // actually struct rc's first byte
             uint32_t packetNum; // LittleEndian
@@ -134,12 +157,15 @@ typedef struct {
         struct {
             uint8_t packetType; // only low 2 bits
             OTA_Sync_s sync;
-            uint8_t free[4];
+            uint8_t switchEncModeHigh: 1, // the full res modes have more than the 2 sync.switchEncMode can carry
+                    stubbornWindow: 1,    // TX takes windowed MSP acks, see StubbornSender::SetWindowed()
+                    free0: 6;
+            uint8_t free[3];
         } PACKED sync;
         /** PACKET_TYPE_TLM **/
         struct {
             uint8_t packetType: 2,
-                    tlmConfirm: 1,
+                    tlmConfirm: 1,      // in LINKSTATS set if ul_link_stats.payload[0] is the windowed MSP ack
                     packageIndex: 5;
             union {
                 struct {
@@ -172,9 +198,11 @@ extern volatile uint8_t OtaNonce;
 extern uint16_t OtaCrcInitializer;
 void OtaUpdateCrcInitFromUid();
 
-enum OtaSwitchMode_e { smWideOr8ch = 0, smHybridOr16ch = 1, sm12ch = 2 };
+enum OtaSwitchMode_e { smWideOr8ch = 0, smHybridOr16ch = 1, sm12ch = 2, sm16chDelta = 3 };
 void OtaUpdateSerializers(OtaSwitchMode_e const mode, uint8_t packetSize);
 extern OtaSwitchMode_e OtaSwitchModeCurrent;
+void OtaSetSyncSwitchMode(OTA_Packet_s * const otaPktPtr, uint8_t const switchMode);
+uint8_t OtaGetSyncSwitchMode(OTA_Packet_s const * const otaPktPtr);
 
 // CRC
 typedef bool (*ValidatePacketCrc_t)(OTA_Packet_s * const otaPktPtr);
@@ -200,8 +228,8 @@ typedef bool (*UnpackChannelData_t)(OTA_Packet_s const * const otaPktPtr, uint32
 extern UnpackChannelData_t OtaUnpackChannelData;
 #endif
 
-void OtaPackAirportData(OTA_Packet_s * const otaPktPtr, FIFO<AP_MAX_BUF_LEN> *inputBuffer);
-void OtaUnpackAirportData(OTA_Packet_s const * const otaPktPtr, FIFO<AP_MAX_BUF_LEN> *outputBuffer);
+void OtaPackAirportData(OTA_Packet_s * const otaPktPtr, SpscFIFO<AP_MAX_BUF_LEN> *inputBuffer);
+void OtaUnpackAirportData(OTA_Packet_s const * const otaPktPtr, SpscFIFO<AP_MAX_BUF_LEN> *outputBuffer);
 
 #if defined(DEBUG_RCVR_LINKSTATS)
 extern uint32_t debugRcvrLinkstatsPacketId;
@@ -1,5 +1,7 @@
 #pragma once
+#if !defined(TARGET_NATIVE)
 #include <Arduino.h>
+#endif
 #include <stdio.h>
 #include "../../src/include/targets.h"
 
@@ -0,0 +1,54 @@
+#include "PhaseLock.h"
+
+// Phase errors beyond this are a timer still being pulled in, not frequency error, so
+// only this much is integrated to keep the frequency estimate from winding up
+#define PHASELOCK_FREQ_ERR_MAX 64
+
+static inline int32_t clampErr(int32_t val, int32_t max)
+{
+    return (val > max) ? max : (val < -max) ? -max : val;
+}
+
+// Round a Q8 value to an integer, leaving the remainder in it
+static inline int32_t ICACHE_RAM_ATTR takeQ8(int32_t &val)
+{
+    int32_t const retVal = (val + 128) >> 8;
+    val -= retVal << 8;
+    return retVal;
+}
+
+void PhaseLock::reset()
+{
+    freq = 0;
+    phaseResidue = 0;
+    phaseMean = 0;
+    phaseVariance = 0;
+    lockCount = 0;
+}
+
+int32_t ICACHE_RAM_ATTR PhaseLock::update(int32_t phaseError, bool acquire)
+{
+    phaseError = clampErr(phaseError, PHASELOCK_ERR_MAX);
+    uint8_t const kpShift = acquire ? PHASELOCK_KP_ACQUIRE_SHIFT : PHASELOCK_KP_TRACK_SHIFT;
+    uint8_t const kiShift = acquire ? PHASELOCK_KI_ACQUIRE_SHIFT : PHASELOCK_KI_TRACK_SHIFT;
+
+    // Integral path
+    freq += (clampErr(phaseError, PHASELOCK_FREQ_ERR_MAX) * 256) >> kiShift;
+    freq = clampErr(freq, PHASELOCK_FREQ_MAX);
+
+    // Lock detector, mean is Q8
+    phaseMean += ((phaseError * 256) - phaseMean) >> 3;
+    int32_t const mean = phaseMean >> 8;
+    int32_t const dev = clampErr(phaseError - mean, 255);
+    phaseVariance += (dev * dev - phaseVariance) >> 3;
+    bool const inLimits = mean <= PHASELOCK_MEAN_LOCKED && mean >= -PHASELOCK_MEAN_LOCKED
+        && phaseVariance <= PHASELOCK_VARIANCE_LOCKED;
+    if (!inLimits)
+        lockCount = 0;
+    else if (lockCount < PHASELOCK_LOCK_UPDATES)
+        ++lockCount;
+
+    // Proportional path
+    phaseResidue += (phaseError * 256) >> kpShift;
+    return takeQ8(phaseResidue);
+}
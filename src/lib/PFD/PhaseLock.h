@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include "targets.h"
+
+// Loop gains as right shifts of the phase error, (Kp, Ki) = (1/2, 1/64) acquiring and (1/8, 1/128) tracking.
+// A correction only shows in the PFD one interval after it is applied, so the gains must leave margin for that.
+// Acquiring settles in ~15 packets, tracking in ~45 but passes a quarter of the packet timing jitter
+#define PHASELOCK_KP_ACQUIRE_SHIFT  1
+#define PHASELOCK_KI_ACQUIRE_SHIFT  6
+#define PHASELOCK_KP_TRACK_SHIFT    3
+#define PHASELOCK_KI_TRACK_SHIFT    7
+#define PHASELOCK_FREQ_MAX          (16 << 8)   // us/interval in Q8, well beyond any pair of crystals
+#define PHASELOCK_ERR_MAX           (1 << 20)   // us, keeps the Q8 maths in 32 bits
+#define PHASELOCK_MEAN_LOCKED       8           // us, |mean phase error| to be considered locked
+#define PHASELOCK_VARIANCE_LOCKED   64          // us^2, phase error variance to be considered locked
+#define PHASELOCK_LOCK_UPDATES      16          // consecutive updates within the limits before reporting locked
+
+/**
+ * @brief Second order digital PLL locking the RX timer to the PFD phase error.
+ *
+ * A proportional path corrects the phase through hwTimer::phaseShift() and an
+ * integral path tracks the frequency error between the TX and RX crystals,
+ * applied through hwTimer::setFreqOffset(). The phase path keeps its fractional
+ * remainder so the corrections average out to sub-microsecond resolution, the
+ * frequency is applied with the 1/256us resolution of FreqOffset.
+ *
+ * The mean and variance of the phase error are tracked to report the lock state.
+ */
+class PhaseLock
+{
+public:
+    PhaseLock() { reset(); }
+
+    void reset();
+
+    /**
+     * @brief Feed the phase error of one packet (PFD ext - int) and get the phase
+     * correction for it.
+     * @param phaseError in microseconds, positive if the timer is early
+     * @param acquire use the wide loop bandwidth, for before the link is connected
+     * @return the phase shift to apply with hwTimer::phaseShift(), in microseconds
+     */
+    int32_t update(int32_t phaseError, bool acquire);
+
+    // Frequency error estimate, Q8 microseconds per interval (positive = TX interval longer)
+    int32_t getFreq() const { return freq; }
+    // The frequency estimate as a hwTimer FreqOffset, 1/256us per half interval
+    int32_t getFreqOffset() const { return freq / 2; }
+    int32_t getPhaseMean() const { return phaseMean >> 8; }
+    // Variance of the phase error in us^2, squared deviations are capped at 255^2
+    int32_t getPhaseVariance() const { return phaseVariance; }
+    bool isLocked() const { return lockCount >= PHASELOCK_LOCK_UPDATES; }
+
+private:
+    int32_t freq;           // Q8 us per interval
+    int32_t phaseResidue;   // Q8 us not yet applied by update()
+    int32_t phaseMean;      // Q8 us
+    int32_t phaseVariance;
+    uint8_t lockCount;
+};
@@ -5,6 +5,37 @@
 #endif
 
 void ICACHE_RAM_ATTR SPIExClass::_transfer(uint8_t cs_mask, uint8_t *data, uint32_t size, bool reading)
+{
+    // Anything queued goes first, it was asked for before this
+    if (asyncCount)
+    {
+        flush();
+    }
+
+    _start(cs_mask, data, size);
+
+    if (reading)
+    {
+        // wait for SPI write to complete
+        while(_busy()) {}
+
+        _readFifo(data, size);
+    }
+}
+
+bool ICACHE_RAM_ATTR SPIExClass::_busy()
+{
+#if defined(PLATFORM_ESP32)
+    spi_dev_t *spi = *(reinterpret_cast<spi_dev_t**>(bus()));
+    return spi->cmd.usr;
+#elif defined(PLATFORM_ESP8266)
+    return SPI1CMD & SPIBUSY;
+#else
+    return false;
+#endif
+}
+
+void ICACHE_RAM_ATTR SPIExClass::_start(uint8_t cs_mask, uint8_t *data, uint32_t size)
 {
 #if defined(PLATFORM_ESP32)
     spi_dev_t *spi = *(reinterpret_cast<spi_dev_t**>(bus()));
@@ -36,17 +67,6 @@ void ICACHE_RAM_ATTR SPIExClass::_transfer(uint8_t cs_mask, uint8_t *data, uint3
 #endif
     // start the SPI module
     spi->cmd.usr = 1;
-
-    if (reading)
-    {
-        // wait for SPI write to complete
-        while(spi->cmd.usr) {}
-
-        for(int i=0; i<words; i++)
-        {
-            wordsBuf[i] = spi->data_buf[i]; //copy spi fifo to buffer
-        }
-    }
 #elif defined(PLATFORM_ESP8266)
     // we support only one hardware controlled CS pin, so theres nothing to do to configure it at this point
 
@@ -69,19 +89,109 @@ void ICACHE_RAM_ATTR SPIExClass::_transfer(uint8_t cs_mask, uint8_t *data, uint3
 
     // start the SPI module
     SPI1CMD |= SPIBUSY;
+#endif
+}
 
-    if (reading)
+// read data from the FIFO back to the application buffer, once the transfer is complete
+void ICACHE_RAM_ATTR SPIExClass::_readFifo(uint8_t *data, uint32_t size)
+{
+#if defined(PLATFORM_ESP32)
+    spi_dev_t *spi = *(reinterpret_cast<spi_dev_t**>(bus()));
+    const uint32_t words = (size + 3) / 4;
+    auto * const wordsBuf = reinterpret_cast<uint32_t *>(data);
+    for(int i=0; i<words; i++)
     {
-        // wait for SPI write to complete
-        while(SPI1CMD & SPIBUSY) {}
+        wordsBuf[i] = spi->data_buf[i]; //copy spi fifo to buffer
+    }
+#elif defined(PLATFORM_ESP8266)
+    volatile uint32_t * const fifoPtr = &SPI1W0;
+    const uint8_t outSize = ((size + 3) / 4);
+    uint32_t * const dataPtr = (uint32_t*) data;
+    for(int i=0; i<outSize; i++)
+    {
+        dataPtr[i] = fifoPtr[i];
+    }
+#endif
+}
+
+uint32_t ICACHE_RAM_ATTR SPIExClass::_queue(uint8_t cs_mask, uint8_t *data, uint32_t size, bool reading, SPIExCallback_t callback, SPIExReady_t ready)
+{
+    if (asyncCount == SPIEX_ASYNC_QUEUE_LEN)
+    {
+        flush();
+    }
+
+    SPIExTransaction_t &transaction = asyncQueue[(asyncHead + asyncCount) % SPIEX_ASYNC_QUEUE_LEN];
+    transaction = {cs_mask, reading, size, data, ready, callback};
+    ++asyncCount;
+    ++asyncQueued;
+
+    poll();
+    return asyncQueued;
+}
+
+void ICACHE_RAM_ATTR SPIExClass::_startQueueHead()
+{
+    SPIExTransaction_t const &transaction = asyncQueue[asyncHead];
+    _start(transaction.cs_mask, transaction.data, transaction.size);
+    asyncInFlight = true;
+}
+
+bool ICACHE_RAM_ATTR SPIExClass::poll()
+{
+    if (asyncInFlight)
+    {
+        if (_busy())
+        {
+            return true;
+        }
 
-        // read data from the FIFO back to the application buffer
-        for(int i=0; i<outSize; i++)
+        // Copied out as the callback may queue another transfer in its place
+        SPIExTransaction_t const transaction = asyncQueue[asyncHead];
+        if (transaction.reading)
+        {
+            _readFifo(transaction.data, transaction.size);
+        }
+        asyncHead = (asyncHead + 1) % SPIEX_ASYNC_QUEUE_LEN;
+        --asyncCount;
+        ++asyncCompleted;
+        asyncInFlight = false;
+        if (transaction.callback)
         {
-            dataPtr[i] = fifoPtr[i];
+            transaction.callback(transaction.data, transaction.size);
+        }
+    }
+
+    if (!asyncInFlight && asyncCount)
+    {
+        SPIExReady_t const ready = asyncQueue[asyncHead].ready;
+        if (ready == nullptr || ready())
+        {
+            _startQueueHead();
+        }
+    }
+    return asyncCount != 0;
+}
+
+/**
+ * Wait for a queued transfer and those before it. Like the radio WaitOnBusy(), a transfer
+ * is started anyway if it's not ready within the timeout
+ */
+void ICACHE_RAM_ATTR SPIExClass::wait(uint32_t id)
+{
+    constexpr uint32_t timeoutUS = 1000U;
+    uint32_t startTime = micros();
+    while (!isDone(id) && poll())
+    {
+        if (asyncInFlight)
+        {
+            startTime = micros();
+        }
+        else if ((micros() - startTime) > timeoutUS)
+        {
+            _startQueueHead();
         }
     }
-#endif
 }
 
 #if defined(PLATFORM_ESP32_S3) || defined(PLATFORM_ESP32_C3)
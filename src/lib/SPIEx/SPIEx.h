@@ -1,6 +1,22 @@
 #include "targets.h"
 #include <SPI.h>
 
+#define SPIEX_ASYNC_QUEUE_LEN   4
+
+// Checked before a queued transfer is started, e.g. the device's BUSY pin
+typedef bool (*SPIExReady_t)();
+typedef void (*SPIExCallback_t)(uint8_t *data, uint32_t size);
+
+typedef struct
+{
+    uint8_t cs_mask;
+    bool reading;
+    uint32_t size;
+    uint8_t *data;
+    SPIExReady_t ready;
+    SPIExCallback_t callback;
+} SPIExTransaction_t;
+
 /**
  * @brief An extension to the platform SPI class that provides some performance enhancements.
  *
@@ -47,8 +63,57 @@ public:
      */
     void inline ICACHE_RAM_ATTR write(uint8_t cs_mask, uint8_t * data, uint32_t size) { _transfer(cs_mask, data, size, false); }
 
+    /**
+     * @brief Queue an SPI read operation and return without waiting for it.
+     *
+     * Queued transfers are chained, each one is started as the one before completes, once its
+     * ready check (if any) passes. The chain moves on each time poll() is called, which every
+     * blocking read() and write() does until the queue is empty, so those stay in order.
+     * Every ELRS transfer fits the SPI module's FIFO, so this needs no DMA.
+     *
+     * @param cs_mask mask of CS pins to enable for this operation
+     * @param data word-aligned and padded data buffer, which must stay valid until the transfer is done
+     * @param size the number of bytes to be read into in the data buffer
+     * @param callback called with the data once it has been read
+     * @param ready checked before starting the transfer, nullptr to start it as soon as the bus is free
+     * @returns an id to pass to isDone() or wait()
+     */
+    uint32_t inline ICACHE_RAM_ATTR readAsync(uint8_t cs_mask, uint8_t *data, uint32_t size, SPIExCallback_t callback = nullptr, SPIExReady_t ready = nullptr)
+    {
+        return _queue(cs_mask, data, size, true, callback, ready);
+    }
+
+    /**
+     * @brief Queue an SPI write operation, as readAsync()
+     */
+    uint32_t inline ICACHE_RAM_ATTR writeAsync(uint8_t cs_mask, uint8_t *data, uint32_t size, SPIExCallback_t callback = nullptr, SPIExReady_t ready = nullptr)
+    {
+        return _queue(cs_mask, data, size, false, callback, ready);
+    }
+
+    /**
+     * @brief Complete the queued transfer in flight if the SPI module has finished it, and start the next
+     * @returns true while there are queued transfers
+     */
+    bool ICACHE_RAM_ATTR poll();
+    bool inline ICACHE_RAM_ATTR isDone(uint32_t id) const { return (int32_t)(asyncCompleted - id) >= 0; }
+    void ICACHE_RAM_ATTR wait(uint32_t id);
+    void inline ICACHE_RAM_ATTR flush() { wait(asyncQueued); }
+
 private:
+    SPIExTransaction_t asyncQueue[SPIEX_ASYNC_QUEUE_LEN];
+    uint8_t asyncHead = 0;
+    uint8_t asyncCount = 0;
+    bool asyncInFlight = false;
+    uint32_t asyncQueued = 0;
+    uint32_t asyncCompleted = 0;
+
     void _transfer(uint8_t cs_mask, uint8_t *data, uint32_t size, bool reading);
+    uint32_t _queue(uint8_t cs_mask, uint8_t *data, uint32_t size, bool reading, SPIExCallback_t callback, SPIExReady_t ready);
+    void _start(uint8_t cs_mask, uint8_t *data, uint32_t size);
+    bool _busy();
+    void _readFifo(uint8_t *data, uint32_t size);
+    void _startQueueHead();
 };
 
 extern SPIExClass SPIEx;
@@ -71,6 +71,7 @@ public:
     int8_t GetLastPacketRSSI(SX12XX_Radio_Number_t radioNumber);
     int8_t GetLastPacketSNRRaw(SX12XX_Radio_Number_t radioNumber);
     int8_t GetCurrRSSI(SX12XX_Radio_Number_t radioNumber);
+    int8_t GetRssiInst(SX12XX_Radio_Number_t radioNumber) { return GetCurrRSSI(radioNumber); }
     void GetLastPacketStats();
 
     ////////////Non-blocking TX related Functions/////////////////
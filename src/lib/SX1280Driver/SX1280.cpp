@@ -55,6 +55,7 @@ SX1280Driver::SX1280Driver(): SX12xxDriverCommon()
     currOpmode = SX1280_MODE_SLEEP;
     lastSuccessfulPacketRadio = SX12XX_Radio_1;
     fallBackMode = SX1280_MODE_STDBY_RC;
+    rxBufferAddrRadios = SX12XX_Radio_NONE;
 }
 
 void SX1280Driver::End()
@@ -153,6 +154,7 @@ void SX1280Driver::Config(uint8_t bw, uint8_t sf, uint8_t cr, uint32_t regfreq,
     PayloadLength = _PayloadLength;
     IQinverted = InvertIQ;
     packet_mode = mode;
+    rxBufferAddrRadios = SX12XX_Radio_NONE;
     SetMode(SX1280_MODE_STDBY_RC, SX12XX_Radio_All);
     hal.WriteCommand(SX1280_RADIO_SET_PACKETTYPE, mode, SX12XX_Radio_All, 20);
     if (mode == SX1280_PACKET_TYPE_FLRC)
@@ -251,7 +253,8 @@ void SX1280Driver::SetMode(SX1280_RadioOperatingModes_t OPmode, SX12XX_Radio_Num
         break;
 
     case SX1280_MODE_FS:
-        hal.WriteCommand(SX1280_RADIO_SET_FS, (uint8_t)0x00, radioNumber, 70);
+        buf[0] = 0x00;
+        hal.QueueCommand(SX1280_RADIO_SET_FS, buf, 1, radioNumber, 70);
         break;
 
     case SX1280_MODE_RX:
@@ -259,14 +262,14 @@ void SX1280Driver::SetMode(SX1280_RadioOperatingModes_t OPmode, SX12XX_Radio_Num
         buf[0] = RX_TIMEOUT_PERIOD_BASE;
         buf[1] = tempTimeout >> 8;
         buf[2] = tempTimeout & 0xFF;
-        hal.WriteCommand(SX1280_RADIO_SET_RX, buf, sizeof(buf), radioNumber, 100);
+        hal.QueueCommand(SX1280_RADIO_SET_RX, buf, sizeof(buf), radioNumber, 100);
         break;
 
     case SX1280_MODE_RX_CONT:
         buf[0] = RX_TIMEOUT_PERIOD_BASE;
         buf[1] = 0xFFFF >> 8;
         buf[2] = 0xFFFF & 0xFF;
-        hal.WriteCommand(SX1280_RADIO_SET_RX, buf, sizeof(buf), radioNumber, 100);
+        hal.QueueCommand(SX1280_RADIO_SET_RX, buf, sizeof(buf), radioNumber, 100);
         break;
 
     case SX1280_MODE_TX:
@@ -274,7 +277,7 @@ void SX1280Driver::SetMode(SX1280_RadioOperatingModes_t OPmode, SX12XX_Radio_Num
         buf[0] = RX_TIMEOUT_PERIOD_BASE;
         buf[1] = 0xFF; // no timeout set for now
         buf[2] = 0xFF; // TODO dynamic timeout based on expected onairtime
-        hal.WriteCommand(SX1280_RADIO_SET_TX, buf, sizeof(buf), radioNumber, 100);
+        hal.QueueCommand(SX1280_RADIO_SET_TX, buf, sizeof(buf), radioNumber, 100);
         break;
 
     case SX1280_MODE_CAD:
@@ -409,7 +412,7 @@ void ICACHE_RAM_ATTR SX1280Driver::SetFrequencyReg(uint32_t regfreq, SX12XX_Radi
     buf[1] = (uint8_t)((regfreq >> 8) & 0xFF);
     buf[2] = (uint8_t)(regfreq & 0xFF);
 
-    hal.WriteCommand(SX1280_RADIO_SET_RFFREQUENCY, buf, sizeof(buf), radioNumber);
+    hal.QueueCommand(SX1280_RADIO_SET_RFFREQUENCY, buf, sizeof(buf), radioNumber);
 
     currFreq = regfreq;
 }
@@ -454,7 +457,7 @@ void ICACHE_RAM_ATTR SX1280Driver::ClearIrqStatus(uint16_t irqMask, SX12XX_Radio
     buf[0] = (uint8_t)(((uint16_t)irqMask >> 8) & 0x00FF);
     buf[1] = (uint8_t)((uint16_t)irqMask & 0x00FF);
 
-    hal.WriteCommand(SX1280_RADIO_CLR_IRQSTATUS, buf, sizeof(buf), radioNumber);
+    hal.QueueCommand(SX1280_RADIO_CLR_IRQSTATUS, buf, sizeof(buf), radioNumber);
 }
 
 void ICACHE_RAM_ATTR SX1280Driver::TXnbISR()
@@ -514,7 +517,7 @@ void ICACHE_RAM_ATTR SX1280Driver::TXnb(uint8_t * data, uint8_t size, SX12XX_Rad
     }
 
     RFAMP.TXenable(radioNumber); // do first to allow PA stablise
-    hal.WriteBuffer(0x00, data, size, radioNumber); //todo fix offset to equal fifo addr
+    hal.QueueBuffer(0x00, data, size, radioNumber); //todo fix offset to equal fifo addr
     instance->SetMode(SX1280_MODE_TX, radioNumber);
 
 #ifdef DEBUG_SX1280_OTA_TIMING
@@ -533,6 +536,8 @@ bool ICACHE_RAM_ATTR SX1280Driver::RXnbISR(uint16_t irqStatus, SX12XX_Radio_Numb
         currOpmode = SX1280_MODE_FS;
     }
 
+    hal.DiscardPrefetchedPacketStatus();
+
     rx_status fail = SX12XX_RX_OK;
     // The SYNCWORD_VALID bit isn't set on LoRa, it has no synch (sic) word, and CRC is only on for FLRC
     if (packet_mode == SX1280_PACKET_TYPE_FLRC)
@@ -544,7 +549,8 @@ bool ICACHE_RAM_ATTR SX1280Driver::RXnbISR(uint16_t irqStatus, SX12XX_Radio_Numb
     if (fail == SX12XX_RX_OK)
     {
         uint8_t const FIFOaddr = GetRxBufferAddr(radioNumber);
-        hal.ReadBuffer(FIFOaddr, RXdataBuffer, PayloadLength, radioNumber);
+        // The packet status for GetLastPacketStats() is read while the packet is processed
+        hal.ReadBufferAndPacketStatus(FIFOaddr, RXdataBuffer, PayloadLength, radioNumber);
     }
 
     return RXdoneCallback(fail);
@@ -558,9 +564,15 @@ void ICACHE_RAM_ATTR SX1280Driver::RXnb(SX1280_RadioOperatingModes_t rxMode, uin
 
 uint8_t ICACHE_RAM_ATTR SX1280Driver::GetRxBufferAddr(SX12XX_Radio_Number_t radioNumber)
 {
-    WORD_ALIGNED_ATTR uint8_t status[2] = {0};
-    hal.ReadCommand(SX1280_RADIO_GET_RXBUFFERSTATUS, status, 2, radioNumber);
-    return status[1];
+    uint8_t const idx = (radioNumber == SX12XX_Radio_1) ? 0 : 1;
+    if (!(rxBufferAddrRadios & radioNumber))
+    {
+        WORD_ALIGNED_ATTR uint8_t status[2] = {0};
+        hal.ReadCommand(SX1280_RADIO_GET_RXBUFFERSTATUS, status, 2, radioNumber);
+        rxBufferAddr[idx] = status[1];
+        rxBufferAddrRadios |= radioNumber;
+    }
+    return rxBufferAddr[idx];
 }
 
 void ICACHE_RAM_ATTR SX1280Driver::GetStatus(SX12XX_Radio_Number_t radioNumber)
@@ -619,7 +631,7 @@ void ICACHE_RAM_ATTR SX1280Driver::GetLastPacketStats()
             {
                 uint8_t const FIFOaddr = GetRxBufferAddr(radio[secondRadioIdx]);
                 WORD_ALIGNED_ATTR uint8_t RXdataBuffer_second[RXBuffSize];
-                hal.ReadBuffer (FIFOaddr, RXdataBuffer_second, PayloadLength, radio[secondRadioIdx]);
+                hal.ReadBufferAndPacketStatus(FIFOaddr, RXdataBuffer_second, PayloadLength, radio[secondRadioIdx]);
 
                 // if the second packet is same to the first, it's valid
                 if(memcmp(RXdataBuffer, RXdataBuffer_second, PayloadLength) == 0)
@@ -647,7 +659,10 @@ void ICACHE_RAM_ATTR SX1280Driver::GetLastPacketStats()
     {
         if (gotRadio[i])
         {
-            hal.ReadCommand(SX1280_RADIO_GET_PACKETSTATUS, status, 2, radio[i]);
+            if (!hal.GetPrefetchedPacketStatus(status, radio[i]))
+            {
+                hal.ReadCommand(SX1280_RADIO_GET_PACKETSTATUS, status, 2, radio[i]);
+            }
 
             if (packet_mode == SX1280_PACKET_TYPE_FLRC)
             {
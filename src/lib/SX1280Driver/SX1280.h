@@ -63,6 +63,9 @@ private:
     uint8_t pwrCurrent;
     uint8_t pwrPending;
     SX1280_RadioOperatingModes_t fallBackMode;
+    // Each packet is received at the RX base address, so GetRxBufferAddr() only reads it once per Config()
+    uint8_t rxBufferAddr[2];
+    uint8_t rxBufferAddrRadios;
 
     void SetMode(SX1280_RadioOperatingModes_t OPmode, SX12XX_Radio_Number_t radioNumber, uint32_t incomingTimeout = 0);
     void SetFIFOaddr(uint8_t txBaseAddr, uint8_t rxBaseAddr);
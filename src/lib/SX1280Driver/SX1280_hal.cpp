@@ -36,6 +36,16 @@ void SX1280Hal::end()
     {
         detachInterrupt(GPIO_PIN_DIO1_2);
     }
+    if (commandQueueEnabled)
+    {
+        FlushCommandQueue();
+        commandQueueEnabled = false;
+        detachInterrupt(GPIO_PIN_BUSY);
+        if (GPIO_PIN_BUSY_2 != UNDEF_PIN)
+        {
+            detachInterrupt(GPIO_PIN_BUSY_2);
+        }
+    }
     SPIEx.end();
     IsrCallback_1 = nullptr; // remove callbacks
     IsrCallback_2 = nullptr; // remove callbacks
@@ -84,7 +94,19 @@ void SX1280Hal::init()
     SPIEx.setFrequency(17500000);
 #endif
 
-    //attachInterrupt(digitalPinToInterrupt(GPIO_PIN_BUSY), this->busyISR, CHANGE); //not used atm
+    // Queued commands are sent as BUSY falls, which needs an interrupt on every BUSY pin
+    cmdQueueHead = 0;
+    cmdQueueCount = 0;
+    commandQueueEnabled = GPIO_PIN_BUSY != UNDEF_PIN && digitalPinToInterrupt(GPIO_PIN_BUSY) >= 0 &&
+        (GPIO_PIN_BUSY_2 == UNDEF_PIN || digitalPinToInterrupt(GPIO_PIN_BUSY_2) >= 0);
+    if (commandQueueEnabled)
+    {
+        attachInterrupt(digitalPinToInterrupt(GPIO_PIN_BUSY), this->busyISR, FALLING);
+        if (GPIO_PIN_BUSY_2 != UNDEF_PIN)
+        {
+            attachInterrupt(digitalPinToInterrupt(GPIO_PIN_BUSY_2), this->busyISR, FALLING);
+        }
+    }
     attachInterrupt(digitalPinToInterrupt(GPIO_PIN_DIO1), this->dioISR_1, RISING);
     if (GPIO_PIN_DIO1_2 != UNDEF_PIN)
     {
@@ -237,8 +259,205 @@ void ICACHE_RAM_ATTR SX1280Hal::ReadBuffer(uint8_t offset, uint8_t *buffer, uint
     memcpy(buffer, OutBuffer + 3, size);
 }
 
+void ICACHE_RAM_ATTR SX1280Hal::QueueCommand(SX1280_RadioCommands_t command, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber, uint32_t busyDelay)
+{
+    if (!commandQueueEnabled || size + 1 > SX1280_CMD_QUEUE_MAX_SIZE)
+    {
+        WriteCommand(command, buffer, size, radioNumber, busyDelay);
+        return;
+    }
+
+    WORD_ALIGNED_ATTR uint8_t OutBuffer[WORD_PADDED(size + 1)] = {
+        command,
+    };
+
+    memcpy(OutBuffer + 1, buffer, size);
+
+    queueTransfer(OutBuffer, size + 1, radioNumber);
+}
+
+void ICACHE_RAM_ATTR SX1280Hal::QueueBuffer(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    if (!commandQueueEnabled || size + 2 > SX1280_CMD_QUEUE_MAX_SIZE)
+    {
+        WriteBuffer(offset, buffer, size, radioNumber);
+        return;
+    }
+
+    WORD_ALIGNED_ATTR uint8_t OutBuffer[WORD_PADDED(size + 2)] = {
+        SX1280_RADIO_WRITE_BUFFER,
+        offset
+    };
+
+    memcpy(OutBuffer + 2, buffer, size);
+
+    queueTransfer(OutBuffer, size + 2, radioNumber);
+}
+
+void ICACHE_RAM_ATTR SX1280Hal::queueTransfer(uint8_t *data, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    if (cmdQueueCount == SX1280_CMD_QUEUE_LEN)
+    {
+        FlushCommandQueue();
+    }
+
+    lockCommandQueue();
+    SX1280_QueuedTransfer_t &transfer = cmdQueue[(cmdQueueHead + cmdQueueCount) % SX1280_CMD_QUEUE_LEN];
+    transfer.radioNumber = radioNumber;
+    transfer.size = size;
+    memcpy(transfer.buf, data, size);
+    cmdQueueCount = cmdQueueCount + 1;
+    // Straight out if the radio is free, otherwise when BUSY falls
+    serviceCommandQueue();
+    unlockCommandQueue();
+}
+
+/**
+ * Send everything queued, waiting on BUSY for each. Like WaitOnBusy(), a transfer is sent
+ * anyway if the radio stays busy for longer than the timeout
+ */
+void ICACHE_RAM_ATTR SX1280Hal::FlushCommandQueue()
+{
+    constexpr uint32_t wtimeoutUS = 1000U;
+    uint32_t startTime = micros();
+
+    lockCommandQueue();
+    while (cmdQueueCount)
+    {
+        if (!IsBusy(cmdQueue[cmdQueueHead].radioNumber) || (micros() - startTime) > wtimeoutUS)
+        {
+            sendQueueHead();
+            startTime = micros();
+        }
+        // Let the other ISRs in while spinning
+        unlockCommandQueue();
+        lockCommandQueue();
+    }
+    unlockCommandQueue();
+}
+
+// Called with the queue locked
+void ICACHE_RAM_ATTR SX1280Hal::serviceCommandQueue()
+{
+    if (cmdQueueCount && !IsBusy(cmdQueue[cmdQueueHead].radioNumber))
+    {
+        sendQueueHead();
+    }
+}
+
+void ICACHE_RAM_ATTR SX1280Hal::sendQueueHead()
+{
+    SX1280_QueuedTransfer_t &transfer = cmdQueue[cmdQueueHead];
+    // read() rather than write() to wait for the SPI transfer to finish
+    SPIEx.read(transfer.radioNumber, transfer.buf, transfer.size);
+    cmdQueueHead = (cmdQueueHead + 1) % SX1280_CMD_QUEUE_LEN;
+    cmdQueueCount = cmdQueueCount - 1;
+
+    // BUSY rises a moment after NSS, until then the radio would look free to the next
+    // BUSY edge. Commands which are done by then never raise it, so don't wait long
+    constexpr uint32_t busyRiseTimeoutUS = 2U;
+    uint32_t const startTime = micros();
+    while (!IsBusy(transfer.radioNumber) && (micros() - startTime) < busyRiseTimeoutUS)
+        ;
+}
+
+bool ICACHE_RAM_ATTR SX1280Hal::IsBusy(SX12XX_Radio_Number_t radioNumber)
+{
+    if ((radioNumber & SX12XX_Radio_1) && GPIO_PIN_BUSY != UNDEF_PIN && digitalRead(GPIO_PIN_BUSY) == HIGH)
+    {
+        return true;
+    }
+    if ((radioNumber & SX12XX_Radio_2) && GPIO_PIN_BUSY_2 != UNDEF_PIN && digitalRead(GPIO_PIN_BUSY_2) == HIGH)
+    {
+        return true;
+    }
+    return false;
+}
+
+void ICACHE_RAM_ATTR SX1280Hal::lockCommandQueue()
+{
+#if defined(PLATFORM_ESP32)
+    portENTER_CRITICAL(&cmdQueueMux);
+#elif defined(PLATFORM_ESP8266)
+    noInterrupts();
+#endif
+}
+
+void ICACHE_RAM_ATTR SX1280Hal::unlockCommandQueue()
+{
+#if defined(PLATFORM_ESP32)
+    portEXIT_CRITICAL(&cmdQueueMux);
+#elif defined(PLATFORM_ESP8266)
+    interrupts();
+#endif
+}
+
+/**
+ * ReadBuffer() for a received packet, with the packet status read queued behind it so it
+ * goes as soon as BUSY allows while the CPU gets on with the payload
+ */
+void ICACHE_RAM_ATTR SX1280Hal::ReadBufferAndPacketStatus(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    WORD_ALIGNED_ATTR uint8_t OutBuffer[WORD_PADDED(size + 3)] = {
+        SX1280_RADIO_READ_BUFFER,
+        offset,
+        0x00
+    };
+
+    uint8_t const idx = (radioNumber == SX12XX_Radio_1) ? 0 : 1;
+
+    WaitOnBusy(radioNumber);
+    // The last one may still be queued
+    SPIEx.wait(prefetchId[idx]);
+
+    uint32_t const bufferId = SPIEx.readAsync(radioNumber, OutBuffer, size + 3);
+
+    prefetchBuffer[idx][0] = SX1280_RADIO_GET_PACKETSTATUS;
+    prefetchBuffer[idx][1] = 0x00;
+    prefetchRadios |= radioNumber;
+    prefetchId[idx] = SPIEx.readAsync(radioNumber, prefetchBuffer[idx], 4, nullptr,
+        (idx == 0) ? &radio1Ready : &radio2Ready);
+
+    SPIEx.wait(bufferId);
+    memcpy(buffer, OutBuffer + 3, size);
+}
+
+/**
+ * The packet status read by ReadBufferAndPacketStatus() for the radio
+ * @returns false if there isn't one, so the caller should read it
+ ***/
+bool ICACHE_RAM_ATTR SX1280Hal::GetPrefetchedPacketStatus(uint8_t *status, SX12XX_Radio_Number_t radioNumber)
+{
+    if (!(prefetchRadios & radioNumber))
+    {
+        return false;
+    }
+
+    uint8_t const idx = (radioNumber == SX12XX_Radio_1) ? 0 : 1;
+    SPIEx.wait(prefetchId[idx]);
+    prefetchRadios &= ~radioNumber;
+    memcpy(status, prefetchBuffer[idx] + 2, 2); // first 2 bytes returned are status!
+    return true;
+}
+
+bool ICACHE_RAM_ATTR SX1280Hal::radio1Ready()
+{
+    return !instance->IsBusy(SX12XX_Radio_1);
+}
+
+bool ICACHE_RAM_ATTR SX1280Hal::radio2Ready()
+{
+    return !instance->IsBusy(SX12XX_Radio_2);
+}
+
 bool ICACHE_RAM_ATTR SX1280Hal::WaitOnBusy(SX12XX_Radio_Number_t radioNumber)
 {
+    // Anything queued goes before the access waiting on this
+    if (cmdQueueCount)
+    {
+        FlushCommandQueue();
+    }
+
     if (GPIO_PIN_BUSY != UNDEF_PIN)
     {
         constexpr uint32_t wtimeoutUS = 1000U;
@@ -293,4 +512,11 @@ void ICACHE_RAM_ATTR SX1280Hal::dioISR_2()
         instance->IsrCallback_2();
 }
 
+void ICACHE_RAM_ATTR SX1280Hal::busyISR()
+{
+    instance->lockCommandQueue();
+    instance->serviceCommandQueue();
+    instance->unlockCommandQueue();
+}
+
 #endif // UNIT_TEST
@@ -27,6 +27,17 @@ enum SX1280_BusyState_
     SX1280_BUSY = false,
 };
 
+#define SX1280_CMD_QUEUE_LEN        8
+// The longest transfer which can be queued, a WriteBuffer of an OTA8 packet
+#define SX1280_CMD_QUEUE_MAX_SIZE   16
+
+typedef struct
+{
+    SX12XX_Radio_Number_t radioNumber;
+    uint8_t size;
+    WORD_ALIGNED_ATTR uint8_t buf[WORD_PADDED(SX1280_CMD_QUEUE_MAX_SIZE)];
+} SX1280_QueuedTransfer_t;
+
 class SX1280Hal
 {
 public:
@@ -49,11 +60,28 @@ public:
 
     void ICACHE_RAM_ATTR WriteBuffer(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber); // Writes and Reads to FIFO
     void ICACHE_RAM_ATTR ReadBuffer(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber);
+    // ReadBuffer() with the packet status read chained behind it, collected by GetPrefetchedPacketStatus()
+    void ICACHE_RAM_ATTR ReadBufferAndPacketStatus(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber);
+    bool ICACHE_RAM_ATTR GetPrefetchedPacketStatus(uint8_t *status, SX12XX_Radio_Number_t radioNumber);
+    void DiscardPrefetchedPacketStatus() { prefetchRadios = SX12XX_Radio_NONE; }
 
     bool ICACHE_RAM_ATTR WaitOnBusy(SX12XX_Radio_Number_t radioNumber);
 
+    /**
+     * Writes which don't need to wait for the radio, for the timer and DIO ISRs. If the
+     * radio is busy the write is queued and sent from the BUSY falling edge interrupt.
+     * Every other access sends anything queued first, so the order is kept. Without
+     * interrupt capable BUSY pins these are the same as WriteCommand() and WriteBuffer()
+     */
+    void ICACHE_RAM_ATTR QueueCommand(SX1280_RadioCommands_t command, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber, uint32_t busyDelay = 15);
+    void ICACHE_RAM_ATTR QueueBuffer(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber);
+    void ICACHE_RAM_ATTR FlushCommandQueue();
+
     static ICACHE_RAM_ATTR void dioISR_1();
     static ICACHE_RAM_ATTR void dioISR_2();
+    static ICACHE_RAM_ATTR void busyISR();
+    static ICACHE_RAM_ATTR bool radio1Ready();
+    static ICACHE_RAM_ATTR bool radio2Ready();
     void (*IsrCallback_1)(); //function pointer for callback
     void (*IsrCallback_2)(); //function pointer for callback
 
@@ -69,5 +97,23 @@ public:
     }
 
 private:
-
+    // The packet status reads queued by ReadBufferAndPacketStatus() for each radio, [command, NOP, status]
+    WORD_ALIGNED_ATTR uint8_t prefetchBuffer[2][WORD_PADDED(4)];
+    uint32_t prefetchId[2] = {0, 0};
+    uint8_t prefetchRadios = SX12XX_Radio_NONE;
+
+    bool commandQueueEnabled;
+    SX1280_QueuedTransfer_t cmdQueue[SX1280_CMD_QUEUE_LEN];
+    volatile uint8_t cmdQueueHead;
+    volatile uint8_t cmdQueueCount;
+#if defined(PLATFORM_ESP32)
+    portMUX_TYPE cmdQueueMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    void ICACHE_RAM_ATTR lockCommandQueue();
+    void ICACHE_RAM_ATTR unlockCommandQueue();
+    bool ICACHE_RAM_ATTR IsBusy(SX12XX_Radio_Number_t radioNumber);
+    void ICACHE_RAM_ATTR queueTransfer(uint8_t *data, uint8_t size, SX12XX_Radio_Number_t radioNumber);
+    void ICACHE_RAM_ATTR serviceCommandQueue();
+    void ICACHE_RAM_ATTR sendQueueHead();
 };
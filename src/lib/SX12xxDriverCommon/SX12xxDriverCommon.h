@@ -22,6 +22,7 @@ public:
         SX12XX_RX_CRC_FAIL       = 1 << 0,
         SX12XX_RX_TIMEOUT        = 1 << 1,
         SX12XX_RX_SYNCWORD_ERROR = 1 << 2,
+        SX12XX_RX_FEC_CORRECTED  = 1 << 3, // Not an error, FEC corrected some bits of the packet
     };
 
     SX12xxDriverCommon():
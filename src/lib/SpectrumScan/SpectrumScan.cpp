@@ -0,0 +1,116 @@
+#include "SpectrumScan.h"
+#include <string.h>
+
+void SpectrumScan::reset(uint8_t count)
+{
+    channelCount = (count < SPECTRUM_SCAN_MAX_CHANNELS) ? count : SPECTRUM_SCAN_MAX_CHANNELS;
+    memset(noise, 0, sizeof(noise));
+    memset(samples, 0, sizeof(samples));
+    memset(sampled, 0, sizeof(sampled));
+}
+
+void ICACHE_RAM_ATTR SpectrumScan::addSample(uint8_t channel, int8_t rssiDbm)
+{
+    if (channel >= channelCount)
+    {
+        return;
+    }
+
+    int16_t const value = rssiDbm * 16;
+    if (samples[channel] == 0)
+    {
+        noise[channel] = value;
+    }
+    else
+    {
+        // 1/8 of the way to the new sample
+        noise[channel] += (value - noise[channel]) / 8;
+    }
+    if (samples[channel] < 255)
+    {
+        ++samples[channel];
+    }
+    sampled[channel] = true;
+}
+
+bool SpectrumScan::isReady() const
+{
+    if (channelCount == 0)
+    {
+        return false;
+    }
+    for (uint8_t ch = 0; ch < channelCount; ++ch)
+    {
+        if (samples[ch] < SPECTRUM_SCAN_MIN_SAMPLES)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int16_t SpectrumScan::medianNoise() const
+{
+    int16_t sorted[SPECTRUM_SCAN_MAX_CHANNELS];
+    memcpy(sorted, noise, channelCount * sizeof(sorted[0]));
+    // Insertion sort, there are at most 80
+    for (uint8_t i = 1; i < channelCount; ++i)
+    {
+        int16_t const value = sorted[i];
+        uint8_t j = i;
+        while (j > 0 && sorted[j - 1] > value)
+        {
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = value;
+    }
+    return sorted[channelCount / 2];
+}
+
+uint8_t SpectrumScan::buildBlacklist(uint8_t *blacklist, uint8_t maxCount, uint8_t skipChannel)
+{
+    int16_t const median = medianNoise();
+
+    // Which channels are over the threshold, with the blacklisted ones getting the hysteresis
+    bool candidate[SPECTRUM_SCAN_MAX_CHANNELS];
+    for (uint8_t ch = 0; ch < channelCount; ++ch)
+    {
+        bool const listed = FHSSisBlacklisted(blacklist, ch);
+        if (!sampled[ch] && listed)
+        {
+            noise[ch] -= SPECTRUM_SCAN_DECAY_DB * 16;
+        }
+        sampled[ch] = false;
+
+        int16_t threshold = median + SPECTRUM_SCAN_MARGIN_DB * 16;
+        if (listed)
+        {
+            threshold -= SPECTRUM_SCAN_HYSTERESIS_DB * 16;
+        }
+        candidate[ch] = ch != skipChannel && samples[ch] != 0 && noise[ch] > threshold;
+    }
+
+    // The noisiest first
+    memset(blacklist, 0, FHSS_BLACKLIST_BYTES);
+    uint8_t count = 0;
+    while (count < maxCount)
+    {
+        int8_t worst = -1;
+        for (uint8_t ch = 0; ch < channelCount; ++ch)
+        {
+            if (candidate[ch] && (worst < 0 || noise[ch] > noise[worst]))
+            {
+                worst = ch;
+            }
+        }
+        if (worst < 0)
+        {
+            break;
+        }
+        candidate[worst] = false;
+        blacklist[worst / 8] |= 1 << (worst % 8);
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include "FHSS.h"
+
+#define SPECTRUM_SCAN_MAX_CHANNELS      (FHSS_BLACKLIST_BYTES * 8)
+#define SPECTRUM_SCAN_MIN_SAMPLES       4   // Samples of every channel before a blacklist is built
+#define SPECTRUM_SCAN_MARGIN_DB         10  // Noise above the median of all channels to blacklist a channel
+#define SPECTRUM_SCAN_HYSTERESIS_DB     3   // A blacklisted channel stays until it is this much below the margin
+#define SPECTRUM_SCAN_DECAY_DB          2   // Drop in the noise of a channel without new samples, each buildBlacklist()
+
+/**
+ * @brief A map of the noise on each FHSS channel, from instant RSSI samples taken while
+ * the link is quiet, and the blacklist of the worst channels built from it.
+ *
+ * A channel on the blacklist isn't hopped on, so it isn't sampled either. Its noise decays
+ * each time the blacklist is built until it comes off and gets sampled again, which
+ * puts it straight back on if the interference is still there.
+ */
+class SpectrumScan
+{
+public:
+    SpectrumScan() { reset(0); }
+
+    void reset(uint8_t channelCount);
+    void addSample(uint8_t channel, int8_t rssiDbm);
+
+    // Every channel has SPECTRUM_SCAN_MIN_SAMPLES
+    bool isReady() const;
+    // Average noise of the channel in dBm
+    int8_t getNoise(uint8_t channel) const { return noise[channel] / 16; }
+
+    /**
+     * @param blacklist in: the current blacklist, out: the new one
+     * @param maxCount the most channels to blacklist, the noisiest go first
+     * @param skipChannel a channel which must not be blacklisted, the sync channel
+     * @return the number of channels blacklisted
+     */
+    uint8_t buildBlacklist(uint8_t *blacklist, uint8_t maxCount, uint8_t skipChannel);
+
+private:
+    uint8_t channelCount;
+    int16_t noise[SPECTRUM_SCAN_MAX_CHANNELS];      // dBm * 16, moving average
+    uint8_t samples[SPECTRUM_SCAN_MAX_CHANNELS];    // saturates at 255
+    bool sampled[SPECTRUM_SCAN_MAX_CHANNELS];       // since the last buildBlacklist()
+
+    int16_t medianNoise() const;
+};
@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <cstring>
 #include "stubborn_receiver.h"
+#include "telemetry_protocol.h"
 
 StubbornReceiver::StubbornReceiver()
 {
@@ -24,6 +25,16 @@ void StubbornReceiver::ResetState()
     currentPackage = 1;
     currentOffset = 0;
     telemetryConfirm = false;
+    windowParity = false;
+    ResetWindow();
+}
+
+void StubbornReceiver::ResetWindow()
+{
+    windowBase = 1;
+    windowReceived = 0;
+    windowLast = 0;
+    windowLength = 0;
 }
 
 bool StubbornReceiver::GetCurrentConfirm()
@@ -31,6 +42,15 @@ bool StubbornReceiver::GetCurrentConfirm()
     return telemetryConfirm;
 }
 
+/**
+ * @brief: The ack for StubbornSender::ConfirmWindow(), see STUBBORN_ACK_BASE()
+ ***/
+uint8_t StubbornReceiver::GetWindowAck() const
+{
+    uint8_t const received = (windowReceived >> (windowBase + 1)) & 0x07;
+    return windowBase | (received << 4) | (windowParity << 7);
+}
+
 void StubbornReceiver::SetDataToReceive(uint8_t* dataToReceive, uint8_t maxLength)
 {
     length = maxLength;
@@ -38,10 +58,75 @@ void StubbornReceiver::SetDataToReceive(uint8_t* dataToReceive, uint8_t maxLengt
     currentPackage = 1;
     currentOffset = 0;
     finishedData = false;
+    ResetWindow();
+}
+
+/**
+ * @brief: A chunk of a windowed transfer, chunks are placed by their number so can
+ * arrive in any order. The transfer is finished once every chunk up to the one flagged
+ * as the last has arrived.
+ ***/
+void StubbornReceiver::ReceiveWindowData(uint8_t const packageIndex, uint8_t const * const receiveData, uint8_t dataLen)
+{
+    // Resync, the sender sets the parity for its next transfer
+    if (packageIndex == STUBBORN_WINDOWED_RESYNC)
+    {
+        windowParity = receiveData[0] & 1;
+        ResetWindow();
+        currentPackage = 1;
+        currentOffset = 0;
+        finishedData = false;
+        return;
+    }
+
+    if (finishedData)
+    {
+        return;
+    }
+
+    uint8_t const chunk = packageIndex & STUBBORN_WINDOWED_CHUNK;
+    uint8_t const offset = (chunk - 1) * dataLen;
+    // Chunks already received are sent again if the ack is lost
+    if (chunk == 0 || chunk < windowBase || (windowReceived & (1 << chunk)) || offset >= length)
+    {
+        return;
+    }
+
+    // A stop-and-wait transfer in progress is abandoned
+    currentPackage = 1;
+
+    uint8_t const len = std::min((uint8_t)(length - offset), dataLen);
+    memcpy(&data[offset], receiveData, len);
+    windowReceived |= 1 << chunk;
+    if (packageIndex & STUBBORN_WINDOWED_LAST)
+    {
+        windowLast = chunk;
+        windowLength = offset + len;
+    }
+
+    while (windowReceived & (1 << windowBase))
+    {
+        windowBase++;
+    }
+
+    if (windowLast && windowBase > windowLast)
+    {
+        currentOffset = windowLength;
+        finishedData = true;
+        windowParity = !windowParity;
+        ResetWindow();
+    }
 }
 
 void StubbornReceiver::ReceiveData(uint8_t const packageIndex, uint8_t const * const receiveData, uint8_t dataLen)
 {
+    // Windowed chunks only fit above the indexes of a short stop-and-wait transfer (MSP)
+    if (maxPackageIndex < STUBBORN_WINDOWED_INDEX && (packageIndex & STUBBORN_WINDOWED_INDEX))
+    {
+        ReceiveWindowData(packageIndex, receiveData, dataLen);
+        return;
+    }
+
     // Resync
     if (packageIndex == maxPackageIndex)
     {
@@ -82,6 +167,8 @@ void StubbornReceiver::ReceiveData(uint8_t const packageIndex, uint8_t const * c
 
     if (acceptData)
     {
+        // A windowed transfer in progress is abandoned
+        ResetWindow();
         uint8_t len = std::min((uint8_t)(length - currentOffset), dataLen);
         memcpy(&data[currentOffset], receiveData, len);
         currentPackage++;
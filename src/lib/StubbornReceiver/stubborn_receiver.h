@@ -11,8 +11,11 @@ public:
     void SetDataToReceive(uint8_t* dataToReceive, uint8_t maxLength);
     void ReceiveData(uint8_t const packageIndex, uint8_t const * const receiveData, uint8_t dataLen);
     bool HasFinishedData();
+    // Bytes received, including any padding in the last package. Only valid once HasFinishedData()
+    uint8_t GetReceivedLength() const { return currentOffset; }
     void Unlock();
     bool GetCurrentConfirm();
+    uint8_t GetWindowAck() const;
 private:
     uint8_t *data;
     bool finishedData;
@@ -21,4 +24,13 @@ private:
     uint8_t currentPackage;
     bool telemetryConfirm;
     uint8_t maxPackageIndex;
+    // Windowed transfers, bit n of windowReceived is chunk n
+    bool windowParity;
+    uint8_t windowBase;
+    uint8_t windowReceived;
+    uint8_t windowLast;
+    uint8_t windowLength;
+
+    void ResetWindow();
+    void ReceiveWindowData(uint8_t const packageIndex, uint8_t const * const receiveData, uint8_t dataLen);
 };
@@ -2,9 +2,10 @@
 #include <algorithm>
 #include <cstring>
 #include "stubborn_sender.h"
+#include "telemetry_protocol.h"
 
 StubbornSender::StubbornSender()
-    : data(nullptr), length(0)
+    : data(nullptr), length(0), nextData(nullptr), windowed(false), windowTransfer(false)
 {
     ResetState();
 }
@@ -28,6 +29,64 @@ void StubbornSender::ResetState()
     // 80 corresponds to UpdateTelemetryRate(ANY, 2, 1), which is what the TX uses in boost mode
     maxWaitCount = 80;
     senderState = SENDER_IDLE;
+    nextData = nullptr;
+    windowed = false;
+    windowTransfer = false;
+    windowParity = false;
+    windowSynced = false;
+    ResetWindow();
+}
+
+void StubbornSender::lock()
+{
+#if defined(PLATFORM_ESP32)
+    portENTER_CRITICAL(&mux);
+#elif defined(PLATFORM_ESP8266)
+    noInterrupts();
+#endif
+}
+
+void StubbornSender::unlock()
+{
+#if defined(PLATFORM_ESP32)
+    portEXIT_CRITICAL(&mux);
+#elif defined(PLATFORM_ESP8266)
+    interrupts();
+#endif
+}
+
+void StubbornSender::ResetWindow()
+{
+    windowChunkSize = 0;
+    windowChunks = 0;
+    windowBase = 1;
+    windowAcked = 0;
+    windowSent = 0;
+    windowEverSent = 0;
+}
+
+/***
+ * Switch to selective repeat for the next transfer: up to STUBBORN_WINDOW_SIZE chunks are
+ * in flight at once and ConfirmWindow() takes an ack of which have been received, so a
+ * transfer does not take a round trip per chunk. Both ends must support it, the receiver
+ * takes either. Only for transfers of up to STUBBORN_WINDOWED_MAX_CHUNKS chunks, all of
+ * the same size, longer ones go stop-and-wait. A transfer that is active is restarted in
+ * the new mode.
+ ***/
+void StubbornSender::SetWindowed(bool windowed)
+{
+    if (this->windowed == windowed)
+    {
+        return;
+    }
+
+    this->windowed = windowed;
+    windowTransfer = windowed;
+    windowSynced = false;
+    if (IsActive())
+    {
+        SetDataToTransmit(data, length);
+    }
 }
 
 /***
@@ -45,7 +104,67 @@ void StubbornSender::SetDataToTransmit(uint8_t* dataToTransmit, uint8_t lengthTo
     currentOffset = 0;
     currentPackage = 1;
     waitCount = 0;
-    senderState = (senderState == SENDER_IDLE) ? SEND_PENDING : RESYNC_THEN_SEND;
+    ResetWindow();
+    // Until GetCurrentPayload() gives the chunk size, see SizeTransfer()
+    windowTransfer = windowed;
+    // A windowed receiver part way through another transfer would take its chunks as acked
+    bool const needsResync = windowed && !windowSynced;
+    senderState = (senderState == SENDER_IDLE && !needsResync) ? SEND_PENDING : RESYNC_THEN_SEND;
+}
+
+/***
+ * Queues a message to go out as soon as the current one has been acked, so consecutive
+ * messages go back to back rather than each waiting for the main loop to see the sender
+ * go idle. Only one message can be queued, see HasQueuedData(). Neither buffer may be
+ * changed until the sender has moved on from it.
+ ***/
+void StubbornSender::QueueDataToTransmit(uint8_t* dataToTransmit, uint8_t lengthToTransmit)
+{
+    // Started or queued in one step, so an ack in the ISR can't see the sender go idle
+    // between the two and start the message as well, or leave it queued behind nothing
+    lock();
+    if (IsActive())
+    {
+        nextLength = lengthToTransmit;
+        nextData = dataToTransmit;
+    }
+    else
+    {
+        SetDataToTransmit(dataToTransmit, lengthToTransmit);
+    }
+    unlock();
+}
+
+void StubbornSender::StartQueuedData()
+{
+    lock();
+    // QueueDataToTransmit() may have started a message since the caller saw the sender idle
+    if (nextData && !IsActive())
+    {
+        SetDataToTransmit(nextData, nextLength);
+        nextData = nullptr;
+    }
+    unlock();
+}
+
+/***
+ * Split a windowed transfer into chunks of maxLen on its first GetCurrentPayload(). The
+ * chunk number only goes up to STUBBORN_WINDOWED_MAX_CHUNKS, so a longer transfer goes
+ * stop-and-wait instead. Windowed transfers leave the stop-and-wait confirm alone, so
+ * that starts with a stop-and-wait resync.
+ ***/
+void StubbornSender::SizeTransfer(uint8_t maxLen)
+{
+    windowChunkSize = maxLen;
+    windowChunks = std::max(1, (length + maxLen - 1) / maxLen);
+    if (windowChunks > STUBBORN_WINDOWED_MAX_CHUNKS)
+    {
+        ResetWindow();
+        windowTransfer = false;
+        // The receiver drops its window state for the stop-and-wait transfer
+        windowSynced = false;
+        senderState = RESYNC_THEN_SEND;
+    }
 }
 
 /**
@@ -57,17 +176,36 @@ uint8_t StubbornSender::GetCurrentPayload(uint8_t *outData, uint8_t maxLen)
     uint8_t packageIndex;
 
     bytesLastPayload = 0;
+    if (windowTransfer && windowChunkSize == 0 && IsActive())
+    {
+        SizeTransfer(maxLen);
+    }
+
     switch (senderState)
     {
     case RESYNC:
     case RESYNC_THEN_SEND:
-        packageIndex = maxPackageIndex;
+        if (windowTransfer)
+        {
+            // The parity the receiver is to take for the next transfer
+            packageIndex = STUBBORN_WINDOWED_RESYNC;
+            outData[0] = windowParity;
+        }
+        else
+        {
+            packageIndex = maxPackageIndex;
+        }
         break;
     case SEND_PENDING:
         // This package can now be acked
         senderState = SENDING;
         // fallthrough
     case SENDING:
+        if (windowTransfer)
+        {
+            packageIndex = GetWindowPayload(outData);
+        }
+        else
         {
             bytesLastPayload = std::min((uint8_t)(length - currentOffset), maxLen);
             // If this is the last data chunk, and there has been at least one other packet
@@ -87,8 +225,149 @@ uint8_t StubbornSender::GetCurrentPayload(uint8_t *outData, uint8_t maxLen)
     return packageIndex;
 }
 
+/***
+ * The next chunk of a windowed transfer: the first in the window not sent since it was
+ * last found missing. Once they have all been sent go round the unacked ones again.
+ ***/
+uint8_t StubbornSender::GetWindowPayload(uint8_t *outData)
+{
+    uint8_t const windowEnd = std::min(windowBase + STUBBORN_WINDOW_SIZE - 1, (int)windowChunks);
+    uint8_t chunk = 0;
+    for (uint8_t pass = 0; pass < 2 && chunk == 0; pass++)
+    {
+        for (uint8_t c = windowBase; c <= windowEnd; c++)
+        {
+            if (!((windowAcked | windowSent) & (1 << c)))
+            {
+                chunk = c;
+                break;
+            }
+        }
+        if (chunk == 0)
+        {
+            windowSent = 0;
+        }
+    }
+
+    uint8_t const offset = (chunk - 1) * windowChunkSize;
+    bytesLastPayload = (offset < length) ? std::min((uint8_t)(length - offset), windowChunkSize) : 0;
+    memcpy(outData, &data[offset], bytesLastPayload);
+    windowSent |= 1 << chunk;
+    windowEverSent |= 1 << chunk;
+
+    return STUBBORN_WINDOWED_INDEX | ((chunk == windowChunks) ? STUBBORN_WINDOWED_LAST : 0) | chunk;
+}
+
+void StubbornSender::WindowTimeout(bool parity, stubborn_sender_state_e &nextSenderState)
+{
+    waitCount++;
+    if (waitCount > maxWaitCount)
+    {
+        // A parity the receiver is not showing, so only an ack sent after the resync matches
+        windowParity = !parity;
+        windowSynced = false;
+        nextSenderState = RESYNC;
+    }
+}
+
+/***
+ * Take the ack of a windowed transfer from StubbornReceiver::GetWindowAck()
+ ***/
+void StubbornSender::ConfirmWindow(uint8_t ack)
+{
+    // A stop-and-wait transfer in windowed mode is acked by ConfirmCurrentPayload()
+    if (!windowed || (IsActive() && !windowTransfer))
+    {
+        return;
+    }
+
+    bool const parity = STUBBORN_ACK_PARITY(ack);
+    uint8_t const base = STUBBORN_ACK_BASE(ack);
+    stubborn_sender_state_e nextSenderState = senderState;
+
+    switch (senderState)
+    {
+    case SENDING:
+        if (parity != windowParity)
+        {
+            // The receiver flips the parity when it has the whole transfer, which it can
+            // only have once every chunk has been sent
+            uint8_t const allChunks = (1 << (windowChunks + 1)) - 2;
+            if (windowChunks && windowEverSent == allChunks)
+            {
+                windowParity = parity;
+                windowSynced = true;
+                nextSenderState = SENDER_IDLE;
+            }
+            else
+            {
+                WindowTimeout(parity, nextSenderState);
+            }
+            break;
+        }
+
+        if (base > windowBase && base <= windowChunks + 1)
+        {
+            windowAcked |= (1 << base) - 2;
+            windowBase = base;
+            waitCount = 0;
+        }
+        else
+        {
+            WindowTimeout(parity, nextSenderState);
+        }
+
+        {
+            uint8_t const received = STUBBORN_ACK_MASK(ack) << (base + 1);
+            windowAcked |= received;
+            // Chunks before the last one received were lost, send them again
+            for (uint8_t c = base; (1 << c) < received; c++)
+            {
+                if (!(windowAcked & (1 << c)))
+                    windowSent &= ~(1 << c);
+            }
+        }
+        break;
+
+    case RESYNC:
+    case RESYNC_THEN_SEND:
+        // The receiver has taken the parity sent in the resync
+        if (parity == windowParity && base == 1)
+        {
+            ResetWindow();
+            windowSynced = true;
+            nextSenderState = (senderState == RESYNC_THEN_SEND) ? SENDING : SENDER_IDLE;
+        }
+        break;
+
+    case SENDER_IDLE:
+        // An idle receiver, it may have been reset since the last transfer
+        windowSynced = (base == 1 && STUBBORN_ACK_MASK(ack) == 0);
+        if (windowSynced)
+        {
+            windowParity = parity;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    senderState = nextSenderState;
+    if (senderState == SENDER_IDLE)
+    {
+        StartQueuedData();
+    }
+}
+
 void StubbornSender::ConfirmCurrentPayload(bool telemetryConfirmValue)
 {
+    // Windowed transfers are acked by ConfirmWindow()
+    if (windowTransfer)
+    {
+        return;
+    }
+
     stubborn_sender_state_e nextSenderState = senderState;
 
     switch (senderState)
@@ -150,6 +429,10 @@ void StubbornSender::ConfirmCurrentPayload(bool telemetryConfirmValue)
     }
 
     senderState = nextSenderState;
+    if (senderState == SENDER_IDLE)
+    {
+        StartQueuedData();
+    }
 }
 
 /*
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include "targets.h"
 
 // The number of times to resend the same package index before going to RESYNC
 #define SSENDER_MAX_MISSED_PACKETS 20
@@ -22,8 +23,14 @@ public:
     void ResetState();
     void UpdateTelemetryRate(uint16_t airRate, uint8_t tlmRatio, uint8_t tlmBurst);
     void SetDataToTransmit(uint8_t* dataToTransmit, uint8_t lengthToTransmit);
+    void QueueDataToTransmit(uint8_t* dataToTransmit, uint8_t lengthToTransmit);
+    bool HasQueuedData() const { return nextData != nullptr; }
     uint8_t GetCurrentPayload(uint8_t *outData, uint8_t maxLen);
     void ConfirmCurrentPayload(bool telemetryConfirmValue);
+    void SetWindowed(bool windowed);
+    // The current transfer is windowed, see SetWindowed()
+    bool IsWindowed() const { return windowTransfer; }
+    void ConfirmWindow(uint8_t ack);
     bool IsActive() const { return senderState != SENDER_IDLE; }
     uint16_t GetMaxPacketsBeforeResync() const { return maxWaitCount; }
 private:
@@ -37,4 +44,29 @@ private:
     uint16_t maxWaitCount;
     uint8_t maxPackageIndex;
     stubborn_sender_state_e senderState;
+    // Sent as soon as the current message has been acked
+    uint8_t * volatile nextData;
+    uint8_t nextLength;
+#if defined(PLATFORM_ESP32)
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+    // Windowed mode, bit n of the masks is chunk n
+    bool windowed;
+    bool windowTransfer; // this transfer is windowed, only if it fits in STUBBORN_WINDOWED_MAX_CHUNKS
+    bool windowParity;
+    bool windowSynced; // the receiver is known to be idle with windowParity
+    uint8_t windowChunkSize;
+    uint8_t windowChunks;
+    uint8_t windowBase;
+    uint8_t windowAcked;
+    uint8_t windowSent;
+    uint8_t windowEverSent;
+
+    void lock();
+    void unlock();
+    void ResetWindow();
+    void SizeTransfer(uint8_t maxLen);
+    void StartQueuedData();
+    uint8_t GetWindowPayload(uint8_t *outData);
+    void WindowTimeout(bool parity, stubborn_sender_state_e &nextSenderState);
 };
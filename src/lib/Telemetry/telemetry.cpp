@@ -8,6 +8,25 @@
 extern TCPSOCKET wifi2tcp;
 #endif
 
+uint8_t TelemetryBatchFrameSize(uint8_t const *batch, uint8_t len, uint8_t offset)
+{
+    // Every frame starts with a non-zero address, a zero is the padding after the last frame
+    if (offset + CRSF_FRAME_NOT_COUNTED_BYTES > len || batch[offset] == 0)
+    {
+        return 0;
+    }
+
+    // The length covers at least the type and crc
+    uint8_t const frameLength = batch[offset + CRSF_TELEMETRY_LENGTH_INDEX];
+    uint8_t const frameSize = CRSF_FRAME_SIZE(frameLength);
+    if (frameLength < 2 || offset + frameSize > len)
+    {
+        return 0;
+    }
+
+    return frameSize;
+}
+
 #if defined(TARGET_RX) || defined(UNIT_TEST)
 #include "devMSPVTX.h"
 
@@ -78,45 +97,171 @@ void Telemetry::CheckCrsfBaroSensorDetected()
     }
 }
 
+typedef struct {
+    uint8_t type;
+    uint8_t priority;
+    uint16_t intervalMs;
+} telemetry_schedule_t;
+
+// Frame types not listed are sent as soon as possible at low priority
+static const telemetry_schedule_t telemetrySchedule[] = {
+    { CRSF_FRAMETYPE_GPS, TELEMETRY_PRIORITY_HIGH, 200 },
+    { CRSF_FRAMETYPE_BATTERY_SENSOR, TELEMETRY_PRIORITY_HIGH, 1000 },
+    { CRSF_FRAMETYPE_FLIGHT_MODE, TELEMETRY_PRIORITY_HIGH, 500 },
+    { CRSF_FRAMETYPE_ATTITUDE, TELEMETRY_PRIORITY_NORMAL, 100 },
+    { CRSF_FRAMETYPE_VARIO, TELEMETRY_PRIORITY_NORMAL, 200 },
+    { CRSF_FRAMETYPE_BARO_ALTITUDE, TELEMETRY_PRIORITY_NORMAL, 200 },
+    { CRSF_FRAMETYPE_DEVICE_INFO, TELEMETRY_PRIORITY_URGENT, 0 },
+    { CRSF_FRAMETYPE_PARAMETER_SETTINGS_ENTRY, TELEMETRY_PRIORITY_URGENT, 0 },
+};
+
+void TelemetrySchedule(uint8_t const *package, uint16_t &intervalMs, uint8_t &priority)
+{
+    uint8_t const type = package[CRSF_TELEMETRY_TYPE_INDEX];
+    intervalMs = 0;
+    priority = TELEMETRY_PRIORITY_LOW;
+
+    if (type == CRSF_FRAMETYPE_ARDUPILOT_RESP && package[CRSF_TELEMETRY_TYPE_INDEX + 1] == CRSF_AP_CUSTOM_TELEM_STATUS_TEXT)
+    {
+        priority = TELEMETRY_PRIORITY_URGENT;
+        return;
+    }
+
+    for (uint8_t i = 0; i < sizeof(telemetrySchedule) / sizeof(telemetrySchedule[0]); i++)
+    {
+        if (telemetrySchedule[i].type == type)
+        {
+            intervalMs = telemetrySchedule[i].intervalMs;
+            priority = telemetrySchedule[i].priority;
+            return;
+        }
+    }
+}
+
 PAYLOAD_DATA(GPS, BATTERY_SENSOR, ATTITUDE, DEVICE_INFO, FLIGHT_MODE, VARIO, BARO_ALTITUDE);
 
-bool Telemetry::GetNextPayload(uint8_t* nextPayloadSize, uint8_t **payloadData)
+/**
+ * @brief Pick the updated frame to send next. A frame is held back until its interval
+ * has passed since the last one of its type went, so a type can't use more than its
+ * share of the link. Of the frames which are due the highest priority goes first, then
+ * the one which has been due the longest, so a stream of low priority frames can't hold
+ * up GPS or battery. Ties go to the next slot round robin from the last sent.
+ * @param maxSize only consider frames of up to this many bytes
+ * @param skipMask bitmask of slots not to consider
+ * @return index of the slot, or -1 if there is nothing due to send
+ */
+int8_t Telemetry::NextScheduledPayload(uint32_t now, uint8_t maxSize, uint16_t skipMask)
+{
+    int8_t best = -1;
+    uint8_t index = currentPayloadIndex;
+    for (uint8_t checks = 0; checks < payloadTypesCount; checks++)
+    {
+        index = (index + 1) % payloadTypesCount;
+        volatile crsf_telemetry_package_t *payload = &payloadTypes[index];
+        if (!payload->updated || (skipMask & (1 << index)) ||
+            CRSF_FRAME_SIZE(payload->data[CRSF_TELEMETRY_LENGTH_INDEX]) > maxSize)
+        {
+            continue;
+        }
+
+        // Never more than one interval ahead, anything further has wrapped and is long overdue
+        uint32_t const wait = payload->nextDue - now;
+        if ((int32_t)wait > 0 && wait <= payload->intervalMs)
+            continue;
+
+        if (best != -1)
+        {
+            volatile crsf_telemetry_package_t *bestPayload = &payloadTypes[best];
+            if (payload->priority != bestPayload->priority)
+            {
+                if (payload->priority < bestPayload->priority)
+                    continue;
+            }
+            else if ((int32_t)(payload->nextDue - bestPayload->nextDue) >= 0)
+            {
+                continue;
+            }
+        }
+        best = index;
+    }
+
+    return best;
+}
+
+void Telemetry::PayloadSent(uint32_t now, uint8_t index)
 {
-    uint8_t checks = 0;
-    uint8_t oldPayloadIndex = currentPayloadIndex;
-    uint8_t realLength = 0;
+    payloadTypes[index].nextDue = now + payloadTypes[index].intervalMs;
+    // Continue round robin from the last frame sent
+    currentPayloadIndex = index;
+}
 
+bool Telemetry::GetNextPayload(uint32_t now, uint8_t* nextPayloadSize, uint8_t **payloadData)
+{
     if (payloadTypes[currentPayloadIndex].locked)
     {
         payloadTypes[currentPayloadIndex].locked = false;
         payloadTypes[currentPayloadIndex].updated = false;
     }
 
-    do
-    {
-        currentPayloadIndex = (currentPayloadIndex + 1) % payloadTypesCount;
-        checks++;
-    } while(!payloadTypes[currentPayloadIndex].updated && checks < payloadTypesCount);
-
-    if (payloadTypes[currentPayloadIndex].updated)
+    int8_t const index = NextScheduledPayload(now, CRSF_MAX_PACKET_LEN, 0);
+    if (index != -1)
     {
-        payloadTypes[currentPayloadIndex].locked = true;
-
-        realLength = CRSF_FRAME_SIZE(payloadTypes[currentPayloadIndex].data[CRSF_TELEMETRY_LENGTH_INDEX]);
+        uint8_t const realLength = CRSF_FRAME_SIZE(payloadTypes[index].data[CRSF_TELEMETRY_LENGTH_INDEX]);
         if (realLength > 0)
         {
+            payloadTypes[index].locked = true;
+            PayloadSent(now, index);
             *nextPayloadSize = realLength;
-            *payloadData = payloadTypes[currentPayloadIndex].data;
+            *payloadData = payloadTypes[index].data;
             return true;
         }
     }
 
-    currentPayloadIndex = oldPayloadIndex;
     *nextPayloadSize = 0;
     *payloadData = 0;
     return false;
 }
 
+/**
+ * @brief Like GetNextPayload(), but packs as many of the updated frames as fit in
+ * maxSize bytes into one payload, in schedule order, so small frames don't each need
+ * a whole transfer. The frames are copied so are released immediately rather than on
+ * the next call.
+ */
+bool Telemetry::GetNextPayloadBatch(uint32_t now, uint8_t maxSize, uint8_t* nextPayloadSize, uint8_t **payloadData)
+{
+    // Release a frame still locked by GetNextPayload()
+    if (payloadTypes[currentPayloadIndex].locked)
+    {
+        payloadTypes[currentPayloadIndex].locked = false;
+        payloadTypes[currentPayloadIndex].updated = false;
+    }
+
+    if (maxSize > sizeof(batchBuffer))
+    {
+        maxSize = sizeof(batchBuffer);
+    }
+
+    uint8_t batchSize = 0;
+    uint16_t batched = 0;
+    int8_t index;
+    // Frames which don't fit are skipped, a smaller one might
+    while ((index = NextScheduledPayload(now, maxSize - batchSize, batched)) != -1)
+    {
+        volatile crsf_telemetry_package_t *payload = &payloadTypes[index];
+        uint8_t const frameSize = CRSF_FRAME_SIZE(payload->data[CRSF_TELEMETRY_LENGTH_INDEX]);
+        memcpy(&batchBuffer[batchSize], payload->data, frameSize);
+        batchSize += frameSize;
+        payload->updated = false;
+        batched |= 1 << index;
+        PayloadSent(now, index);
+    }
+
+    *nextPayloadSize = batchSize;
+    *payloadData = batchSize ? batchBuffer : 0;
+    return batchSize != 0;
+}
+
 uint8_t Telemetry::UpdatedPayloadCount()
 {
     uint8_t count = 0;
@@ -150,6 +295,7 @@ void Telemetry::ResetState()
     {
         payloadTypes[i].locked = false;
         payloadTypes[i].updated = false;
+        payloadTypes[i].nextDue = 0;
         payloadTypes[i].data = PayloadData + offset;
         offset += payloadTypes[i].size;
 
@@ -372,6 +518,12 @@ bool Telemetry::AppendTelemetryPackage(uint8_t *package)
     if (targetFound && !payloadTypes[targetIndex].locked)
     {
         memcpy(payloadTypes[targetIndex].data, package, CRSF_FRAME_SIZE(package[CRSF_TELEMETRY_LENGTH_INDEX]));
+        // The general slots hold any type, so the schedule goes with the frame
+        uint16_t intervalMs;
+        uint8_t priority;
+        TelemetrySchedule(package, intervalMs, priority);
+        payloadTypes[targetIndex].intervalMs = intervalMs;
+        payloadTypes[targetIndex].priority = priority;
         payloadTypes[targetIndex].updated = true;
     }
 
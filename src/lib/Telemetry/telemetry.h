@@ -16,12 +16,23 @@ typedef enum {
     RECEIVING_DATA
 } telemetry_state_s;
 
+typedef enum : uint8_t {
+    TELEMETRY_PRIORITY_LOW = 0, // bulk streams, MSP and passthrough
+    TELEMETRY_PRIORITY_NORMAL,
+    TELEMETRY_PRIORITY_HIGH,
+    TELEMETRY_PRIORITY_URGENT   // status text, replies to the handset
+} telemetry_priority_e;
+
 typedef struct crsf_telemetry_package_t {
     const uint8_t type;
     const uint8_t size;
     volatile bool locked;
     volatile bool updated;
     uint8_t *data;
+    // Schedule of the frame in the slot, see TelemetrySchedule()
+    uint8_t priority;
+    uint16_t intervalMs;
+    uint32_t nextDue;
 } crsf_telemetry_package_t;
 
 #define PAYLOAD_DATA(type0, type1, type2, type3, type4, type5, type6)\
@@ -36,17 +47,36 @@ typedef struct crsf_telemetry_package_t {
         CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_GENERAL_RESP_PAYLOAD_SIZE) + \
         CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_GENERAL_RESP_PAYLOAD_SIZE)]; \
     crsf_telemetry_package_t payloadTypes[] = {\
-    {CRSF_FRAMETYPE_##type0, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type0##_PAYLOAD_SIZE), false, false, 0},\
-    {CRSF_FRAMETYPE_##type1, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type1##_PAYLOAD_SIZE), false, false, 0},\
-    {CRSF_FRAMETYPE_##type2, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type2##_PAYLOAD_SIZE), false, false, 0},\
-    {CRSF_FRAMETYPE_##type3, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type3##_PAYLOAD_SIZE), false, false, 0},\
-    {CRSF_FRAMETYPE_##type4, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type4##_PAYLOAD_SIZE), false, false, 0},\
-    {CRSF_FRAMETYPE_##type5, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type5##_PAYLOAD_SIZE), false, false, 0},\
-    {CRSF_FRAMETYPE_##type6, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type6##_PAYLOAD_SIZE), false, false, 0},\
-    {0, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_GENERAL_RESP_PAYLOAD_SIZE), false, false, 0},\
-    {0, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_GENERAL_RESP_PAYLOAD_SIZE), false, false, 0}};\
+    {CRSF_FRAMETYPE_##type0, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type0##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {CRSF_FRAMETYPE_##type1, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type1##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {CRSF_FRAMETYPE_##type2, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type2##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {CRSF_FRAMETYPE_##type3, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type3##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {CRSF_FRAMETYPE_##type4, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type4##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {CRSF_FRAMETYPE_##type5, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type5##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {CRSF_FRAMETYPE_##type6, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_##type6##_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {0, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_GENERAL_RESP_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0},\
+    {0, CRSF_TELEMETRY_TOTAL_SIZE(CRSF_FRAME_GENERAL_RESP_PAYLOAD_SIZE), false, false, 0, TELEMETRY_PRIORITY_LOW, 0, 0}};\
     const uint8_t payloadTypesCount = (sizeof(payloadTypes)/sizeof(crsf_telemetry_package_t))
 
+// The TX asks for batches with MSP_ELRS_TELEMETRY_BATCH and this version. The RX sends
+// one frame per transfer until then, all an older TX can split up
+#define TELEMETRY_BATCH_VERSION 1
+
+/**
+ * @brief Get the size of the CRSF frame at `offset` in a batch of frames from
+ * Telemetry::GetNextPayloadBatch(), for splitting the batch up again
+ * @param len number of bytes in the batch, may include zero padding after the last frame
+ * @return size of the frame, or 0 if there are no more frames
+ */
+uint8_t TelemetryBatchFrameSize(uint8_t const *batch, uint8_t len, uint8_t offset);
+
+/**
+ * @brief Get the target rate and priority of a CRSF telemetry frame
+ * @param intervalMs set to the minimum time between two frames of this type, 0 to send as soon as possible
+ * @param priority set to the telemetry_priority_e used to pick between frames which are due
+ */
+void TelemetrySchedule(uint8_t const *package, uint16_t &intervalMs, uint8_t &priority);
+
 class Telemetry
 {
 public:
@@ -64,14 +94,18 @@ public:
     void SetCrsfBaroSensorDetected();
     bool GetCrsfBaroSensorDetected() { return crsfBaroSensorDetected; };
     uint8_t GetUpdatedModelMatch() { return modelMatchId; }
-    bool GetNextPayload(uint8_t* nextPayloadSize, uint8_t **payloadData);
+    bool GetNextPayload(uint32_t now, uint8_t* nextPayloadSize, uint8_t **payloadData);
+    bool GetNextPayloadBatch(uint32_t now, uint8_t maxSize, uint8_t* nextPayloadSize, uint8_t **payloadData);
     uint8_t UpdatedPayloadCount();
     uint8_t ReceivedPackagesCount();
     bool AppendTelemetryPackage(uint8_t *package);
 private:
     bool processInternalTelemetryPackage(uint8_t *package);
     void AppendToPackage(volatile crsf_telemetry_package_t *current);
+    int8_t NextScheduledPayload(uint32_t now, uint8_t maxSize, uint16_t skipMask);
+    void PayloadSent(uint32_t now, uint8_t index);
     uint8_t CRSFinBuffer[CRSF_MAX_PACKET_LEN];
+    uint8_t batchBuffer[CRSF_MAX_PACKET_LEN];
     telemetry_state_s telemetry_state;
     uint8_t currentTelemetryByte;
     uint8_t currentPayloadIndex;
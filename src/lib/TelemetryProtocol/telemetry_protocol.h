@@ -12,4 +12,19 @@
 #define ELRS_MSP_BUFFER 65
 #define ELRS_MSP_MAX_PACKAGES ((ELRS_MSP_BUFFER/ELRS4_MSP_BYTES_PER_CALL)+1)
 
+// Windowed (selective repeat) transfers, see StubbornSender::SetWindowed(). The packageIndex
+// of a windowed chunk is STUBBORN_WINDOWED_INDEX | [STUBBORN_WINDOWED_LAST] | chunk (1-7),
+// above anything the MSP stop-and-wait transfers use
+#define STUBBORN_WINDOWED_INDEX     0x10
+#define STUBBORN_WINDOWED_LAST      0x08
+#define STUBBORN_WINDOWED_CHUNK     0x07
+#define STUBBORN_WINDOWED_MAX_CHUNKS 7
+#define STUBBORN_WINDOWED_RESYNC    (STUBBORN_WINDOWED_INDEX | STUBBORN_WINDOWED_LAST) // chunk 0 is never sent
+// Chunks in flight, the ack carries the first missing chunk and a bit for each of the rest
+#define STUBBORN_WINDOW_SIZE        4
+// The ack byte: 0-3 first missing chunk, 4-6 the chunks after it received, 7 message parity
+#define STUBBORN_ACK_BASE(ack)      ((ack) & 0x0F)
+#define STUBBORN_ACK_MASK(ack)      (((ack) >> 4) & 0x07)
+#define STUBBORN_ACK_PARITY(ack)    ((ack) >> 7)
+
 #define AP_MAX_BUF_LEN  64
@@ -39,6 +39,8 @@
 #include "options.h"
 #include "helpers.h"
 #include "devButton.h"
+#include "CycleStats.h"
+#include "ChannelStats.h"
 #if defined(TARGET_RX) && defined(PLATFORM_ESP32)
 #include "devVTXSPI.h"
 #endif
@@ -852,6 +854,67 @@ static size_t getFirmwareChunk(uint8_t *data, size_t len, size_t pos)
   return len;
 }
 
+#if defined(DEBUG_CYCLE_STATS)
+// The radio is stopped while WiFi is running, these are the stats from before it started
+static void WebUpdateGetCycleStats(AsyncWebServerRequest *request)
+{
+  JsonDocument json;
+  json["cycles_per_us"] = CycleStats_CyclesPerUs();
+  for (uint8_t i = 0; i < CYCLE_STATS_SECTION_COUNT; i++)
+  {
+    cycle_stats_t stats;
+    CycleStats_Get((cycleStatsSection_e)i, &stats);
+    if (stats.count == 0)
+      continue;
+
+    JsonObject section = json["sections"][CycleStats_SectionName((cycleStatsSection_e)i)].to<JsonObject>();
+    section["count"] = stats.count;
+    section["min"] = stats.min;
+    section["max"] = stats.max;
+    section["mean"] = (uint32_t)(stats.total / stats.count);
+    JsonArray histogram = section["histogram"].to<JsonArray>();
+    for (uint8_t b = 0; b < CYCLE_STATS_BUCKETS; b++)
+      histogram.add(stats.histogram[b]);
+  }
+  if (request->hasArg("reset"))
+    CycleStats_Reset();
+
+  AsyncResponseStream *response = request->beginResponseStream("application/json");
+  serializeJson(json, *response);
+  request->send(response);
+}
+#endif
+
+static void WebUpdateGetChannelStats(AsyncWebServerRequest *request)
+{
+  JsonDocument json;
+  json["reg_domain"] = FHSSgetRegulatoryDomain();
+  json["history"] = CHANNEL_STATS_HISTORY;
+  JsonArray channels = json["channels"].to<JsonArray>();
+  for (uint8_t ch = 0; ch < ChannelStats_ChannelCount(); ch++)
+  {
+    channel_stats_t stats;
+    ChannelStats_Get(ch, &stats);
+
+    JsonObject channel = channels.add<JsonObject>();
+    channel["count"] = stats.count;
+    channel["received"] = stats.received;
+    channel["crc_errors"] = stats.crcErrors;
+    if (stats.received)
+    {
+      channel["rssi"] = stats.rssi;
+      channel["snr"] = (float)stats.snr / RADIO_SNR_SCALE;
+    }
+    channel["blacklisted"] = FHSSusePrimaryFreqBand && FHSSisBlacklisted(FHSSblacklist, ch);
+  }
+  if (request->hasArg("reset"))
+    ChannelStats_Reset(ChannelStats_ChannelCount());
+
+  AsyncResponseStream *response = request->beginResponseStream("application/json");
+  serializeJson(json, *response);
+  request->send(response);
+}
+
 static void WebUpdateGetFirmware(AsyncWebServerRequest *request) {
   #if defined(PLATFORM_ESP32)
   const esp_partition_t *running = esp_ota_get_running_partition();
@@ -1072,6 +1135,10 @@ static void startServices()
   server.on("/access", WebUpdateAccessPoint);
   server.on("/target", WebUpdateGetTarget);
   server.on("/firmware.bin", WebUpdateGetFirmware);
+  #if defined(DEBUG_CYCLE_STATS)
+    server.on("/cyclestats", HTTP_GET, WebUpdateGetCycleStats);
+  #endif
+  server.on("/channelstats", HTTP_GET, WebUpdateGetChannelStats);
 
   server.on("/update", HTTP_POST, WebUploadResponseHandler, WebUploadDataHandler);
   server.on("/update", HTTP_OPTIONS, corsPreflightResponse);
@@ -5,8 +5,8 @@
 #include "common.h"
 
 // Variables / constants for Airport //
-FIFO<AP_MAX_BUF_LEN> apInputBuffer;
-FIFO<AP_MAX_BUF_LEN> apOutputBuffer;
+SpscFIFO<AP_MAX_BUF_LEN> apInputBuffer;
+SpscFIFO<AP_MAX_BUF_LEN> apOutputBuffer;
 
 
 uint32_t SerialAirPort::sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t *channelData)
@@ -23,20 +23,19 @@ void SerialAirPort::processBytes(uint8_t *bytes, u_int16_t size)
 {
     if (connectionState == connected)
     {
-        apInputBuffer.atomicPushBytes(bytes, size);
+        apInputBuffer.pushBytes(bytes, size);
     }
 }
 
 void SerialAirPort::sendQueuedData(uint32_t maxBytesToSend)
 {
-    auto size = apOutputBuffer.size();
-    if (size != 0)
+    const uint8_t *span;
+    uint16_t size;
+    // At most two spans, either side of the wrap
+    while ((size = apOutputBuffer.peekSpan(&span)) != 0)
     {
-        uint8_t buf[size];
-        apOutputBuffer.lock();
-        apOutputBuffer.popBytes(buf, size);
-        apOutputBuffer.unlock();
-        _outputPort->write(buf, size);
+        _outputPort->write(span, size);
+        apOutputBuffer.consume(size);
     }
 }
 #endif
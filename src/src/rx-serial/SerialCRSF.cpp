@@ -60,7 +60,8 @@ uint32_t SerialCRSF::sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t
     if (!frameAvailable)
         return DURATION_IMMEDIATELY;
 
-    crsf_channels_s PackedRCdataOut;
+    // Packed straight into the frame, which is only byte aligned like the struct
+    crsf_channels_s &PackedRCdataOut = *(crsf_channels_s *)&rcFrame[3];
     PackedRCdataOut.ch0 = channelData[0];
     PackedRCdataOut.ch1 = channelData[1];
     PackedRCdataOut.ch2 = channelData[2];
@@ -77,7 +78,7 @@ uint32_t SerialCRSF::sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t
     PackedRCdataOut.ch13 = channelData[13];
 
     // In 16ch mode, do not output RSSI/LQ on channels
-    if (OtaIsFullRes && OtaSwitchModeCurrent == smHybridOr16ch)
+    if (OtaIsFullRes && (OtaSwitchModeCurrent == smHybridOr16ch || OtaSwitchModeCurrent == sm16chDelta))
     {
         PackedRCdataOut.ch14 = channelData[14];
         PackedRCdataOut.ch15 = channelData[15];
@@ -92,19 +93,11 @@ uint32_t SerialCRSF::sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t
                                                    ExpressLRS_currAirRate_RFperfParams->RXsensitivity, -50, 0, 1023));
     }
 
-    constexpr uint8_t outBuffer[] = {
-        // No need for length prefix as we aren't using the FIFO
-        CRSF_ADDRESS_FLIGHT_CONTROLLER,
-        CRSF_FRAME_SIZE(sizeof(PackedRCdataOut)),
-        CRSF_FRAMETYPE_RC_CHANNELS_PACKED
-    };
-
-    uint8_t crc = crsf_crc.calc(outBuffer[2]);
-    crc = crsf_crc.calc((byte *)&PackedRCdataOut, sizeof(PackedRCdataOut), crc);
-
-    _outputPort->write(outBuffer, sizeof(outBuffer));
-    _outputPort->write((byte *)&PackedRCdataOut, sizeof(PackedRCdataOut));
-    _outputPort->write(crc);
+    // CRC covers the type and payload. This is one table lookup per byte whichever way
+    // it is split up, and the sticks are at the front, so there is nothing to gain from
+    // updating it incrementally from the last frame
+    rcFrame[sizeof(rcFrame) - 1] = crsf_crc.calc(&rcFrame[2], sizeof(rcFrame) - 3);
+    _outputPort->write(rcFrame, sizeof(rcFrame));
     return DURATION_IMMEDIATELY;
 }
 
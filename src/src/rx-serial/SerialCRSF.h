@@ -1,8 +1,10 @@
 #include "SerialIO.h"
+#include "crsf_protocol.h"
 
 class SerialCRSF : public SerialIO {
 public:
-    explicit SerialCRSF(Stream &out, Stream &in) : SerialIO(&out, &in) {}
+    explicit SerialCRSF(Stream &out, Stream &in) : SerialIO(&out, &in),
+        rcFrame{CRSF_ADDRESS_FLIGHT_CONTROLLER, CRSF_FRAME_SIZE(sizeof(crsf_channels_t)), CRSF_FRAMETYPE_RC_CHANNELS_PACKED} {}
     virtual ~SerialCRSF() {}
 
     uint32_t sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t *channelData) override;
@@ -14,4 +16,8 @@ public:
 
 private:
     void processBytes(uint8_t *bytes, uint16_t size) override;
+
+    // RC frame with the header filled in, sendRCFrame() only packs the channels and CRC
+    // No need for length prefix as we aren't using the FIFO
+    uint8_t rcFrame[CRSF_FRAME_SIZE(sizeof(crsf_channels_t)) + CRSF_FRAME_NOT_COUNTED_BYTES];
 };
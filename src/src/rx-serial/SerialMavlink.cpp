@@ -11,6 +11,7 @@
 // Variables / constants for Mavlink //
 FIFO<MAV_INPUT_BUF_LEN> mavlinkInputBuffer;
 FIFO<MAV_OUTPUT_BUF_LEN> mavlinkOutputBuffer;
+MAVLinkTunnel mavlinkTunnel;
 
 #define MAVLINK_COMM_NUM_BUFFERS 1
 #include "common/mavlink.h"
@@ -90,8 +91,9 @@ void SerialMavlink::sendQueuedData(uint32_t maxBytesToSend)
     {
         lastSentFlowCtrl = now; 
 
-        // Software-based flow control for mavlink
-        uint8_t percentage_remaining = ((MAV_INPUT_BUF_LEN - mavlinkInputBuffer.size()) * 100) / MAV_INPUT_BUF_LEN;
+        // Software-based flow control for mavlink, over both the input buffer and the frames queued to send
+        constexpr uint32_t bufferLen = MAV_INPUT_BUF_LEN + MAVLINK_TUNNEL_QUEUE_LEN;
+        uint8_t percentage_remaining = ((bufferLen - mavlinkInputBuffer.size() - mavlinkTunnel.size()) * 100) / bufferLen;
 
         // Populate radio status packet
         const mavlink_radio_status_t radio_status {
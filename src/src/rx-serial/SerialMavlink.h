@@ -1,6 +1,7 @@
 #include "SerialIO.h"
 #include "FIFO.h"
 #include "telemetry_protocol.h"
+#include "MAVLinkTunnel.h"
 
 #define MAV_INPUT_BUF_LEN       1024
 #define MAV_OUTPUT_BUF_LEN      512
@@ -9,6 +10,8 @@
 // Variables / constants
 extern FIFO<MAV_INPUT_BUF_LEN> mavlinkInputBuffer;
 extern FIFO<MAV_OUTPUT_BUF_LEN> mavlinkOutputBuffer;
+// Whole frames from mavlinkInputBuffer, for the TelemetrySender
+extern MAVLinkTunnel mavlinkTunnel;
 
 class SerialMavlink : public SerialIO {
 public:
@@ -27,7 +27,7 @@ uint32_t SerialSBUS::sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t
     }
 
     // TODO: if failsafeMode == FAILSAFE_SET_POSITION then we use the set positions rather than the last values
-    crsf_channels_s PackedRCdataOut;
+    crsf_channels_s &PackedRCdataOut = *(crsf_channels_s *)&sbusFrame[1];
 
 #if defined(PLATFORM_ESP32)
     extern Stream* serial_protocol_tx;
@@ -79,11 +79,9 @@ uint32_t SerialSBUS::sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t
     uint8_t extraData = 0;
     extraData |= effectivelyFailsafed ? SBUS_FLAG_FAILSAFE_ACTIVE : 0;
     extraData |= frameMissed ? SBUS_FLAG_SIGNAL_LOSS : 0;
+    sbusFrame[SBUS_FRAME_LEN - 2] = extraData;    // ch 17, 18, lost packet, failsafe
 
-    _outputPort->write(0x0F);    // HEADER
-    _outputPort->write((byte *)&PackedRCdataOut, sizeof(PackedRCdataOut));
-    _outputPort->write((uint8_t)extraData);    // ch 17, 18, lost packet, failsafe
-    _outputPort->write((uint8_t)0x00);    // FOOTER
+    _outputPort->write(sbusFrame, sizeof(sbusFrame));
     return SBUS_CALLBACK_INTERVAL_MS;
 }
 
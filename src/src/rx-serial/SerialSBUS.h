@@ -1,10 +1,14 @@
 #include "SerialIO.h"
 
+#define SBUS_FRAME_LEN 25 // header, 16x 11 bit channels, flags, footer
+
 class SerialSBUS : public SerialIO {
 public:
     explicit SerialSBUS(Stream &out, Stream &in) : SerialIO(&out, &in)
     {
         streamOut = &out;
+        sbusFrame[0] = 0x0F;                    // HEADER
+        sbusFrame[SBUS_FRAME_LEN - 1] = 0x00;   // FOOTER
     }
 
     ~SerialSBUS() override = default;
@@ -17,4 +21,5 @@ private:
     void processBytes(uint8_t *bytes, uint16_t size) override {};
 
     Stream *streamOut;
+    uint8_t sbusFrame[SBUS_FRAME_LEN];
 };
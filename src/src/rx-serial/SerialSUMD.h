@@ -1,9 +1,15 @@
 #include "SerialIO.h"
 #include "crc.h"
 
+#define SUMD_HEADER_SIZE		3														// 3 Bytes header
+#define SUMD_DATA_SIZE_16CH		(16*2)													// 2 Bytes per channel
+#define SUMD_CRC_SIZE			2														// 16 bit CRC
+#define SUMD_FRAME_16CH_LEN		(SUMD_HEADER_SIZE+SUMD_DATA_SIZE_16CH+SUMD_CRC_SIZE)
+#define SUMD_CRC_POLY			0x1021														// CRC16-CCITT
+
 class SerialSUMD : public SerialIO {
 public:
-    explicit SerialSUMD(Stream &out, Stream &in) : SerialIO(&out, &in) { crc2Byte.init(16, 0x1021); }
+    explicit SerialSUMD(Stream &out, Stream &in);
     virtual ~SerialSUMD() {}
 
     void queueLinkStatisticsPacket() override {}
@@ -11,6 +17,6 @@ public:
     uint32_t sendRCFrame(bool frameAvailable, bool frameMissed, uint32_t *channelData) override;
 
 private:
-    Crc2Byte crc2Byte;
+    uint8_t sumdFrame[SUMD_FRAME_16CH_LEN];
     void processBytes(uint8_t *bytes, uint16_t size) override {};
 };
@@ -11,10 +11,14 @@
 #include "msp.h"
 #include "msptypes.h"
 #include "PFD.h"
+#include "PhaseLock.h"
 #include "options.h"
 #include "dynpower.h"
 #include "MeanAccumulator.h"
 #include "freqTable.h"
+#include "SpscQueue.h"
+#include "CycleStats.h"
+#include "ChannelStats.h"
 
 #include "rx-serial/SerialIO.h"
 #include "rx-serial/SerialNOOP.h"
@@ -24,6 +28,7 @@
 #include "rx-serial/SerialAirPort.h"
 #include "rx-serial/SerialHoTT_TLM.h"
 #include "rx-serial/SerialMavlink.h"
+#include "MAVLinkCompress.h"
 #include "rx-serial/SerialTramp.h"
 #include "rx-serial/SerialSmartAudio.h"
 #include "rx-serial/SerialDisplayport.h"
@@ -101,7 +106,7 @@ uint8_t antenna = 0;    // which antenna is currently in use
 uint8_t geminiMode = 0;
 
 PFD PFDloop;
-Crc2Byte ota_crc;
+PhaseLock phaseLock;
 ELRS_EEPROM eeprom;
 RxConfig config;
 Telemetry telemetry;
@@ -142,8 +147,23 @@ static uint8_t telemetryBurstMax;
 
 StubbornReceiver MspReceiver;
 uint8_t MspData[ELRS_MSP_BUFFER];
-
-uint8_t mavlinkSSBuffer[CRSF_MAX_PACKET_LEN]; // Buffer for current stubbon sender packet (mavlink only)
+static bool MspWindowOffered; // TX takes windowed MSP acks in the LINKSTATS payload
+
+// Buffers for the current and queued stubborn sender packets (mavlink only)
+uint8_t mavlinkSSBuffer[2][CRSF_MAX_PACKET_LEN];
+static uint8_t mavlinkSSBufferIdx;
+// Compress the downlink once the TX has said it can decompress it
+static MAVLinkCompressor mavlinkCompressor;
+static bool mavlinkCompress;
+// Sent in the link stats, a new one each time the connection is lost and the TX's requests forgotten.
+// Picked on the next tentative connection, so the LINKSTATS sent before connecting have it
+static uint8_t rxSession;
+static bool rxSessionExpired = true;
+// The TX can split several CRSF frames out of one telemetry transfer
+static bool telemetryBatch;
+// The confirmation of an FHSS blacklist from the TX: MSP_ELRS_FHSS_BLACKLIST, length, version, generation
+static uint8_t fhssBlacklistReply[4];
+static bool fhssBlacklistReplyPending;
 
 static bool tlmSent = false;
 static uint8_t NextTelemetryType = PACKET_TYPE_LINKSTATS;
@@ -162,6 +182,14 @@ MeanAccumulator<int32_t, int8_t, -16> SnrMean;
 
 static uint8_t scanIndex;
 uint8_t ExpressLRS_nextAirRateIndex;
+// Adaptive rate switch announced by the TX, applied when OtaNonce reaches rateSwitchNonce
+static volatile bool rateSwitchPending;
+static volatile uint8_t rateSwitchIndex;
+static volatile uint8_t rateSwitchNonce;
+// The switch nonce has been reached, loop() changes rate without dropping the connection
+static volatile bool rateSwitchNow;
+// Changed rate, the timer is stopped and the RX stays on the sync channel until a SYNC arrives
+static volatile bool rateSwitchResync;
 int8_t SwitchModePending;
 
 int32_t PfdPrevRawOffset;
@@ -189,6 +217,8 @@ int16_t RFnoiseFloor; //measurement of the current RF noise floor
 #if defined(DEBUG_RX_SCOREBOARD)
 static bool lastPacketCrcError;
 #endif
+// PACKET_TYPE_DATA packets, unpacked in loop() rather than in the RX ISR
+static SpscQueue<OTA_Packet_s, 8> RxDataPackets;
 ///////////////////////////////////////////////////////////////
 
 /// Variables for Sync Behaviour ////
@@ -327,8 +357,14 @@ void SetRFLinkRate(uint8_t index, bool bindMode) // Set speed of RF link
 
     hwTimer::updateInterval(interval);
 
-    FHSSusePrimaryFreqBand = !(ModParams->radio_type == RADIO_TYPE_LR1121_LORA_2G4) && !(ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4);
-    FHSSuseDualBand = ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL;
+    bool const primaryFreqBand = FHSSusePrimaryFreqBand;
+    FHSSsetBandMode(!(ModParams->radio_type == RADIO_TYPE_LR1121_LORA_2G4) && !(ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4),
+                    ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL);
+    // The channel numbers are of the other band now
+    if (FHSSusePrimaryFreqBand != primaryFreqBand)
+    {
+        ChannelStats_Reset(FHSSgetChannelCount());
+    }
 
     Radio.Config(ModParams->bw, ModParams->sf, ModParams->cr, FHSSgetInitialFreq(),
                  ModParams->PreambleLen, invertIQ, ModParams->PayloadLength, 0
@@ -375,7 +411,7 @@ bool ICACHE_RAM_ATTR HandleFHSS()
 {
     uint8_t modresultFHSS = (OtaNonce + 1) % ExpressLRS_currAirRate_Modparams->FHSShopInterval;
 
-    if ((ExpressLRS_currAirRate_Modparams->FHSShopInterval == 0) || alreadyFHSS == true || InBindingMode || (modresultFHSS != 0) || (connectionState == disconnected))
+    if ((ExpressLRS_currAirRate_Modparams->FHSShopInterval == 0) || alreadyFHSS == true || InBindingMode || (modresultFHSS != 0) || (connectionState == disconnected) || rateSwitchResync)
     {
         return false;
     }
@@ -427,6 +463,7 @@ void ICACHE_RAM_ATTR LinkStatsToOta(OTA_LinkStats_s * const ls)
     ls->modelMatch = connectionHasModelMatch;
     ls->lq = CRSF::LinkStatistics.uplink_Link_quality;
     ls->tlmConfirm = MspReceiver.GetCurrentConfirm() ? 1 : 0;
+    ls->rxSession = rxSession;
 #if defined(DEBUG_FREQ_CORRECTION)
     ls->SNR = FreqCorrection * 127 / FreqCorrectionMax;
 #else
@@ -474,9 +511,16 @@ bool ICACHE_RAM_ATTR HandleSendTelemetryResponse()
             ls = &otaPkt.full.tlm_dl.ul_link_stats.stats;
             // Include some advanced telemetry in the extra space
             // Note the use of `ul_link_stats.payload` vs just `payload`
-            otaPkt.full.tlm_dl.packageIndex = TelemetrySender.GetCurrentPayload(
-                otaPkt.full.tlm_dl.ul_link_stats.payload,
-                sizeof(otaPkt.full.tlm_dl.ul_link_stats.payload));
+            uint8_t *payload = otaPkt.full.tlm_dl.ul_link_stats.payload;
+            uint8_t payloadLen = sizeof(otaPkt.full.tlm_dl.ul_link_stats.payload);
+            // The TX takes windowed MSP, ack it in the first byte
+            if (MspWindowOffered)
+            {
+                otaPkt.full.tlm_dl.tlmConfirm = 1;
+                *payload++ = MspReceiver.GetWindowAck();
+                --payloadLen;
+            }
+            otaPkt.full.tlm_dl.packageIndex = TelemetrySender.GetCurrentPayload(payload, payloadLen);
         }
         else
         {
@@ -622,35 +666,15 @@ void ICACHE_RAM_ATTR updatePhaseLock()
         int32_t OffsetDx = LPF_OffsetDx.update(RawOffset - PfdPrevRawOffset);
         PfdPrevRawOffset = RawOffset;
 
-        if (RXtimerState == tim_locked)
-        {
-            // limit rate of freq offset adjustment, use slot 1
-            // because telemetry can fall on slot 1 and will
-            // never get here
-            if (OtaNonce % 8 == 1)
-            {
-                if (Offset > 0)
-                {
-                    hwTimer::incFreqOffset();
-                }
-                else if (Offset < 0)
-                {
-                    hwTimer::decFreqOffset();
-                }
-            }
-        }
-
-        if (connectionState != connected)
-        {
-            hwTimer::phaseShift(RawOffset >> 1);
-        }
-        else
-        {
-            hwTimer::phaseShift(Offset >> 2);
-        }
+        // Wide bandwidth to pull the timer in quickly until connected, then narrow
+        // to filter the packet timing jitter
+        hwTimer::phaseShift(phaseLock.update(RawOffset, connectionState != connected));
+        hwTimer::setFreqOffset(phaseLock.getFreqOffset());
 
-        DBGVLN("%d:%d:%d:%d:%d", Offset, RawOffset, OffsetDx, hwTimer::getFreqOffset(), uplinkLQ);
-        UNUSED(OffsetDx); // complier warning if no debug
+        DBGVLN("%d:%d:%d:%d:%d:%d:%d", Offset, RawOffset, OffsetDx, hwTimer::getFreqOffset(),
+            phaseLock.getPhaseVariance(), phaseLock.isLocked(), uplinkLQ);
+        UNUSED(Offset); // complier warning if no debug
+        UNUSED(OffsetDx);
     }
 
     PFDloop.reset();
@@ -658,9 +682,27 @@ void ICACHE_RAM_ATTR updatePhaseLock()
 
 void ICACHE_RAM_ATTR HWtimerCallbackTick() // this is 180 out of phase with the other callback, occurs mid-packet reception
 {
+    CYCLE_STATS_SCOPE(CYCLE_STATS_TICK);
     updatePhaseLock();
     OtaNonce++;
 
+    if (rateSwitchPending && OtaNonce == rateSwitchNonce)
+    {
+        rateSwitchPending = false;
+        // A switch to the same rate is the TX changing to the FHSS blacklist it sent, which
+        // loop() has built the hops for already, only the hops after this change
+        if (rateSwitchIndex == ExpressLRS_currAirRate_Modparams->index)
+        {
+            FHSSswapBlacklist();
+        }
+        // loop() changes the rate in place, the TX changes on this nonce too
+        else
+        {
+            ExpressLRS_nextAirRateIndex = rateSwitchIndex;
+            rateSwitchNow = true;
+        }
+    }
+
     // if (!alreadyTLMresp && !alreadyFHSS && !LQCalc.currentIsSet()) // packet timeout AND didn't DIDN'T just hop or send TLM
     // {
     //     Radio.RXnb(); // put the radio cleanly back into RX in case of garbage data
@@ -681,7 +723,10 @@ void ICACHE_RAM_ATTR HWtimerCallbackTick() // this is 180 out of phase with the
     CRSF::LinkStatistics.uplink_Link_quality = uplinkLQ;
     // Only advance the LQI period counter if we didn't send Telemetry this period
     if (!alreadyTLMresp)
+    {
         LQCalc.inc();
+        ChannelStats_NextPacket((connectionState == connected) ? FHSSgetCurrChannel() : CHANNEL_STATS_NONE);
+    }
 
     alreadyTLMresp = false;
     alreadyFHSS = false;
@@ -777,6 +822,7 @@ static void ICACHE_RAM_ATTR updateDiversity()
 
 void ICACHE_RAM_ATTR HWtimerCallbackTock()
 {
+    CYCLE_STATS_SCOPE(CYCLE_STATS_TOCK);
     PFDloop.intEvent(micros()); // our internal osc just fired
 
     if (ExpressLRS_currAirRate_Modparams->numOfSends > 1 && !(OtaNonce % ExpressLRS_currAirRate_Modparams->numOfSends))
@@ -831,9 +877,13 @@ void LostConnection(bool resumeRx)
         config.SetRateInitialIdx(ExpressLRS_nextAirRateIndex);
 
     RFmodeCycleMultiplier = 1;
+    rateSwitchPending = false;
+    rateSwitchNow = false;
+    rateSwitchResync = false;
     setConnectionState(disconnected); //set lost connection
     RXtimerState = tim_disconnected;
     hwTimer::resetFreqOffset();
+    phaseLock.reset();
     PfdPrevRawOffset = 0;
     GotConnectionMillis = 0;
     uplinkLQ = 0;
@@ -843,6 +893,11 @@ void LostConnection(bool resumeRx)
     LPF_OffsetDx.init(0);
     alreadyTLMresp = false;
     alreadyFHSS = false;
+    mavlinkCompress = false;
+    telemetryBatch = false;
+    fhssBlacklistReplyPending = false;
+    FHSSsetBlacklist(nullptr);
+    rxSessionExpired = true;
 
     if (!InBindingMode)
     {
@@ -860,6 +915,33 @@ void LostConnection(bool resumeRx)
     }
 }
 
+/**
+ * Change to the rate announced by the TX at the switch nonce, staying connected. The TX
+ * restarts the FHSS sequence on the new rate and spams SYNC packets, so wait on the sync
+ * channel with the timer stopped and restart it from the first SYNC, like connecting does
+ * but without a disconnect or the initial rate being written to the config
+ */
+static void RateSwitchInPlace()
+{
+    rateSwitchNow = false;
+
+    while (micros() - PFDloop.getIntEventTime() > 250); // time it just after the tock()
+    hwTimer::stop();
+
+    SetRFLinkRate(ExpressLRS_nextAirRateIndex, false); // also sets to initialFreq
+    FHSSsetCurrIndex(0);
+    rateSwitchResync = true;
+    RXtimerState = tim_tentative;
+    GotConnectionMillis = millis();
+    phaseLock.reset();
+    PfdPrevRawOffset = 0;
+    LPF_Offset.init(0);
+    LPF_OffsetDx.init(0);
+    alreadyTLMresp = false;
+    alreadyFHSS = false;
+    Radio.RXnb();
+}
+
 void ICACHE_RAM_ATTR TentativeConnection(unsigned long now)
 {
     PFDloop.reset();
@@ -871,6 +953,15 @@ void ICACHE_RAM_ATTR TentativeConnection(unsigned long now)
     LPF_Offset.init(0);
     SnrMean.reset();
     RFmodeLastCycled = now; // give another 3 sec for lock to occur
+    if (rxSessionExpired)
+    {
+        // Any value but the last, the time makes it unlikely to repeat across a reboot
+        uint8_t const prevSession = rxSession;
+        rxSession = micros();
+        if (rxSession == prevSession)
+            ++rxSession;
+        rxSessionExpired = false;
+    }
 
     // The caller MUST call hwTimer::resume(). It is not done here because
     // the timer ISR will fire immediately and preempt any other code
@@ -947,7 +1038,7 @@ void ICACHE_RAM_ATTR OnELRSBindMSP(uint8_t* newUid4)
     config.SetUID(UID);
 }
 
-static void ICACHE_RAM_ATTR ProcessRfPacket_MSP(OTA_Packet_s const * const otaPktPtr)
+static void ProcessRfPacket_MSP(OTA_Packet_s const * const otaPktPtr)
 {
     uint8_t packageIndex;
     uint8_t const * payload;
@@ -957,11 +1048,7 @@ static void ICACHE_RAM_ATTR ProcessRfPacket_MSP(OTA_Packet_s const * const otaPk
         packageIndex = otaPktPtr->full.msp_ul.packageIndex;
         payload = otaPktPtr->full.msp_ul.payload;
         dataLen = sizeof(otaPktPtr->full.msp_ul.payload);
-        if (config.GetSerialProtocol() == PROTOCOL_MAVLINK)
-        {
-            TelemetrySender.ConfirmCurrentPayload(otaPktPtr->full.msp_ul.tlmConfirm);
-        }
-        else
+        if (config.GetSerialProtocol() != PROTOCOL_MAVLINK)
         {
             packageIndex &= ELRS8_TELEMETRY_MAX_PACKAGES;
         }
@@ -971,11 +1058,7 @@ static void ICACHE_RAM_ATTR ProcessRfPacket_MSP(OTA_Packet_s const * const otaPk
         packageIndex = otaPktPtr->std.msp_ul.packageIndex;
         payload = otaPktPtr->std.msp_ul.payload;
         dataLen = sizeof(otaPktPtr->std.msp_ul.payload);
-        if (config.GetSerialProtocol() == PROTOCOL_MAVLINK)
-        {
-            TelemetrySender.ConfirmCurrentPayload(otaPktPtr->std.msp_ul.tlmConfirm);
-        }
-        else
+        if (config.GetSerialProtocol() != PROTOCOL_MAVLINK)
         {
             packageIndex &= ELRS4_TELEMETRY_MAX_PACKAGES;
         }
@@ -997,6 +1080,40 @@ static void ICACHE_RAM_ATTR ProcessRfPacket_MSP(OTA_Packet_s const * const otaPk
     }
 }
 
+static void ICACHE_RAM_ATTR QueueRfPacket_Data(OTA_Packet_s const * const otaPktPtr)
+{
+    // The MAVLink downlink confirm must be seen before the next telemetry packet is sent
+    if (!firmwareOptions.is_airport && config.GetSerialProtocol() == PROTOCOL_MAVLINK)
+    {
+        TelemetrySender.ConfirmCurrentPayload(OtaIsFullRes ? otaPktPtr->full.msp_ul.tlmConfirm : otaPktPtr->std.msp_ul.tlmConfirm);
+    }
+
+    // If the queue is full the packet is dropped, MSP will be resent as it is never acked
+    OTA_Packet_s * const slot = RxDataPackets.reserve();
+    if (slot != nullptr)
+    {
+        memcpy(slot, otaPktPtr, OtaIsFullRes ? OTA8_PACKET_SIZE : OTA4_PACKET_SIZE);
+        RxDataPackets.commit();
+    }
+}
+
+static void ProcessQueuedRfPackets()
+{
+    OTA_Packet_s const *otaPktPtr;
+    while ((otaPktPtr = RxDataPackets.front()) != nullptr)
+    {
+        if (firmwareOptions.is_airport)
+        {
+            OtaUnpackAirportData(otaPktPtr, &apOutputBuffer);
+        }
+        else
+        {
+            ProcessRfPacket_MSP(otaPktPtr);
+        }
+        RxDataPackets.pop();
+    }
+}
+
 static void ICACHE_RAM_ATTR updateSwitchModePendingFromOta(uint8_t newSwitchMode)
 {
     if (OtaSwitchModeCurrent == newSwitchMode)
@@ -1029,8 +1146,10 @@ static void ICACHE_RAM_ATTR updateSwitchModePendingFromOta(uint8_t newSwitchMode
     }
 }
 
-static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Sync_s const * const otaSync)
+static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Packet_s const * const otaPktPtr)
 {
+    OTA_Sync_s const * const otaSync = OtaIsFullRes ? &otaPktPtr->full.sync.sync : &otaPktPtr->std.sync;
+
     // Verify the first byte of the binding ID, which should always match
     if (otaSync->UID4 != UID[4])
         return false;
@@ -1042,6 +1161,7 @@ static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Sync_s
         return false;
 
     LastSyncPacket = now;
+    MspWindowOffered = OtaIsFullRes && otaPktPtr->full.sync.stubbornWindow;
 #if defined(DEBUG_RX_SCOREBOARD)
     DBGW('s');
 #endif
@@ -1069,8 +1189,19 @@ static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Sync_s
     }
 
     // Will change the packet air rate in loop() if this changes
-    ExpressLRS_nextAirRateIndex = enumRatetoIndex((expresslrs_RFrates_e)otaSync->rfRateEnum);
-    updateSwitchModePendingFromOta(otaSync->switchEncMode);
+    uint8_t const rateIndex = enumRatetoIndex((expresslrs_RFrates_e)otaSync->rfRateEnum);
+    if (otaSync->rateSwitch)
+    {
+        // The TX changes to this rate at the next nonce window too, change on the same nonce
+        rateSwitchIndex = rateIndex;
+        rateSwitchNonce = OtaRateSwitchNonce(otaSync->nonce);
+        rateSwitchPending = true;
+    }
+    else
+    {
+        ExpressLRS_nextAirRateIndex = rateIndex;
+    }
+    updateSwitchModePendingFromOta(OtaGetSyncSwitchMode(otaPktPtr));
 
     // Update TLM ratio, should never be TLM_RATIO_STD/DISARMED, the TX calculates the correct value for the RX
     expresslrs_tlm_ratio_e TLMrateIn = (expresslrs_tlm_ratio_e)(otaSync->newTlmRatio + (uint8_t)TLM_RATIO_NO_TLM);
@@ -1087,6 +1218,16 @@ static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Sync_s
     bool modelMatched = otaSync->UID5 == (UID[5] ^ modelXor);
     DBGVLN("MM %u=%u %d", otaSync->UID5, UID[5], modelMatched);
 
+    // First SYNC on the new rate after an adaptive rate switch, start the timer from it
+    if (rateSwitchResync && connectionState == connected)
+    {
+        FHSSsetCurrIndex(otaSync->fhssIndex);
+        OtaNonce = otaSync->nonce;
+        PFDloop.reset();
+        rateSwitchResync = false;
+        return true;
+    }
+
     if (connectionState == disconnected
         || OtaNonce != otaSync->nonce
         || FHSSgetCurrIndex() != otaSync->fhssIndex
@@ -1104,25 +1245,61 @@ static bool ICACHE_RAM_ATTR ProcessRfPacket_SYNC(uint32_t const now, OTA_Sync_s
     return false;
 }
 
+#if defined(RADIO_LR1121)
+/***
+ * @brief: DVDA sends every packet numOfSends times, with FEC a copy which failed the
+ * CRC is kept so its codewords can be combined with those of the next copy
+ * @return: true if the combined packet passes the CRC
+ ***/
+static bool ICACHE_RAM_ATTR CombineDvdaCopiesFEC(OTA_Packet_s * const otaPktPtr)
+{
+    static uint8_t keptNonceGroup;
+    static uint32_t keptMicros;
+    uint8_t const numOfSends = ExpressLRS_currAirRate_Modparams->numOfSends;
+    if (numOfSends == 1 || !Radio.FECEnabled())
+        return false;
+
+    // Only combine copies of the same packet, the nonce group alone repeats every 256 packets
+    uint8_t const nonceGroup = OtaNonce / numOfSends;
+    uint32_t const now = micros();
+    bool const sameGroup = nonceGroup == keptNonceGroup
+        && (now - keptMicros) < ExpressLRS_currAirRate_Modparams->interval * numOfSends;
+    if (sameGroup && Radio.FECCombineWithKept() && OtaValidatePacketCrc(otaPktPtr))
+        return true;
+
+    Radio.FECKeepForCombining();
+    keptNonceGroup = nonceGroup;
+    keptMicros = now;
+    return false;
+}
+#endif
+
 bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
 {
-    if (status != SX12xxDriverCommon::SX12XX_RX_OK)
+    CYCLE_STATS_SCOPE(CYCLE_STATS_PROCESS_PACKET);
+    if (status & ~SX12xxDriverCommon::SX12XX_RX_FEC_CORRECTED)
     {
         DBGVLN("HW CRC error");
         #if defined(DEBUG_RX_SCOREBOARD)
             lastPacketCrcError = true;
         #endif
+        ChannelStats_CrcError();
         return false;
     }
     uint32_t const beginProcessing = micros();
 
     OTA_Packet_s * const otaPktPtr = (OTA_Packet_s * const)Radio.RXdataBuffer;
-    if (!OtaValidatePacketCrc(otaPktPtr))
+    if (!OtaValidatePacketCrc(otaPktPtr)
+#if defined(RADIO_LR1121)
+        && !CombineDvdaCopiesFEC(otaPktPtr)
+#endif
+        )
     {
         DBGVLN("CRC error");
         #if defined(DEBUG_RX_SCOREBOARD)
             lastPacketCrcError = true;
         #endif
+        ChannelStats_CrcError();
         return false;
     }
 
@@ -1139,19 +1316,10 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
         ProcessRfPacket_RC(otaPktPtr);
         break;
     case PACKET_TYPE_SYNC: //sync packet from master
-        doStartTimer = ProcessRfPacket_SYNC(now,
-            OtaIsFullRes ? &otaPktPtr->full.sync.sync : &otaPktPtr->std.sync)
-            && !InBindingMode;
+        doStartTimer = ProcessRfPacket_SYNC(now, otaPktPtr) && !InBindingMode;
         break;
     case PACKET_TYPE_DATA:
-        if (firmwareOptions.is_airport)
-        {
-            OtaUnpackAirportData(otaPktPtr, &apOutputBuffer);
-        }
-        else
-        {
-            ProcessRfPacket_MSP(otaPktPtr);
-        }
+        QueueRfPacket_Data(otaPktPtr);
         break;
     default:
         break;
@@ -1160,6 +1328,9 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
     // Store the LQ/RSSI/Antenna
     Radio.GetLastPacketStats();
     getRFlinkInfo();
+    ChannelStats_Received(
+        (Radio.GetProcessingPacketRadio() == SX12XX_Radio_1) ? Radio.LastPacketRSSI : Radio.LastPacketRSSI2,
+        Radio.LastPacketSNRRaw);
 
     if (Radio.FrequencyErrorAvailable())
     {
@@ -1181,6 +1352,7 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
     RFmodeCycleMultiplier = RFmodeCycleMultiplierSlow;
 
 #if defined(DEBUG_RX_SCOREBOARD)
+    if (status & SX12xxDriverCommon::SX12XX_RX_FEC_CORRECTED) DBGW('f');
     if (otaPktPtr->std.type != PACKET_TYPE_SYNC) DBGW(connectionHasModelMatch ? 'R' : 'r');
 #endif
 
@@ -1189,7 +1361,9 @@ bool ICACHE_RAM_ATTR ProcessRFPacket(SX12xxDriverCommon::rx_status const status)
 
 bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 {
-    if (LQCalc.currentIsSet() && connectionState == connected)
+    CYCLE_STATS_SCOPE(CYCLE_STATS_RXDONE);
+    // No LQ periods while resyncing after a rate switch, any packet may be the SYNC
+    if (LQCalc.currentIsSet() && connectionState == connected && !rateSwitchResync)
     {
         return false; // Already received a packet, do not run ProcessRFPacket() again.
     }
@@ -1211,6 +1385,7 @@ bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 
 void ICACHE_RAM_ATTR TXdoneISR()
 {
+    CYCLE_STATS_SCOPE(CYCLE_STATS_TXDONE);
     Radio.RXnb();
 #if defined(Regulatory_Domain_EU_CE_2400)
     SetClearChannelAssessmentTime();
@@ -1249,6 +1424,34 @@ void MspReceiveComplete()
         // raw mavlink data
         mavlinkOutputBuffer.atomicPushBytes(&MspData[2], MspData[1]);
         break;
+    case MSP_ELRS_MAVLINK_COMPRESS:
+        // The TX has reset its decompressor, until the connection is lost
+        if (MspData[2] == MAVLINK_COMPRESS_VERSION)
+        {
+            mavlinkCompressor.reset();
+            mavlinkCompress = true;
+        }
+        break;
+    case MSP_ELRS_TELEMETRY_BATCH:
+        // The TX can split up batched telemetry, until the connection is lost
+        if (MspData[2] == TELEMETRY_BATCH_VERSION)
+        {
+            telemetryBatch = true;
+        }
+        break;
+    case MSP_ELRS_FHSS_BLACKLIST:
+        // The hops are built now and swapped in when the TX announces the switch to it, which
+        // it does once it has the reply
+        if (MspData[2] == MSP_ELRS_FHSS_BLACKLIST_VERSION && connectionState == connected)
+        {
+            FHSSprepareBlacklist(&MspData[4]);
+            fhssBlacklistReply[0] = MSP_ELRS_FHSS_BLACKLIST;
+            fhssBlacklistReply[1] = 2;
+            fhssBlacklistReply[2] = MSP_ELRS_FHSS_BLACKLIST_VERSION;
+            fhssBlacklistReply[3] = MspData[3];
+            fhssBlacklistReplyPending = true;
+        }
+        break;
     default:
         //handle received CRSF package
         crsf_ext_header_t *receivedHeader = (crsf_ext_header_t *) MspData;
@@ -2046,6 +2249,7 @@ void setup()
         setupBindingFromConfig();
 
         FHSSrandomiseFHSSsequence(uidMacSeedGet());
+        ChannelStats_Reset(FHSSgetChannelCount());
 
         setupRadio();
 
@@ -2078,6 +2282,8 @@ void loop()
 {
     unsigned long now = millis();
 
+    ProcessQueuedRfPackets();
+
     if (MspReceiver.HasFinishedData())
     {
         MspReceiveComplete();
@@ -2107,6 +2313,13 @@ void loop()
         return;
     }
 
+    if (rateSwitchNow && connectionState == connected && isSupportedRFRate(ExpressLRS_nextAirRateIndex))
+    {
+        DBGLN("Adaptive rate %u->%u", ExpressLRS_currAirRate_Modparams->index, ExpressLRS_nextAirRateIndex);
+        RateSwitchInPlace();
+    }
+    rateSwitchNow = false;
+
     if ((connectionState != disconnected) && (ExpressLRS_currAirRate_Modparams->index != ExpressLRS_nextAirRateIndex)) // forced change
     {
         DBGLN("Req air rate change %u->%u", ExpressLRS_currAirRate_Modparams->index, ExpressLRS_nextAirRateIndex);
@@ -2153,24 +2366,51 @@ void loop()
 
     uint8_t *nextPayload = 0;
     uint8_t nextPlayloadSize = 0;
-    if (!TelemetrySender.IsActive() && telemetry.GetNextPayload(&nextPlayloadSize, &nextPayload))
+    if (fhssBlacklistReplyPending && !TelemetrySender.HasQueuedData())
     {
-        TelemetrySender.SetDataToTransmit(nextPayload, nextPlayloadSize);
+        TelemetrySender.QueueDataToTransmit(fhssBlacklistReply, sizeof(fhssBlacklistReply));
+        fhssBlacklistReplyPending = false;
     }
 
+    // Pack as many frames as the TX can receive (CRSFinBuffer) into each transfer, once
+    // the TX has said it can split them up
+    if (!TelemetrySender.IsActive())
+    {
+        bool const hasPayload = telemetryBatch
+            ? telemetry.GetNextPayloadBatch(now, CRSF_MAX_PACKET_LEN, &nextPlayloadSize, &nextPayload)
+            : telemetry.GetNextPayload(now, &nextPlayloadSize, &nextPayload);
+        if (hasPayload)
+        {
+            TelemetrySender.SetDataToTransmit(nextPayload, nextPlayloadSize);
+        }
+    }
+
+    // Parse the FC stream into frames, the tunnel merges the high rate ones under pressure
     uint16_t count = mavlinkInputBuffer.size();
-    if (count > 0 && !TelemetrySender.IsActive())
+    while (count > 0 && mavlinkTunnel.free() >= MAVLINK_TUNNEL_MAX_FRAME)
+    {
+        uint8_t buf[CRSF_MAX_PACKET_LEN];
+        uint16_t const size = std::min(count, (uint16_t)sizeof(buf));
+        mavlinkInputBuffer.lock();
+        mavlinkInputBuffer.popBytes(buf, size);
+        mavlinkInputBuffer.unlock();
+        mavlinkTunnel.pushBytes(buf, size);
+        count -= size;
+    }
+
+    // The next transfer is queued while the current one is in flight so they go back to back
+    if (mavlinkTunnel.size() > 0 && !TelemetrySender.HasQueuedData())
     {
-        uint16_t maxMavPayloadSize = (uint16_t)MAV_PAYLOAD_SIZE_MAX - CRSF_FRAME_NOT_COUNTED_BYTES; // Constrain to multiplication of the OTA payload size e.g. 5, 10, and 20B.
-        count = std::min(count, maxMavPayloadSize);
+        uint8_t maxMavPayloadSize = MAV_PAYLOAD_SIZE_MAX - CRSF_FRAME_NOT_COUNTED_BYTES; // Constrain to multiplication of the OTA payload size e.g. 5, 10, and 20B.
+        nextPayload = mavlinkSSBuffer[mavlinkSSBufferIdx];
+        mavlinkSSBufferIdx ^= 1;
         // First 2 bytes conform to crsf_header_s format
-        mavlinkSSBuffer[0] = CRSF_ADDRESS_USB; // device_addr - used on TX to differentiate between std tlm and mavlink
-        mavlinkSSBuffer[1] = count;
-        // Following n bytes are just raw mavlink
-        mavlinkInputBuffer.popBytes(mavlinkSSBuffer + CRSF_FRAME_NOT_COUNTED_BYTES, count);
-        nextPayload = mavlinkSSBuffer;
-        nextPlayloadSize = count + CRSF_FRAME_NOT_COUNTED_BYTES;
-        TelemetrySender.SetDataToTransmit(nextPayload, nextPlayloadSize);
+        nextPayload[0] = CRSF_ADDRESS_USB; // device_addr - used on TX to differentiate between std tlm and mavlink
+        // Following n bytes are whole mavlink frames where they fit
+        nextPayload[1] = mavlinkTunnel.popChunk(nextPayload + CRSF_FRAME_NOT_COUNTED_BYTES, maxMavPayloadSize,
+            mavlinkCompress ? &mavlinkCompressor : nullptr);
+        nextPlayloadSize = nextPayload[1] + CRSF_FRAME_NOT_COUNTED_BYTES;
+        TelemetrySender.QueueDataToTransmit(nextPayload, nextPlayloadSize);
     }
 
     updateTelemetryBurst();
@@ -2,12 +2,19 @@
 
 #include "CRSFHandset.h"
 #include "dynpower.h"
+#include "AdaptiveRate.h"
+#include "SpectrumScan.h"
+#include "CycleStats.h"
+#include "ChannelStats.h"
 #include "lua.h"
 #include "msp.h"
 #include "msptypes.h"
 #include "telemetry_protocol.h"
+#include "telemetry.h"
 #include "stubborn_receiver.h"
 #include "stubborn_sender.h"
+#include "MAVLinkTunnel.h"
+#include "MAVLinkCompress.h"
 
 #include "devHandset.h"
 #include "devLED.h"
@@ -51,13 +58,26 @@ Stream *TxBackpack;
 Stream *TxUSB;
 
 // Variables / constants for Airport //
-FIFO<AP_MAX_BUF_LEN> apInputBuffer;
-FIFO<AP_MAX_BUF_LEN> apOutputBuffer;
+SpscFIFO<AP_MAX_BUF_LEN> apInputBuffer;
+SpscFIFO<AP_MAX_BUF_LEN> apOutputBuffer;
 
 #define UART_INPUT_BUF_LEN 1024
 FIFO<UART_INPUT_BUF_LEN> uartInputBuffer;
 
-uint8_t mavlinkSSBuffer[CRSF_MAX_PACKET_LEN]; // Buffer for current stubbon sender packet (mavlink only)
+// Whole MAVLink frames from uartInputBuffer, for the MspSender
+MAVLinkTunnel mavlinkTunnel;
+// Buffers for the current and queued stubborn sender packets (mavlink only)
+uint8_t mavlinkSSBuffer[2][CRSF_MAX_PACKET_LEN];
+static uint8_t mavlinkSSBufferIdx;
+// The RX compresses the downlink once asked on each connection
+static MAVLinkDecompressor mavlinkDecompressor;
+static bool mavlinkCompressRequested;
+// and batches the CRSF telemetry once told the TX can split it up
+static bool telemetryBatchRequested;
+// The RX picks a new session each time it connects, its requests have to be sent again
+static uint8_t rxSessionLast;
+static volatile bool rxReconnected;
+static uint8_t mavlinkDecoded[CRSF_FRAME_NOT_COUNTED_BYTES + MAVLINK_COMPRESS_MAX_DECODED];
 
 unsigned long rebootTime = 0;
 extern bool webserverPreventAutoStart;
@@ -75,6 +95,39 @@ uint32_t rfModeLastChangedMS = 0;
 uint32_t SyncPacketLastSent = 0;
 ////////////////////////////////////////////////
 
+////////////ADAPTIVE RATE/////////
+typedef enum {
+  arsIdle,
+  arsPending,   // A new rate has been picked, waiting for the start of a nonce window to announce it
+  arsAnnounced, // SYNC packets are announcing the switch at adaptiveRateSwitchNonce
+  arsSwitching, // The switch nonce has been reached, loop() changes the rate
+} adaptiveRateState_e;
+
+static AdaptiveRate adaptiveRate;
+static volatile adaptiveRateState_e adaptiveRateState = arsIdle;
+static volatile uint8_t adaptiveRateNextIndex;
+static volatile uint8_t adaptiveRateSwitchNonce;
+static volatile uint8_t adaptiveRateSyncCounter;
+static volatile bool adaptiveRateNewStats;
+static volatile int8_t adaptiveRateSnrScaled;
+static uint32_t adaptiveRateConnectedMs;
+static uint32_t adaptiveRateSwitchMillis;
+////////////////////////////////////////////////
+
+////////////FHSS BLACKLIST/////////
+#define FHSS_BLACKLIST_INTERVAL_MS  5000    // How often the spectrum scan is turned into a new blacklist
+#define FHSS_BLACKLIST_TIMEOUT_MS   10000   // How long to wait for the RX to confirm it has the blacklist
+#define FHSS_BLACKLIST_ANNOUNCE     2       // Switches announced for each blacklist, in case the RX misses the SYNCs of one
+
+static SpectrumScan spectrumScan;
+// MSP_ELRS_FHSS_BLACKLIST, payload length, version, generation, channel bitmask
+static uint8_t fhssBlacklistMsg[4 + FHSS_BLACKLIST_BYTES];
+static uint32_t fhssBlacklistSentMs;
+static bool fhssBlacklistPending;           // Sent, waiting for the RX to echo the generation
+static uint8_t fhssBlacklistAnnounce;       // The RX has it, switches left to announce
+static volatile bool fhssBlacklistSwitch;   // The announced adaptive rate switch is to the blacklist
+////////////////////////////////////////////////
+
 volatile uint32_t LastTLMpacketRecvMillis = 0;
 uint32_t TLMpacketReported = 0;
 static bool commitInProgress = false;
@@ -135,6 +188,8 @@ void ICACHE_RAM_ATTR LinkStatsFromOta(OTA_LinkStats_s * const ls)
 {
   int8_t snrScaled = ls->SNR;
   DynamicPower_TelemetryUpdate(snrScaled);
+  adaptiveRateSnrScaled = snrScaled;
+  adaptiveRateNewStats = true;
 
   // Antenna is the high bit in the RSSI_1 value
   // RSSI received is signed, inverted polarity (positive value = -dBm)
@@ -150,6 +205,11 @@ void ICACHE_RAM_ATTR LinkStatsFromOta(OTA_LinkStats_s * const ls)
 #endif
   CRSF::LinkStatistics.active_antenna = ls->antenna;
   connectionHasModelMatch = ls->modelMatch;
+  if (ls->rxSession != rxSessionLast)
+  {
+    rxSessionLast = ls->rxSession;
+    rxReconnected = true;
+  }
   // -- downlink_SNR / downlink_RSSI is updated for any packet received, not just Linkstats
   // -- uplink_TX_Power is updated when sending to the handset, so it updates when missing telemetry
   // -- rf_mode is updated when we change rates
@@ -159,9 +219,10 @@ void ICACHE_RAM_ATTR LinkStatsFromOta(OTA_LinkStats_s * const ls)
 
 bool ICACHE_RAM_ATTR ProcessTLMpacket(SX12xxDriverCommon::rx_status const status)
 {
-  if (status != SX12xxDriverCommon::SX12XX_RX_OK)
+  if (status & ~SX12xxDriverCommon::SX12XX_RX_FEC_CORRECTED)
   {
     DBGLN("TLM HW CRC error");
+    ChannelStats_CrcError();
     return false;
   }
 
@@ -169,6 +230,7 @@ bool ICACHE_RAM_ATTR ProcessTLMpacket(SX12xxDriverCommon::rx_status const status
   if (!OtaValidatePacketCrc(otaPktPtr))
   {
     DBGLN("TLM crc error");
+    ChannelStats_CrcError();
     return false;
   }
 
@@ -176,6 +238,9 @@ bool ICACHE_RAM_ATTR ProcessTLMpacket(SX12xxDriverCommon::rx_status const status
   LQCalc.add();
 
   Radio.GetLastPacketStats();
+  ChannelStats_Received(
+    (Radio.GetProcessingPacketRadio() == SX12XX_Radio_1) ? Radio.LastPacketRSSI : Radio.LastPacketRSSI2,
+    Radio.LastPacketSNRRaw);
   CRSF::LinkStatistics.downlink_SNR = SNR_DESCALE(Radio.LastPacketSNRRaw);
   CRSF::LinkStatistics.downlink_RSSI_1 = Radio.LastPacketRSSI;
   CRSF::LinkStatistics.downlink_RSSI_2 = Radio.LastPacketRSSI2;
@@ -193,6 +258,13 @@ bool ICACHE_RAM_ATTR ProcessTLMpacket(SX12xxDriverCommon::rx_status const status
         LinkStatsFromOta(&ota8->tlm_dl.ul_link_stats.stats);
         telemPtr = ota8->tlm_dl.ul_link_stats.payload;
         dataLen = sizeof(ota8->tlm_dl.ul_link_stats.payload);
+        // The RX acks windowed MSP in the first payload byte, older RXs never set the bit
+        MspSender.SetWindowed(ota8->tlm_dl.tlmConfirm);
+        if (ota8->tlm_dl.tlmConfirm)
+        {
+          MspSender.ConfirmWindow(*telemPtr++);
+          --dataLen;
+        }
         break;
 
       case PACKET_TYPE_DATA:
@@ -219,6 +291,7 @@ bool ICACHE_RAM_ATTR ProcessTLMpacket(SX12xxDriverCommon::rx_status const status
     {
       case PACKET_TYPE_LINKSTATS:
         LinkStatsFromOta(&otaPktPtr->std.tlm_dl.ul_link_stats.stats);
+        MspSender.SetWindowed(false);
         break;
 
       case PACKET_TYPE_DATA:
@@ -247,13 +320,8 @@ expresslrs_tlm_ratio_e ICACHE_RAM_ATTR UpdateTlmRatioEffective()
   expresslrs_tlm_ratio_e retVal = ExpressLRS_currAirRate_Modparams->TLMinterval;
   bool updateTelemDenom = true;
 
-  // TLM ratio is boosted for one sync cycle when the MspSender goes active
-  if (MspSender.IsActive())
-  {
-    retVal = TLM_RATIO_1_2;
-  }
   // If Armed, telemetry is disabled, otherwise use STD
-  else if (ratioConfigured == TLM_RATIO_DISARMED)
+  if (ratioConfigured == TLM_RATIO_DISARMED)
   {
     if (handset->IsArmed())
     {
@@ -268,6 +336,26 @@ expresslrs_tlm_ratio_e ICACHE_RAM_ATTR UpdateTlmRatioEffective()
     retVal = ratioConfigured;
   }
 
+  // TLM ratio is boosted for one sync cycle when the MspSender goes active. A windowed
+  // sender gets a whole window acked per telemetry slot, so it keeps ratios up to
+  // one ack per window of MSP packets (MSP goes in every other uplink packet) and
+  // slower ratios are only boosted that far
+  if (MspSender.IsActive())
+  {
+    static_assert(STUBBORN_WINDOW_SIZE * 2 == 8, "Windowed MSP boost ratio does not match the window");
+    uint8_t const denom = TLMratioEnumToValue(retVal);
+    if (!MspSender.IsWindowed())
+    {
+      retVal = TLM_RATIO_1_2;
+      updateTelemDenom = true;
+    }
+    else if (denom < 2 || denom > STUBBORN_WINDOW_SIZE * 2)
+    {
+      retVal = TLM_RATIO_1_8;
+      updateTelemDenom = true;
+    }
+  }
+
   if (updateTelemDenom)
   {
     uint8_t newTlmDenom = TLMratioEnumToValue(retVal);
@@ -280,18 +368,28 @@ expresslrs_tlm_ratio_e ICACHE_RAM_ATTR UpdateTlmRatioEffective()
   return retVal;
 }
 
-void ICACHE_RAM_ATTR GenerateSyncPacketData(OTA_Sync_s * const syncPtr)
+void ICACHE_RAM_ATTR GenerateSyncPacketData(OTA_Packet_s * const otaPktPtr)
 {
+  OTA_Sync_s * const syncPtr = OtaIsFullRes ? &otaPktPtr->full.sync.sync : &otaPktPtr->std.sync;
   const uint8_t SwitchEncMode = config.GetSwitchMode();
-  const uint8_t Index = (syncSpamCounter) ? config.GetRate() : ExpressLRS_currAirRate_Modparams->index;
+  const bool rateSwitch = !syncSpamCounter && adaptiveRateState == arsAnnounced;
+  uint8_t Index = ExpressLRS_currAirRate_Modparams->index;
+  if (syncSpamCounter)
+    Index = config.GetRate();
+  else if (rateSwitch)
+    Index = adaptiveRateNextIndex;
 
   if (syncSpamCounter)
     --syncSpamCounter;
+  else if (adaptiveRateSyncCounter)
+    --adaptiveRateSyncCounter;
 
   if (syncSpamCounterAfterRateChange && Index == ExpressLRS_currAirRate_Modparams->index)
   {
     --syncSpamCounterAfterRateChange;
-    if (connectionState == connected) // We are connected again after a rate change.  No need to keep spaming sync.
+    // We are connected again after a rate change.  No need to keep spaming sync.
+    // An adaptive rate change stays connected, wait for telemetry on the new rate instead
+    if (connectionState == connected && (int32_t)(LastTLMpacketRecvMillis - adaptiveRateSwitchMillis) > 0)
       syncSpamCounterAfterRateChange = 0;
   }
 
@@ -302,12 +400,15 @@ void ICACHE_RAM_ATTR GenerateSyncPacketData(OTA_Sync_s * const syncPtr)
   syncPtr->fhssIndex = FHSSgetCurrIndex();
   syncPtr->nonce = OtaNonce;
   syncPtr->rfRateEnum = get_elrs_airRateConfig(Index)->enum_rate;
-  syncPtr->switchEncMode = SwitchEncMode;
+  OtaSetSyncSwitchMode(otaPktPtr, SwitchEncMode);
   syncPtr->newTlmRatio = newTlmRatio - TLM_RATIO_NO_TLM;
   syncPtr->geminiMode = isDualRadio() && config.GetAntennaMode() == TX_RADIO_MODE_GEMINI;
   syncPtr->otaProtocol = config.GetLinkMode();
+  syncPtr->rateSwitch = rateSwitch;
   syncPtr->UID4 = UID[4];
   syncPtr->UID5 = UID[5];
+  if (OtaIsFullRes)
+    otaPktPtr->full.sync.stubbornWindow = 1;
 
   // For model match, the last byte of the binding ID is XORed with the inverse of the modelId
   if (!InBindingMode && config.GetModelMatch())
@@ -321,7 +422,7 @@ uint8_t adjustPacketRateForBaud(uint8_t rateIndex)
   return rateIndex = get_elrs_HandsetRate_max(rateIndex, handset->getMinPacketInterval());
 }
 
-void SetRFLinkRate(uint8_t index) // Set speed of RF link
+void SetRFLinkRate(uint8_t index, bool keepConnection) // Set speed of RF link
 {
   expresslrs_mod_settings_s *const ModParams = get_elrs_airRateConfig(index);
   expresslrs_rf_pref_params_s *const RFperf = get_elrs_RFperfParams(index);
@@ -341,8 +442,14 @@ void SetRFLinkRate(uint8_t index) // Set speed of RF link
 #endif
   hwTimer::updateInterval(interval);
 
-  FHSSusePrimaryFreqBand = !(ModParams->radio_type == RADIO_TYPE_LR1121_LORA_2G4) && !(ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4);
-  FHSSuseDualBand = ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL;
+  bool const primaryFreqBand = FHSSusePrimaryFreqBand;
+  FHSSsetBandMode(!(ModParams->radio_type == RADIO_TYPE_LR1121_LORA_2G4) && !(ModParams->radio_type == RADIO_TYPE_LR1121_GFSK_2G4),
+                  ModParams->radio_type == RADIO_TYPE_LR1121_LORA_DUAL);
+  // The channel numbers are of the other band now
+  if (FHSSusePrimaryFreqBand != primaryFreqBand)
+  {
+    ChannelStats_Reset(FHSSgetChannelCount());
+  }
 
   Radio.Config(ModParams->bw, ModParams->sf, ModParams->cr, FHSSgetInitialFreq(),
                ModParams->PreambleLen, invertIQ, ModParams->PayloadLength, ModParams->interval
@@ -384,8 +491,12 @@ void SetRFLinkRate(uint8_t index) // Set speed of RF link
   CRSF::LinkStatistics.rf_Mode = ModParams->enum_rate;
 
   handset->setPacketInterval(interval * ExpressLRS_currAirRate_Modparams->numOfSends);
-  setConnectionState(disconnected);
-  rfModeLastChangedMS = millis();
+  // An adaptive rate switch stays connected, the RX changes rate in place and keeps its session
+  if (!keepConnection)
+  {
+    setConnectionState(disconnected);
+    rfModeLastChangedMS = millis();
+  }
 }
 
 void ICACHE_RAM_ATTR HandleFHSS()
@@ -505,11 +616,20 @@ void ICACHE_RAM_ATTR SendRCdataToRF()
 
   uint8_t NonceFHSSresult = OtaNonce % ExpressLRS_currAirRate_Modparams->FHSShopInterval;
 
+  // Announce an adaptive rate switch in the first half of a nonce window, so the
+  // RX has the rest of the window to hear one of the SYNCs before the switch
+  if (adaptiveRateState == arsPending && (OtaNonce % OTA_RATE_SWITCH_NONCE_ALIGN) < (OTA_RATE_SWITCH_NONCE_ALIGN / 2))
+  {
+    adaptiveRateSwitchNonce = OtaRateSwitchNonce(OtaNonce);
+    adaptiveRateSyncCounter = syncSpamAmount;
+    adaptiveRateState = arsAnnounced;
+  }
+
   // Sync spam only happens on slot 1 and 2 and can't be disabled
-  if ((syncSpamCounter || (syncSpamCounterAfterRateChange && FHSSonSyncChannel())) && (NonceFHSSresult == 1 || NonceFHSSresult == 2))
+  if ((syncSpamCounter || adaptiveRateSyncCounter || (syncSpamCounterAfterRateChange && FHSSonSyncChannel())) && (NonceFHSSresult == 1 || NonceFHSSresult == 2))
   {
     otaPkt.std.type = PACKET_TYPE_SYNC;
-    GenerateSyncPacketData(OtaIsFullRes ? &otaPkt.full.sync.sync : &otaPkt.std.sync);
+    GenerateSyncPacketData(&otaPkt);
     syncSlot = 0; // reset the sync slot in case the new rate (after the syncspam) has a lower FHSShopInterval
   }
   // Regular sync rotates through 4x slots, twice on each slot, and telemetry pushes it to the next slot up
@@ -517,7 +637,7 @@ void ICACHE_RAM_ATTR SendRCdataToRF()
   else if ((!skipSync) && ((syncSlot / 2) <= NonceFHSSresult) && (now - SyncPacketLastSent > SyncInterval) && FHSSonSyncChannel())
   {
     otaPkt.std.type = PACKET_TYPE_SYNC;
-    GenerateSyncPacketData(OtaIsFullRes ? &otaPkt.full.sync.sync : &otaPkt.std.sync);
+    GenerateSyncPacketData(&otaPkt);
     syncSlot = (syncSlot + 1) % (ExpressLRS_currAirRate_Modparams->FHSShopInterval * 2);
   }
   else
@@ -622,8 +742,9 @@ void ICACHE_RAM_ATTR nonceAdvance()
  */
 void ICACHE_RAM_ATTR timerCallback()
 {
-  /* If we are busy writing to EEPROM (committing config changes) then we just advance the nonces, i.e. no SPI traffic */
-  if (commitInProgress)
+  CYCLE_STATS_SCOPE(CYCLE_STATS_TIMER);
+  /* If we are busy writing to EEPROM (committing config changes) or changing rate then we just advance the nonces, i.e. no SPI traffic */
+  if (commitInProgress || adaptiveRateState == arsSwitching)
   {
     nonceAdvance();
     return;
@@ -653,6 +774,24 @@ void ICACHE_RAM_ATTR timerCallback()
   if (!InBindingMode)
     OtaNonce++;
 
+  // The RX changes to the announced rate on this nonce too, stop transmitting until loop() has changed rate
+  if (adaptiveRateState == arsAnnounced && OtaNonce == adaptiveRateSwitchNonce)
+  {
+    // A switch to the same rate changes to the FHSS blacklist loop() built the hops for,
+    // only the hops after this change
+    if (fhssBlacklistSwitch && adaptiveRateNextIndex == ExpressLRS_currAirRate_Modparams->index)
+    {
+      FHSSswapBlacklist();
+      fhssBlacklistSwitch = false;
+      adaptiveRateState = arsIdle;
+    }
+    else
+    {
+      adaptiveRateState = arsSwitching;
+      return;
+    }
+  }
+
   // If HandleTLM has started Receive mode, TLM packet reception should begin shortly
   // Skip transmitting on this slot
   if (TelemetryRcvPhase == ttrpPreReceiveGap)
@@ -665,6 +804,7 @@ void ICACHE_RAM_ATTR timerCallback()
     CRSF::LinkStatistics.downlink_Link_quality = LQCalc.getLQ();
 #endif
     LQCalc.inc();
+    ChannelStats_NextPacket((connectionState == connected) ? FHSSgetCurrChannel() : CHANNEL_STATS_NONE);
     return;
   }
   else if (TelemetryRcvPhase == ttrpExpectingTelem && !LQCalc.currentIsSet())
@@ -732,10 +872,197 @@ void ResetPower()
 static void ChangeRadioParams()
 {
   ModelUpdatePending = false;
-  SetRFLinkRate(config.GetRate());
+  // Start back at the configured rate, cancelling any adaptive rate switch
+  adaptiveRateState = arsIdle;
+  adaptiveRateSyncCounter = 0;
+  adaptiveRate.reset();
+  SetRFLinkRate(config.GetRate(), false);
   ResetPower();
 }
 
+/**
+ * The radio listens on the hop from the end of the packet before the telemetry slot until
+ * the slot starts and the RX has not started its telemetry yet, so what it hears then is
+ * the noise on the channel. It is read here rather than in the timer as it is a blocking
+ * SPI transfer, which no ISR uses in that gap, and dropped if the slot started meanwhile.
+ */
+static void SpectrumScanUpdate()
+{
+  static uint8_t lastSampleNonce;
+  uint8_t const nonce = OtaNonce;
+  if (TelemetryRcvPhase != ttrpPreReceiveGap || nonce == lastSampleNonce || !FHSSusePrimaryFreqBand || InBindingMode)
+    return;
+
+  uint8_t const channel = FHSSgetCurrChannel();
+  int8_t const rssi = Radio.GetRssiInst(SX12XX_Radio_1);
+  if (TelemetryRcvPhase == ttrpPreReceiveGap && OtaNonce == nonce)
+  {
+    lastSampleNonce = nonce;
+    spectrumScan.addSample(channel, rssi);
+  }
+}
+
+// Only on a new RX session, the RX drops its blacklist in LostConnection() and the TX losing
+// the downlink alone does not change it, so the hops of both ends stay the same
+static void FhssBlacklistReset()
+{
+  FHSSsetBlacklist(nullptr);
+  fhssBlacklistPending = false;
+  fhssBlacklistAnnounce = 0;
+  // Drop an announced switch to the blacklist too, the RX will not be expecting it
+  if (fhssBlacklistSwitch)
+  {
+    fhssBlacklistSwitch = false;
+    adaptiveRateState = arsIdle;
+  }
+  fhssBlacklistSentMs = millis();
+}
+
+// The RX can only echo the blacklist with telemetry, and sending it while there is none
+// would boost the ratio for the MSP at the cost of RC packets
+static bool FhssBlacklistHasDownlink()
+{
+  expresslrs_tlm_ratio_e const ratioConfigured = (expresslrs_tlm_ratio_e)config.GetTlm();
+  return ratioConfigured != TLM_RATIO_NO_TLM && !(ratioConfigured == TLM_RATIO_DISARMED && handset->IsArmed());
+}
+
+/**
+ * Build a blacklist of the noisiest channels from the spectrum scan and send it to the RX
+ * if it has changed. The RX keeps it and echoes the generation back, then the TX announces
+ * the change like an adaptive rate switch to the rate already in use, and both ends change
+ * to the blacklist on the switch nonce.
+ */
+static void FhssBlacklistUpdate(uint32_t now)
+{
+  if (connectionState != connected || InBindingMode)
+    return;
+
+  if (fhssBlacklistPending)
+  {
+    // Sent again once the telemetry is back if it still differs
+    if (now - fhssBlacklistSentMs > FHSS_BLACKLIST_TIMEOUT_MS)
+    {
+      fhssBlacklistPending = false;
+      DBGLN("FHSS blacklist not confirmed");
+    }
+    return;
+  }
+
+  if (fhssBlacklistAnnounce)
+  {
+    // Leave config changes and their sync spam to finish first
+    if (adaptiveRateState == arsIdle && !syncSpamCounter && !config.IsModified())
+    {
+      // Built now, the timer only swaps to it on the switch nonce
+      FHSSprepareBlacklist(&fhssBlacklistMsg[4]);
+      --fhssBlacklistAnnounce;
+      fhssBlacklistSwitch = true;
+      adaptiveRateNextIndex = ExpressLRS_currAirRate_Modparams->index;
+      adaptiveRateState = arsPending;
+    }
+    return;
+  }
+
+  if (now - fhssBlacklistSentMs < FHSS_BLACKLIST_INTERVAL_MS || !FHSSusePrimaryFreqBand || !spectrumScan.isReady()
+    || !FhssBlacklistHasDownlink())
+    return;
+  fhssBlacklistSentMs = now;
+
+  uint8_t blacklist[FHSS_BLACKLIST_BYTES];
+  memcpy(blacklist, FHSSblacklist, sizeof(blacklist));
+  uint8_t const count = spectrumScan.buildBlacklist(blacklist, FHSSgetBlacklistMax(), sync_channel);
+  if (memcmp(blacklist, FHSSblacklist, sizeof(blacklist)) == 0 || MspSender.HasQueuedData())
+    return;
+
+  // The generation skips the values an old RX would take as a CRSF destination address
+  fhssBlacklistMsg[0] = MSP_ELRS_FHSS_BLACKLIST;
+  fhssBlacklistMsg[1] = 2 + FHSS_BLACKLIST_BYTES;
+  fhssBlacklistMsg[2] = MSP_ELRS_FHSS_BLACKLIST_VERSION;
+  fhssBlacklistMsg[3] = (fhssBlacklistMsg[3] % 127) + 1;
+  memcpy(&fhssBlacklistMsg[4], blacklist, sizeof(blacklist));
+  MspSender.QueueDataToTransmit(fhssBlacklistMsg, sizeof(fhssBlacklistMsg));
+  fhssBlacklistPending = true;
+  DBGLN("FHSS blacklist %u channels", count);
+}
+
+static void AdaptiveRateSwitch()
+{
+  // wait until no longer transmitting
+  while (busyTransmitting);
+  // If telemetry was expected the radio is in RX mode, return to normal send mode
+  if (TelemetryRcvPhase != ttrpTransmitting)
+  {
+    Radio.SetTxIdleMode();
+    TelemetryRcvPhase = ttrpTransmitting;
+  }
+
+  DBGLN("Adaptive rate %u->%u", ExpressLRS_currAirRate_Modparams->index, adaptiveRateNextIndex);
+  SetRFLinkRate(adaptiveRateNextIndex, true);
+  adaptiveRate.reset();
+  adaptiveRateState = arsIdle;
+  // The RX waits on the sync channel for a SYNC to restart its timer on the new rate
+  adaptiveRateSwitchMillis = millis();
+  syncSpamCounterAfterRateChange = syncSpamAmountAfterRateChange;
+}
+
+static void AdaptiveRateUpdate(uint32_t now)
+{
+  if (adaptiveRateState == arsSwitching)
+  {
+    AdaptiveRateSwitch();
+    return;
+  }
+
+  if (connectionState != connected)
+  {
+    if (adaptiveRateState == arsPending)
+      adaptiveRateState = arsIdle;
+    adaptiveRate.reset();
+    adaptiveRateConnectedMs = now;
+    return;
+  }
+
+  if (!adaptiveRateNewStats)
+    return;
+  adaptiveRateNewStats = false;
+
+  // The RX LQ counts up from 0 over its 100 packet window after connecting, ignore it until then
+  if (now - adaptiveRateConnectedMs < ExpressLRS_currAirRate_Modparams->interval * 100U / 1000U)
+    return;
+
+  // Leave config changes and their sync spam to finish first
+  if (!config.GetAdaptiveRate() || InBindingMode || config.IsModified() || ModelUpdatePending
+    || syncSpamCounter || adaptiveRateState != arsIdle)
+    return;
+
+  uint8_t const currIndex = ExpressLRS_currAirRate_Modparams->index;
+  expresslrs_mod_settings_s const *rates = get_elrs_airRateConfig(0);
+  uint8_t const slowerIndex = AdaptiveRate_SlowerIndex(rates, RATE_MAX, currIndex);
+  uint8_t const fasterIndex = AdaptiveRate_FasterIndex(rates, RATE_MAX, currIndex, adjustPacketRateForBaud(config.GetRate()));
+
+  adaptive_rate_stats_t stats;
+  stats.uplinkLq = CRSF::LinkStatistics.uplink_Link_quality;
+  stats.downlinkLq = CRSF::LinkStatistics.downlink_Link_quality;
+  stats.rssi = (CRSF::LinkStatistics.active_antenna == 0) ? CRSF::LinkStatistics.uplink_RSSI_1 : CRSF::LinkStatistics.uplink_RSSI_2;
+  stats.snrScaled = adaptiveRateSnrScaled;
+  stats.powerHeadroom = config.GetDynamicPower() && POWERMGNT::currPower() < (PowerLevels_e)config.GetPower();
+
+  adaptive_rate_step_e step = adaptiveRate.update(stats, get_elrs_RFperfParams(currIndex),
+    (fasterIndex != currIndex) ? get_elrs_RFperfParams(fasterIndex) : nullptr);
+
+  uint8_t nextIndex = currIndex;
+  if (step == ADAPTIVE_RATE_SLOWER)
+    nextIndex = slowerIndex;
+  else if (step == ADAPTIVE_RATE_FASTER)
+    nextIndex = fasterIndex;
+
+  if (nextIndex != currIndex)
+  {
+    adaptiveRateNextIndex = nextIndex;
+    adaptiveRateState = arsPending;
+  }
+}
+
 void ModelUpdateReq()
 {
   // Force synspam with the current rate parameters in case already have a connection established
@@ -800,6 +1127,7 @@ static void CheckConfigChangePending()
 
 bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 {
+  CYCLE_STATS_SCOPE(CYCLE_STATS_RXDONE);
   if (LQCalc.currentIsSet())
   {
     return false; // Already received tlm, do not run ProcessTLMpacket() again.
@@ -818,6 +1146,7 @@ bool ICACHE_RAM_ATTR RXdoneISR(SX12xxDriverCommon::rx_status const status)
 
 void ICACHE_RAM_ATTR TXdoneISR()
 {
+  CYCLE_STATS_SCOPE(CYCLE_STATS_TXDONE);
   if (!busyTransmitting)
   {
     return; // Already finished transmission and do not call HandleFHSS() a second time, which may hop the frequency!
@@ -863,6 +1192,7 @@ static void UpdateConnectDisconnectStatus()
       apInputBuffer.flush();
       apOutputBuffer.flush();
       uartInputBuffer.flush();
+      mavlinkTunnel.reset();
 
       VtxTriggerSend();
     }
@@ -935,6 +1265,86 @@ void OnPowerSetCalibration(mspPacket_t *packet)
   hwTimer::resume();
 }
 
+/**
+ * Request: [opcode, first channel]
+ * Response: [opcode, channel count, first channel, then for up to CHANNEL_STATS_MSP_CHANNELS
+ *   channels: count, received, crcErrors, rssi (int8 dBm), snr (int8 RADIO_SNR_SCALE units)]
+ */
+#define CHANNEL_STATS_MSP_CHANNELS 12
+static void OnGetChannelStats(mspPacket_t *packet)
+{
+  uint8_t const first = packet->readByte();
+  CHECK_PACKET_PARSING();
+
+  mspPacket_t out;
+  out.reset();
+  out.makeResponse();
+  out.function = MSP_ELRS_FUNC;
+  out.addByte(MSP_ELRS_GET_CHANNEL_STATS);
+  out.addByte(ChannelStats_ChannelCount());
+  out.addByte(first);
+  for (uint8_t ch = first; ch < ChannelStats_ChannelCount() && ch - first < CHANNEL_STATS_MSP_CHANNELS; ch++)
+  {
+    channel_stats_t stats;
+    ChannelStats_Get(ch, &stats);
+    out.addByte(stats.count);
+    out.addByte(stats.received);
+    out.addByte(stats.crcErrors);
+    out.addByte(stats.rssi);
+    out.addByte(stats.snr);
+  }
+  MSP::sendPacket(&out, TxBackpack);
+}
+
+#if defined(DEBUG_CYCLE_STATS)
+static void mspAddU32(mspPacket_t *packet, uint32_t value)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    packet->addByte(value >> (i * 8));
+}
+
+/**
+ * Request: [opcode, section], section 0xFF resets all the sections instead
+ * Response: [opcode, section, cyclesPerUs, count, min, max, mean (uint32 each),
+ *   histogram (uint16 each, saturated)]
+ */
+static void OnGetCycleStats(mspPacket_t *packet)
+{
+  uint8_t section = packet->readByte();
+  CHECK_PACKET_PARSING();
+
+  if (section == 0xFF)
+  {
+    CycleStats_Reset();
+    return;
+  }
+  if (section >= CYCLE_STATS_SECTION_COUNT)
+    return;
+
+  cycle_stats_t stats;
+  CycleStats_Get((cycleStatsSection_e)section, &stats);
+
+  mspPacket_t out;
+  out.reset();
+  out.makeResponse();
+  out.function = MSP_ELRS_FUNC;
+  out.addByte(MSP_ELRS_GET_CYCLE_STATS);
+  out.addByte(section);
+  out.addByte(CycleStats_CyclesPerUs());
+  mspAddU32(&out, stats.count);
+  mspAddU32(&out, stats.min);
+  mspAddU32(&out, stats.max);
+  mspAddU32(&out, stats.count ? (uint32_t)(stats.total / stats.count) : 0);
+  for (uint8_t i = 0; i < CYCLE_STATS_BUCKETS; i++)
+  {
+    uint16_t const bucket = stats.histogram[i] > UINT16_MAX ? UINT16_MAX : stats.histogram[i];
+    out.addByte(bucket & 0xFF);
+    out.addByte(bucket >> 8);
+  }
+  MSP::sendPacket(&out, TxBackpack);
+}
+#endif
+
 void SendUIDOverMSP()
 {
   MSPDataPackage[0] = MSP_ELRS_BIND;
@@ -963,7 +1373,7 @@ static void EnterBindingMode()
 
   // Start attempting to bind
   // Lock the RF rate and freq while binding
-  SetRFLinkRate(enumRatetoIndex(RATE_BINDING));
+  SetRFLinkRate(enumRatetoIndex(RATE_BINDING), false);
 
   // Start transmitting again
   hwTimer::resume();
@@ -1011,6 +1421,14 @@ void ProcessMSPPacket(uint32_t now, mspPacket_t *packet)
     case MSP_ELRS_POWER_CALI_SET:
       OnPowerSetCalibration(packet);
       break;
+    case MSP_ELRS_GET_CHANNEL_STATS:
+      OnGetChannelStats(packet);
+      break;
+#if defined(DEBUG_CYCLE_STATS)
+    case MSP_ELRS_GET_CYCLE_STATS:
+      OnGetCycleStats(packet);
+      break;
+#endif
     default:
       break;
     }
@@ -1059,14 +1477,13 @@ static void HandleUARTout()
 {
   if (firmwareOptions.is_airport)
   {
-    auto size = apOutputBuffer.size();
-    if (size)
+    const uint8_t *span;
+    uint16_t size;
+    // At most two spans, either side of the wrap
+    while ((size = apOutputBuffer.peekSpan(&span)) != 0)
     {
-      uint8_t buf[size];
-      apOutputBuffer.lock();
-      apOutputBuffer.popBytes(buf, size);
-      apOutputBuffer.unlock();
-      TxUSB->write(buf, size);
+      TxUSB->write(span, size);
+      apOutputBuffer.consume(size);
     }
   }
 }
@@ -1078,14 +1495,13 @@ static void HandleUARTin()
   {
     if (firmwareOptions.is_airport)
     {
-      auto size = std::min(apInputBuffer.free(), (uint16_t)TxUSB->available());
+      // Read straight into the FIFO, the rest is picked up next time if it wraps
+      uint8_t *span;
+      auto size = std::min(apInputBuffer.writeSpan(&span), (uint16_t)TxUSB->available());
       if (size > 0)
       {
-        uint8_t buf[size];
-        TxUSB->readBytes(buf, size);
-        apInputBuffer.lock();
-        apInputBuffer.pushBytes(buf, size);
-        apInputBuffer.unlock();
+        TxUSB->readBytes(span, size);
+        apInputBuffer.commitWrite(size);
       }
     }
     else
@@ -1301,6 +1717,8 @@ void setup()
 
     setupBindingFromConfig();
     FHSSrandomiseFHSSsequence(uidMacSeedGet());
+    spectrumScan.reset(FHSSconfig->freq_count);
+    ChannelStats_Reset(FHSSgetChannelCount());
 
     Radio.RXdoneCallback = &RXdoneISR;
     Radio.TXdoneCallback = &TXdoneISR;
@@ -1414,6 +1832,9 @@ void loop()
   CheckReadyToSend();
   CheckConfigChangePending();
   DynamicPower_Update(now);
+  AdaptiveRateUpdate(now);
+  SpectrumScanUpdate();
+  FhssBlacklistUpdate(now);
   VtxPitmodeSwitchUpdate();
 
   /* Send TLM updates to handset if connected + reporting period
@@ -1435,27 +1856,58 @@ void loop()
       {
         if (config.GetLinkMode() == TX_MAVLINK_MODE)
         {
-          // raw mavlink data - forward to USB rather than handset
-          uint8_t count = CRSFinBuffer[1];
+          // raw mavlink data - forward to USB rather than handset, once the frames
+          // the RX compressed have been rebuilt
+          mavlinkDecoded[0] = CRSFinBuffer[0];
+          mavlinkDecoded[1] = mavlinkDecompressor.decode(CRSFinBuffer + CRSF_FRAME_NOT_COUNTED_BYTES, CRSFinBuffer[1],
+            mavlinkDecoded + CRSF_FRAME_NOT_COUNTED_BYTES);
+          uint8_t count = mavlinkDecoded[1];
           // Convert to CRSF telemetry where we can
-          convert_mavlink_to_crsf_telem(CRSFinBuffer, count, handset);
-          TxUSB->write(CRSFinBuffer + CRSF_FRAME_NOT_COUNTED_BYTES, count);
+          convert_mavlink_to_crsf_telem(mavlinkDecoded, count, handset);
+          TxUSB->write(mavlinkDecoded + CRSF_FRAME_NOT_COUNTED_BYTES, count);
           // If we have a backpack
           if (TxUSB != TxBackpack)
           {
-            sendMAVLinkTelemetryToBackpack(CRSFinBuffer);
+            sendMAVLinkTelemetryToBackpack(mavlinkDecoded);
           }
         }
       }
+      else if (CRSFinBuffer[0] == MSP_ELRS_FHSS_BLACKLIST)
+      {
+        // The RX has the blacklist, announce the switch to it
+        if (fhssBlacklistPending && CRSFinBuffer[3] == fhssBlacklistMsg[3])
+        {
+          fhssBlacklistPending = false;
+          fhssBlacklistAnnounce = FHSS_BLACKLIST_ANNOUNCE;
+        }
+      }
       else
       {
-        // Send all other tlm to handset
-        handset->sendTelemetryToTX(CRSFinBuffer);
-        sendCRSFTelemetryToBackpack(CRSFinBuffer);
+        // Send all other tlm to handset, the RX batches several CRSF frames into each transfer
+        uint8_t const receivedLength = TelemetryReceiver.GetReceivedLength();
+        uint8_t offset = 0;
+        uint8_t frameSize;
+        while ((frameSize = TelemetryBatchFrameSize(CRSFinBuffer, receivedLength, offset)) != 0)
+        {
+          handset->sendTelemetryToTX(CRSFinBuffer + offset);
+          sendCRSFTelemetryToBackpack(CRSFinBuffer + offset);
+          offset += frameSize;
+        }
       }
       TelemetryReceiver.Unlock();
   }
 
+  // The RX has reconnected (a new session in LINKSTATS), whether or not the TX lost the
+  // link. It has forgotten the requests and its FHSS blacklist, and compresses from scratch
+  if (rxReconnected)
+  {
+    rxReconnected = false;
+    mavlinkDecompressor.reset();
+    mavlinkCompressRequested = false;
+    telemetryBatchRequested = false;
+    FhssBlacklistReset();
+  }
+
   // only send msp data when binding is not active
   static bool mspTransferActive = false;
   if (InBindingMode)
@@ -1463,7 +1915,7 @@ void loop()
 #if defined(RADIO_LR1121)
     // Send half of the bind packets on the 2.4GHz domain
     if (BindingSendCount == BindingSpamAmount / 2) {
-      SetRFLinkRate(RATE_DUALBAND_BINDING);
+      SetRFLinkRate(RATE_DUALBAND_BINDING, false);
       // Increment BindingSendCount so that SetRFLinkRate is only called once.
       BindingSendCount++;
     }
@@ -1482,6 +1934,14 @@ void loop()
       CRSF::UnlockMspMessage();
       mspTransferActive = false;
     }
+    // Tell the RX it can batch the telemetry, ahead of any msp package. An RX which
+    // does not know the opcode takes it as a CRSF frame for the TX's address, and drops it
+    else if (!telemetryBatchRequested && connectionState == connected)
+    {
+      static uint8_t telemetryBatchRequest[] = {MSP_ELRS_TELEMETRY_BATCH, 2, TELEMETRY_BATCH_VERSION, CRSF_ADDRESS_CRSF_TRANSMITTER};
+      MspSender.SetDataToTransmit(telemetryBatchRequest, sizeof(telemetryBatchRequest));
+      telemetryBatchRequested = true;
+    }
     // we are not sending so look for next msp package
     else
     {
@@ -1499,22 +1959,39 @@ void loop()
 
   if (config.GetLinkMode() == TX_MAVLINK_MODE)
   {
-    // Use MspSender for MAVLINK uplink data
-    uint8_t *nextPayload = 0;
-    uint8_t nextPlayloadSize = 0;
+    // Parse the GCS stream into frames, leaving the rest in uartInputBuffer while the
+    // tunnel can't take a whole frame so the USB serial is held off
     uint16_t count = uartInputBuffer.size();
-    if (count > 0 && !MspSender.IsActive())
+    while (count > 0 && mavlinkTunnel.free() >= MAVLINK_TUNNEL_MAX_FRAME)
     {
-        count = std::min(count, (uint16_t)CRSF_PAYLOAD_SIZE_MAX);
-        mavlinkSSBuffer[0] = MSP_ELRS_MAVLINK_TLM; // Used on RX to differentiate between std msp opcodes and mavlink
-        mavlinkSSBuffer[1] = count;
-        // Following n bytes are just raw mavlink
+        uint8_t buf[CRSF_MAX_PACKET_LEN];
+        uint16_t const size = std::min(count, (uint16_t)sizeof(buf));
         uartInputBuffer.lock();
-        uartInputBuffer.popBytes(mavlinkSSBuffer + CRSF_FRAME_NOT_COUNTED_BYTES, count);
+        uartInputBuffer.popBytes(buf, size);
         uartInputBuffer.unlock();
-        nextPayload = mavlinkSSBuffer;
-        nextPlayloadSize = count + CRSF_FRAME_NOT_COUNTED_BYTES;
-        MspSender.SetDataToTransmit(nextPayload, nextPlayloadSize);
+        mavlinkTunnel.pushBytes(buf, size);
+        count -= size;
+    }
+
+    // Ask for the downlink to be compressed. An RX which does not know the opcode takes
+    // it as a CRSF frame for the TX's address, and drops it
+    if (!mavlinkCompressRequested && connectionState == connected && !MspSender.HasQueuedData())
+    {
+        static uint8_t mavlinkCompressRequest[] = {MSP_ELRS_MAVLINK_COMPRESS, 2, MAVLINK_COMPRESS_VERSION, CRSF_ADDRESS_CRSF_TRANSMITTER};
+        MspSender.QueueDataToTransmit(mavlinkCompressRequest, sizeof(mavlinkCompressRequest));
+        mavlinkCompressRequested = true;
+    }
+
+    // Use MspSender for MAVLINK uplink data, the next transfer is queued while the
+    // current one is in flight so they go back to back
+    if (mavlinkTunnel.size() > 0 && !MspSender.HasQueuedData())
+    {
+        uint8_t * const nextPayload = mavlinkSSBuffer[mavlinkSSBufferIdx];
+        mavlinkSSBufferIdx ^= 1;
+        nextPayload[0] = MSP_ELRS_MAVLINK_TLM; // Used on RX to differentiate between std msp opcodes and mavlink
+        // Following n bytes are whole mavlink frames where they fit
+        nextPayload[1] = mavlinkTunnel.popChunk(nextPayload + CRSF_FRAME_NOT_COUNTED_BYTES, CRSF_PAYLOAD_SIZE_MAX);
+        MspSender.QueueDataToTransmit(nextPayload, nextPayload[1] + CRSF_FRAME_NOT_COUNTED_BYTES);
     }
   }
 }
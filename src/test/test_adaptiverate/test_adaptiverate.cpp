@@ -0,0 +1,198 @@
+#include <cstdint>
+#include <unity.h>
+#include "AdaptiveRate.h"
+#include "OTA.h"
+
+#define RADIO_TYPE_TEST_FLRC 0
+#define RADIO_TYPE_TEST_LORA 1
+
+// Laid out like the SX128x table, only the fields the ladder uses are set
+static expresslrs_mod_settings_s rates[] = {
+    {0, RADIO_TYPE_TEST_FLRC, RATE_FLRC_2G4_1000HZ,     0, 0, 0, 0, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 1},
+    {1, RADIO_TYPE_TEST_FLRC, RATE_FLRC_2G4_500HZ,      0, 0, 0, 0, TLM_RATIO_1_128, 2,  2000, OTA4_PACKET_SIZE, 1},
+    {2, RADIO_TYPE_TEST_FLRC, RATE_FLRC_2G4_500HZ_DVDA, 0, 0, 0, 0, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 2},
+    {3, RADIO_TYPE_TEST_LORA, RATE_LORA_2G4_500HZ,      0, 0, 0, 0, TLM_RATIO_1_128, 4,  2000, OTA4_PACKET_SIZE, 1},
+    {4, RADIO_TYPE_TEST_LORA, RATE_LORA_2G4_333HZ_8CH,  0, 0, 0, 0, TLM_RATIO_1_128, 4,  3003, OTA8_PACKET_SIZE, 1},
+    {5, RADIO_TYPE_TEST_LORA, RATE_LORA_2G4_250HZ,      0, 0, 0, 0, TLM_RATIO_1_64,  4,  4000, OTA4_PACKET_SIZE, 1},
+    {6, RADIO_TYPE_TEST_LORA, RATE_LORA_2G4_150HZ,      0, 0, 0, 0, TLM_RATIO_1_32,  4,  6666, OTA4_PACKET_SIZE, 1},
+    {7, RADIO_TYPE_TEST_LORA, RATE_LORA_2G4_100HZ_8CH,  0, 0, 0, 0, TLM_RATIO_1_32,  4, 10000, OTA8_PACKET_SIZE, 1},
+    {8, RADIO_TYPE_TEST_LORA, RATE_LORA_2G4_50HZ,       0, 0, 0, 0, TLM_RATIO_1_16,  2, 20000, OTA4_PACKET_SIZE, 1}};
+#define RATE_COUNT (sizeof(rates) / sizeof(rates[0]))
+
+static expresslrs_rf_pref_params_s rf500 = {3, -105, 1507, 2500, 2500, 3, 5000, 20, 38};
+static expresslrs_rf_pref_params_s rf250 = {5, -108, 3300, 3000, 2500, 6, 5000, 12, 38};
+
+static adaptive_rate_stats_t goodStats()
+{
+    adaptive_rate_stats_t stats = {100, 100, -60, 40, false};
+    return stats;
+}
+
+static AdaptiveRate settled()
+{
+    AdaptiveRate ar;
+    adaptive_rate_stats_t stats = goodStats();
+    for (uint8_t i = 0; i < ADAPTIVE_RATE_SETTLE_REPORTS; i++)
+        ar.update(stats, &rf250, &rf500);
+    return ar;
+}
+
+void test_ladder_slower(void)
+{
+    // LoRa 4ch 500 -> 250 -> 150 -> 50, skipping the 8ch rates
+    TEST_ASSERT_EQUAL(5, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 3));
+    TEST_ASSERT_EQUAL(6, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 5));
+    TEST_ASSERT_EQUAL(8, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 6));
+    TEST_ASSERT_EQUAL(8, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 8));
+    // 8ch rates have their own ladder
+    TEST_ASSERT_EQUAL(7, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 4));
+    // FLRC doesn't step into LoRa, DVDA is not part of any ladder
+    TEST_ASSERT_EQUAL(1, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 0));
+    TEST_ASSERT_EQUAL(1, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 1));
+    TEST_ASSERT_EQUAL(2, AdaptiveRate_SlowerIndex(rates, RATE_COUNT, 2));
+}
+
+void test_ladder_faster(void)
+{
+    TEST_ASSERT_EQUAL(6, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 8, 3));
+    TEST_ASSERT_EQUAL(5, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 6, 3));
+    TEST_ASSERT_EQUAL(3, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 5, 3));
+    TEST_ASSERT_EQUAL(3, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 3, 3));
+    // Never faster than the configured rate
+    TEST_ASSERT_EQUAL(6, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 6, 6));
+    TEST_ASSERT_EQUAL(5, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 6, 5));
+    TEST_ASSERT_EQUAL(5, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 5, 5));
+    TEST_ASSERT_EQUAL(4, AdaptiveRate_FasterIndex(rates, RATE_COUNT, 7, 4));
+}
+
+void test_settle_after_reset(void)
+{
+    AdaptiveRate ar;
+    adaptive_rate_stats_t stats = goodStats();
+    stats.uplinkLq = 0;
+    for (uint8_t i = 0; i < ADAPTIVE_RATE_SETTLE_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_SLOWER, ar.update(stats, &rf250, &rf500));
+}
+
+void test_critical_lq_steps_slower_at_once(void)
+{
+    AdaptiveRate ar = settled();
+    adaptive_rate_stats_t stats = goodStats();
+    stats.uplinkLq = ADAPTIVE_RATE_LQ_CRITICAL;
+    // Even with power still to add
+    stats.powerHeadroom = true;
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_SLOWER, ar.update(stats, &rf250, &rf500));
+}
+
+void test_low_rssi_waits_for_power(void)
+{
+    AdaptiveRate ar = settled();
+    adaptive_rate_stats_t stats = goodStats();
+    stats.rssi = rf250.RXsensitivity + 2;
+    stats.powerHeadroom = true;
+    for (uint8_t i = 0; i < 20; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+
+    // Power maxed out, steps slower after the reports agree
+    stats.powerHeadroom = false;
+    for (uint8_t i = 1; i < ADAPTIVE_RATE_SLOWER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_SLOWER, ar.update(stats, &rf250, &rf500));
+}
+
+void test_low_snr_steps_slower(void)
+{
+    AdaptiveRate ar = settled();
+    adaptive_rate_stats_t stats = goodStats();
+    stats.snrScaled = rf250.DynpowerSnrThreshUp;
+    for (uint8_t i = 1; i < ADAPTIVE_RATE_SLOWER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_SLOWER, ar.update(stats, &rf250, &rf500));
+}
+
+void test_average_lq_steps_slower(void)
+{
+    AdaptiveRate ar = settled();
+    adaptive_rate_stats_t stats = goodStats();
+    stats.uplinkLq = 60;
+    adaptive_rate_step_e step = ADAPTIVE_RATE_HOLD;
+    uint8_t reports = 0;
+    while (step == ADAPTIVE_RATE_HOLD && reports < 20)
+    {
+        step = ar.update(stats, &rf250, &rf500);
+        ++reports;
+    }
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_SLOWER, step);
+    // The average has to come down first, a single report isn't enough
+    TEST_ASSERT_GREATER_THAN(ADAPTIVE_RATE_SLOWER_REPORTS, reports);
+    TEST_ASSERT_LESS_THAN(ADAPTIVE_RATE_LQ_SLOWER, ar.getLqAvg());
+}
+
+void test_faster_needs_sustained_margin(void)
+{
+    AdaptiveRate ar = settled();
+    adaptive_rate_stats_t stats = goodStats();
+    for (uint8_t i = 1; i < ADAPTIVE_RATE_FASTER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+
+    // One report without margin for the faster rate starts the count again
+    stats.rssi = rf500.RXsensitivity + ADAPTIVE_RATE_RSSI_MARGIN_FASTER;
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+    stats = goodStats();
+    for (uint8_t i = 1; i < ADAPTIVE_RATE_FASTER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+    TEST_ASSERT_EQUAL(ADAPTIVE_RATE_FASTER, ar.update(stats, &rf250, &rf500));
+}
+
+void test_faster_blocked(void)
+{
+    AdaptiveRate ar = settled();
+    adaptive_rate_stats_t stats = goodStats();
+    // Already at the fastest rate allowed
+    for (uint8_t i = 0; i < 2 * ADAPTIVE_RATE_FASTER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf500, nullptr));
+
+    // Telemetry link is poor
+    stats.downlinkLq = 80;
+    for (uint8_t i = 0; i < 2 * ADAPTIVE_RATE_FASTER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+
+    // SNR too low for the faster rate
+    stats = goodStats();
+    stats.snrScaled = rf500.DynpowerSnrThreshDn - 1;
+    for (uint8_t i = 0; i < 2 * ADAPTIVE_RATE_FASTER_REPORTS; i++)
+        TEST_ASSERT_EQUAL(ADAPTIVE_RATE_HOLD, ar.update(stats, &rf250, &rf500));
+}
+
+void test_rate_switch_nonce(void)
+{
+    TEST_ASSERT_EQUAL(64, OtaRateSwitchNonce(0));
+    TEST_ASSERT_EQUAL(64, OtaRateSwitchNonce(31));
+    TEST_ASSERT_EQUAL(64, OtaRateSwitchNonce(63));
+    TEST_ASSERT_EQUAL(128, OtaRateSwitchNonce(64));
+    TEST_ASSERT_EQUAL(0, OtaRateSwitchNonce(200));
+    TEST_ASSERT_EQUAL(0, OtaRateSwitchNonce(255));
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ladder_slower);
+    RUN_TEST(test_ladder_faster);
+    RUN_TEST(test_settle_after_reset);
+    RUN_TEST(test_critical_lq_steps_slower_at_once);
+    RUN_TEST(test_low_rssi_waits_for_power);
+    RUN_TEST(test_low_snr_steps_slower);
+    RUN_TEST(test_average_lq_steps_slower);
+    RUN_TEST(test_faster_needs_sustained_margin);
+    RUN_TEST(test_faster_blocked);
+    RUN_TEST(test_rate_switch_nonce);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,283 @@
+/**
+ * This file is part of ExpressLRS
+ * See https://github.com/AlessandroAU/ExpressLRS
+ *
+ * Micro-benchmarks of the per-packet hot paths, run with `pio test -e native_bench`.
+ * Each benchmark prints one JSON line:
+ *
+ *   {"bench":"crc14_ota8","ns_per_op":12.3,"bytes_per_op":11,"threshold_ns":250}
+ *
+ * and fails if ns_per_op is over the threshold. The thresholds are an order of
+ * magnitude above a desktop build so only a real regression trips them, scale them
+ * for a slower machine with -D BENCH_THRESHOLD_SCALE=n
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <unity.h>
+
+#include "common.h"
+#include "CRSF.h"
+#include "crc.h"
+#include "FEC.h"
+#include "OTA.h"
+#include "FHSS.h"
+#include "FIFO.h"
+#include "telemetry.h"
+#include "msp2crsf.h"
+#include "crsf2msp.h"
+#include "LQCALC.h"
+
+#if !defined(BENCH_THRESHOLD_SCALE)
+#define BENCH_THRESHOLD_SCALE 1
+#endif
+#define BENCH_OPS       200000
+#define BENCH_ROUNDS    5
+
+CRSF crsf;  // need an instance to provide the fields used by the code under test
+uint32_t ChannelData[CRSF_NUM_CHANNELS];      // Current state of channels, CRSF format
+uint8_t UID[6] = {1,2,3,4,5,6};
+Telemetry telemetry;
+
+static volatile uint32_t benchSink;
+
+/**
+ * Time BENCH_OPS calls of op(i), the best of BENCH_ROUNDS so a context switch
+ * on the host doesn't count against the code under test
+ */
+template <typename OP>
+static void bench(const char *name, uint32_t bytesPerOp, double thresholdNs, OP op)
+{
+    double bestNs = 0;
+    for (unsigned round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        uint32_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < BENCH_OPS; ++i)
+            sink += op(i);
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        benchSink = benchSink + sink;
+        double const nsPerOp = ns / (double)BENCH_OPS;
+        if (round == 0 || nsPerOp < bestNs)
+            bestNs = nsPerOp;
+    }
+
+    double const threshold = thresholdNs * BENCH_THRESHOLD_SCALE;
+    printf("{\"bench\":\"%s\",\"ns_per_op\":%.2f,\"bytes_per_op\":%u,\"threshold_ns\":%.0f}\n",
+        name, bestNs, bytesPerOp, threshold);
+    TEST_ASSERT_TRUE_MESSAGE(bestNs <= threshold, name);
+}
+
+// Packets of pseudo random bytes, so the branches see data like the real thing
+static uint8_t benchData[64][64];
+
+static void fillBenchData()
+{
+    uint32_t seed = 0x12345678;
+    for (auto &row : benchData)
+    {
+        for (uint8_t &b : row)
+        {
+            seed = seed * 1103515245 + 12345;
+            b = seed >> 16;
+        }
+    }
+}
+
+void test_bench_crc()
+{
+    Crc2Byte crc14;
+    crc14.init(14, ELRS_CRC14_POLY);
+    bench("crc14_ota4", OTA4_CRC_CALC_LEN, 250, [&](uint32_t i) {
+        return crc14.calc(benchData[i % 64], OTA4_CRC_CALC_LEN, 0);
+    });
+    bench("crc14_fixed_ota4", OTA4_CRC_CALC_LEN, 250, [](uint32_t i) {
+        return Crc2ByteFixed<14, ELRS_CRC14_POLY>::calc(benchData[i % 64], OTA4_CRC_CALC_LEN, 0);
+    });
+
+    Crc2Byte crc16;
+    crc16.init(16, ELRS_CRC16_POLY);
+    bench("crc16_ota8", OTA8_CRC_CALC_LEN, 250, [&](uint32_t i) {
+        return crc16.calc(benchData[i % 64], OTA8_CRC_CALC_LEN, 0);
+    });
+    bench("crc16_fixed_ota8", OTA8_CRC_CALC_LEN, 250, [](uint32_t i) {
+        return Crc2ByteFixed<16, ELRS_CRC16_POLY>::calc(benchData[i % 64], OTA8_CRC_CALC_LEN, 0);
+    });
+
+    // A 16 channel RC frame
+    GENERIC_CRC8 crsfCrc(CRSF_CRC_POLY);
+    bench("crc8_crsf_rc", CRSF_FRAME_SIZE(sizeof(crsf_channels_t)), 500, [&](uint32_t i) {
+        return crsfCrc.calc(benchData[i % 64], CRSF_FRAME_SIZE(sizeof(crsf_channels_t)));
+    });
+}
+
+void test_bench_fec()
+{
+    static uint8_t encoded[64][14];
+    bench("fec_encode", 8, 500, [](uint32_t i) {
+        FECEncode(benchData[i % 64], encoded[i % 64]);
+        return encoded[i % 64][0];
+    });
+    // Flip a bit in each codeword so the decoder has to correct it
+    for (unsigned i = 0; i < 64; ++i)
+        encoded[i][i % 14] ^= 1 << (i % 8);
+    bench("fec_decode", 8, 1000, [](uint32_t i) {
+        uint8_t decoded[8];
+        FECDecode(encoded[i % 64], decoded);
+        return decoded[0];
+    });
+}
+
+typedef struct {
+    OtaSwitchMode_e mode;
+    uint8_t packetSize;
+    const char *packName;
+    const char *unpackName;
+} bench_serializer_t;
+
+void test_bench_ota_pack()
+{
+    static bench_serializer_t const serializers[] = {
+        { smWideOr8ch, OTA4_PACKET_SIZE, "ota_pack_wide", "ota_unpack_wide" },
+        { smHybridOr16ch, OTA4_PACKET_SIZE, "ota_pack_hybrid8", "ota_unpack_hybrid8" },
+        { smWideOr8ch, OTA8_PACKET_SIZE, "ota_pack_8ch", "ota_unpack_8ch" },
+        { smHybridOr16ch, OTA8_PACKET_SIZE, "ota_pack_16ch", "ota_unpack_16ch" },
+        { sm12ch, OTA8_PACKET_SIZE, "ota_pack_12ch", "ota_unpack_12ch" },
+        { sm16chDelta, OTA8_PACKET_SIZE, "ota_pack_16ch_delta", "ota_unpack_16ch_delta" },
+    };
+
+    static uint32_t channels[64][CRSF_NUM_CHANNELS];
+    for (unsigned i = 0; i < 64; ++i)
+        for (unsigned ch = 0; ch < CRSF_NUM_CHANNELS; ++ch)
+            channels[i][ch] = CRSF_CHANNEL_VALUE_MIN + (i * 37 + ch * 101) % (CRSF_CHANNEL_VALUE_MAX - CRSF_CHANNEL_VALUE_MIN);
+
+    OtaUpdateCrcInitFromUid();
+    for (bench_serializer_t const &s : serializers)
+    {
+        OtaUpdateSerializers(s.mode, s.packetSize);
+        static uint8_t packets[64][OTA8_PACKET_SIZE];
+        bench(s.packName, s.packetSize, 500, [&](uint32_t i) {
+            OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)packets[i % 64];
+            OtaPackChannelData(otaPktPtr, channels[i % 64], false, 0);
+            OtaGeneratePacketCrc(otaPktPtr);
+            return packets[i % 64][1];
+        });
+        bench(s.unpackName, s.packetSize, 500, [&](uint32_t i) {
+            OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)packets[i % 64];
+            uint32_t channelsOut[CRSF_NUM_CHANNELS];
+            uint32_t const valid = OtaValidatePacketCrc(otaPktPtr);
+            OtaUnpackChannelData(otaPktPtr, channelsOut, 0);
+            return valid + channelsOut[i % 4];
+        });
+    }
+}
+
+void test_bench_fhss()
+{
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    bench("fhss_hop", 0, 100, [](uint32_t i) {
+        return FHSSgetNextFreq();
+    });
+}
+
+void test_bench_lqcalc()
+{
+    LQCALC<100> lq;
+    bench("lqcalc_inc", 0, 100, [&](uint32_t i) {
+        lq.inc();
+        if (i & 3)
+            lq.add();
+        return lq.getLQ();
+    });
+}
+
+void test_bench_telemetry()
+{
+    // A battery sensor frame a byte at a time, as it comes from the FC UART
+    uint8_t const battery[] = {0xEC, 10, CRSF_FRAMETYPE_BATTERY_SENSOR, 0, 0, 0, 0, 0, 0, 0, 0, 109};
+    telemetry.ResetState();
+    bench("telemetry_rx_uart_battery", sizeof(battery), 2000, [&](uint32_t i) {
+        uint32_t accepted = 0;
+        for (uint8_t b : battery)
+            accepted += telemetry.RXhandleUARTin(b);
+        return accepted;
+    });
+}
+
+void test_bench_msp()
+{
+    // MSPv2 MSP2_COMMON_SERIAL_CONFIG, 46 bytes
+    static uint8_t const mspFrame[] = {0x24, 0x58, 0x3C, 0x00, 0x0A, 0x10, 0x25, 0x00, 0x04, 0x14, 0x01, 0x00, 0x00,
+        0x00, 0x05, 0x04, 0x00, 0x05, 0x00, 0x40, 0x00, 0x00, 0x00, 0x05, 0x04, 0x00, 0x05, 0x02, 0x00, 0x00, 0x00,
+        0x00, 0x05, 0x04, 0x00, 0x05, 0x05, 0x00, 0x00, 0x00, 0x00, 0x05, 0x04, 0x00, 0x05, 0x7B};
+    static MSP2CROSSFIRE msp2crsf;
+    static CROSSFIRE2MSP crsf2msp;
+
+    bench("msp2crsf_parse", sizeof(mspFrame), 5000, [](uint32_t i) {
+        msp2crsf.parse(mspFrame, sizeof(mspFrame));
+        uint32_t frames = 0;
+        while (msp2crsf.FIFOout.peek() > 0)
+        {
+            uint8_t crsfFrame[CRSF_MAX_PACKET_LEN];
+            uint8_t const size = msp2crsf.FIFOout.pop();
+            msp2crsf.FIFOout.popBytes(crsfFrame, size);
+            ++frames;
+        }
+        return frames;
+    });
+
+    // The CRSF chunks of the same frame, fed back in to rebuild it
+    static uint8_t crsfFrames[4][CRSF_MAX_PACKET_LEN];
+    uint8_t crsfCount = 0;
+    msp2crsf.parse(mspFrame, sizeof(mspFrame));
+    while (msp2crsf.FIFOout.peek() > 0 && crsfCount < 4)
+    {
+        uint8_t const size = msp2crsf.FIFOout.pop();
+        msp2crsf.FIFOout.popBytes(crsfFrames[crsfCount++], size);
+    }
+    bench("crsf2msp_parse", sizeof(mspFrame), 5000, [&](uint32_t i) {
+        for (uint8_t f = 0; f < crsfCount; ++f)
+            crsf2msp.parse(crsfFrames[f]);
+        return crsf2msp.getFrameLen();
+    });
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(mspFrame, crsf2msp.getFrame(), sizeof(mspFrame));
+}
+
+void test_bench_fifo()
+{
+    static FIFO<256> fifo;
+    bench("fifo_push_pop_byte", 1, 100, [](uint32_t i) {
+        fifo.push(i);
+        return fifo.pop();
+    });
+    bench("fifo_push_pop_bytes_16", 16, 500, [](uint32_t i) {
+        uint8_t out[16];
+        fifo.pushBytes(benchData[i % 64], sizeof(out));
+        fifo.popBytes(out, sizeof(out));
+        return out[i % 16];
+    });
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    fillBenchData();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bench_crc);
+    RUN_TEST(test_bench_fec);
+    RUN_TEST(test_bench_ota_pack);
+    RUN_TEST(test_bench_fhss);
+    RUN_TEST(test_bench_lqcalc);
+    RUN_TEST(test_bench_telemetry);
+    RUN_TEST(test_bench_msp);
+    RUN_TEST(test_bench_fifo);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <cstdint>
+#include <unity.h>
+#include "ChannelStats.h"
+
+#define TEST_CHANNELS 40
+
+static void packet(uint8_t channel, bool received, int8_t rssi = -80, int8_t snr = 20)
+{
+    ChannelStats_NextPacket(channel);
+    if (received)
+        ChannelStats_Received(rssi, snr);
+}
+
+void test_channelstats_counts(void)
+{
+    ChannelStats_Reset(TEST_CHANNELS);
+    packet(CHANNEL_STATS_NONE, false);
+    TEST_ASSERT_EQUAL(TEST_CHANNELS, ChannelStats_ChannelCount());
+
+    // 3 of 4 received on channel 5, one of the misses had a bad CRC
+    packet(5, true);
+    packet(5, false);
+    ChannelStats_CrcError();
+    packet(5, true);
+    packet(5, true);
+    // Only counted once the next packet starts
+    channel_stats_t stats;
+    ChannelStats_Get(5, &stats);
+    TEST_ASSERT_EQUAL(3, stats.count);
+    packet(6, false);
+
+    ChannelStats_Get(5, &stats);
+    TEST_ASSERT_EQUAL(4, stats.count);
+    TEST_ASSERT_EQUAL(3, stats.received);
+    TEST_ASSERT_EQUAL(1, stats.crcErrors);
+    TEST_ASSERT_EQUAL(-80, stats.rssi);
+    TEST_ASSERT_EQUAL(20, stats.snr);
+
+    // Other channels untouched, and past the end is zeros
+    ChannelStats_Get(4, &stats);
+    TEST_ASSERT_EQUAL(0, stats.count);
+    ChannelStats_Get(TEST_CHANNELS, &stats);
+    TEST_ASSERT_EQUAL(0, stats.count);
+}
+
+void test_channelstats_history_wraps(void)
+{
+    ChannelStats_Reset(TEST_CHANNELS);
+    for (unsigned i = 0; i < CHANNEL_STATS_HISTORY; i++)
+        packet(2, true);
+    // The misses push the received packets out of the ring
+    for (unsigned i = 0; i < CHANNEL_STATS_HISTORY / 2; i++)
+        packet(2, false);
+    packet(CHANNEL_STATS_NONE, false);
+
+    channel_stats_t stats;
+    ChannelStats_Get(2, &stats);
+    TEST_ASSERT_EQUAL(CHANNEL_STATS_HISTORY, stats.count);
+    TEST_ASSERT_EQUAL(CHANNEL_STATS_HISTORY / 2, stats.received);
+}
+
+void test_channelstats_average(void)
+{
+    ChannelStats_Reset(TEST_CHANNELS);
+    packet(0, true, -100, 0);
+    packet(0, true, -20, 80);
+    // Only the first packet counts if the ISR sees two in one period
+    ChannelStats_Received(0, 0);
+    packet(CHANNEL_STATS_NONE, false);
+
+    channel_stats_t stats;
+    ChannelStats_Get(0, &stats);
+    TEST_ASSERT_EQUAL(2, stats.received);
+    TEST_ASSERT_EQUAL(-90, stats.rssi);
+    TEST_ASSERT_EQUAL(10, stats.snr);
+}
+
+void test_channelstats_reset(void)
+{
+    ChannelStats_Reset(TEST_CHANNELS);
+    packet(1, true);
+    packet(CHANNEL_STATS_NONE, false);
+
+    // Takes effect on the next packet, the one in progress is dropped
+    ChannelStats_Reset(20);
+    packet(1, true);
+    channel_stats_t stats;
+    ChannelStats_Get(1, &stats);
+    TEST_ASSERT_EQUAL(20, ChannelStats_ChannelCount());
+    TEST_ASSERT_EQUAL(0, stats.count);
+
+    // Channels past the new count are not recorded
+    packet(30, true);
+    packet(CHANNEL_STATS_NONE, false);
+    ChannelStats_Get(30, &stats);
+    TEST_ASSERT_EQUAL(0, stats.count);
+    ChannelStats_Get(1, &stats);
+    TEST_ASSERT_EQUAL(1, stats.count);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_channelstats_counts);
+    RUN_TEST(test_channelstats_history_wraps);
+    RUN_TEST(test_channelstats_average);
+    RUN_TEST(test_channelstats_reset);
+    UNITY_END();
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <chrono>
 #include <iostream>
 #include <unity.h>
 #include "ucrc_t.h"
@@ -276,6 +277,90 @@ void test_crc8(void)
     TEST_ASSERT_EQUAL_MESSAGE((int)(crc & 0xFF), c, genMsg(bytes, sizeof(bytes)));
 }
 
+template <uint8_t BITS, uint16_t POLY>
+void test_crc_fixed_compatibility(uint8_t testlen)
+{
+    uint8_t bytes[testlen];
+    for (int i = 0; i < testlen; i++)
+        bytes[i] = random() % 255;
+    uint16_t init = random();
+
+    Crc2Byte ecrc;
+    ecrc.init(BITS, POLY);
+    uint16_t c = ecrc.calc(bytes, testlen, init);
+
+    TEST_ASSERT_EQUAL_MESSAGE(c, (Crc2ByteSlice4<BITS, POLY>::calc(bytes, testlen, init)), genMsg(bytes, testlen));
+    TEST_ASSERT_EQUAL_MESSAGE(c, (Crc2ByteNibble<BITS, POLY>::calc(bytes, testlen, init)), genMsg(bytes, testlen));
+
+    uCRC_t ccrc = uCRC_t("CRC", BITS, POLY, 0, false, false, 0);
+    uint64_t crc = ccrc.get_raw_crc(bytes, testlen, 0);
+    uint32_t mask = (1 << BITS) - 1;
+    TEST_ASSERT_EQUAL_MESSAGE(crc & mask, (Crc2ByteSlice4<BITS, POLY>::calc(bytes, testlen, 0)), genMsg(bytes, testlen));
+}
+
+void test_crc14_fixed_compatibility(void)
+{
+    // Every length through the slicing tail, not just the OTA4 packet size
+    for (int x = 0; x < NUM_ITERATIONS; x++)
+        for (uint8_t len = 0; len <= 13; len++)
+            test_crc_fixed_compatibility<14, ELRS_CRC14_POLY>(len);
+}
+
+void test_crc16_fixed_compatibility(void)
+{
+    for (int x = 0; x < NUM_ITERATIONS; x++)
+        for (uint8_t len = 0; len <= 13; len++)
+            test_crc_fixed_compatibility<16, ELRS_CRC16_POLY>(len);
+}
+
+void test_crc_sumd_fixed_compatibility(void)
+{
+    // SUMD frames are 35 bytes before the CRC
+    for (int x = 0; x < NUM_ITERATIONS; x++)
+        test_crc_fixed_compatibility<16, 0x1021>(35);
+}
+
+#define NUM_BENCH_PACKETS 256
+
+template <typename F>
+static double benchNsPerPacket(uint8_t testlen, F calc)
+{
+    static uint8_t bytes[NUM_BENCH_PACKETS][OTA8_PACKET_SIZE];
+    for (int i = 0; i < NUM_BENCH_PACKETS; i++)
+        for (int j = 0; j < OTA8_PACKET_SIZE; j++)
+            bytes[i][j] = random();
+
+    volatile uint16_t sink = 0;
+    uint32_t rounds = NUM_ITERATIONS;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t r = 0; r < rounds; r++)
+        for (int i = 0; i < NUM_BENCH_PACKETS; i++)
+            sink = sink + calc(bytes[i], testlen);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (double)(rounds * NUM_BENCH_PACKETS);
+}
+
+template <uint8_t BITS, uint16_t POLY>
+static void benchCrc(uint8_t testlen)
+{
+    uCRC_t ucrc = uCRC_t("CRC", BITS, POLY, 0, false, false, 0);
+    Crc2Byte ecrc;
+    ecrc.init(BITS, POLY);
+
+    printf("CRC%u %u bytes, ns/packet: ucrc_t %.1f, Crc2Byte %.1f, Crc2ByteSlice4 %.1f, Crc2ByteNibble %.1f\n", BITS, testlen,
+        benchNsPerPacket(testlen, [&](uint8_t *b, uint8_t l) { return (uint16_t)ucrc.get_raw_crc(b, l, 0); }),
+        benchNsPerPacket(testlen, [&](uint8_t *b, uint8_t l) { return ecrc.calc(b, l, 0); }),
+        benchNsPerPacket(testlen, [](uint8_t *b, uint8_t l) { return Crc2ByteSlice4<BITS, POLY>::calc(b, l, 0); }),
+        benchNsPerPacket(testlen, [](uint8_t *b, uint8_t l) { return Crc2ByteNibble<BITS, POLY>::calc(b, l, 0); }));
+}
+
+void test_crc_benchmark(void)
+{
+    // Only reports, the host is too noisy to assert on timings
+    benchCrc<14, ELRS_CRC14_POLY>(OTA4_CRC_CALC_LEN);
+    benchCrc<16, ELRS_CRC16_POLY>(OTA8_CRC_CALC_LEN);
+}
+
 // Unity setup/teardown
 void setUp() {}
 void tearDown() {}
@@ -290,6 +375,10 @@ int main(int argc, char **argv)
     RUN_TEST(test_crc16_implementation_compatibility);
     RUN_TEST(test_crc16_flip5);
     RUN_TEST(test_crc8);
+    RUN_TEST(test_crc14_fixed_compatibility);
+    RUN_TEST(test_crc16_fixed_compatibility);
+    RUN_TEST(test_crc_sumd_fixed_compatibility);
+    RUN_TEST(test_crc_benchmark);
     UNITY_END();
 #endif
 #ifdef BIG_TEST
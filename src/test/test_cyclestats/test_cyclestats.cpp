@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <unity.h>
+#include "CycleStats.h"
+
+void test_cyclestats_record(void)
+{
+    CycleStats_Reset();
+    CycleStats_Record(CYCLE_STATS_TICK, 300);
+    CycleStats_Record(CYCLE_STATS_TICK, 100);
+    CycleStats_Record(CYCLE_STATS_TICK, 200);
+
+    cycle_stats_t stats;
+    CycleStats_Get(CYCLE_STATS_TICK, &stats);
+    TEST_ASSERT_EQUAL(3, stats.count);
+    TEST_ASSERT_EQUAL(100, stats.min);
+    TEST_ASSERT_EQUAL(300, stats.max);
+    TEST_ASSERT_EQUAL(600, stats.total);
+
+    // Other sections are untouched
+    CycleStats_Get(CYCLE_STATS_TOCK, &stats);
+    TEST_ASSERT_EQUAL(0, stats.count);
+}
+
+void test_cyclestats_histogram(void)
+{
+    CycleStats_Reset();
+    uint32_t const durations[] = {0, 1, 2, 3, 4, 1023, 1024, 1UL << (CYCLE_STATS_BUCKETS - 1), 0xFFFFFFFF};
+    for (uint32_t d : durations)
+        CycleStats_Record(CYCLE_STATS_RXDONE, d);
+
+    cycle_stats_t stats;
+    CycleStats_Get(CYCLE_STATS_RXDONE, &stats);
+    TEST_ASSERT_EQUAL(2, stats.histogram[0]);   // 0, 1
+    TEST_ASSERT_EQUAL(2, stats.histogram[1]);   // 2, 3
+    TEST_ASSERT_EQUAL(1, stats.histogram[2]);   // 4
+    TEST_ASSERT_EQUAL(1, stats.histogram[9]);   // 1023
+    TEST_ASSERT_EQUAL(1, stats.histogram[10]);  // 1024
+    // The last bucket takes everything longer
+    TEST_ASSERT_EQUAL(2, stats.histogram[CYCLE_STATS_BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(0, stats.min);
+    TEST_ASSERT_EQUAL(0xFFFFFFFF, stats.max);
+}
+
+void test_cyclestats_reset_is_deferred(void)
+{
+    CycleStats_Reset();
+    CycleStats_Record(CYCLE_STATS_TXDONE, 500);
+    CycleStats_Reset();
+
+    // Reads as empty straight away, cleared on the next record
+    cycle_stats_t stats;
+    CycleStats_Get(CYCLE_STATS_TXDONE, &stats);
+    TEST_ASSERT_EQUAL(0, stats.count);
+
+    CycleStats_Record(CYCLE_STATS_TXDONE, 40);
+    CycleStats_Get(CYCLE_STATS_TXDONE, &stats);
+    TEST_ASSERT_EQUAL(1, stats.count);
+    TEST_ASSERT_EQUAL(40, stats.min);
+    TEST_ASSERT_EQUAL(40, stats.max);
+    TEST_ASSERT_EQUAL(1, stats.histogram[5]);
+}
+
+void test_cyclestats_scope(void)
+{
+    CycleStats_Reset();
+    {
+        CYCLE_STATS_SCOPE(CYCLE_STATS_PROCESS_PACKET);
+        usleep(1000);
+    }
+
+    cycle_stats_t stats;
+    CycleStats_Get(CYCLE_STATS_PROCESS_PACKET, &stats);
+    TEST_ASSERT_EQUAL(1, stats.count);
+    // Native counts nanoseconds
+    TEST_ASSERT_GREATER_OR_EQUAL(1000000, stats.max);
+}
+
+void test_cyclestats_format(void)
+{
+    char buf[16];
+    CycleStats_Reset();
+    CycleStats_Format(CYCLE_STATS_TIMER, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("-", buf);
+
+    CycleStats_Record(CYCLE_STATS_TIMER, 10000);
+    CycleStats_Record(CYCLE_STATS_TIMER, 30000);
+    CycleStats_Format(CYCLE_STATS_TIMER, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("20/30us", buf);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cyclestats_record);
+    RUN_TEST(test_cyclestats_histogram);
+    RUN_TEST(test_cyclestats_reset_is_deferred);
+    RUN_TEST(test_cyclestats_scope);
+    RUN_TEST(test_cyclestats_format);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,371 @@
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <unity.h>
+#include "FEC.h"
+
+#ifdef BIG_TEST
+#define NUM_ITERATIONS 10000000
+#else
+#define NUM_ITERATIONS 100000
+#endif
+
+// The original bit-at-a-time implementation the transposed one must match
+static void FECEncodeReference(uint8_t *incomingData, uint8_t *FECBuffer)
+{
+    uint8_t encodedBuffer[8 * 2] = {0};
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        encodedBuffer[i * 2 + 0] = HammingTableEncode(incomingData[i] & 0x0F);
+        encodedBuffer[i * 2 + 1] = HammingTableEncode(incomingData[i] >> 4);
+    }
+
+    for (uint8_t i = 0; i < (14 / 2); i++)
+    {
+        for (uint8_t j = 0; j < 8; j++)
+        {
+            FECBuffer[i * 2 + 0] |= ((encodedBuffer[j + 0] >> i) & 0x01) << j;
+            FECBuffer[i * 2 + 1] |= ((encodedBuffer[j + 8] >> i) & 0x01) << j;
+        }
+    }
+}
+
+static void FECDecodeReference(uint8_t *incomingFECBuffer, uint8_t *outgoingData)
+{
+    uint8_t encodedBuffer[16] = {0};
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        for (uint8_t j = 0; j < 7; j++)
+        {
+            encodedBuffer[i + 0] |= ((incomingFECBuffer[j * 2 + 0] >> i) & 0x01) << j;
+            encodedBuffer[i + 8] |= ((incomingFECBuffer[j * 2 + 1] >> i) & 0x01) << j;
+        }
+    }
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        outgoingData[i] =  HammingTableDecode(encodedBuffer[i * 2 + 0]);
+        outgoingData[i] |= HammingTableDecode(encodedBuffer[i * 2 + 1]) << 4;
+    }
+}
+
+static void checkEncode(uint8_t data[8])
+{
+    uint8_t expected[14] = {0};
+    uint8_t actual[14] = {0};
+    FECEncodeReference(data, expected);
+    FECEncode(data, actual);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, sizeof(expected));
+}
+
+static void checkDecode(uint8_t fec[14])
+{
+    uint8_t expected[8];
+    uint8_t actual[8];
+    FECDecodeReference(fec, expected);
+    FECDecode(fec, actual);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, sizeof(expected));
+}
+
+void test_fec_encode_equivalence(void)
+{
+    // The encoding is linear per input byte, so every value in every position
+    // (with the rest random) covers every bit path
+    uint8_t data[8];
+    for (uint8_t pos = 0; pos < sizeof(data); pos++)
+    {
+        for (uint16_t val = 0; val < 256; val++)
+        {
+            for (uint8_t i = 0; i < sizeof(data); i++)
+                data[i] = random();
+            data[pos] = val;
+            checkEncode(data);
+        }
+    }
+
+    for (int x = 0; x < NUM_ITERATIONS; x++)
+    {
+        for (uint8_t i = 0; i < sizeof(data); i++)
+            data[i] = random();
+        checkEncode(data);
+    }
+}
+
+void test_fec_encode_or_into_buffer(void)
+{
+    // FECEncode ORs into the buffer, keep doing so
+    uint8_t data[8] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0};
+    uint8_t expected[14];
+    uint8_t actual[14];
+    memset(expected, 0x81, sizeof(expected));
+    memset(actual, 0x81, sizeof(actual));
+    FECEncodeReference(data, expected);
+    FECEncode(data, actual);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, sizeof(expected));
+}
+
+void test_fec_decode_equivalence(void)
+{
+    uint8_t fec[14];
+    for (uint8_t pos = 0; pos < sizeof(fec); pos++)
+    {
+        for (uint16_t val = 0; val < 256; val++)
+        {
+            for (uint8_t i = 0; i < sizeof(fec); i++)
+                fec[i] = random();
+            fec[pos] = val;
+            checkDecode(fec);
+        }
+    }
+
+    // Arbitrary garbage, the decoders must agree on what they correct it to
+    for (int x = 0; x < NUM_ITERATIONS; x++)
+    {
+        for (uint8_t i = 0; i < sizeof(fec); i++)
+            fec[i] = random();
+        checkDecode(fec);
+    }
+}
+
+void test_fec_roundtrip_single_bit_errors(void)
+{
+    // Any single bit error in the air must be corrected
+    for (int x = 0; x < NUM_ITERATIONS / 112; x++)
+    {
+        uint8_t data[8];
+        for (uint8_t i = 0; i < sizeof(data); i++)
+            data[i] = random();
+
+        uint8_t fec[14] = {0};
+        FECEncode(data, fec);
+        for (uint8_t bit = 0; bit < sizeof(fec) * 8; bit++)
+        {
+            uint8_t decoded[8];
+            fec[bit / 8] ^= 1 << (bit % 8);
+            FECDecode(fec, decoded);
+            fec[bit / 8] ^= 1 << (bit % 8);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+        }
+    }
+}
+
+// Flip bit `bit` of codeword `n`, (FECBuffer byte bit*2 + n/8, bit n%8)
+static void flipCodewordBit(uint8_t fec[14], uint8_t n, uint8_t bit)
+{
+    fec[bit * 2 + n / 8] ^= 1 << (n % 8);
+}
+
+static void encodeRandom(uint8_t data[8], uint8_t fec[14])
+{
+    for (uint8_t i = 0; i < 8; i++)
+        data[i] = random();
+    memset(fec, 0, 14);
+    FECEncode(data, fec);
+}
+
+void test_fec_status_clean(void)
+{
+    uint8_t data[8], fec[14], decoded[8];
+    FECDecodeStatus_s status;
+    encodeRandom(data, fec);
+
+    TEST_ASSERT_EQUAL(FEC_CLEAN, FECDecodeWithStatus(fec, decoded, &status));
+    TEST_ASSERT_EQUAL(0, status.corrected);
+    TEST_ASSERT_EQUAL(0, status.unreliable);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+}
+
+void test_fec_status_reports_syndromes(void)
+{
+    for (uint8_t n = 0; n < 16; n++)
+    {
+        for (uint8_t bit = 0; bit < 7; bit++)
+        {
+            uint8_t data[8], fec[14], decoded[8], plain[8];
+            FECDecodeStatus_s status;
+            encodeRandom(data, fec);
+            flipCodewordBit(fec, n, bit);
+
+            TEST_ASSERT_EQUAL(FEC_CORRECTED, FECDecodeWithStatus(fec, decoded, &status));
+            TEST_ASSERT_EQUAL_HEX16(1 << n, status.corrected);
+            TEST_ASSERT_EQUAL(0, status.unreliable);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+
+            // Same data as the plain decode
+            FECDecode(fec, plain);
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(plain, decoded, sizeof(data));
+        }
+    }
+}
+
+void test_fec_combine_double_errors(void)
+{
+    // Each copy has two errors in a different codeword which a single decode
+    // miscorrects, so neither copy alone would pass the packet CRC
+    for (uint8_t n = 0; n < 16; n++)
+    {
+        for (int x = 0; x < 20; x++)
+        {
+            uint8_t data[8], first[14], second[14], decoded[8];
+            FECDecodeStatus_s status;
+            encodeRandom(data, first);
+            memcpy(second, first, sizeof(second));
+
+            uint8_t const m = (n + 1 + random() % 15) % 16;
+            uint8_t const bit = random() % 7;
+            flipCodewordBit(first, n, bit);
+            flipCodewordBit(first, n, (bit + 1 + random() % 6) % 7);
+            flipCodewordBit(second, m, bit);
+            flipCodewordBit(second, m, (bit + 1 + random() % 6) % 7);
+
+            FECDecodeWithStatus(first, decoded, &status);
+            TEST_ASSERT_FALSE(memcmp(data, decoded, sizeof(data)) == 0);
+            FECDecodeWithStatus(second, decoded, &status);
+            TEST_ASSERT_FALSE(memcmp(data, decoded, sizeof(data)) == 0);
+
+            TEST_ASSERT_EQUAL(FEC_CLEAN, FECDecodeCombine(first, second, decoded, &status));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+        }
+    }
+}
+
+void test_fec_combine_erasures(void)
+{
+    // Both copies of a codeword damaged in different bits, the disagreeing
+    // bits are filled in from the bits they agree on
+    for (uint8_t n = 0; n < 16; n++)
+    {
+        for (uint8_t bitA = 0; bitA < 7; bitA++)
+        {
+            for (uint8_t bitB = 0; bitB < 7; bitB++)
+            {
+                if (bitA == bitB)
+                    continue;
+                uint8_t data[8], first[14], second[14], decoded[8];
+                FECDecodeStatus_s status;
+                encodeRandom(data, first);
+                memcpy(second, first, sizeof(second));
+                flipCodewordBit(first, n, bitA);
+                flipCodewordBit(second, n, bitB);
+
+                TEST_ASSERT_EQUAL(FEC_CORRECTED, FECDecodeCombine(first, second, decoded, &status));
+                TEST_ASSERT_EQUAL_HEX16(1 << n, status.corrected);
+                TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+            }
+        }
+    }
+}
+
+void test_fec_combine_one_clean_copy(void)
+{
+    uint8_t data[8], first[14], second[14], decoded[8];
+    FECDecodeStatus_s status;
+    encodeRandom(data, first);
+    memcpy(second, first, sizeof(second));
+    // Trash the first copy of every codeword
+    for (uint8_t n = 0; n < 16; n++)
+    {
+        flipCodewordBit(first, n, n % 7);
+        flipCodewordBit(first, n, (n + 3) % 7);
+    }
+
+    TEST_ASSERT_EQUAL(FEC_CLEAN, FECDecodeCombine(first, second, decoded, &status));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+    TEST_ASSERT_EQUAL(FEC_CLEAN, FECDecodeCombine(second, first, decoded, &status));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, decoded, sizeof(data));
+}
+
+void test_fec_combine_different_packets(void)
+{
+    uint8_t data[8], first[14], second[14], decoded[8];
+    FECDecodeStatus_s status;
+    encodeRandom(data, first);
+    encodeRandom(data, second);
+    TEST_ASSERT_EQUAL(FEC_UNRELIABLE, FECDecodeCombine(first, second, decoded, &status));
+    TEST_ASSERT_NOT_EQUAL(0, status.unreliable);
+}
+
+void test_fec_combine_random_errors(void)
+{
+    // At a 3% bit error rate combining must recover more packets than
+    // picking whichever copy decodes correctly
+    int singleOk = 0;
+    int eitherOk = 0;
+    int combinedOk = 0;
+    for (int x = 0; x < NUM_ITERATIONS / 10; x++)
+    {
+        uint8_t data[8], first[14], second[14], decoded[8];
+        FECDecodeStatus_s status;
+        encodeRandom(data, first);
+        memcpy(second, first, sizeof(second));
+        for (uint8_t bit = 0; bit < 14 * 8; bit++)
+        {
+            if (random() % 100 < 3)
+                first[bit / 8] ^= 1 << (bit % 8);
+            if (random() % 100 < 3)
+                second[bit / 8] ^= 1 << (bit % 8);
+        }
+
+        FECDecodeWithStatus(first, decoded, &status);
+        bool const firstOk = memcmp(data, decoded, sizeof(data)) == 0;
+        FECDecodeWithStatus(second, decoded, &status);
+        bool const secondOk = memcmp(data, decoded, sizeof(data)) == 0;
+        singleOk += firstOk;
+        eitherOk += firstOk || secondOk;
+        FECDecodeCombine(first, second, decoded, &status);
+        combinedOk += memcmp(data, decoded, sizeof(data)) == 0;
+    }
+    printf("%d single, %d either copy, %d combined decodes correct out of %d\n", singleOk, eitherOk, combinedOk, NUM_ITERATIONS / 10);
+    TEST_ASSERT_GREATER_THAN(eitherOk, combinedOk);
+}
+
+template <typename F>
+static double benchNsPerPacket(F fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int x = 0; x < NUM_ITERATIONS; x++)
+        fn(x);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (double)NUM_ITERATIONS;
+}
+
+void test_fec_benchmark(void)
+{
+    // Only reports, the host is too noisy to assert on timings
+    static uint8_t data[256][8];
+    static uint8_t fec[256][14];
+    for (int i = 0; i < 256; i++)
+        for (int j = 0; j < 8; j++)
+            data[i][j] = random();
+
+    double encRef = benchNsPerPacket([](int x) { memset(fec[x & 0xFF], 0, 14); FECEncodeReference(data[x & 0xFF], fec[x & 0xFF]); });
+    double enc = benchNsPerPacket([](int x) { memset(fec[x & 0xFF], 0, 14); FECEncode(data[x & 0xFF], fec[x & 0xFF]); });
+    double decRef = benchNsPerPacket([](int x) { FECDecodeReference(fec[x & 0xFF], data[x & 0xFF]); });
+    double dec = benchNsPerPacket([](int x) { FECDecode(fec[x & 0xFF], data[x & 0xFF]); });
+
+    printf("ns/packet: encode %.1f (was %.1f), decode %.1f (was %.1f)\n", enc, encRef, dec, decRef);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fec_encode_equivalence);
+    RUN_TEST(test_fec_encode_or_into_buffer);
+    RUN_TEST(test_fec_decode_equivalence);
+    RUN_TEST(test_fec_roundtrip_single_bit_errors);
+    RUN_TEST(test_fec_status_clean);
+    RUN_TEST(test_fec_status_reports_syndromes);
+    RUN_TEST(test_fec_combine_double_errors);
+    RUN_TEST(test_fec_combine_erasures);
+    RUN_TEST(test_fec_combine_one_clean_copy);
+    RUN_TEST(test_fec_combine_different_packets);
+    RUN_TEST(test_fec_combine_random_errors);
+    RUN_TEST(test_fec_benchmark);
+    UNITY_END();
+
+    return 0;
+}
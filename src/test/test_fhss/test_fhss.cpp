@@ -1,8 +1,10 @@
 #include <cstdint>
+#include <cstring>
 #include <SX1280_Regs.h>
 #include <FHSS.h>
 #include <unity.h>
 #include <set>
+#include "options.h"
 
 void test_fhss_first(void)
 {
@@ -84,6 +86,191 @@ void test_fhss_reg_same(void)
     }
 }
 
+// The per hop calculations from before the frequency tables, as the reference
+static uint32_t oldGetNextFreq(uint8_t &ptr)
+{
+    ptr = (ptr + 1) % FHSSgetSequenceCount();
+
+    if (FHSSusePrimaryFreqBand)
+    {
+        return FHSSconfig->freq_start + (freq_spread * FHSSsequence[ptr] / FREQ_SPREAD_SCALE) - FreqCorrection;
+    }
+    else
+    {
+        return FHSSconfigDualBand->freq_start + (freq_spread_DualBand * FHSSsequence_DualBand[ptr] / FREQ_SPREAD_SCALE);
+    }
+}
+
+static uint32_t oldGetGeminiFreq(uint8_t ptr)
+{
+    if (FHSSuseDualBand)
+    {
+        return FHSSconfigDualBand->freq_start + (FHSSsequence_DualBand[ptr] * freq_spread_DualBand / FREQ_SPREAD_SCALE);
+    }
+    if (FHSSusePrimaryFreqBand)
+    {
+        return FHSSGeminiFreq(FHSSsequence[ptr]);
+    }
+    return FHSSGeminiFreq(FHSSsequence_DualBand[ptr]);
+}
+
+void test_fhss_table_matches_calculation(void)
+{
+    const uint8_t savedDomain = firmwareOptions.domain;
+    const int32_t corrections[] = {0, 37, -1234};
+
+    for (uint8_t domain = 0; domain < FHSSdomainCount; domain++)
+    {
+        firmwareOptions.domain = domain;
+        for (uint32_t seed = 0; seed < 16; seed++)
+        {
+            FHSSrandomiseFHSSsequence(seed * 0x9E3779B9);
+            TEST_ASSERT_EQUAL(FHSSgetSequenceCount(), FHSSsequenceCount);
+
+            for (const int32_t correction : corrections)
+            {
+                FreqCorrection = correction;
+                FreqCorrection_2 = -correction / 2;
+                FHSSsetCurrIndex(0);
+                uint8_t ptr = 0;
+
+                // Twice around the sequence to cover the wrap
+                for (unsigned i = 0; i < 2 * FHSSsequenceCount; i++)
+                {
+                    uint32_t const expected = oldGetNextFreq(ptr);
+                    TEST_ASSERT_EQUAL_UINT32(expected, FHSSgetNextFreq());
+                    TEST_ASSERT_EQUAL_UINT8(ptr, FHSSgetCurrIndex());
+                    TEST_ASSERT_EQUAL_UINT32(oldGetGeminiFreq(ptr), FHSSgetGeminiFreq());
+                }
+
+                // The pointer can run past the end of the sequence while hops are skipped
+                FHSSptr = 250;
+                ptr = 250;
+                TEST_ASSERT_EQUAL_UINT32(oldGetNextFreq(ptr), FHSSgetNextFreq());
+                TEST_ASSERT_EQUAL_UINT8(ptr, FHSSgetCurrIndex());
+            }
+        }
+    }
+
+    FreqCorrection = 0;
+    FreqCorrection_2 = 0;
+    firmwareOptions.domain = savedDomain;
+}
+
+static uint8_t channelOfFreq(uint32_t freq)
+{
+    return ((freq - FHSSconfig->freq_start) * FREQ_SPREAD_SCALE + freq_spread / 2) / freq_spread;
+}
+
+void test_fhss_blacklist_avoided(void)
+{
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    const uint8_t max = FHSSgetBlacklistMax();
+    TEST_ASSERT_TRUE(max > 0);
+
+    // The sync channel and the channels either side of it, then as many more as are allowed
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES] = {0};
+    for (uint8_t ch = sync_channel - 1; ch < FHSSconfig->freq_count; ch++)
+        blacklist[ch / 8] |= 1 << (ch % 8);
+    FHSSsetBlacklist(blacklist);
+
+    // The sync channel is never blacklisted, and no more than the max are
+    TEST_ASSERT_FALSE(FHSSisBlacklisted(FHSSblacklist, sync_channel));
+    unsigned count = 0;
+    for (uint8_t ch = 0; ch < FHSS_BLACKLIST_BYTES * 8; ch++)
+        count += FHSSisBlacklisted(FHSSblacklist, ch) ? 1 : 0;
+    TEST_ASSERT_EQUAL(max, count);
+
+    // No hop lands on a blacklisted channel, or on the same channel as the hop before
+    uint8_t prev = channelOfFreq(FHSSfreqs[FHSSsequenceCount - 1]);
+    for (unsigned i = 0; i < FHSSsequenceCount; i++)
+    {
+        const uint8_t ch = channelOfFreq(FHSSfreqs[i]);
+        TEST_ASSERT_FALSE(FHSSisBlacklisted(FHSSblacklist, ch));
+        TEST_ASSERT_NOT_EQUAL(prev, ch);
+        if (FHSSsequence[i] == sync_channel)
+            TEST_ASSERT_EQUAL(sync_channel, ch);
+        else if (!FHSSisBlacklisted(FHSSblacklist, FHSSsequence[i]))
+            TEST_ASSERT_EQUAL(FHSSsequence[i], ch);
+        prev = ch;
+    }
+
+    // The current channel follows the hops
+    FHSSsetCurrIndex(0);
+    for (unsigned i = 0; i < FHSSsequenceCount; i++)
+    {
+        TEST_ASSERT_EQUAL(channelOfFreq(FHSSfreqs[i]), FHSSgetCurrChannel());
+        FHSSgetNextFreq();
+    }
+
+    // Clearing it puts the sequence back
+    FHSSsetBlacklist(nullptr);
+    for (unsigned i = 0; i < FHSSsequenceCount; i++)
+        TEST_ASSERT_EQUAL(FHSSsequence[i], channelOfFreq(FHSSfreqs[i]));
+}
+
+void test_fhss_blacklist_changed_in_place(void)
+{
+    // Going from one blacklist to another gives the same hops as setting it on a new sequence
+    uint8_t first[FHSS_BLACKLIST_BYTES] = {0x0F};
+    uint8_t second[FHSS_BLACKLIST_BYTES] = {0x0C, 0x30};
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    FHSSsetBlacklist(second);
+    uint32_t expected[FHSS_SEQUENCE_LEN];
+    memcpy(expected, FHSSfreqs, sizeof(uint32_t) * FHSSsequenceCount);
+
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    FHSSsetBlacklist(first);
+    FHSSsetBlacklist(second);
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, FHSSfreqs, FHSSsequenceCount);
+}
+
+void test_fhss_blacklist_swapped(void)
+{
+    // Preparing a blacklist leaves the hops in use alone until it is swapped in, once
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES] = {0x0F};
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    FHSSsetBlacklist(blacklist);
+    uint32_t expected[FHSS_SEQUENCE_LEN];
+    memcpy(expected, FHSSfreqs, sizeof(uint32_t) * FHSSsequenceCount);
+
+    FHSSsetBlacklist(nullptr);
+    FHSSprepareBlacklist(blacklist);
+    TEST_ASSERT_FALSE(FHSSisBlacklisted(FHSSblacklist, 0));
+    for (unsigned i = 0; i < FHSSsequenceCount; i++)
+        TEST_ASSERT_EQUAL(FHSSsequence[i], channelOfFreq(FHSSfreqs[i]));
+
+    TEST_ASSERT_TRUE(FHSSswapBlacklist());
+    TEST_ASSERT_TRUE(FHSSisBlacklisted(FHSSblacklist, 0));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, FHSSfreqs, FHSSsequenceCount);
+    TEST_ASSERT_FALSE(FHSSswapBlacklist());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, FHSSfreqs, FHSSsequenceCount);
+
+    // A prepared blacklist follows a change of band mode, and a new sequence drops it
+    FHSSprepareBlacklist(nullptr);
+    FHSSsetBandMode(true, false);
+    TEST_ASSERT_TRUE(FHSSswapBlacklist());
+    for (unsigned i = 0; i < FHSSsequenceCount; i++)
+        TEST_ASSERT_EQUAL(FHSSsequence[i], channelOfFreq(FHSSfreqs[i]));
+    FHSSprepareBlacklist(blacklist);
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    TEST_ASSERT_FALSE(FHSSswapBlacklist());
+    TEST_ASSERT_FALSE(FHSSisBlacklisted(FHSSblacklist, 0));
+}
+
+void test_fhss_blacklist_cleared_by_new_sequence(void)
+{
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES] = {0x03};
+    FHSSsetBlacklist(blacklist);
+    TEST_ASSERT_TRUE(FHSSisBlacklisted(FHSSblacklist, 0));
+
+    FHSSrandomiseFHSSsequence(0x01020304L);
+    TEST_ASSERT_FALSE(FHSSisBlacklisted(FHSSblacklist, 0));
+    for (unsigned i = 0; i < FHSSsequenceCount; i++)
+        TEST_ASSERT_EQUAL(FHSSsequence[i], channelOfFreq(FHSSfreqs[i]));
+}
+
 // Unity setup/teardown
 void setUp() {}
 void tearDown() {}
@@ -96,6 +283,11 @@ int main(int argc, char **argv)
     RUN_TEST(test_fhss_unique);
     RUN_TEST(test_fhss_same);
     RUN_TEST(test_fhss_reg_same);
+    RUN_TEST(test_fhss_table_matches_calculation);
+    RUN_TEST(test_fhss_blacklist_avoided);
+    RUN_TEST(test_fhss_blacklist_changed_in_place);
+    RUN_TEST(test_fhss_blacklist_swapped);
+    RUN_TEST(test_fhss_blacklist_cleared_by_new_sequence);
     UNITY_END();
 
     return 0;
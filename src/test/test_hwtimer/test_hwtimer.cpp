@@ -0,0 +1,185 @@
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <unity.h>
+#include "hwTimer.h"
+#include "PFD.h"
+#include "PhaseLock.h"
+
+#define RX_TICKS_PER_US 5
+
+void test_hwtimer_freq_offset_units(void)
+{
+    // Over 256 half intervals a FreqOffset adds exactly freqOffset * unitsPerUs / 256 each
+    int32_t const offsets[] = {0, 1, 51, 255, 256, 1000, -1, -51, -1000};
+    for (int32_t freqOffset : offsets)
+    {
+        int32_t residue = 0;
+        int32_t total = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            int32_t units = hwTimerFreqOffsetUnits(freqOffset, RX_TICKS_PER_US, residue);
+            // Never more than one unit from the exact value
+            TEST_ASSERT_INT_WITHIN(1, freqOffset * RX_TICKS_PER_US / 256, units);
+            TEST_ASSERT_GREATER_OR_EQUAL(0, residue);
+            TEST_ASSERT_LESS_THAN(256, residue);
+            total += units;
+        }
+        TEST_ASSERT_EQUAL(freqOffset * RX_TICKS_PER_US, total);
+        TEST_ASSERT_EQUAL(0, residue);
+    }
+
+    // The ESP8266 counts CPU cycles
+    int32_t residue = 0;
+    int32_t total = 0;
+    for (int i = 0; i < 256; ++i)
+        total += hwTimerFreqOffsetUnits(-77, 80, residue);
+    TEST_ASSERT_EQUAL(-77 * 80, total);
+}
+
+/***
+ * An hour of a 500Hz link. The TX crystal is off by `ppm` relative to the RX, packet
+ * times come from the TX clock and the RX hwTimer (TARGET_RX callback()) is modelled
+ * tick for tick. The true phase error is tracked exactly, the PFD only sees whole
+ * microseconds as micros() does.
+ ***/
+#define SIM_INTERVAL_US 2000
+#define SIM_PACKETS     (3600U * 1000000U / SIM_INTERVAL_US)
+
+typedef struct {
+    double maxErrUs;        // |tock - packet| after the first second
+    double finalErrUs;
+    double meanFreqOffset;  // after the first second
+} drift_result_t;
+
+/**
+ * @param closedLoop run PhaseLock, otherwise freewheel on a fixed FreqOffset
+ * @param freqOffset FreqOffset when freewheeling
+ * @param quantum round the PhaseLock FreqOffset to multiples of this, 256 / RX_TICKS_PER_US
+ * behaves as FreqOffset did in whole timer ticks
+ */
+static drift_result_t simulateHour(double ppm, bool closedLoop, int32_t freqOffset, int32_t quantum)
+{
+    drift_result_t res = {0, 0, 0};
+    int64_t freqOffsetSum = 0;
+    uint32_t freqOffsetCount = 0;
+    PFD pfd;
+    PhaseLock pl;
+
+    double const txInterval = SIM_INTERVAL_US * (1.0 + ppm / 1e6);
+    int64_t const halfTicks = SIM_INTERVAL_US * RX_TICKS_PER_US / 2;
+    int64_t timerTicks = 0; // time of the next timer event, the first is a tock at 0
+    int32_t residue = 0;
+    int32_t phaseShift = 0;
+    bool isTick = false;
+    uint32_t packet = 0;
+    uint32_t tock = 0;
+    uint32_t const settledPackets = 1000000 / SIM_INTERVAL_US;
+
+    while (packet < SIM_PACKETS)
+    {
+        double const pktTime = packet * txInterval;
+        if (pktTime * RX_TICKS_PER_US < timerTicks)
+        {
+            pfd.extEvent((uint32_t)pktTime);
+            ++packet;
+            continue;
+        }
+
+        // hwTimer::callback()
+        double const now = (double)timerTicks / RX_TICKS_PER_US;
+        int64_t nextInterval = halfTicks + hwTimerFreqOffsetUnits(freqOffset, RX_TICKS_PER_US, residue);
+        if (packet > settledPackets)
+        {
+            freqOffsetSum += freqOffset;
+            ++freqOffsetCount;
+        }
+        if (!isTick)
+        {
+            nextInterval += phaseShift;
+            phaseShift = 0;
+        }
+        timerTicks += nextInterval;
+
+        if (isTick)
+        {
+            if (closedLoop && pfd.hasResult())
+            {
+                phaseShift = pl.update(pfd.calcResult(), packet < settledPackets) * RX_TICKS_PER_US;
+                freqOffset = pl.getFreqOffset() / quantum * quantum;
+            }
+            pfd.reset();
+        }
+        else
+        {
+            pfd.intEvent((uint32_t)now);
+            // Each tock is aligned to the packet of the same number
+            double const err = fabs(now - tock * txInterval);
+            ++tock;
+            if (packet > settledPackets && err > res.maxErrUs)
+                res.maxErrUs = err;
+            res.finalErrUs = err;
+        }
+        isTick = !isTick;
+    }
+
+    res.meanFreqOffset = (double)freqOffsetSum / freqOffsetCount;
+    return res;
+}
+
+// FreqOffset matching a TX with the given crystal error
+static double idealFreqOffset(double ppm)
+{
+    return SIM_INTERVAL_US / 2 * ppm / 1e6 * (1 << HWTIMER_FREQ_OFFSET_FRAC_BITS);
+}
+
+void test_hwtimer_drift_hour_freewheel(void)
+{
+    // Start aligned on the ideal FreqOffset for the crystal error, with no phase
+    // corrections the timer only drifts by the rounding of FreqOffset to 1/256us
+    double const ppm = 37.3;
+    double const idealUnits = idealFreqOffset(ppm);
+    int32_t const freqOffset = lround(idealUnits);
+    drift_result_t const res = simulateHour(ppm, false, freqOffset, 1);
+
+    double const bound = 2.0 * SIM_PACKETS * fabs(idealUnits - freqOffset) / 256 + 1.0;
+    printf("freewheel %.1fppm: FreqOffset=%d drift after 1h=%.1fus bound=%.1fus, with whole ticks up to %.0fus\n",
+        ppm, freqOffset, res.finalErrUs, bound, 2.0 * SIM_PACKETS * 0.5 / RX_TICKS_PER_US);
+    TEST_ASSERT_LESS_OR_EQUAL(bound, res.finalErrUs);
+}
+
+static void assertHourLocked(double ppm)
+{
+    drift_result_t const frac = simulateHour(ppm, true, 0, 1);
+    drift_result_t const ticks = simulateHour(ppm, true, 0, 256 / RX_TICKS_PER_US);
+    printf("locked %+.1fppm: ideal FreqOffset=%.2f | 1/256us max=%.2fus mean FreqOffset=%.2f | whole ticks max=%.2fus mean FreqOffset=%.2f\n",
+        ppm, idealFreqOffset(ppm), frac.maxErrUs, frac.meanFreqOffset, ticks.maxErrUs, ticks.meanFreqOffset);
+
+    // Within the 1us resolution of micros() for the whole hour, with the timer running
+    // at the TX rate rather than being pulled back by the phase path
+    TEST_ASSERT_LESS_THAN(1.5, frac.maxErrUs);
+    TEST_ASSERT_LESS_OR_EQUAL(ticks.maxErrUs, frac.maxErrUs);
+    TEST_ASSERT_FLOAT_WITHIN(1.0, idealFreqOffset(ppm), frac.meanFreqOffset);
+}
+
+void test_hwtimer_drift_hour_locked(void)
+{
+    assertHourLocked(37.3);
+    assertHourLocked(-80.0);
+    assertHourLocked(3.1);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_hwtimer_freq_offset_units);
+    RUN_TEST(test_hwtimer_drift_hour_freewheel);
+    RUN_TEST(test_hwtimer_drift_hour_locked);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,1338 @@
+/**
+ * This file is part of ExpressLRS
+ * See https://github.com/AlessandroAU/ExpressLRS
+ *
+ * Host-side OTA link model, see linksim.h
+ */
+#include "linksim.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "FHSS.h"
+#include "SX1280Driver.h"
+#include "hwTimer.h"
+#include "MAVLinkTunnel.h"
+
+#define LINKSIM_PACKET_TO_TOCK_SLACK 200    // PACKET_TO_TOCK_SLACK in rx_main.cpp
+#define LINKSIM_CONSIDER_CONN_GOOD_MS 1000  // ConsiderConnGoodMillis in rx_main.cpp
+#define LINKSIM_RF_MODE_CYCLE_MULTIPLIER_SLOW 10
+#define LINKSIM_SYNC_SPAM_AMOUNT    3       // syncSpamAmount in tx_main.cpp
+#define LINKSIM_FHSS_BLACKLIST_INTERVAL_MS 5000 // FHSS_BLACKLIST_INTERVAL_MS in tx_main.cpp
+#define LINKSIM_FHSS_BLACKLIST_TIMEOUT_MS 10000 // FHSS_BLACKLIST_TIMEOUT_MS in tx_main.cpp
+#define LINKSIM_FHSS_BLACKLIST_ANNOUNCE 2   // FHSS_BLACKLIST_ANNOUNCE in tx_main.cpp
+#define LINKSIM_SYNC_SPAM_AMOUNT_AFTER_RATE_CHANGE 10 // syncSpamAmountAfterRateChange in tx_main.cpp
+#define LINKSIM_MAVLINK_HEARTBEAT_LEN 9
+#define LINKSIM_MAVLINK_HEARTBEAT_CRC_EXTRA 50
+#define LINKSIM_LOOP_INTERVAL_US    1000
+#define LINKSIM_AIR_SLOTS           (sizeof(_air) / sizeof(_air[0]))
+
+expresslrs_mod_settings_s LinkSimAirRateConfig[LINKSIM_RATE_COUNT] = {
+    {0, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_1000HZ,     SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 1},
+    {1, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_500HZ,      SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  2000, OTA4_PACKET_SIZE, 1},
+    {2, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_500HZ_DVDA, SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 2},
+    {3, RADIO_TYPE_SX128x_FLRC, RATE_FLRC_2G4_250HZ_DVDA, SX1280_FLRC_BR_0_650_BW_0_6, SX1280_FLRC_BT_1, SX1280_FLRC_CR_1_2,    32, TLM_RATIO_1_128, 2,  1000, OTA4_PACKET_SIZE, 4},
+    {4, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_500HZ,      SX1280_LORA_BW_0800,         SX1280_LORA_SF5,  SX1280_LORA_CR_LI_4_6, 12, TLM_RATIO_1_128, 4,  2000, OTA4_PACKET_SIZE, 1},
+    {5, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_333HZ_8CH,  SX1280_LORA_BW_0800,         SX1280_LORA_SF5,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_128, 4,  3003, OTA8_PACKET_SIZE, 1},
+    {6, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_250HZ,      SX1280_LORA_BW_0800,         SX1280_LORA_SF6,  SX1280_LORA_CR_LI_4_8, 14, TLM_RATIO_1_64,  4,  4000, OTA4_PACKET_SIZE, 1},
+    {7, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_150HZ,      SX1280_LORA_BW_0800,         SX1280_LORA_SF7,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_32,  4,  6666, OTA4_PACKET_SIZE, 1},
+    {8, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_100HZ_8CH,  SX1280_LORA_BW_0800,         SX1280_LORA_SF7,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_32,  4, 10000, OTA8_PACKET_SIZE, 1},
+    {9, RADIO_TYPE_SX128x_LORA, RATE_LORA_2G4_50HZ,       SX1280_LORA_BW_0800,         SX1280_LORA_SF8,  SX1280_LORA_CR_LI_4_8, 12, TLM_RATIO_1_16,  2, 20000, OTA4_PACKET_SIZE, 1}};
+
+expresslrs_rf_pref_params_s LinkSimAirRateRFperf[LINKSIM_RATE_COUNT] = {
+    {0, -104,   389, 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {1, -104,   389, 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {2, -104,   389, 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {3, -104,   389, 2500, 2500,  3, 5000, DYNPOWER_SNR_THRESH_NONE, DYNPOWER_SNR_THRESH_NONE},
+    {4, -105,  1507, 2500, 2500,  3, 5000, SNR_SCALE( 5), SNR_SCALE(9.5)},
+    {5, -105,  2374, 2500, 2500,  4, 5000, SNR_SCALE( 5), SNR_SCALE(9.5)},
+    {6, -108,  3300, 3000, 2500,  6, 5000, SNR_SCALE( 3), SNR_SCALE(9.5)},
+    {7, -112,  5871, 3500, 2500, 10, 5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {8, -112,  7605, 3500, 2500, 11, 5000, SNR_SCALE( 0), SNR_SCALE(8.5)},
+    {9, -115, 10798, 4000, 2500,  0, 5000, SNR_SCALE(-1), SNR_SCALE(6.5)}};
+
+// Copies of the helpers in common.cpp
+static uint8_t linksimTlmRatioEnumToValue(expresslrs_tlm_ratio_e const enumval)
+{
+    if (enumval == TLM_RATIO_NO_TLM)
+        return 1;
+    return 1 << (8 + TLM_RATIO_NO_TLM - enumval);
+}
+
+static uint8_t linksimTlmBurstMaxForRateRatio(uint16_t const rateHz, uint8_t const ratioDiv)
+{
+    constexpr uint32_t TELEM_MIN_LINK_INTERVAL_MS = 512U;
+    unsigned retVal = TELEM_MIN_LINK_INTERVAL_MS * rateHz / ratioDiv / 1000U;
+    if (retVal > 1)
+        --retVal;
+    else
+        retVal = 1;
+    return retVal;
+}
+
+static uint8_t linksimRateIndex(uint8_t const rfRateEnum)
+{
+    for (uint8_t i = 0; i < LINKSIM_RATE_COUNT; ++i)
+    {
+        if (LinkSimAirRateConfig[i].enum_rate == rfRateEnum)
+            return i;
+    }
+    return 0;
+}
+
+// HEARTBEAT frame the RX sends as its telemetry, the payload only changes every
+// few frames so some go as a repeat when compressed
+static uint16_t linksimMavlinkFrame(uint32_t counter, uint8_t *out)
+{
+    const uint8_t len = LINKSIM_MAVLINK_HEARTBEAT_LEN;
+    const uint8_t crcExtra = LINKSIM_MAVLINK_HEARTBEAT_CRC_EXTRA;
+    const uint8_t header[10] = {MAVLINK_TUNNEL_STX_V2, len, 0, 0, (uint8_t)counter, 1, 1, 0, 0, 0};
+    memcpy(out, header, sizeof(header));
+    memset(&out[10], (uint8_t)(counter / 4), len);
+    const uint16_t crc = MAVLinkCrc(&crcExtra, 1, MAVLinkCrc(&out[1], 9 + len));
+    out[10 + len] = crc & 0xFF;
+    out[11 + len] = crc >> 8;
+    return 12 + len;
+}
+
+static bool linksimMavlinkFrameValid(uint8_t const *frame, uint16_t frameLen)
+{
+    const uint8_t len = LINKSIM_MAVLINK_HEARTBEAT_LEN;
+    const uint8_t crcExtra = LINKSIM_MAVLINK_HEARTBEAT_CRC_EXTRA;
+    if (frameLen != 12 + len || frame[0] != MAVLINK_TUNNEL_STX_V2 || frame[1] != len || frame[7] != 0)
+        return false;
+    for (uint8_t i = 1; i < len; ++i)
+    {
+        if (frame[10 + i] != frame[10])
+            return false;
+    }
+    const uint16_t crc = MAVLinkCrc(&crcExtra, 1, MAVLinkCrc(&frame[1], 9 + len));
+    return frame[10 + len] == (crc & 0xFF) && frame[11 + len] == (crc >> 8);
+}
+
+// Channel value the TX sends on channel ch for the RC frame numbered counter
+static uint32_t linksimChannelValue(uint32_t counter, uint8_t ch)
+{
+    return UINT10_to_CRSF((counter * 7 + ch * 256) & 1023);
+}
+
+double linksim_stats_t::tlmBytesPerSecond() const
+{
+    return simulatedUs ? tlmBytesDelivered * 1000000.0 / simulatedUs : 0.0;
+}
+
+void linksim_stats_t::print(FILE *f) const
+{
+    fprintf(f, "simulated %.1fs in %llu events\n", simulatedUs / 1e6, (unsigned long long)events);
+    fprintf(f, "sync: rx tentative %lldus, rx connected %lldus, tx connected %lldus, rx disconnects %u\n",
+        rxTentativeUs == UINT64_MAX ? -1LL : (long long)rxTentativeUs,
+        rxConnectedUs == UINT64_MAX ? -1LL : (long long)rxConnectedUs,
+        txConnectedUs == UINT64_MAX ? -1LL : (long long)txConnectedUs,
+        rxDisconnects);
+    fprintf(f, "sessions: tx disconnects %u, rx sessions seen %u, rate switches tx %u rx %u, blacklist switches tx %u rx %u\n",
+        txDisconnects, rxSessionsSeen, txRateSwitches, rxRateSwitches, txBlacklistSwitches, rxBlacklistSwitches);
+    fprintf(f, "uplink: sent=%u heard=%u lost=%u crcRejected=%u rcOut=%u rcMissed=%u rcCorrupt=%u LQ=%u\n",
+        packetsSent, packetsHeard, packetsLost, crcRejected, rcFramesOut, rcFramesMissed, rcFramesCorrupt, lastUplinkLq);
+    fprintf(f, "downlink: sent=%u heard=%u frames=%u corrupt=%u compressed=%u %.1fB/s\n",
+        tlmPacketsSent, tlmPacketsHeard, tlmFramesDelivered, tlmFramesCorrupt, tlmFramesCompressed, tlmBytesPerSecond());
+}
+
+void LinkSim::FhssTables::prepare(const uint8_t *newBlacklist)
+{
+    FHSSsetBlacklist(newBlacklist);
+    uint8_t const spare = active ^ 1;
+    memcpy(freqs[spare], FHSSfreqs, sizeof(freqs[spare]));
+    memcpy(blacklist[spare], FHSSblacklist, sizeof(blacklist[spare]));
+    ready = true;
+    use();
+}
+
+bool LinkSim::FhssTables::swap()
+{
+    if (!ready)
+        return false;
+    active ^= 1;
+    ready = false;
+    use();
+    return true;
+}
+
+void LinkSim::FhssTables::use()
+{
+    FHSSfreqs = freqs[active];
+    FHSSblacklist = blacklist[active];
+}
+
+bool LinkSim::hopsMatch() const
+{
+    return memcmp(_tx.fhss.freqs[_tx.fhss.active], _rx.fhss.freqs[_rx.fhss.active], sizeof(uint32_t) * FHSSsequenceCount) == 0
+        && memcmp(txBlacklist(), rxBlacklist(), FHSS_BLACKLIST_BYTES) == 0;
+}
+
+/***
+ * Simulation plumbing
+ ***/
+linksim_config_t LinkSim::defaultConfig(uint8_t rateIndex)
+{
+    linksim_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.rateIndex = rateIndex;
+    config.tlmRatio = TLM_RATIO_STD;
+    config.seed = 1;
+    config.latencyUs = 5;
+    config.rxStartDelayUs = 50000;
+    config.tlmPayloadLen = 12;
+    return config;
+}
+
+LinkSim::LinkSim(const linksim_config_t &config) :
+    _config(config), _now(0), _order(0), _rng(config.seed | 1), _burstBad(false), _airNext(0)
+{
+    _tx.modParams = _rx.modParams = &LinkSimAirRateConfig[config.rateIndex];
+    _tx.rfPerf = _rx.rfPerf = &LinkSimAirRateRFperf[config.rateIndex];
+    _modParams = _tx.modParams;
+    _rfPerf = _tx.rfPerf;
+
+    _stats = linksim_stats_t();
+    _stats.rxTentativeUs = UINT64_MAX;
+    _stats.rxConnectedUs = UINT64_MAX;
+    _stats.txConnectedUs = UINT64_MAX;
+
+    // Both sides are bound to the same UID, so share the sequence and the OTA configuration
+    FHSSusePrimaryFreqBand = true;
+    FHSSuseDualBand = false;
+    FreqCorrection = 0;
+    FHSSrandomiseFHSSsequence(((uint32_t)UID[2] << 24) + ((uint32_t)UID[3] << 16) + ((uint32_t)UID[4] << 8) + UID[5]);
+    OtaUpdateCrcInitFromUid();
+    OtaUpdateSerializers(smWideOr8ch, _modParams->PayloadLength);
+    _tx.fhss.prepare(nullptr);
+    _tx.fhss.swap();
+    _rx.fhss.prepare(nullptr);
+    _rx.fhss.swap();
+    memset(_tx.fhssBlacklistNext, 0, sizeof(_tx.fhssBlacklistNext));
+    memset(&_mspBlacklist, 0, sizeof(_mspBlacklist));
+    _mspMavlinkCompress = false;
+
+    _tx.freq = FHSSgetInitialFreq();
+    _tx.tlmDenom = 1;
+    _tx.telemetryReceiver.setMaxPackageIndex(OtaIsFullRes ? ELRS8_TELEMETRY_MAX_PACKAGES : ELRS4_TELEMETRY_MAX_PACKAGES);
+    _tx.telemetryReceiver.SetDataToReceive(_tx.tlmBuffer, sizeof(_tx.tlmBuffer));
+    for (unsigned ch = 0; ch < CRSF_NUM_CHANNELS; ++ch)
+        _tx.channelData[ch] = CRSF_CHANNEL_VALUE_1000;
+
+    _rx.pfd.reset();
+    _rx.tlmDenom = 1;
+    _rx.nextTelemetryType = PACKET_TYPE_LINKSTATS;
+    _rx.telemetryBurstCount = 1;
+    _rx.telemetryBurstMax = 1;
+    _rx.telemetrySender.setMaxPackageIndex(OtaIsFullRes ? ELRS8_TELEMETRY_MAX_PACKAGES : ELRS4_TELEMETRY_MAX_PACKAGES);
+
+    _tx.nextTimerUs = _modParams->interval;
+    schedule(txLocalToNs(_tx.nextTimerUs), evTxTimer);
+    schedule(txLocalToNs(LINKSIM_LOOP_INTERVAL_US), evTxLoop);
+    schedule((uint64_t)config.rxStartDelayUs * 1000, evRxLoop);
+}
+
+void LinkSim::schedule(uint64_t ns, linksim_event_e type, uint32_t air, uint32_t generation)
+{
+    linksim_event_t ev = { ns, _order++, type, air, generation };
+    _events.push(ev);
+}
+
+uint64_t LinkSim::txLocalUs(uint64_t ns) const
+{
+    return (uint64_t)((double)ns * (1000000.0 + _config.txPpm) / 1e9);
+}
+
+uint64_t LinkSim::rxLocalUs(uint64_t ns) const
+{
+    return (uint64_t)((double)ns * (1000000.0 + _config.rxPpm) / 1e9);
+}
+
+uint64_t LinkSim::txLocalToNs(uint64_t us) const
+{
+    return (uint64_t)((double)us * 1e9 / (1000000.0 + _config.txPpm) + 0.5);
+}
+
+uint64_t LinkSim::rxTicksToNs(uint64_t ticks) const
+{
+    return (uint64_t)((double)ticks * (1e9 / LINKSIM_RX_TICKS_PER_US) / (1000000.0 + _config.rxPpm) + 0.5);
+}
+
+bool LinkSim::outage(bool uplink) const
+{
+    uint64_t const atMs = uplink ? _config.uplinkOutageAtMs : _config.downlinkOutageAtMs;
+    uint64_t const lengthMs = uplink ? _config.uplinkOutageMs : _config.downlinkOutageMs;
+    return lengthMs && _now >= atMs * 1000000 && _now < (atMs + lengthMs) * 1000000;
+}
+
+uint32_t LinkSim::random32()
+{
+    // xorshift32, independent of the FHSS rng so runs are repeatable
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+bool LinkSim::chance(uint32_t ppm)
+{
+    return ppm && (random32() % 1000000U) < ppm;
+}
+
+bool LinkSim::channelDelivers()
+{
+    if (_burstBad)
+    {
+        if (chance(_config.burstExitPpm))
+            _burstBad = false;
+    }
+    else if (chance(_config.burstEnterPpm))
+    {
+        _burstBad = true;
+    }
+
+    if (_burstBad && chance(_config.burstLossPpm))
+        return false;
+    return !chance(_config.lossPpm);
+}
+
+uint32_t LinkSim::transmit(OTA_Packet_s const &pkt, uint32_t freq, bool uplink)
+{
+    const uint32_t slot = _airNext++ % LINKSIM_AIR_SLOTS;
+    linksim_air_t &air = _air[slot];
+    air.pkt = pkt;
+    air.freq = freq;
+    air.rateIndex = _modParams->index;
+    air.rcCounter = _tx.rcCounter;
+
+    const uint64_t toaNs = (uint64_t)_rfPerf->TOA * 1000;
+    schedule(_now + toaNs + (uint64_t)_config.latencyUs * 1000, uplink ? evUplinkArrive : evDownlinkArrive, slot);
+    return slot;
+}
+
+void LinkSim::swapInTx()
+{
+    OtaNonce = _tx.nonce;
+    FHSSptr = _tx.fhssPtr;
+    _modParams = _tx.modParams;
+    _rfPerf = _tx.rfPerf;
+    _tx.fhss.use();
+}
+
+void LinkSim::swapOutTx()
+{
+    _tx.nonce = OtaNonce;
+    _tx.fhssPtr = FHSSptr;
+}
+
+void LinkSim::swapInRx()
+{
+    OtaNonce = _rx.nonce;
+    FHSSptr = _rx.fhssPtr;
+    _modParams = _rx.modParams;
+    _rfPerf = _rx.rfPerf;
+    _rx.fhss.use();
+}
+
+void LinkSim::swapOutRx()
+{
+    _rx.nonce = OtaNonce;
+    _rx.fhssPtr = FHSSptr;
+}
+
+void LinkSim::run(uint32_t durationMs)
+{
+    const uint64_t endNs = _now + (uint64_t)durationMs * 1000000;
+    while (!_events.empty() && _events.top().ns <= endNs)
+    {
+        const linksim_event_t ev = _events.top();
+        _events.pop();
+        _now = ev.ns;
+        ++_stats.events;
+
+        switch (ev.type)
+        {
+        case evTxTimer:
+            swapInTx();
+            _tx.nextTimerUs += _modParams->interval;
+            schedule(txLocalToNs(_tx.nextTimerUs), evTxTimer);
+            txTimerCallback();
+            swapOutTx();
+            break;
+        case evTxDone:
+            swapInTx();
+            txDoneISR();
+            swapOutTx();
+            break;
+        case evTxLoop:
+            schedule(_now + (uint64_t)LINKSIM_LOOP_INTERVAL_US * 1000, evTxLoop);
+            swapInTx();
+            txLoop();
+            swapOutTx();
+            break;
+        case evRxTimer:
+            if (!_rx.running || ev.generation != _rx.generation)
+                break;
+            swapInRx();
+            rxTimerCallback();
+            swapOutRx();
+            break;
+        case evRxLoop:
+            schedule(_now + (uint64_t)LINKSIM_LOOP_INTERVAL_US * 1000, evRxLoop);
+            swapInRx();
+            rxLoop();
+            swapOutRx();
+            break;
+        case evUplinkArrive:
+        {
+            linksim_air_t const &air = _air[ev.air];
+            if (!_rx.powered || _now < _rx.busyUntilNs || air.freq != _rx.freq || air.rateIndex != _rx.modParams->index)
+                break;
+            ++_stats.packetsHeard;
+            if (outage(true) || !channelDelivers())
+            {
+                ++_stats.packetsLost;
+                break;
+            }
+            swapInRx();
+            rxProcessRFPacket(air);
+            swapOutRx();
+            break;
+        }
+        case evDownlinkArrive:
+        {
+            linksim_air_t const &air = _air[ev.air];
+            if (!_tx.listening || air.freq != _tx.freq || air.rateIndex != _tx.modParams->index)
+                break;
+            ++_stats.tlmPacketsHeard;
+            if (outage(false) || !channelDelivers())
+                break;
+            swapInTx();
+            txProcessTLMpacket(air);
+            swapOutTx();
+            break;
+        }
+        }
+    }
+    _now = endNs;
+    _stats.simulatedUs = _now / 1000;
+}
+
+/***
+ * TX side, mirrors tx_main.cpp
+ ***/
+void LinkSim::txTimerCallback()
+{
+    // Changing rate, just advance the nonces, nonceAdvance()
+    if (_tx.adaptiveRateState == arsSwitching)
+    {
+        OtaNonce++;
+        if ((OtaNonce + 1) % _modParams->FHSShopInterval == 0)
+            ++FHSSptr;
+        return;
+    }
+
+    // handset->JustSentRFpacket(), the handset delivers fresh channels once per RC frame
+    if (!(OtaNonce % _modParams->numOfSends))
+    {
+        ++_tx.rcCounter;
+        for (uint8_t ch = 0; ch < 4; ++ch)
+            _tx.channelData[ch] = linksimChannelValue(_tx.rcCounter, ch);
+    }
+
+    OtaNonce++;
+
+    // The RX changes on the announced nonce too, a switch to the same rate is to the FHSS blacklist
+    if (_tx.adaptiveRateState == arsAnnounced && OtaNonce == _tx.adaptiveRateSwitchNonce)
+    {
+        if (_tx.fhssBlacklistSwitch && _tx.adaptiveRateNextIndex == _modParams->index)
+        {
+            _tx.fhss.swap();
+            _tx.fhssBlacklistSwitch = false;
+            _tx.adaptiveRateState = arsIdle;
+            ++_stats.txBlacklistSwitches;
+        }
+        else
+        {
+            _tx.adaptiveRateState = arsSwitching;
+            return;
+        }
+    }
+
+    if (_tx.tlmPhase == ttrpPreReceiveGap)
+    {
+        _tx.tlmPhase = ttrpExpectingTelem;
+        _tx.lq.inc();
+        return;
+    }
+
+    _tx.tlmPhase = ttrpTransmitting;
+    txSendRCdataToRF();
+}
+
+void LinkSim::txGenerateSyncPacketData(OTA_Sync_s * const syncPtr)
+{
+    _tx.syncPacketLastSent = txMillis();
+
+    // UpdateTlmRatioEffective()
+    expresslrs_tlm_ratio_e newTlmRatio = (_config.tlmRatio == TLM_RATIO_STD) ? _modParams->TLMinterval : _config.tlmRatio;
+    uint8_t newTlmDenom = linksimTlmRatioEnumToValue(newTlmRatio);
+    if (_tx.connectionState == connected && _tx.tlmDenom > newTlmDenom)
+        _tx.lastTlmPacketRecvMillis = _tx.syncPacketLastSent;
+    _tx.tlmDenom = newTlmDenom;
+
+    const bool rateSwitch = _tx.adaptiveRateState == arsAnnounced;
+    const uint8_t index = rateSwitch ? _tx.adaptiveRateNextIndex : _modParams->index;
+    if (_tx.adaptiveRateSyncCounter)
+        --_tx.adaptiveRateSyncCounter;
+
+    if (_tx.syncSpamCounterAfterRateChange && index == _modParams->index)
+    {
+        --_tx.syncSpamCounterAfterRateChange;
+        // An adaptive rate change stays connected, wait for telemetry on the new rate
+        if (_tx.connectionState == connected && (int32_t)(_tx.lastTlmPacketRecvMillis - _tx.adaptiveRateSwitchMillis) > 0)
+            _tx.syncSpamCounterAfterRateChange = 0;
+    }
+
+    syncPtr->fhssIndex = FHSSgetCurrIndex();
+    syncPtr->nonce = OtaNonce;
+    syncPtr->rfRateEnum = LinkSimAirRateConfig[index].enum_rate;
+    syncPtr->switchEncMode = smWideOr8ch;
+    syncPtr->newTlmRatio = newTlmRatio - TLM_RATIO_NO_TLM;
+    syncPtr->geminiMode = 0;
+    syncPtr->otaProtocol = 0;
+    syncPtr->rateSwitch = rateSwitch;
+    syncPtr->UID4 = UID[4];
+    syncPtr->UID5 = UID[5];
+}
+
+void LinkSim::txSendRCdataToRF()
+{
+    _tx.busyTransmitting = true;
+
+    uint32_t const now = txMillis();
+    WORD_ALIGNED_ATTR OTA_Packet_s otaPkt = {0};
+
+    uint32_t SyncInterval = (_tx.connectionState == connected) ? _rfPerf->SyncPktIntervalConnected : _rfPerf->SyncPktIntervalDisconnected;
+    uint8_t NonceFHSSresult = OtaNonce % _modParams->FHSShopInterval;
+
+    // Announce an adaptive rate switch in the first half of a nonce window
+    if (_tx.adaptiveRateState == arsPending && (OtaNonce % OTA_RATE_SWITCH_NONCE_ALIGN) < (OTA_RATE_SWITCH_NONCE_ALIGN / 2))
+    {
+        _tx.adaptiveRateSwitchNonce = OtaRateSwitchNonce(OtaNonce);
+        _tx.adaptiveRateSyncCounter = LINKSIM_SYNC_SPAM_AMOUNT;
+        _tx.adaptiveRateState = arsAnnounced;
+    }
+
+    if ((_tx.adaptiveRateSyncCounter || (_tx.syncSpamCounterAfterRateChange && FHSSonSyncChannel()))
+        && (NonceFHSSresult == 1 || NonceFHSSresult == 2))
+    {
+        otaPkt.std.type = PACKET_TYPE_SYNC;
+        txGenerateSyncPacketData(OtaIsFullRes ? &otaPkt.full.sync.sync : &otaPkt.std.sync);
+        _tx.syncSlot = 0;
+    }
+    // Regular sync rotates through 4x slots, twice on each slot, and telemetry pushes it to the next slot up
+    else if (((_tx.syncSlot / 2) <= NonceFHSSresult) && (now - _tx.syncPacketLastSent > SyncInterval) && FHSSonSyncChannel())
+    {
+        otaPkt.std.type = PACKET_TYPE_SYNC;
+        txGenerateSyncPacketData(OtaIsFullRes ? &otaPkt.full.sync.sync : &otaPkt.std.sync);
+        _tx.syncSlot = (_tx.syncSlot + 1) % (_modParams->FHSShopInterval * 2);
+    }
+    else
+    {
+        OtaPackChannelData(&otaPkt, _tx.channelData, _tx.telemetryReceiver.GetCurrentConfirm(), _tx.tlmDenom);
+    }
+
+    OtaGeneratePacketCrc(&otaPkt);
+
+    _tx.listening = false;
+    ++_stats.packetsSent;
+    transmit(otaPkt, _tx.freq, true);
+    schedule(_now + (uint64_t)_rfPerf->TOA * 1000, evTxDone);
+}
+
+void LinkSim::txHandleFHSS()
+{
+    if ((OtaNonce + 1) % _modParams->FHSShopInterval == 0)
+    {
+        _tx.freq = FHSSgetNextFreq();
+    }
+}
+
+void LinkSim::txHandlePrepareForTLM()
+{
+    if (_tx.tlmDenom != 1 && ((OtaNonce + 1) % _tx.tlmDenom) == 0)
+    {
+        _tx.listening = true;
+        _tx.tlmPhase = ttrpPreReceiveGap;
+    }
+}
+
+void LinkSim::txDoneISR()
+{
+    if (!_tx.busyTransmitting)
+        return;
+
+    txHandleFHSS();
+    txHandlePrepareForTLM();
+    _tx.busyTransmitting = false;
+}
+
+void LinkSim::txProcessTLMpacket(linksim_air_t const &air)
+{
+    // RXdoneISR()
+    if (_tx.lq.currentIsSet())
+        return;
+
+    WORD_ALIGNED_ATTR OTA_Packet_s pkt = air.pkt;
+    OTA_Packet_s * const otaPktPtr = &pkt;
+    if (!OtaValidatePacketCrc(otaPktPtr))
+        return;
+
+    _tx.lastTlmPacketRecvMillis = txMillis();
+    _tx.lq.add();
+
+    OTA_LinkStats_s const *ls = nullptr;
+    if (OtaIsFullRes)
+    {
+        OTA_Packet8_s * const ota8 = (OTA_Packet8_s * const)otaPktPtr;
+        uint8_t *telemPtr = ota8->tlm_dl.payload;
+        uint8_t dataLen = sizeof(ota8->tlm_dl.payload);
+        if (otaPktPtr->std.type == PACKET_TYPE_LINKSTATS)
+        {
+            ls = &ota8->tlm_dl.ul_link_stats.stats;
+            telemPtr = ota8->tlm_dl.ul_link_stats.payload;
+            dataLen = sizeof(ota8->tlm_dl.ul_link_stats.payload);
+        }
+        _tx.telemetryReceiver.ReceiveData(ota8->tlm_dl.packageIndex & ELRS8_TELEMETRY_MAX_PACKAGES, telemPtr, dataLen);
+    }
+    else if (otaPktPtr->std.type == PACKET_TYPE_LINKSTATS)
+    {
+        ls = &otaPktPtr->std.tlm_dl.ul_link_stats.stats;
+    }
+    else if (otaPktPtr->std.type == PACKET_TYPE_DATA)
+    {
+        _tx.telemetryReceiver.ReceiveData(otaPktPtr->std.tlm_dl.packageIndex & ELRS4_TELEMETRY_MAX_PACKAGES,
+            otaPktPtr->std.tlm_dl.payload,
+            sizeof(otaPktPtr->std.tlm_dl.payload));
+    }
+
+    if (ls)
+    {
+        _stats.lastUplinkLq = ls->lq;
+        if (ls->rxSession != _tx.rxSessionLast)
+        {
+            _tx.rxSessionLast = ls->rxSession;
+            _tx.rxReconnected = true;
+        }
+    }
+
+    _tx.busyTransmitting = false;
+}
+
+void LinkSim::txSetRFLinkRate(uint8_t index)
+{
+    // SetRFLinkRate(index, true), an adaptive switch keeps the connection state
+    _tx.modParams = _modParams = &LinkSimAirRateConfig[index];
+    _tx.rfPerf = _rfPerf = &LinkSimAirRateRFperf[index];
+    _tx.freq = FHSSgetInitialFreq();
+    FHSSsetCurrIndex(0);
+    OtaNonce = 0;
+}
+
+void LinkSim::txAdaptiveRateSwitch()
+{
+    // The radio goes back to sending if it was waiting for telemetry
+    _tx.tlmPhase = ttrpTransmitting;
+    _tx.listening = false;
+    txSetRFLinkRate(_tx.adaptiveRateNextIndex);
+    _tx.adaptiveRateState = arsIdle;
+    _tx.adaptiveRateSwitchMillis = txMillis();
+    _tx.syncSpamCounterAfterRateChange = LINKSIM_SYNC_SPAM_AMOUNT_AFTER_RATE_CHANGE;
+    ++_stats.txRateSwitches;
+}
+
+void LinkSim::txAdaptiveRateUpdate(uint32_t now)
+{
+    if (_tx.adaptiveRateState == arsSwitching)
+    {
+        txAdaptiveRateSwitch();
+        return;
+    }
+
+    // The simulator doesn't pick the rate, it switches once at the configured time
+    if (_tx.connectionState != connected || _tx.adaptiveRateState != arsIdle
+        || !_config.adaptiveRateAtMs || now < _config.adaptiveRateAtMs
+        || _config.adaptiveRateIndex == _modParams->index || _tx.adaptiveRateDone)
+        return;
+
+    _tx.adaptiveRateDone = true;
+    _tx.adaptiveRateNextIndex = _config.adaptiveRateIndex;
+    _tx.adaptiveRateState = arsPending;
+}
+
+void LinkSim::txFhssBlacklistReset()
+{
+    _tx.fhss.prepare(nullptr);
+    _tx.fhss.swap();
+    _tx.fhssBlacklistPending = false;
+    _tx.fhssBlacklistAnnounce = 0;
+    if (_tx.fhssBlacklistSwitch)
+    {
+        _tx.fhssBlacklistSwitch = false;
+        _tx.adaptiveRateState = arsIdle;
+    }
+    _tx.fhssBlacklistSentMs = txMillis();
+}
+
+void LinkSim::txFhssBlacklistUpdate(uint32_t now)
+{
+    if (_tx.connectionState != connected)
+        return;
+
+    if (_tx.fhssBlacklistPending)
+    {
+        if (now - _tx.fhssBlacklistSentMs > LINKSIM_FHSS_BLACKLIST_TIMEOUT_MS)
+            _tx.fhssBlacklistPending = false;
+        return;
+    }
+
+    if (_tx.fhssBlacklistAnnounce)
+    {
+        if (_tx.adaptiveRateState == arsIdle)
+        {
+            _tx.fhss.prepare(_tx.fhssBlacklistNext);
+            --_tx.fhssBlacklistAnnounce;
+            _tx.fhssBlacklistSwitch = true;
+            _tx.adaptiveRateNextIndex = _modParams->index;
+            _tx.adaptiveRateState = arsPending;
+        }
+        return;
+    }
+
+    if (now - _tx.fhssBlacklistSentMs < LINKSIM_FHSS_BLACKLIST_INTERVAL_MS)
+        return;
+    _tx.fhssBlacklistSentMs = now;
+
+    if (memcmp(_config.blacklist, FHSSblacklist, FHSS_BLACKLIST_BYTES) == 0)
+        return;
+
+    memcpy(_tx.fhssBlacklistNext, _config.blacklist, FHSS_BLACKLIST_BYTES);
+    _mspBlacklist.generation = (_mspBlacklist.generation % 127) + 1;
+    memcpy(_mspBlacklist.blacklist, _config.blacklist, FHSS_BLACKLIST_BYTES);
+    _mspBlacklist.toRx = true;
+    _tx.fhssBlacklistPending = true;
+}
+
+void LinkSim::txLoop()
+{
+    // UpdateConnectDisconnectStatus()
+    constexpr unsigned RX_LOSS_CNT = 5;
+    const uint32_t msConnectionLostTimeout = std::max((uint32_t)512U,
+        (uint32_t)_tx.tlmDenom * _modParams->interval / (1000U / RX_LOSS_CNT)) + 2U;
+    const uint32_t now = txMillis();
+    if (_tx.lastTlmPacketRecvMillis && ((now - _tx.lastTlmPacketRecvMillis) <= msConnectionLostTimeout))
+    {
+        if (_tx.connectionState != connected)
+        {
+            _tx.connectionState = connected;
+            if (_stats.txConnectedUs == UINT64_MAX)
+                _stats.txConnectedUs = _now / 1000;
+        }
+    }
+    else if (_tx.connectionState == connected)
+    {
+        _tx.connectionState = disconnected;
+        ++_stats.txDisconnects;
+    }
+
+    // The RX has reconnected (a new session in LINKSTATS), whether or not the TX lost the link
+    if (_tx.rxReconnected)
+    {
+        _tx.rxReconnected = false;
+        ++_stats.rxSessionsSeen;
+        txFhssBlacklistReset();
+        _tx.mavlinkDecompressor.reset();
+        _tx.mavlinkCompressRequested = false;
+    }
+
+    // The RX has the blacklist, announce the switch to it
+    if (_mspBlacklist.toTx)
+    {
+        _mspBlacklist.toTx = false;
+        if (_tx.fhssBlacklistPending && _mspBlacklist.replyGeneration == _mspBlacklist.generation)
+        {
+            _tx.fhssBlacklistPending = false;
+            _tx.fhssBlacklistAnnounce = LINKSIM_FHSS_BLACKLIST_ANNOUNCE;
+        }
+    }
+    txAdaptiveRateUpdate(now);
+    txFhssBlacklistUpdate(now);
+
+    // Ask the RX to compress the MAVLink telemetry, once for each session
+    if (_config.mavlink && _tx.connectionState == connected && !_tx.mavlinkCompressRequested)
+    {
+        _tx.mavlinkCompressRequested = true;
+        _mspMavlinkCompress = true;
+    }
+
+    if (_tx.telemetryReceiver.HasFinishedData())
+    {
+        bool valid;
+        uint16_t len = _tx.tlmBuffer[1] + CRSF_FRAME_NOT_COUNTED_BYTES;
+        if (_config.mavlink)
+        {
+            // The transfer is the MAVLink, compressed or not, after the CRSF-ish header
+            const uint8_t encodedLen = _tx.tlmBuffer[1];
+            uint8_t frame[MAVLINK_COMPRESS_MAX_DECODED];
+            len = _tx.mavlinkDecompressor.decode(&_tx.tlmBuffer[2], encodedLen, frame);
+            valid = linksimMavlinkFrameValid(frame, len);
+            if (valid && encodedLen < len)
+                ++_stats.tlmFramesCompressed;
+        }
+        else
+        {
+            // Frames queued by the RX are a CRSF-ish header followed by an incrementing pattern
+            valid = len == _config.tlmPayloadLen;
+            for (uint8_t i = CRSF_FRAME_NOT_COUNTED_BYTES; valid && i < len; ++i)
+                valid = _tx.tlmBuffer[i] == (uint8_t)(_tx.tlmBuffer[CRSF_FRAME_NOT_COUNTED_BYTES] + i - CRSF_FRAME_NOT_COUNTED_BYTES);
+        }
+        if (valid)
+        {
+            ++_stats.tlmFramesDelivered;
+            _stats.tlmBytesDelivered += len;
+        }
+        else
+        {
+            ++_stats.tlmFramesCorrupt;
+        }
+        _tx.telemetryReceiver.Unlock();
+    }
+}
+
+/***
+ * RX side, mirrors rx_main.cpp
+ ***/
+void LinkSim::rxTimerResume()
+{
+    if (_rx.running)
+        return;
+    // ESP32 hwTimer fires tock() immediately after resume
+    _rx.running = true;
+    _rx.isTick = false;
+    ++_rx.generation;
+    _rx.nextTimerTicks = rxLocalUs(_now) * LINKSIM_RX_TICKS_PER_US;
+    schedule(_now, evRxTimer, 0, _rx.generation);
+}
+
+void LinkSim::rxTimerStop()
+{
+    _rx.running = false;
+    ++_rx.generation;
+}
+
+void LinkSim::rxTimerCallback()
+{
+    // hwTimer::callback() for TARGET_RX
+    const uint32_t HWtimerInterval = _modParams->interval * LINKSIM_RX_TICKS_PER_US;
+    uint32_t NextInterval = (HWtimerInterval >> 1) + hwTimerFreqOffsetUnits(_rx.freqOffset, LINKSIM_RX_TICKS_PER_US, _rx.freqOffsetResidue);
+    const bool isTick = _rx.isTick;
+    if (!isTick)
+    {
+        NextInterval += _rx.phaseShift;
+        _rx.phaseShift = 0;
+    }
+    _rx.nextTimerTicks += NextInterval;
+    schedule(rxTicksToNs(_rx.nextTimerTicks), evRxTimer, 0, _rx.generation);
+    _rx.isTick = !_rx.isTick;
+
+    if (isTick)
+        rxTick();
+    else
+        rxTock();
+}
+
+void LinkSim::rxUpdatePhaseLock()
+{
+    if (_rx.connectionState != disconnected && _rx.pfd.hasResult())
+    {
+        int32_t RawOffset = _rx.pfd.calcResult();
+        _rx.lpfOffset.update(RawOffset);
+        _rx.lpfOffsetDx.update(RawOffset - _rx.pfdPrevRawOffset);
+        _rx.pfdPrevRawOffset = RawOffset;
+
+        // hwTimer::phaseShift()
+        const int32_t HWtimerInterval = _modParams->interval * LINKSIM_RX_TICKS_PER_US;
+        int32_t newPhaseShift = _rx.phaseLock.update(RawOffset, _rx.connectionState != connected);
+        _rx.phaseShift = constrain(newPhaseShift, -(HWtimerInterval >> 2), (HWtimerInterval >> 2)) * LINKSIM_RX_TICKS_PER_US;
+        _rx.freqOffset = _rx.phaseLock.getFreqOffset();
+    }
+
+    _rx.pfd.reset();
+}
+
+void LinkSim::rxTick()
+{
+    rxUpdatePhaseLock();
+    OtaNonce++;
+
+    if (_rx.rateSwitchPending && OtaNonce == _rx.rateSwitchNonce)
+    {
+        _rx.rateSwitchPending = false;
+        // A switch to the same rate is the TX changing to the FHSS blacklist it sent
+        if (_rx.rateSwitchIndex == _modParams->index)
+        {
+            _rx.fhss.swap();
+            ++_stats.rxBlacklistSwitches;
+        }
+        // rxLoop() changes the rate in place, the TX changes on this nonce too
+        else
+        {
+            _rx.rateSwitchNow = true;
+        }
+    }
+
+    if (_modParams->numOfSends == 1)
+    {
+        _rx.uplinkLq = _rx.lq.getLQ();
+    }
+    else if (!((OtaNonce - 1) % _modParams->numOfSends))
+    {
+        _rx.uplinkLq = _rx.lqDvda.getLQ();
+        _rx.lqDvda.inc();
+    }
+
+    if (!_rx.alreadyTLMresp)
+        _rx.lq.inc();
+
+    _rx.alreadyTLMresp = false;
+    _rx.alreadyFHSS = false;
+}
+
+void LinkSim::rxFrameAvailable()
+{
+    ++_stats.rcFramesOut;
+}
+
+void LinkSim::rxTock()
+{
+    _rx.pfd.intEvent(rxMicros());
+
+    if (_modParams->numOfSends > 1 && !(OtaNonce % _modParams->numOfSends))
+    {
+        if (_rx.lqDvda.currentIsSet())
+            rxFrameAvailable();
+        else if (_rx.connectionState == connected)
+            ++_stats.rcFramesMissed;
+    }
+    else if (_modParams->numOfSends == 1)
+    {
+        if (!_rx.lq.currentIsSet() && _rx.connectionState == connected)
+            ++_stats.rcFramesMissed;
+    }
+
+    if (!_rx.didFHSS)
+        rxHandleFHSS();
+    _rx.didFHSS = false;
+
+    rxHandleSendTelemetryResponse();
+}
+
+bool LinkSim::rxHandleFHSS()
+{
+    uint8_t modresultFHSS = (OtaNonce + 1) % _modParams->FHSShopInterval;
+    if (_rx.alreadyFHSS || (modresultFHSS != 0) || (_rx.connectionState == disconnected) || _rx.rateSwitchResync)
+        return false;
+
+    _rx.alreadyFHSS = true;
+    _rx.freq = FHSSgetNextFreq();
+    return true;
+}
+
+bool LinkSim::rxHandleSendTelemetryResponse()
+{
+    uint8_t modresult = (OtaNonce + 1) % _rx.tlmDenom;
+    if ((_rx.connectionState == disconnected) || (_rx.tlmDenom == 1) || _rx.alreadyTLMresp || (modresult != 0))
+        return false;
+
+    WORD_ALIGNED_ATTR OTA_Packet_s otaPkt = {0};
+    _rx.alreadyTLMresp = true;
+
+    bool tlmQueued = _rx.telemetrySender.IsActive();
+    if (_rx.nextTelemetryType == PACKET_TYPE_LINKSTATS || !tlmQueued)
+    {
+        otaPkt.std.type = PACKET_TYPE_LINKSTATS;
+        OTA_LinkStats_s *ls;
+        if (OtaIsFullRes)
+        {
+            ls = &otaPkt.full.tlm_dl.ul_link_stats.stats;
+            otaPkt.full.tlm_dl.packageIndex = _rx.telemetrySender.GetCurrentPayload(
+                otaPkt.full.tlm_dl.ul_link_stats.payload,
+                sizeof(otaPkt.full.tlm_dl.ul_link_stats.payload));
+        }
+        else
+        {
+            ls = &otaPkt.std.tlm_dl.ul_link_stats.stats;
+        }
+        ls->lq = _rx.uplinkLq;
+        ls->modelMatch = 1;
+        ls->rxSession = _rx.session;
+
+        _rx.nextTelemetryType = PACKET_TYPE_DATA;
+        _rx.telemetryBurstCount = 1;
+    }
+    else
+    {
+        if (_rx.telemetryBurstCount < _rx.telemetryBurstMax)
+            _rx.telemetryBurstCount++;
+        else
+            _rx.nextTelemetryType = PACKET_TYPE_LINKSTATS;
+
+        otaPkt.std.type = PACKET_TYPE_DATA;
+        if (OtaIsFullRes)
+        {
+            otaPkt.full.tlm_dl.packageIndex = _rx.telemetrySender.GetCurrentPayload(
+                otaPkt.full.tlm_dl.payload,
+                sizeof(otaPkt.full.tlm_dl.payload));
+        }
+        else
+        {
+            otaPkt.std.tlm_dl.packageIndex = _rx.telemetrySender.GetCurrentPayload(
+                otaPkt.std.tlm_dl.payload,
+                sizeof(otaPkt.std.tlm_dl.payload));
+        }
+    }
+
+    OtaGeneratePacketCrc(&otaPkt);
+
+    ++_stats.tlmPacketsSent;
+    transmit(otaPkt, _rx.freq, false);
+    // Radio is in TX until TXdoneISR() puts it back in RX
+    _rx.busyUntilNs = _now + (uint64_t)_rfPerf->TOA * 1000;
+    return true;
+}
+
+void LinkSim::rxProcessRfPacket_RC(linksim_air_t const &air)
+{
+    if (_rx.connectionState != connected)
+        return;
+
+    bool telemetryConfirmValue = OtaUnpackChannelData(&air.pkt, _rx.channelData, _rx.tlmDenom);
+    _rx.telemetrySender.ConfirmCurrentPayload(telemetryConfirmValue);
+
+    // Channels are sent with 10 bit resolution, anything further off came through corrupt
+    for (uint8_t ch = 0; ch < 4; ++ch)
+    {
+        if (abs((int32_t)_rx.channelData[ch] - (int32_t)linksimChannelValue(air.rcCounter, ch)) > 2)
+        {
+            ++_stats.rcFramesCorrupt;
+            break;
+        }
+    }
+
+    if (_modParams->numOfSends == 1)
+        rxFrameAvailable();
+    else if (!_rx.lqDvda.currentIsSet())
+        _rx.lqDvda.add();
+}
+
+bool LinkSim::rxProcessRfPacket_SYNC(OTA_Sync_s const * const otaSync)
+{
+    if (otaSync->UID4 != UID[4])
+        return false;
+    if ((otaSync->UID5 & ~MODELMATCH_MASK) != (UID[5] & ~MODELMATCH_MASK))
+        return false;
+
+    _rx.lastSyncPacket = rxMillis();
+
+    expresslrs_tlm_ratio_e TLMrateIn = (expresslrs_tlm_ratio_e)(otaSync->newTlmRatio + (uint8_t)TLM_RATIO_NO_TLM);
+    uint8_t TlmDenom = linksimTlmRatioEnumToValue(TLMrateIn);
+    if (_rx.tlmDenom != TlmDenom)
+    {
+        _rx.tlmDenom = TlmDenom;
+        _rx.telemBurstValid = false;
+    }
+
+    if (otaSync->rateSwitch)
+    {
+        _rx.rateSwitchIndex = linksimRateIndex(otaSync->rfRateEnum);
+        _rx.rateSwitchNonce = OtaRateSwitchNonce(otaSync->nonce);
+        _rx.rateSwitchPending = true;
+    }
+
+    // First SYNC on the new rate after an adaptive rate switch, start the timer from it
+    if (_rx.rateSwitchResync && _rx.connectionState == connected)
+    {
+        FHSSsetCurrIndex(otaSync->fhssIndex);
+        OtaNonce = otaSync->nonce;
+        _rx.pfd.reset();
+        _rx.rateSwitchResync = false;
+        return true;
+    }
+
+    if (_rx.connectionState == disconnected
+        || OtaNonce != otaSync->nonce
+        || FHSSgetCurrIndex() != otaSync->fhssIndex)
+    {
+        FHSSsetCurrIndex(otaSync->fhssIndex);
+        OtaNonce = otaSync->nonce;
+        rxTentativeConnection();
+        return true;
+    }
+
+    return false;
+}
+
+void LinkSim::rxProcessRFPacket(linksim_air_t const &air)
+{
+    // RXdoneISR()
+    if (_rx.lq.currentIsSet() && _rx.connectionState == connected && !_rx.rateSwitchResync)
+        return;
+
+    uint32_t const beginProcessing = rxMicros();
+
+    linksim_air_t rxAir = air;
+    if (chance(_config.corruptPpm))
+        ((uint8_t *)&rxAir.pkt)[random32() % _modParams->PayloadLength] ^= 1 << (random32() % 8);
+
+    if (!OtaValidatePacketCrc(&rxAir.pkt))
+    {
+        ++_stats.crcRejected;
+        return;
+    }
+
+    _rx.pfd.extEvent(beginProcessing + LINKSIM_PACKET_TO_TOCK_SLACK);
+    _rx.doStartTimer = false;
+    _rx.lastValidPacket = rxMillis();
+
+    switch (rxAir.pkt.std.type)
+    {
+    case PACKET_TYPE_RCDATA:
+        rxProcessRfPacket_RC(rxAir);
+        break;
+    case PACKET_TYPE_SYNC:
+        _rx.doStartTimer = rxProcessRfPacket_SYNC(OtaIsFullRes ? &rxAir.pkt.full.sync.sync : &rxAir.pkt.std.sync);
+        break;
+    default:
+        break;
+    }
+
+    _rx.lq.add();
+    _rx.rfModeCycleMultiplier = LINKSIM_RF_MODE_CYCLE_MULTIPLIER_SLOW;
+
+    _rx.didFHSS = rxHandleFHSS();
+    if (_rx.doStartTimer)
+    {
+        _rx.doStartTimer = false;
+        rxTimerResume();
+    }
+}
+
+void LinkSim::rxSetRFLinkRate()
+{
+    _rx.freq = FHSSgetInitialFreq();
+    _rx.cycleInterval = ((uint32_t)11U * FHSSgetChannelCount() * _modParams->FHSShopInterval * _modParams->interval) / (10U * 1000U);
+    const uint32_t numfhss = FHSSgetChannelCount();
+    const uint8_t interval = _modParams->FHSShopInterval;
+    _minLqForChaos = interval * ((interval * numfhss + 99) / (interval * numfhss));
+}
+
+void LinkSim::rxRateSwitchInPlace()
+{
+    // RateSwitchInPlace(), the connection, session and blacklist carry over to the new rate
+    _rx.rateSwitchNow = false;
+    rxTimerStop();
+    _rx.modParams = _modParams = &LinkSimAirRateConfig[_rx.rateSwitchIndex];
+    _rx.rfPerf = _rfPerf = &LinkSimAirRateRFperf[_rx.rateSwitchIndex];
+    rxSetRFLinkRate();
+    FHSSsetCurrIndex(0);
+    _rx.rateSwitchResync = true;
+    _rx.timerState = tim_tentative;
+    _rx.gotConnectionMillis = rxMillis();
+    _rx.phaseLock.reset();
+    _rx.pfdPrevRawOffset = 0;
+    _rx.lpfOffset.init(0);
+    _rx.lpfOffsetDx.init(0);
+    _rx.alreadyTLMresp = false;
+    _rx.alreadyFHSS = false;
+    _rx.telemBurstValid = false;
+    ++_stats.rxRateSwitches;
+}
+
+void LinkSim::rxLostConnection()
+{
+    if (_rx.connectionState == connected)
+        ++_stats.rxDisconnects;
+
+    _rx.rfModeCycleMultiplier = 1;
+    _rx.connectionState = disconnected;
+    _rx.timerState = tim_disconnected;
+    _rx.freqOffset = 0;
+    _rx.freqOffsetResidue = 0;
+    _rx.phaseLock.reset();
+    _rx.pfdPrevRawOffset = 0;
+    _rx.gotConnectionMillis = 0;
+    _rx.uplinkLq = 0;
+    _rx.lq.reset();
+    _rx.lqDvda.reset();
+    _rx.lpfOffset.init(0);
+    _rx.lpfOffsetDx.init(0);
+    _rx.alreadyTLMresp = false;
+    _rx.alreadyFHSS = false;
+    _rx.rateSwitchPending = false;
+    _rx.rateSwitchNow = false;
+    _rx.rateSwitchResync = false;
+    _rx.mavlinkCompress = false;
+    _mspBlacklist.toTx = false;
+    _rx.fhss.prepare(nullptr);
+    _rx.fhss.swap();
+    _rx.sessionExpired = true;
+
+    rxTimerStop();
+    rxSetRFLinkRate();
+}
+
+void LinkSim::rxTentativeConnection()
+{
+    _rx.pfd.reset();
+    _rx.connectionState = tentative;
+    _rx.timerState = tim_disconnected;
+    _rx.pfdPrevRawOffset = 0;
+    _rx.lpfOffset.init(0);
+    _rx.rfModeLastCycled = rxMillis();
+    if (_rx.sessionExpired)
+    {
+        uint8_t const prevSession = _rx.session;
+        _rx.session = rxMicros();
+        if (_rx.session == prevSession)
+            ++_rx.session;
+        _rx.sessionExpired = false;
+    }
+    if (_stats.rxTentativeUs == UINT64_MAX)
+        _stats.rxTentativeUs = _now / 1000;
+}
+
+void LinkSim::rxGotConnection()
+{
+    if (_rx.connectionState == connected)
+        return;
+
+    _rx.connectionState = connected;
+    _rx.timerState = tim_tentative;
+    _rx.gotConnectionMillis = rxMillis();
+    if (_stats.rxConnectedUs == UINT64_MAX)
+        _stats.rxConnectedUs = _now / 1000;
+}
+
+void LinkSim::rxLoop()
+{
+    const uint32_t now = rxMillis();
+
+    // setup()
+    if (!_rx.powered)
+    {
+        _rx.powered = true;
+        _rx.rfModeLastCycled = now;
+        _rx.lastSyncPacket = now;
+        _rx.rfModeCycleMultiplier = 1;
+        _rx.lq.reset100();
+        _rx.lqDvda.reset100();
+        rxSetRFLinkRate();
+    }
+
+    if (_rx.rateSwitchNow && _rx.connectionState == connected)
+        rxRateSwitchInPlace();
+    _rx.rateSwitchNow = false;
+
+    if (_rx.connectionState == tentative && (now - _rx.lastSyncPacket > _rfPerf->RxLockTimeoutMs))
+    {
+        rxLostConnection();
+        _rx.rfModeLastCycled = now;
+        _rx.lastSyncPacket = now;
+    }
+
+    // cycleRfMode(), the simulator only has the one rate to cycle to
+    if (_rx.connectionState != connected && (now - _rx.rfModeLastCycled) > (_rx.cycleInterval * _rx.rfModeCycleMultiplier))
+    {
+        _rx.rfModeLastCycled = now;
+        _rx.lastSyncPacket = now;
+        rxSetRFLinkRate();
+        _rx.lq.reset100();
+        _rx.lqDvda.reset100();
+        _rx.rfModeCycleMultiplier = 1;
+    }
+
+    if (_rx.connectionState == connected && ((int32_t)_rfPerf->DisconnectTimeoutMs < (int32_t)(now - _rx.lastValidPacket)))
+    {
+        rxLostConnection();
+    }
+
+    if (_rx.connectionState == tentative && (abs(_rx.lpfOffsetDx.value()) <= 10) && (_rx.lpfOffset.value() < 100) && (_rx.lq.getLQRaw() > _minLqForChaos))
+    {
+        rxGotConnection();
+    }
+
+    if (_rx.timerState == tim_tentative && ((now - _rx.gotConnectionMillis) > LINKSIM_CONSIDER_CONN_GOOD_MS) && (abs(_rx.lpfOffsetDx.value()) <= 5))
+    {
+        _rx.timerState = tim_locked;
+    }
+
+    // MspReceiveComplete(), the hops are built now and swapped in on the announced nonce
+    if (_mspBlacklist.toRx && _rx.connectionState == connected)
+    {
+        _mspBlacklist.toRx = false;
+        _rx.fhss.prepare(_mspBlacklist.blacklist);
+        _mspBlacklist.replyGeneration = _mspBlacklist.generation;
+        _mspBlacklist.toTx = true;
+    }
+
+    // MSP_ELRS_MAVLINK_COMPRESS, both ends start from a reset
+    if (_mspMavlinkCompress && _rx.connectionState == connected)
+    {
+        _mspMavlinkCompress = false;
+        _rx.mavlinkCompressor.reset();
+        _rx.mavlinkCompress = true;
+    }
+
+    // The FC always has another telemetry frame ready to go
+    if (_config.mavlink && !_rx.telemetrySender.IsActive())
+    {
+        uint8_t frame[MAVLINK_COMPRESS_MAX_DECODED];
+        const uint16_t frameLen = linksimMavlinkFrame(_rx.tlmCounter, frame);
+        uint8_t len = frameLen;
+        if (_rx.mavlinkCompress)
+        {
+            len = _rx.mavlinkCompressor.encode(frame, frameLen, &_rx.tlmBuffer[2]);
+            _rx.mavlinkCompressor.commit(frame, frameLen);
+        }
+        else
+        {
+            memcpy(&_rx.tlmBuffer[2], frame, frameLen);
+        }
+        _rx.tlmBuffer[0] = CRSF_ADDRESS_USB;
+        _rx.tlmBuffer[1] = len;
+        ++_rx.tlmCounter;
+        _rx.telemetrySender.SetDataToTransmit(_rx.tlmBuffer, len + 2);
+    }
+    else if (_config.tlmPayloadLen && !_rx.telemetrySender.IsActive())
+    {
+        const uint8_t len = _config.tlmPayloadLen;
+        _rx.tlmBuffer[0] = CRSF_ADDRESS_CRSF_RECEIVER;
+        _rx.tlmBuffer[1] = len - CRSF_FRAME_NOT_COUNTED_BYTES;
+        for (uint8_t i = CRSF_FRAME_NOT_COUNTED_BYTES; i < len; ++i)
+            _rx.tlmBuffer[i] = (uint8_t)(_rx.tlmCounter + i - CRSF_FRAME_NOT_COUNTED_BYTES);
+        ++_rx.tlmCounter;
+        _rx.telemetrySender.SetDataToTransmit(_rx.tlmBuffer, len);
+    }
+
+    // updateTelemetryBurst()
+    if (!_rx.telemBurstValid)
+    {
+        _rx.telemBurstValid = true;
+        uint16_t hz = 1000000 / _modParams->interval;
+        _rx.telemetryBurstMax = linksimTlmBurstMaxForRateRatio(hz, _rx.tlmDenom);
+        _rx.telemetrySender.UpdateTelemetryRate(hz, _rx.tlmDenom, _rx.telemetryBurstMax);
+    }
+}
@@ -0,0 +1,366 @@
+/**
+ * This file is part of ExpressLRS
+ * See https://github.com/AlessandroAU/ExpressLRS
+ *
+ * Host-side discrete-event model of a TX and RX pair talking over a virtual
+ * radio link.
+ *
+ * tx_main.cpp and rx_main.cpp can't be built for the native env, so this is
+ * NOT the firmware: it is a hand-written model of the air protocol timing,
+ * taken from timerCallback, SendRCdataToRF and TXdoneISR on the TX and
+ * ProcessRFPacket, HWtimerCallbackTick/Tock and the connection state machine
+ * in loop() on the RX, and the adaptive rate and FHSS blacklist switches, RX
+ * sessions and MAVLink compression of the telemetry. Only the OTA, FHSS, CRC,
+ * PFD, PhaseLock, LQCALC, Stubborn and MAVLink compression libs it calls are
+ * the real code. It does not model the deferred RX packet processing, DVDA
+ * codeword combining, how the TX picks a rate, rates with another packet size,
+ * telemetry batching, MSP (the requests and replies are handed over directly)
+ * or switch modes other than wide, so what it checks is that the sync, hop and
+ * telemetry slot timing works with those libs, not that the firmware does.
+ *
+ * Each side has its own clock (with configurable ppm error), its own copy of
+ * the OtaNonce / FHSSptr globals which are swapped in before every event, and
+ * a virtual radio which only hears packets sent on the frequency it is tuned
+ * to while it is not transmitting.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <queue>
+#include <vector>
+
+#include "common.h"
+#include "FHSS.h"
+#include "OTA.h"
+#include "PFD.h"
+#include "PhaseLock.h"
+#include "LowPassFilter.h"
+#include "stubborn_sender.h"
+#include "stubborn_receiver.h"
+#include "LQCALC.h"
+#include "MAVLinkCompress.h"
+
+// SX128x air rate table, copied from common.cpp which is not part of the native build
+#define LINKSIM_RATE_COUNT 10
+#define LINKSIM_RX_TICKS_PER_US 5  // RX hwTimer resolution on ESP32/ESP8266
+extern expresslrs_mod_settings_s LinkSimAirRateConfig[LINKSIM_RATE_COUNT];
+extern expresslrs_rf_pref_params_s LinkSimAirRateRFperf[LINKSIM_RATE_COUNT];
+
+typedef struct {
+    uint8_t rateIndex;          // index into LinkSimAirRateConfig
+    expresslrs_tlm_ratio_e tlmRatio; // TLM_RATIO_STD to use the rate's default
+    uint32_t seed;              // seed for the channel model, runs are deterministic
+
+    // Channel model, probabilities are per packet in parts per million
+    uint32_t lossPpm;           // independent loss
+    uint32_t corruptPpm;        // delivered with a flipped bit, must be rejected by the CRC
+    uint32_t burstEnterPpm;     // Gilbert-Elliott good -> bad transition
+    uint32_t burstExitPpm;      // Gilbert-Elliott bad -> good transition
+    uint32_t burstLossPpm;      // loss while in the bad state
+    uint32_t latencyUs;         // propagation + IRQ latency added to every packet
+
+    // Clocks
+    int32_t txPpm;              // TX crystal error
+    int32_t rxPpm;              // RX crystal error
+    uint32_t rxStartDelayUs;    // RX powers up this long after the TX
+
+    // Telemetry
+    uint8_t tlmPayloadLen;      // size of each telemetry frame the RX queues, 0 for none
+    bool mavlink;               // the frames are MAVLink, compressed once the TX asks
+
+    // The TX switches to this rate once it is connected after the time (TX clock), 0 for none.
+    // Only to a rate with the same packet size as rateIndex
+    uint8_t adaptiveRateIndex;
+    uint32_t adaptiveRateAtMs;
+
+    // What the TX spectrum scan picks to blacklist, all 0 for none. No more than
+    // FHSSgetBlacklistMax() channels and not the sync channel, as the TX would build it
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES];
+
+    // Everything sent in one direction is lost for this long from the start time (simulated)
+    uint32_t uplinkOutageAtMs;
+    uint32_t uplinkOutageMs;
+    uint32_t downlinkOutageAtMs;
+    uint32_t downlinkOutageMs;
+} linksim_config_t;
+
+typedef struct {
+    uint64_t simulatedUs;
+    uint64_t events;
+
+    // Sync acquisition, UINT64_MAX if never reached
+    uint64_t rxTentativeUs;
+    uint64_t rxConnectedUs;
+    uint64_t txConnectedUs;
+    uint32_t rxDisconnects;
+    uint32_t txDisconnects;
+    uint32_t rxSessionsSeen;    // by the TX in LINKSTATS
+
+    // Adaptive rate and FHSS blacklist switches, on the nonce the TX announced
+    uint32_t txRateSwitches;
+    uint32_t rxRateSwitches;
+    uint32_t txBlacklistSwitches;
+    uint32_t rxBlacklistSwitches;
+
+    // Uplink
+    uint32_t packetsSent;
+    uint32_t packetsHeard;      // arrived while the RX radio was tuned to the right frequency
+    uint32_t packetsLost;       // dropped by the channel model
+    uint32_t crcRejected;
+    uint32_t rcFramesOut;       // crsfRCFrameAvailable()
+    uint32_t rcFramesMissed;    // crsfRCFrameMissed() while connected
+    uint32_t rcFramesCorrupt;   // channel data which did not match what was sent
+
+    // Downlink
+    uint32_t tlmPacketsSent;
+    uint32_t tlmPacketsHeard;
+    uint32_t tlmFramesDelivered;
+    uint32_t tlmBytesDelivered;
+    uint32_t tlmFramesCorrupt;
+    uint32_t tlmFramesCompressed;
+    uint8_t lastUplinkLq;       // as reported to the TX in LINKSTATS
+
+    double tlmBytesPerSecond() const;
+    void print(FILE *f) const;
+} linksim_stats_t;
+
+class LinkSim
+{
+public:
+    explicit LinkSim(const linksim_config_t &config);
+
+    void run(uint32_t durationMs);
+    const linksim_stats_t &stats() const { return _stats; }
+    const uint8_t *txBlacklist() const { return _tx.fhss.blacklist[_tx.fhss.active]; }
+    const uint8_t *rxBlacklist() const { return _rx.fhss.blacklist[_rx.fhss.active]; }
+    bool hopsMatch() const;
+    uint8_t txRateIndex() const { return _tx.modParams->index; }
+    uint8_t rxRateIndex() const { return _rx.modParams->index; }
+    bool rxMavlinkCompressing() const { return _rx.mavlinkCompress; }
+
+    static linksim_config_t defaultConfig(uint8_t rateIndex);
+
+private:
+    enum linksim_event_e {
+        evTxTimer,
+        evTxDone,
+        evTxLoop,
+        evRxTimer,
+        evRxLoop,
+        evUplinkArrive,
+        evDownlinkArrive,
+    };
+
+    typedef struct {
+        uint64_t ns;
+        uint32_t order;         // FIFO ordering for events at the same time
+        linksim_event_e type;
+        uint32_t air;           // slot in _air for packet arrivals
+        uint32_t generation;    // stale RX timer events are dropped
+    } linksim_event_t;
+
+    struct EventAfter {
+        bool operator()(const linksim_event_t &a, const linksim_event_t &b) const
+        {
+            return a.ns != b.ns ? a.ns > b.ns : a.order > b.order;
+        }
+    };
+
+    typedef struct {
+        WORD_ALIGNED_ATTR OTA_Packet_s pkt;
+        uint32_t freq;
+        uint8_t rateIndex;      // only heard by a radio set to the same rate
+        uint32_t rcCounter;
+    } linksim_air_t;
+
+    typedef enum { ttrpTransmitting, ttrpPreReceiveGap, ttrpExpectingTelem } tx_tlm_phase_e;
+    typedef enum { tim_disconnected, tim_tentative, tim_locked } rx_timer_state_e;
+    typedef enum { arsIdle, arsPending, arsAnnounced, arsSwitching } tx_adaptive_rate_state_e;
+
+    // Each side's hop tables, FHSSfreqs and FHSSblacklist point at the set in use while it runs.
+    // The FHSS lib only keeps the tables of one side, so the ones it builds are copied out
+    struct FhssTables {
+        uint32_t freqs[2][FHSS_SEQUENCE_LEN];
+        uint8_t blacklist[2][FHSS_BLACKLIST_BYTES];
+        uint8_t active = 0;
+        bool ready = false;
+
+        void prepare(const uint8_t *newBlacklist); // FHSSprepareBlacklist()
+        bool swap();                                // FHSSswapBlacklist()
+        void use();
+    };
+
+    struct TxNode {
+        expresslrs_mod_settings_s const *modParams = nullptr;
+        expresslrs_rf_pref_params_s const *rfPerf = nullptr;
+        uint8_t nonce = 0;
+        uint8_t fhssPtr = 0;
+        uint32_t freq = 0;
+        bool listening = false;
+        bool busyTransmitting = false;
+        tx_tlm_phase_e tlmPhase = ttrpTransmitting;
+        connectionState_e connectionState = disconnected;
+        uint8_t tlmDenom = 0;
+        uint8_t syncSlot = 0;
+        uint32_t syncPacketLastSent = 0;
+        uint32_t lastTlmPacketRecvMillis = 0;
+        uint64_t nextTimerUs = 0;
+        uint32_t rcCounter = 0;
+        uint32_t channelData[CRSF_NUM_CHANNELS];
+        LQCALC<100> lq;
+        StubbornReceiver telemetryReceiver;
+        uint8_t tlmBuffer[CRSF_MAX_PACKET_LEN];
+        FhssTables fhss;
+        tx_adaptive_rate_state_e adaptiveRateState = arsIdle;
+        uint8_t adaptiveRateNextIndex = 0;
+        uint8_t adaptiveRateSwitchNonce = 0;
+        uint8_t adaptiveRateSyncCounter = 0;
+        bool fhssBlacklistSwitch = false;
+        bool fhssBlacklistPending = false;
+        uint8_t fhssBlacklistAnnounce = 0;
+        uint32_t fhssBlacklistSentMs = 0;
+        uint8_t fhssBlacklistNext[FHSS_BLACKLIST_BYTES];
+        uint8_t rxSessionLast = 0;
+        bool rxReconnected = false;
+        bool adaptiveRateDone = false;  // the configured switch has been started
+        uint32_t adaptiveRateSwitchMillis = 0;
+        uint8_t syncSpamCounterAfterRateChange = 0;
+        bool mavlinkCompressRequested = false;
+        MAVLinkDecompressor mavlinkDecompressor;
+    } _tx;
+
+    struct RxNode {
+        expresslrs_mod_settings_s const *modParams = nullptr;
+        expresslrs_rf_pref_params_s const *rfPerf = nullptr;
+        uint8_t nonce = 0;
+        uint8_t fhssPtr = 0;
+        uint32_t freq = 0;
+        bool powered = false;
+        bool running = false;    // hwTimer::running
+        bool isTick = false;
+        uint32_t generation = 0;
+        uint64_t nextTimerTicks = 0; // 5 ticks per us, as the ESP32/ESP8266 RX hwTimer
+        int32_t freqOffset = 0;      // 1/256us per half interval
+        int32_t freqOffsetResidue = 0;
+        int32_t phaseShift = 0;
+        uint64_t busyUntilNs = 0;
+        connectionState_e connectionState = disconnected;
+        rx_timer_state_e timerState = tim_disconnected;
+        bool alreadyFHSS = false;
+        bool alreadyTLMresp = false;
+        bool didFHSS = false;
+        bool doStartTimer = false;
+        uint8_t tlmDenom = 0;
+        uint8_t uplinkLq = 0;
+        uint32_t lastValidPacket = 0;
+        uint32_t lastSyncPacket = 0;
+        uint32_t gotConnectionMillis = 0;
+        uint32_t rfModeLastCycled = 0;
+        uint32_t cycleInterval = 0;
+        uint8_t rfModeCycleMultiplier = 0;
+        int32_t pfdPrevRawOffset = 0;
+        PFD pfd;
+        PhaseLock phaseLock;
+        LPF lpfOffset;
+        LPF lpfOffsetDx;
+        LQCALC<100> lq;
+        LQCALC<100> lqDvda;
+        uint8_t nextTelemetryType = 0;
+        uint8_t telemetryBurstCount = 0;
+        uint8_t telemetryBurstMax = 0;
+        bool telemBurstValid = false;
+        StubbornSender telemetrySender;
+        uint8_t tlmBuffer[CRSF_MAX_PACKET_LEN];
+        uint32_t tlmCounter = 0;
+        uint32_t channelData[CRSF_NUM_CHANNELS];
+        FhssTables fhss;
+        uint8_t session = 0;
+        bool sessionExpired = true;
+        bool rateSwitchPending = false;
+        uint8_t rateSwitchIndex = 0;
+        uint8_t rateSwitchNonce = 0;
+        bool rateSwitchNow = false;
+        bool rateSwitchResync = false;
+        bool mavlinkCompress = false;
+        MAVLinkCompressor mavlinkCompressor;
+
+        RxNode() : lpfOffset(2), lpfOffsetDx(4) {}
+    } _rx;
+
+    // Simulation plumbing, _modParams and _rfPerf are those of the side being run
+    void schedule(uint64_t ns, linksim_event_e type, uint32_t air = 0, uint32_t generation = 0);
+    uint64_t txLocalUs(uint64_t ns) const;
+    uint64_t rxLocalUs(uint64_t ns) const;
+    uint64_t txLocalToNs(uint64_t us) const;
+    uint64_t rxTicksToNs(uint64_t ticks) const;
+    bool outage(bool uplink) const;
+    uint32_t txMillis() const { return txLocalUs(_now) / 1000; }
+    uint32_t rxMillis() const { return rxLocalUs(_now) / 1000; }
+    uint32_t rxMicros() const { return rxLocalUs(_now); }
+    uint32_t random32();
+    bool chance(uint32_t ppm);
+    bool channelDelivers();
+    uint32_t transmit(OTA_Packet_s const &pkt, uint32_t freq, bool uplink);
+    void swapInTx();
+    void swapOutTx();
+    void swapInRx();
+    void swapOutRx();
+
+    // TX side, mirrors tx_main.cpp
+    void txTimerCallback();
+    void txSendRCdataToRF();
+    void txGenerateSyncPacketData(OTA_Sync_s * const syncPtr);
+    void txDoneISR();
+    void txHandleFHSS();
+    void txHandlePrepareForTLM();
+    void txProcessTLMpacket(linksim_air_t const &air);
+    void txSetRFLinkRate(uint8_t index);
+    void txAdaptiveRateSwitch();
+    void txAdaptiveRateUpdate(uint32_t now);
+    void txFhssBlacklistReset();
+    void txFhssBlacklistUpdate(uint32_t now);
+    void txLoop();
+
+    // RX side, mirrors rx_main.cpp
+    void rxTimerCallback();
+    void rxTick();
+    void rxTock();
+    void rxUpdatePhaseLock();
+    bool rxHandleFHSS();
+    bool rxHandleSendTelemetryResponse();
+    void rxProcessRFPacket(linksim_air_t const &air);
+    bool rxProcessRfPacket_SYNC(OTA_Sync_s const * const otaSync);
+    void rxProcessRfPacket_RC(linksim_air_t const &air);
+    void rxFrameAvailable();
+    void rxTimerResume();
+    void rxTimerStop();
+    void rxSetRFLinkRate();
+    void rxRateSwitchInPlace();
+    void rxLostConnection();
+    void rxTentativeConnection();
+    void rxGotConnection();
+    void rxLoop();
+
+    linksim_config_t _config;
+    expresslrs_mod_settings_s const *_modParams;
+    expresslrs_rf_pref_params_s const *_rfPerf;
+    uint8_t _minLqForChaos;
+    uint64_t _now;
+    uint32_t _order;
+    uint32_t _rng;
+    bool _burstBad;
+    std::priority_queue<linksim_event_t, std::vector<linksim_event_t>, EventAfter> _events;
+    linksim_air_t _air[32];     // packets in flight, only live for TOA + latency
+    uint32_t _airNext;
+    // MSP_ELRS_FHSS_BLACKLIST and the RX's reply, picked up by the next loop() of the other side
+    struct {
+        bool toRx;
+        bool toTx;
+        uint8_t generation;
+        uint8_t replyGeneration;
+        uint8_t blacklist[FHSS_BLACKLIST_BYTES];
+    } _mspBlacklist;
+    bool _mspMavlinkCompress;   // MSP_ELRS_MAVLINK_COMPRESS
+    linksim_stats_t _stats;
+};
@@ -0,0 +1,221 @@
+/**
+ * This file is part of ExpressLRS
+ * See https://github.com/AlessandroAU/ExpressLRS
+ *
+ * Tests of the TX <-> RX air protocol timing using the link model, see linksim.h
+ * for what it does and does not cover
+ */
+#include <cstdint>
+#include <chrono>
+#include <unity.h>
+
+#include "linksim.h"
+#include "FHSS.h"
+
+uint8_t UID[6] = {1,2,3,4,5,6};
+
+static void assertHealthyLink(linksim_stats_t const &stats)
+{
+    TEST_ASSERT_NOT_EQUAL(UINT64_MAX, stats.rxConnectedUs);
+    TEST_ASSERT_NOT_EQUAL(UINT64_MAX, stats.txConnectedUs);
+    TEST_ASSERT_EQUAL(0, stats.rxDisconnects);
+    TEST_ASSERT_EQUAL(0, stats.rcFramesCorrupt);
+    TEST_ASSERT_EQUAL(0, stats.tlmFramesCorrupt);
+    TEST_ASSERT_GREATER_THAN(0, stats.rcFramesOut);
+    TEST_ASSERT_GREATER_THAN(0, stats.tlmFramesDelivered);
+}
+
+void test_linksim_sync_all_rates(void)
+{
+    for (uint8_t rate = 0; rate < LINKSIM_RATE_COUNT; ++rate)
+    {
+        LinkSim sim(LinkSim::defaultConfig(rate));
+        sim.run(15000);
+        linksim_stats_t const &stats = sim.stats();
+
+        assertHealthyLink(stats);
+        // The TX only sends sync on the sync channel, which comes around once per
+        // pass through the channel list. Allow one pass to hear it and one more
+        // to confirm the phase lock
+        expresslrs_mod_settings_s const *modParams = &LinkSimAirRateConfig[rate];
+        uint32_t syncChannelPeriodUs = FHSSgetChannelCount() * modParams->FHSShopInterval * modParams->interval;
+        TEST_ASSERT_LESS_THAN(3 * syncChannelPeriodUs, stats.rxConnectedUs);
+        TEST_ASSERT_GREATER_OR_EQUAL(99, stats.lastUplinkLq);
+    }
+}
+
+void test_linksim_lossy_link(void)
+{
+    linksim_config_t config = LinkSim::defaultConfig(6);
+    config.lossPpm = 100000;
+    config.corruptPpm = 20000;
+    config.burstEnterPpm = 2000;
+    config.burstExitPpm = 100000;
+    config.burstLossPpm = 900000;
+    LinkSim sim(config);
+    sim.run(30000);
+    linksim_stats_t const &stats = sim.stats();
+
+    assertHealthyLink(stats);
+    TEST_ASSERT_GREATER_THAN(0, stats.packetsLost);
+    TEST_ASSERT_GREATER_THAN(0, stats.crcRejected);
+    TEST_ASSERT_GREATER_THAN(0, stats.rcFramesMissed);
+    TEST_ASSERT_LESS_THAN(95, stats.lastUplinkLq);
+}
+
+void test_linksim_clock_drift(void)
+{
+    // Opposite worst-case crystal errors, the RX timer has to track 80ppm
+    linksim_config_t config = LinkSim::defaultConfig(0);
+    config.txPpm = 40;
+    config.rxPpm = -40;
+    config.rxStartDelayUs = 123457;
+    LinkSim sim(config);
+    sim.run(60000);
+    linksim_stats_t const &stats = sim.stats();
+
+    assertHealthyLink(stats);
+    TEST_ASSERT_GREATER_OR_EQUAL(99, stats.lastUplinkLq);
+}
+
+void test_linksim_dvda(void)
+{
+    // With DVDA a single lost copy must not cost an RC frame
+    linksim_config_t config = LinkSim::defaultConfig(3);
+    config.lossPpm = 50000;
+    LinkSim sim(config);
+    sim.run(20000);
+    linksim_stats_t const &stats = sim.stats();
+
+    assertHealthyLink(stats);
+    TEST_ASSERT_LESS_THAN(stats.packetsLost / 10, stats.rcFramesMissed);
+}
+
+void test_linksim_blacklist_kept_over_tx_dropout(void)
+{
+    // The TX losing the downlink alone keeps the blacklist, the RX is still hopping with it
+    linksim_config_t config = LinkSim::defaultConfig(4);
+    config.blacklist[0] = 0x0F;
+    config.downlinkOutageAtMs = 8000;
+    config.downlinkOutageMs = 2000;
+    LinkSim sim(config);
+    linksim_stats_t const &stats = sim.stats();
+
+    sim.run(7000);
+    TEST_ASSERT_EQUAL(2, stats.txBlacklistSwitches);
+    TEST_ASSERT_EQUAL(2, stats.rxBlacklistSwitches);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(config.blacklist, sim.rxBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+
+    sim.run(8000);
+    assertHealthyLink(stats);
+    TEST_ASSERT_EQUAL(1, stats.txDisconnects);
+    TEST_ASSERT_EQUAL(1, stats.rxSessionsSeen);
+    TEST_ASSERT_EQUAL(2, stats.txBlacklistSwitches);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(config.blacklist, sim.txBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+}
+
+void test_linksim_blacklist_reset_with_rx_session(void)
+{
+    // The RX losing the connection drops the blacklist, the TX drops it too when it sees
+    // the new session and sends it again
+    const uint8_t none[FHSS_BLACKLIST_BYTES] = {0};
+    linksim_config_t config = LinkSim::defaultConfig(4);
+    config.blacklist[0] = 0x0F;
+    config.uplinkOutageAtMs = 8000;
+    config.uplinkOutageMs = 4000;
+    LinkSim sim(config);
+    linksim_stats_t const &stats = sim.stats();
+
+    sim.run(7000);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(config.blacklist, sim.rxBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+
+    sim.run(6000);
+    TEST_ASSERT_EQUAL(1, stats.rxDisconnects);
+    TEST_ASSERT_EQUAL(2, stats.rxSessionsSeen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(none, sim.txBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+
+    sim.run(8000);
+    TEST_ASSERT_EQUAL(4, stats.txBlacklistSwitches);
+    TEST_ASSERT_EQUAL(4, stats.rxBlacklistSwitches);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(config.blacklist, sim.txBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+}
+
+void test_linksim_adaptive_rate_keeps_session(void)
+{
+    // An adaptive rate switch changes rate in place on both ends, the RX keeps its session
+    // so the blacklist and the MAVLink compression state carry over to the new rate
+    linksim_config_t config = LinkSim::defaultConfig(4);
+    config.tlmRatio = TLM_RATIO_1_16;
+    config.mavlink = true;
+    config.blacklist[0] = 0x0F;
+    config.adaptiveRateIndex = 6;
+    config.adaptiveRateAtMs = 8000;
+    LinkSim sim(config);
+    linksim_stats_t const &stats = sim.stats();
+
+    sim.run(7500);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(config.blacklist, sim.rxBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+    TEST_ASSERT_TRUE(sim.rxMavlinkCompressing());
+    TEST_ASSERT_GREATER_THAN(0, stats.tlmFramesCompressed);
+    const uint32_t compressedBefore = stats.tlmFramesCompressed;
+    const uint32_t deliveredBefore = stats.tlmFramesDelivered;
+
+    sim.run(6000);
+    TEST_ASSERT_EQUAL(6, sim.txRateIndex());
+    TEST_ASSERT_EQUAL(6, sim.rxRateIndex());
+    TEST_ASSERT_EQUAL(1, stats.txRateSwitches);
+    TEST_ASSERT_EQUAL(1, stats.rxRateSwitches);
+    assertHealthyLink(stats);
+    TEST_ASSERT_EQUAL(0, stats.txDisconnects);
+    TEST_ASSERT_EQUAL(1, stats.rxSessionsSeen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(config.blacklist, sim.txBlacklist(), FHSS_BLACKLIST_BYTES);
+    TEST_ASSERT_TRUE(sim.hopsMatch());
+    TEST_ASSERT_TRUE(sim.rxMavlinkCompressing());
+    TEST_ASSERT_GREATER_THAN(compressedBefore, stats.tlmFramesCompressed);
+    TEST_ASSERT_GREATER_THAN(deliveredBefore, stats.tlmFramesDelivered);
+}
+
+void test_linksim_report(void)
+{
+    linksim_config_t config = LinkSim::defaultConfig(4);
+    config.lossPpm = 20000;
+    config.txPpm = 10;
+    config.rxPpm = -15;
+    LinkSim sim(config);
+
+    auto start = std::chrono::steady_clock::now();
+    sim.run(600000);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    linksim_stats_t const &stats = sim.stats();
+    stats.print(stdout);
+    printf("%.0f simulated seconds per second\n", elapsed ? stats.simulatedUs / (double)elapsed : 0.0);
+
+    assertHealthyLink(stats);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_linksim_sync_all_rates);
+    RUN_TEST(test_linksim_lossy_link);
+    RUN_TEST(test_linksim_clock_drift);
+    RUN_TEST(test_linksim_dvda);
+    RUN_TEST(test_linksim_blacklist_kept_over_tx_dropout);
+    RUN_TEST(test_linksim_blacklist_reset_with_rx_session);
+    RUN_TEST(test_linksim_adaptive_rate_keeps_session);
+    RUN_TEST(test_linksim_report);
+    UNITY_END();
+
+    return 0;
+}
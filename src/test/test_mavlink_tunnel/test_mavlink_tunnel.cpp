@@ -0,0 +1,343 @@
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <unity.h>
+#include "MAVLinkTunnel.h"
+#include "MAVLinkCompress.h"
+
+#define MSG_ID_HEARTBEAT    0
+#define MSG_ID_ATTITUDE     30
+#define MSG_ID_PARAM_VALUE  22
+#define MSG_ID_MISSION_ITEM_INT 73
+#define MSG_ID_STATUSTEXT   253
+
+MAVLinkTunnel tunnel;
+
+// A v2 frame with the payload filled with fill, the CRC is not checked by the tunnel
+static uint16_t makeFrameV2(uint8_t *buf, uint32_t msgId, uint8_t payloadLen, uint8_t fill, bool isSigned = false, uint8_t sysId = 1)
+{
+    uint8_t const header[10] = {MAVLINK_TUNNEL_STX_V2, payloadLen, (uint8_t)(isSigned ? 1 : 0), 0, 0, sysId, 1,
+        (uint8_t)msgId, (uint8_t)(msgId >> 8), (uint8_t)(msgId >> 16)};
+    memcpy(buf, header, sizeof(header));
+    uint16_t const len = 10 + payloadLen + 2 + (isSigned ? 13 : 0);
+    memset(&buf[10], fill, len - 10);
+    return len;
+}
+
+static uint16_t makeFrameV1(uint8_t *buf, uint8_t msgId, uint8_t payloadLen, uint8_t fill)
+{
+    uint8_t const header[6] = {MAVLINK_TUNNEL_STX_V1, payloadLen, 0, 1, 1, msgId};
+    memcpy(buf, header, sizeof(header));
+    memset(&buf[6], fill, payloadLen + 2);
+    return 6 + payloadLen + 2;
+}
+
+// A v2 frame as the FC would send it, with the CRC for crcExtra
+static uint16_t makeFrameCrc(uint8_t *buf, uint8_t seq, uint8_t msgId, uint8_t crcExtra, uint8_t payloadLen, uint8_t fill)
+{
+    uint8_t const header[10] = {MAVLINK_TUNNEL_STX_V2, payloadLen, 0, 0, seq, 1, 1, msgId, 0, 0};
+    memcpy(buf, header, sizeof(header));
+    for (uint8_t i = 0; i < payloadLen; ++i)
+        buf[10 + i] = fill + i;
+    uint16_t const crc = MAVLinkCrc(&crcExtra, 1, MAVLinkCrc(&buf[1], 9 + payloadLen));
+    buf[10 + payloadLen] = crc;
+    buf[11 + payloadLen] = crc >> 8;
+    return 12 + payloadLen;
+}
+
+// Pop all the queued bytes in chunks of maxLen into out
+static void drain(uint8_t *out, uint16_t &outLen, uint8_t maxLen)
+{
+    outLen = 0;
+    while (tunnel.size())
+    {
+        uint8_t const count = tunnel.popChunk(&out[outLen], maxLen);
+        TEST_ASSERT_GREATER_THAN(0, count);
+        TEST_ASSERT_LESS_OR_EQUAL(maxLen, count);
+        outLen += count;
+    }
+}
+
+void test_mavlink_tunnel_framing(void)
+{
+    tunnel.reset();
+    uint8_t stream[200];
+    uint16_t len = 0;
+    // Noise before and between frames is dropped
+    stream[len++] = 0x55;
+    stream[len++] = 0x00;
+    uint16_t const start = len;
+    len += makeFrameV2(&stream[len], MSG_ID_HEARTBEAT, 9, 0x11);
+    len += makeFrameV1(&stream[len], MSG_ID_ATTITUDE, 28, 0x22);
+    uint16_t const noise = len;
+    stream[len++] = 0x42;
+    len += makeFrameV2(&stream[len], MSG_ID_PARAM_VALUE, 25, 0x33, true);
+
+    // A byte at a time, as it might come from the UART
+    for (uint16_t i = 0; i < len; ++i)
+        tunnel.pushBytes(&stream[i], 1);
+    TEST_ASSERT_EQUAL(len - start - 1, tunnel.size());
+
+    uint8_t out[200];
+    uint16_t outLen;
+    drain(out, outLen, 255);
+    TEST_ASSERT_EQUAL(len - start - 1, outLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&stream[start], out, noise - start);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&stream[noise + 1], &out[noise - start], len - noise - 1);
+}
+
+void test_mavlink_tunnel_chunks_whole_frames(void)
+{
+    tunnel.reset();
+    uint8_t stream[300];
+    uint16_t len = 0;
+    uint16_t frameEnds[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        len += makeFrameV2(&stream[len], MSG_ID_ATTITUDE + i, 10 + i * 3, i);
+        frameEnds[i] = len;
+    }
+    tunnel.pushBytes(stream, len);
+
+    // Each chunk ends on a frame boundary
+    uint16_t offset = 0;
+    while (tunnel.size())
+    {
+        uint8_t chunk[60];
+        uint8_t const count = tunnel.popChunk(chunk, sizeof(chunk));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(&stream[offset], chunk, count);
+        offset += count;
+        bool onBoundary = false;
+        for (uint16_t end : frameEnds)
+            onBoundary |= (end == offset);
+        TEST_ASSERT_TRUE(onBoundary);
+    }
+    TEST_ASSERT_EQUAL(len, offset);
+}
+
+void test_mavlink_tunnel_splits_long_frame(void)
+{
+    tunnel.reset();
+    uint8_t stream[400];
+    uint16_t len = makeFrameV2(stream, MSG_ID_MISSION_ITEM_INT, 190, 0x5A, true);
+    uint16_t const firstLen = len;
+    len += makeFrameV2(&stream[len], MSG_ID_HEARTBEAT, 9, 0x11);
+    tunnel.pushBytes(stream, len);
+
+    // The long frame goes in whole chunks, the short one follows its tail
+    uint8_t out[400];
+    uint16_t outLen = 0;
+    uint8_t count;
+    while ((count = tunnel.popChunk(&out[outLen], 60)) == 60)
+        outLen += 60;
+    outLen += count;
+    TEST_ASSERT_EQUAL(len, outLen);
+    TEST_ASSERT_EQUAL(len - firstLen + firstLen % 60, count);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(stream, out, len);
+}
+
+void test_mavlink_tunnel_merges_under_pressure(void)
+{
+    tunnel.reset();
+    uint8_t frame[64];
+    uint16_t queued = 0;
+
+    // Below the threshold everything is queued
+    while (tunnel.size() + 40 <= MAVLINK_TUNNEL_MERGE_THRESHOLD)
+    {
+        uint16_t const len = makeFrameV2(frame, MSG_ID_ATTITUDE, 28, queued);
+        tunnel.pushBytes(frame, len);
+        queued += len;
+    }
+    TEST_ASSERT_EQUAL(queued, tunnel.size());
+    TEST_ASSERT_EQUAL(0, tunnel.getMerged());
+
+    // A param from the FC then a flood of ATTITUDE and one more param
+    uint8_t param1[64], param2[64];
+    uint16_t const paramLen = makeFrameV2(param1, MSG_ID_PARAM_VALUE, 25, 0xA1);
+    makeFrameV2(param2, MSG_ID_PARAM_VALUE, 25, 0xA2);
+    tunnel.pushBytes(param1, paramLen);
+    uint16_t const size = tunnel.size();
+    for (int i = 0; i < 100; ++i)
+    {
+        uint16_t const len = makeFrameV2(frame, MSG_ID_ATTITUDE, 28, 0xF0);
+        tunnel.pushBytes(frame, len);
+    }
+    // Over the threshold the ATTITUDE replaces the first one queued
+    TEST_ASSERT_GREATER_THAN(0, tunnel.getMerged());
+    TEST_ASSERT_LESS_OR_EQUAL(size + 40, tunnel.size());
+    tunnel.pushBytes(param2, paramLen);
+    TEST_ASSERT_EQUAL(0, tunnel.getDropped());
+
+    // Another system's ATTITUDE is not merged
+    uint16_t const otherLen = makeFrameV2(frame, MSG_ID_ATTITUDE, 28, 0xB0, false, 2);
+    uint16_t const before = tunnel.size();
+    tunnel.pushBytes(frame, otherLen);
+    TEST_ASSERT_EQUAL(before + otherLen, tunnel.size());
+
+    // Both params got through in order, the first ATTITUDE is now the latest
+    uint8_t out[MAVLINK_TUNNEL_QUEUE_LEN];
+    uint16_t outLen;
+    drain(out, outLen, 60);
+    TEST_ASSERT_EQUAL(0xF0, out[10]);
+    uint8_t const *p1 = std::search(out, out + outLen, param1, param1 + paramLen);
+    uint8_t const *p2 = std::search(out, out + outLen, param2, param2 + paramLen);
+    TEST_ASSERT_TRUE(p1 < p2);
+    TEST_ASSERT_TRUE(p2 < out + outLen);
+}
+
+void test_mavlink_tunnel_full_keeps_params(void)
+{
+    tunnel.reset();
+    uint8_t frame[64];
+    // Fill the queue with stream messages from different systems, so none merge
+    uint8_t sysId = 0;
+    while (tunnel.free() >= 40)
+    {
+        uint16_t const len = makeFrameV2(frame, MSG_ID_ATTITUDE, 28, 0, false, sysId++);
+        tunnel.pushBytes(frame, len);
+    }
+
+    // Params push the stream messages out
+    uint16_t const paramLen = makeFrameV2(frame, MSG_ID_PARAM_VALUE, 25, 0xA1);
+    for (int i = 0; i < 20; ++i)
+        tunnel.pushBytes(frame, paramLen);
+    TEST_ASSERT_GREATER_THAN(0, tunnel.getDropped());
+
+    uint8_t out[MAVLINK_TUNNEL_QUEUE_LEN];
+    uint16_t outLen;
+    drain(out, outLen, 255);
+    int params = 0;
+    for (uint16_t offset = 0; offset < outLen; offset += MAVLinkTunnel::frameLength(&out[offset]))
+        params += MAVLinkTunnel::frameMsgId(&out[offset]) == MSG_ID_PARAM_VALUE;
+    TEST_ASSERT_EQUAL(20, params);
+}
+
+void test_mavlink_compress_crc(void)
+{
+    uint8_t const check[] = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x6F91, MAVLinkCrc(check, 9));
+}
+
+void test_mavlink_compress_repeat(void)
+{
+    MAVLinkCompressor compressor;
+    MAVLinkDecompressor decompressor;
+    uint8_t frame[64], encoded[64], decoded[64];
+
+    // The first HEARTBEAT goes as a record with the source
+    uint16_t len = makeFrameCrc(frame, 0, MSG_ID_HEARTBEAT, 50, 9, 0x10);
+    uint16_t encodedLen = compressor.encode(frame, len, encoded);
+    TEST_ASSERT_EQUAL(2 + 1 + 9 + 1, encodedLen);
+    compressor.commit(frame, len);
+
+    // A repeat before the TX has had the record is dropped
+    uint8_t const repeat = MAVLINK_COMPRESS_TAG_REPEAT | 0;
+    uint16_t decodedLen = decompressor.decode(&repeat, 1, decoded);
+    TEST_ASSERT_EQUAL(0, decodedLen);
+    decodedLen = decompressor.decode(encoded, encodedLen, decoded);
+    TEST_ASSERT_EQUAL(len, decodedLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&frame[10], &decoded[10], 9);
+
+    // The same HEARTBEAT again is one byte, a changed one is not
+    // The TX numbers it on from the last frame of the source
+    len = makeFrameCrc(frame, 1, MSG_ID_HEARTBEAT, 50, 9, 0x10);
+    encodedLen = compressor.encode(frame, len, encoded);
+    TEST_ASSERT_EQUAL(1, encodedLen);
+    compressor.commit(frame, len);
+    decodedLen = decompressor.decode(encoded, encodedLen, decoded);
+    TEST_ASSERT_EQUAL(len, decodedLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, decoded, len);
+
+    len = makeFrameCrc(frame, 2, MSG_ID_HEARTBEAT, 50, 9, 0x11);
+    TEST_ASSERT_EQUAL(1 + 1 + 9, compressor.encode(frame, len, encoded));
+}
+
+void test_mavlink_compress_raw(void)
+{
+    MAVLinkCompressor compressor;
+    uint8_t frame[64], encoded[64];
+
+    // v1, signed, unknown message and bad CRC all go as they are
+    uint16_t len = makeFrameV1(frame, MSG_ID_HEARTBEAT, 9, 0x11);
+    TEST_ASSERT_EQUAL(len, compressor.encode(frame, len, encoded));
+    len = makeFrameV2(frame, MSG_ID_ATTITUDE, 28, 0x22, true);
+    TEST_ASSERT_EQUAL(len, compressor.encode(frame, len, encoded));
+    len = makeFrameCrc(frame, 0, MSG_ID_STATUSTEXT, 83, 51, 'A');
+    TEST_ASSERT_EQUAL(len, compressor.encode(frame, len, encoded));
+    len = makeFrameCrc(frame, 0, MSG_ID_ATTITUDE, 40, 28, 0);
+    TEST_ASSERT_EQUAL(len, compressor.encode(frame, len, encoded));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, encoded, len);
+}
+
+void test_mavlink_compress_round_trip(void)
+{
+    tunnel.reset();
+    MAVLinkCompressor compressor;
+    MAVLinkDecompressor decompressor;
+    static uint8_t stream[8192], decoded[8192];
+    uint16_t len = 0, decodedLen = 0, sent = 0;
+    uint8_t seq = 0;
+
+    for (int i = 0; i < 40; ++i)
+    {
+        uint16_t const start = len;
+        len += makeFrameCrc(&stream[len], seq++, MSG_ID_ATTITUDE, 39, 28, i);
+        len += makeFrameCrc(&stream[len], seq++, MSG_ID_PARAM_VALUE, 220, 25, i);
+        if (i % 4 == 0)
+            len += makeFrameCrc(&stream[len], seq++, MSG_ID_HEARTBEAT, 50, 9, 0x10);
+        if (i % 10 == 5)
+        {
+            len += makeFrameCrc(&stream[len], seq++, MSG_ID_STATUSTEXT, 83, 51, 'A');
+            uint16_t const v1Len = makeFrameV1(&stream[len], MSG_ID_ATTITUDE, 28, 0x22);
+            stream[len + 2] = seq++;
+            len += v1Len;
+        }
+        tunnel.pushBytes(&stream[start], len - start);
+
+        // Send a chunk or two each time, as the link would
+        for (int chunk = 0; chunk < 2 && tunnel.size(); ++chunk)
+        {
+            uint8_t buf[60];
+            uint8_t const count = tunnel.popChunk(buf, sizeof(buf), &compressor);
+            sent += count;
+            uint16_t const n = decompressor.decode(buf, count, &decoded[decodedLen]);
+            TEST_ASSERT_LESS_OR_EQUAL(MAVLINK_COMPRESS_MAX_DECODED, n);
+            decodedLen += n;
+        }
+    }
+    while (tunnel.size())
+    {
+        uint8_t buf[60];
+        uint8_t const count = tunnel.popChunk(buf, sizeof(buf), &compressor);
+        sent += count;
+        decodedLen += decompressor.decode(buf, count, &decoded[decodedLen]);
+    }
+    TEST_ASSERT_EQUAL(0, tunnel.getMerged());
+
+    // The GCS gets the same bytes, in fewer over the air
+    TEST_ASSERT_EQUAL(len, decodedLen);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(stream, decoded, len);
+    TEST_ASSERT_LESS_THAN(len * 85 / 100, sent);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mavlink_tunnel_framing);
+    RUN_TEST(test_mavlink_tunnel_chunks_whole_frames);
+    RUN_TEST(test_mavlink_tunnel_splits_long_frame);
+    RUN_TEST(test_mavlink_tunnel_merges_under_pressure);
+    RUN_TEST(test_mavlink_tunnel_full_keeps_params);
+    RUN_TEST(test_mavlink_compress_crc);
+    RUN_TEST(test_mavlink_compress_repeat);
+    RUN_TEST(test_mavlink_compress_raw);
+    RUN_TEST(test_mavlink_compress_round_trip);
+    UNITY_END();
+
+    return 0;
+}
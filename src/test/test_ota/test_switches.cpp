@@ -648,6 +648,151 @@ void test_decodingHybridWide_AUXX_low()
         test_decodingHybridWide(false, i, 0, CRSF_CHANNEL_VALUE_1000);
 }
 
+/**
+ * Send one 16ch delta packet on the next nonce and decode it, a lost packet is
+ * packed but not decoded. Returns the number of channels the RX does not have exactly
+ */
+static unsigned delta_sendPacket(uint32_t const *channelsIn, uint32_t *channelsOut, bool lost)
+{
+    uint8_t TXdataBuffer[OTA8_PACKET_SIZE] = {0};
+    OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)TXdataBuffer;
+
+    ++OtaNonce;
+    OtaPackChannelData(otaPktPtr, channelsIn, false, 0);
+    if (!lost)
+        OtaUnpackChannelData(otaPktPtr, channelsOut, 0);
+
+    unsigned wrong = 0;
+    for (unsigned ch=0; ch<16; ++ch)
+    {
+        if ((channelsIn[ch] & 0b11111111110) != channelsOut[ch])
+            ++wrong;
+    }
+    return wrong;
+}
+
+void test_encodingDelta_smooth()
+{
+    uint32_t channelsIn[16];
+    uint32_t channelsOut[16] = {0};
+    OtaUpdateSerializers(sm16chDelta, OTA8_PACKET_SIZE);
+    OtaNonce = 0;
+
+    // Every channel ramping at its own speed, the fastest at ~7us per packet which
+    // is far beyond the 4 bit residual without the prediction
+    for (unsigned pkt=0; pkt<400; ++pkt)
+    {
+        for (unsigned ch=0; ch<16; ++ch)
+            channelsIn[ch] = CRSF_CHANNEL_VALUE_MIN + (pkt * (ch + 1) * 3 / 4) % (CRSF_CHANNEL_VALUE_MAX - CRSF_CHANNEL_VALUE_MIN);
+
+        unsigned const wrong = delta_sendPacket(channelsIn, channelsOut, false);
+        // All channels are known once each has been refreshed, after that every channel
+        // arrives in every packet apart from the odd one wrapping around
+        if (pkt >= 16)
+            TEST_ASSERT_LESS_OR_EQUAL(1, wrong);
+        else if (pkt == 15)
+            TEST_ASSERT_EQUAL(0, wrong);
+    }
+}
+
+void test_encodingDelta_jump()
+{
+    uint32_t channelsIn[16];
+    uint32_t channelsOut[16] = {0};
+    OtaUpdateSerializers(sm16chDelta, OTA8_PACKET_SIZE);
+    OtaNonce = 0;
+
+    for (unsigned ch=0; ch<16; ++ch)
+        channelsIn[ch] = CRSF_CHANNEL_VALUE_MID;
+    for (unsigned pkt=0; pkt<16; ++pkt)
+        delta_sendPacket(channelsIn, channelsOut, false);
+    TEST_ASSERT_EQUAL(0, delta_sendPacket(channelsIn, channelsOut, false));
+
+    // A switch flipping is sent in full in the same packet
+    channelsIn[9] = CRSF_CHANNEL_VALUE_MAX;
+    TEST_ASSERT_EQUAL(0, delta_sendPacket(channelsIn, channelsOut, false));
+    TEST_ASSERT_EQUAL(CRSF_CHANNEL_VALUE_MAX & 0b11111111110, channelsOut[9]);
+
+    // Several at once go out one per packet, the rest hold their old value until then
+    channelsIn[4] = CRSF_CHANNEL_VALUE_MIN;
+    channelsIn[5] = CRSF_CHANNEL_VALUE_MIN;
+    channelsIn[6] = CRSF_CHANNEL_VALUE_MIN;
+    TEST_ASSERT_EQUAL(2, delta_sendPacket(channelsIn, channelsOut, false));
+    TEST_ASSERT_EQUAL(1, delta_sendPacket(channelsIn, channelsOut, false));
+    TEST_ASSERT_EQUAL(0, delta_sendPacket(channelsIn, channelsOut, false));
+    TEST_ASSERT_EQUAL(CRSF_CHANNEL_VALUE_MAX & 0b11111111110, channelsOut[9]);
+}
+
+void test_decodingDelta_lostPacket()
+{
+    uint32_t channelsIn[16] = {0};
+    uint32_t channelsOut[16] = {0};
+    uint32_t history[16][400];
+    OtaUpdateSerializers(sm16chDelta, OTA8_PACKET_SIZE);
+    OtaNonce = 0;
+    unsigned recoverPkt = 16;
+
+    for (unsigned pkt=0; pkt<400; ++pkt)
+    {
+        bool jumped = false;
+        for (unsigned ch=0; ch<16; ++ch)
+        {
+            uint32_t const prev = channelsIn[ch];
+            channelsIn[ch] = CRSF_CHANNEL_VALUE_MIN + (pkt * (ch + 1) * 3 / 4) % (CRSF_CHANNEL_VALUE_MAX - CRSF_CHANNEL_VALUE_MIN);
+            history[ch][pkt] = channelsIn[ch] & 0b11111111110;
+            jumped |= channelsIn[ch] < prev;
+        }
+
+        // Every 37th packet is lost, and the nonces skip now and then as for a SYNC
+        bool const lost = (pkt % 37) == 20;
+        if (pkt % 50 == 10)
+            ++OtaNonce;
+        unsigned const wrong = delta_sendPacket(channelsIn, channelsOut, lost);
+
+        // A channel is never wrong, only held at a value it had before
+        for (unsigned ch=0; ch<16 && pkt>=16; ++ch)
+        {
+            bool found = false;
+            for (unsigned prev=0; prev<=pkt && !found; ++prev)
+                found = history[ch][prev] == channelsOut[ch];
+            TEST_ASSERT_TRUE(found);
+        }
+
+        // All are back 16 packets after the loss, plus one for each packet a channel
+        // wrapping around took the refresh
+        if (lost)
+            recoverPkt = pkt + 17;
+        else if (jumped && pkt < recoverPkt)
+            ++recoverPkt;
+        if (pkt == recoverPkt)
+            TEST_ASSERT_LESS_OR_EQUAL(1, wrong);
+    }
+}
+
+void test_syncSwitchMode()
+{
+    uint8_t TXdataBuffer[OTA8_PACKET_SIZE] = {0};
+    OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)TXdataBuffer;
+
+    // The full res modes use the extra bit in the OTA8 SYNC
+    OtaUpdateSerializers(smWideOr8ch, OTA8_PACKET_SIZE);
+    for (uint8_t mode = smWideOr8ch; mode <= sm16chDelta; ++mode)
+    {
+        memset(TXdataBuffer, 0, sizeof(TXdataBuffer));
+        OtaSetSyncSwitchMode(otaPktPtr, mode);
+        TEST_ASSERT_EQUAL(mode, OtaGetSyncSwitchMode(otaPktPtr));
+        TEST_ASSERT_EQUAL(mode & 1, otaPktPtr->full.sync.sync.switchEncMode);
+    }
+
+    OtaUpdateSerializers(smWideOr8ch, OTA4_PACKET_SIZE);
+    for (uint8_t mode = smWideOr8ch; mode <= smHybridOr16ch; ++mode)
+    {
+        memset(TXdataBuffer, 0, sizeof(TXdataBuffer));
+        OtaSetSyncSwitchMode(otaPktPtr, mode);
+        TEST_ASSERT_EQUAL(mode, OtaGetSyncSwitchMode(otaPktPtr));
+    }
+}
+
 // Unity setup/teardown
 void setUp() {}
 void tearDown() {}
@@ -677,6 +822,11 @@ int main(int argc, char **argv)
     RUN_TEST(test_encodingFullres12ch);
     RUN_TEST(test_decodingFullres16chLow);
 
+    RUN_TEST(test_encodingDelta_smooth);
+    RUN_TEST(test_encodingDelta_jump);
+    RUN_TEST(test_decodingDelta_lostPacket);
+    RUN_TEST(test_syncSwitchMode);
+
     UNITY_END();
 
     return 0;
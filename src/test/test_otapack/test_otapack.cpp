@@ -0,0 +1,241 @@
+/**
+ * This file is part of ExpressLRS
+ * See https://github.com/AlessandroAU/ExpressLRS
+ *
+ * Round trip and reference tests of the OTA 4x10 bit channel packing for every
+ * switch mode, and a native benchmark of the per-packet serializers
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <unity.h>
+
+#include "targets.h"
+#include "common.h"
+#include "CRSF.h"
+#include <OTA.h>
+
+CRSF crsf;  // need an instance to provide the fields used by the code under test
+uint32_t ChannelData[CRSF_NUM_CHANNELS];      // Current state of channels, CRSF format
+uint8_t UID[6] = {1,2,3,4,5,6};
+
+typedef uint32_t (*Decimate11to10_fn)(uint32_t ch11bit);
+
+static uint32_t Decimate11to10_Limit(uint32_t ch11bit)
+{
+    return CRSF_to_UINT10(constrain(ch11bit, CRSF_CHANNEL_VALUE_MIN, CRSF_CHANNEL_VALUE_MAX));
+}
+
+static uint32_t Decimate11to10_Div2(uint32_t ch11bit)
+{
+    return ch11bit >> 1;
+}
+
+// The channel at a time packer the OTA serializers used before the word-wide kernels
+static void RefPackUInt11ToChannels4x10(uint32_t const * const src, uint8_t *dest, Decimate11to10_fn decimate)
+{
+    const unsigned DEST_PRECISION = 10;
+    *dest = 0;
+    unsigned destShift = 0;
+    for (unsigned ch=0; ch<4; ++ch)
+    {
+        unsigned chVal = decimate(src[ch]);
+        *dest++ |= chVal << destShift;
+        unsigned srcBitsLeft = DEST_PRECISION - 8 + destShift;
+        *dest = chVal >> (DEST_PRECISION - srcBitsLeft);
+        destShift = srcBitsLeft;
+    }
+}
+
+static void RefUnpackChannels4x10ToUInt11(uint8_t const * const src, uint32_t * const dest)
+{
+    const unsigned SRC_PRECISION = 10;
+    const unsigned DEST_SHIFT = 1;
+    uint32_t bitsMerged = 0;
+    uint32_t readValue = 0;
+    unsigned readByteIndex = 0;
+    for (unsigned n = 0; n < 4; n++)
+    {
+        while (bitsMerged < SRC_PRECISION)
+        {
+            readValue |= ((uint32_t)src[readByteIndex++]) << bitsMerged;
+            bitsMerged += 8;
+        }
+        dest[n] = (readValue & ((1 << SRC_PRECISION) - 1)) << DEST_SHIFT;
+        readValue >>= SRC_PRECISION;
+        bitsMerged -= SRC_PRECISION;
+    }
+}
+
+typedef struct {
+    OtaSwitchMode_e mode;
+    uint8_t packetSize;
+    const char *name;
+} serializer_t;
+
+static serializer_t const serializers[] = {
+    { smWideOr8ch, OTA4_PACKET_SIZE, "Wide" },
+    { smHybridOr16ch, OTA4_PACKET_SIZE, "Hybrid8" },
+    { smWideOr8ch, OTA8_PACKET_SIZE, "8ch" },
+    { smHybridOr16ch, OTA8_PACKET_SIZE, "16ch" },
+    { sm12ch, OTA8_PACKET_SIZE, "12ch" },
+};
+
+// The channels carried in the packet, 4 per 4x10 group, and where the group is in the packet
+typedef struct {
+    uint8_t ch[2];
+    uint8_t offset[2];
+    uint8_t groups;
+} packet_layout_t;
+
+static packet_layout_t packetLayout(serializer_t const &s, bool isHighAux)
+{
+    if (s.packetSize == OTA4_PACKET_SIZE)
+        return { {0, 0}, {offsetof(OTA_Packet4_s, rc.ch), 0}, 1 };
+    uint8_t const offsets[2] = { offsetof(OTA_Packet8_s, rc.chLow), offsetof(OTA_Packet8_s, rc.chHigh) };
+    if (s.mode == smHybridOr16ch)
+        return { {(uint8_t)(isHighAux ? 8 : 0), (uint8_t)(isHighAux ? 12 : 4)}, {offsets[0], offsets[1]}, 2 };
+    return { {0, (uint8_t)(isHighAux ? 8 : 4)}, {offsets[0], offsets[1]}, 2 };
+}
+
+static uint32_t expectedRoundTrip(serializer_t const &s, uint32_t ch11bit)
+{
+    if (s.packetSize == OTA4_PACKET_SIZE)
+        return UINT10_to_CRSF(Decimate11to10_Limit(ch11bit));
+    return ch11bit & 0b11111111110;
+}
+
+/**
+ * Every 11 bit value in every channel position of every switch mode, for both channel
+ * sets of the alternating full res modes. The packed bytes must match the reference
+ * packer and the unpacked channels the value the 10 bit encoding can carry
+ */
+void test_otapack_round_trip_all_values()
+{
+    for (serializer_t const &s : serializers)
+    {
+        OtaUpdateSerializers(s.mode, s.packetSize);
+        for (int isHighAux = 0; isHighAux < 2; ++isHighAux)
+        {
+            packet_layout_t const layout = packetLayout(s, isHighAux);
+            // Hybrid/Wide and 8ch only have the one channel set
+            if (isHighAux && (s.mode == smWideOr8ch || layout.groups == 1))
+                continue;
+            Decimate11to10_fn const decimate = (layout.groups == 1) ? &Decimate11to10_Limit : &Decimate11to10_Div2;
+
+            for (uint32_t val = 0; val < 2048; ++val)
+            {
+                uint32_t channelsIn[CRSF_NUM_CHANNELS];
+                for (unsigned ch = 0; ch < CRSF_NUM_CHANNELS; ++ch)
+                    channelsIn[ch] = (val + ch * 131) & 2047;
+
+                uint8_t buffer[OTA8_PACKET_SIZE];
+                memset(buffer, 0xA5, sizeof(buffer));
+                OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)buffer;
+                OtaSetFullResNextChannelSet(isHighAux);
+                OtaPackChannelData(otaPktPtr, channelsIn, false, 0);
+
+                for (unsigned g = 0; g < layout.groups; ++g)
+                {
+                    uint8_t expected[5];
+                    RefPackUInt11ToChannels4x10(&channelsIn[layout.ch[g]], expected, decimate);
+                    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &buffer[layout.offset[g]], sizeof(expected));
+                }
+
+                uint32_t channelsOut[CRSF_NUM_CHANNELS] = {0};
+                OtaUnpackChannelData(otaPktPtr, channelsOut, 0);
+                for (unsigned g = 0; g < layout.groups; ++g)
+                {
+                    for (unsigned ch = layout.ch[g]; ch < layout.ch[g] + 4U; ++ch)
+                        TEST_ASSERT_EQUAL(expectedRoundTrip(s, channelsIn[ch]), channelsOut[ch]);
+                }
+            }
+        }
+    }
+}
+
+void test_otapack_unpack_matches_reference()
+{
+    // Every bit pattern of each 10 bit position through the full res unpacker
+    OtaUpdateSerializers(smWideOr8ch, OTA8_PACKET_SIZE);
+    for (unsigned pos = 0; pos < 4; ++pos)
+    {
+        for (uint32_t val = 0; val < 1024; ++val)
+        {
+            uint8_t buffer[OTA8_PACKET_SIZE] = {0};
+            OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)buffer;
+            otaPktPtr->full.rc.packetType = PACKET_TYPE_RCDATA;
+            // The other channels all ones to catch any bits leaking between them
+            uint64_t raw = 0xFFFFFFFFFFULL & ~(0x3FFULL << (pos * 10));
+            raw |= (uint64_t)val << (pos * 10);
+            for (unsigned b = 0; b < 5; ++b)
+                buffer[offsetof(OTA_Packet8_s, rc.chLow) + b] = raw >> (b * 8);
+
+            uint32_t expected[4];
+            RefUnpackChannels4x10ToUInt11(&buffer[offsetof(OTA_Packet8_s, rc.chLow)], expected);
+            uint32_t channelsOut[CRSF_NUM_CHANNELS];
+            OtaUnpackChannelData(otaPktPtr, channelsOut, 0);
+            TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, channelsOut, 4);
+            TEST_ASSERT_EQUAL(val << 1, channelsOut[pos]);
+        }
+    }
+}
+
+#define BENCH_PACKETS 200000
+
+void test_otapack_benchmark()
+{
+    static uint32_t channels[64][CRSF_NUM_CHANNELS];
+    for (unsigned i = 0; i < 64; ++i)
+        for (unsigned ch = 0; ch < CRSF_NUM_CHANNELS; ++ch)
+            channels[i][ch] = CRSF_CHANNEL_VALUE_MIN + (i * 37 + ch * 101) % (CRSF_CHANNEL_VALUE_MAX - CRSF_CHANNEL_VALUE_MIN);
+
+    volatile uint32_t sink = 0;
+    uint8_t buffer[OTA8_PACKET_SIZE] = {0};
+    OTA_Packet_s * const otaPktPtr = (OTA_Packet_s *)buffer;
+    uint32_t channelsOut[CRSF_NUM_CHANNELS];
+
+    // The channel packing alone, as the old channel at a time code did it for the full res modes
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < BENCH_PACKETS; ++i)
+    {
+        uint32_t const *ch = channels[i % 64];
+        RefPackUInt11ToChannels4x10(&ch[0], &buffer[1], &Decimate11to10_Div2);
+        RefPackUInt11ToChannels4x10(&ch[4], &buffer[6], &Decimate11to10_Div2);
+        RefUnpackChannels4x10ToUInt11(&buffer[1], &channelsOut[0]);
+        RefUnpackChannels4x10ToUInt11(&buffer[6], &channelsOut[4]);
+        sink = sink + channelsOut[i % 8];
+    }
+    auto refNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    printf("reference 8ch channels pack+unpack ns/packet: %.1f\n", refNs / (double)BENCH_PACKETS);
+
+    for (serializer_t const &s : serializers)
+    {
+        OtaUpdateSerializers(s.mode, s.packetSize);
+        start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < BENCH_PACKETS; ++i)
+        {
+            OtaPackChannelData(otaPktPtr, channels[i % 64], false, 0);
+            OtaUnpackChannelData(otaPktPtr, channelsOut, 0);
+            sink = sink + channelsOut[i % 4];
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-8s OtaPackChannelData+OtaUnpackChannelData ns/packet: %.1f\n", s.name, ns / (double)BENCH_PACKETS);
+    }
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_otapack_round_trip_all_values);
+    RUN_TEST(test_otapack_unpack_matches_reference);
+    RUN_TEST(test_otapack_benchmark);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <unity.h>
+#include "PFD.h"
+#include "PhaseLock.h"
+#include "LowPassFilter.h"
+#include "hwTimer.h"
+
+#define TICKS_PER_US 5
+
+void test_phaselock_zero_error_locks(void)
+{
+    PhaseLock pl;
+    for (int i = 0; i < PHASELOCK_LOCK_UPDATES - 1; ++i)
+    {
+        TEST_ASSERT_EQUAL(0, pl.update(0, false));
+        TEST_ASSERT_EQUAL(0, pl.getFreqOffset());
+        TEST_ASSERT_FALSE(pl.isLocked());
+    }
+    pl.update(0, false);
+    TEST_ASSERT_TRUE(pl.isLocked());
+    TEST_ASSERT_EQUAL(0, pl.getPhaseVariance());
+
+    // A large error drops the lock straight away
+    pl.update(500, false);
+    TEST_ASSERT_FALSE(pl.isLocked());
+
+    pl.reset();
+    TEST_ASSERT_FALSE(pl.isLocked());
+    TEST_ASSERT_EQUAL(0, pl.getFreq());
+}
+
+void test_phaselock_direction(void)
+{
+    // Timer early (ext after int) delays it and lengthens the interval
+    PhaseLock pl;
+    TEST_ASSERT_EQUAL(100 >> PHASELOCK_KP_ACQUIRE_SHIFT, pl.update(100, true));
+    TEST_ASSERT_GREATER_THAN(0, pl.getFreq());
+    TEST_ASSERT_GREATER_THAN(0, pl.getFreqOffset());
+
+    pl.reset();
+    TEST_ASSERT_EQUAL(-(100 >> PHASELOCK_KP_ACQUIRE_SHIFT), pl.update(-100, true));
+    TEST_ASSERT_LESS_THAN(0, pl.getFreq());
+    TEST_ASSERT_LESS_THAN(0, pl.getFreqOffset());
+}
+
+void test_phaselock_fractional_phase(void)
+{
+    // A 3us error while tracking is 3/8us per update, which has to come out on average
+    PhaseLock pl;
+    int32_t total = 0;
+    for (int i = 0; i < 64; ++i)
+        total += pl.update(3, false);
+    TEST_ASSERT_INT_WITHIN(1, 64 * 3 / 8, total);
+}
+
+void test_phaselock_freq_offset(void)
+{
+    // One update of 16us while tracking is 32/256 us/interval, far below the 1/5us
+    // timer resolution, and FreqOffset is per half interval
+    PhaseLock pl;
+    pl.update(16, false);
+    TEST_ASSERT_EQUAL((16 * 256) >> PHASELOCK_KI_TRACK_SHIFT, pl.getFreq());
+    TEST_ASSERT_EQUAL(pl.getFreq() / 2, pl.getFreqOffset());
+}
+
+void test_phaselock_no_windup(void)
+{
+    // Huge errors while acquiring must not run the frequency away
+    PhaseLock pl;
+    for (int i = 0; i < 100; ++i)
+        pl.update(5000, true);
+    TEST_ASSERT_LESS_OR_EQUAL(PHASELOCK_FREQ_MAX, pl.getFreq());
+    TEST_ASSERT_GREATER_THAN(-PHASELOCK_FREQ_MAX, pl.getFreq());
+}
+
+/***
+ * Closed loop replay of PFD traces: the packet arrival times from a TX with a
+ * crystal error, arrival jitter and lost packets, against a model of the RX
+ * hwTimer (TARGET_RX callback()) driven by each phase lock controller
+ ***/
+typedef struct {
+    uint32_t interval;  // us
+    double ppm;         // TX clock error relative to the RX
+    uint32_t jitterUs;  // +/- uniform packet arrival jitter
+    uint32_t lossPct;
+    uint32_t packets;
+} trace_config_t;
+
+typedef struct {
+    uint32_t lockPacket;    // first packet after which |error| stays within LOCK_ERR_US
+    double rmsErr;          // over the second half of the trace
+    int32_t maxErr;         // over the second half of the trace
+    bool locked;            // PhaseLock::isLocked() at the end, bang-bang always false
+} trace_result_t;
+
+#define LOCK_ERR_US 15
+#define CONNECT_PACKETS 50 // packets after which the loop is considered connected
+
+class Controller
+{
+public:
+    virtual ~Controller() {}
+    // Returns the phase shift in us, sets the freq offset in 1/256us
+    virtual int32_t update(int32_t rawOffset, bool connected, uint8_t nonce, int32_t &freqOffset) = 0;
+    virtual bool isLocked() const { return false; }
+};
+
+// updatePhaseLock() as it was before PhaseLock
+class BangBangController : public Controller
+{
+public:
+    BangBangController() : lpfOffset(2) {}
+    int32_t update(int32_t rawOffset, bool connected, uint8_t nonce, int32_t &freqOffset) override
+    {
+        int32_t Offset = lpfOffset.update(rawOffset);
+        // One timer tick at a time, as FreqOffset used to be
+        if (connected && nonce % 8 == 1)
+        {
+            if (Offset > 0)
+                freqOffset += 256 / TICKS_PER_US;
+            else if (Offset < 0)
+                freqOffset -= 256 / TICKS_PER_US;
+        }
+        return connected ? (Offset >> 2) : (rawOffset >> 1);
+    }
+
+private:
+    LPF lpfOffset;
+};
+
+class PhaseLockController : public Controller
+{
+public:
+    int32_t update(int32_t rawOffset, bool connected, uint8_t nonce, int32_t &freqOffset) override
+    {
+        int32_t retVal = pl.update(rawOffset, !connected);
+        freqOffset = pl.getFreqOffset();
+        return retVal;
+    }
+    bool isLocked() const override { return pl.isLocked(); }
+
+private:
+    PhaseLock pl;
+};
+
+static uint32_t lcg(uint32_t &seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) & 0xFFFF;
+}
+
+static trace_result_t replayTrace(trace_config_t const &cfg, Controller &ctrl)
+{
+    uint32_t seed = 0x1234;
+    PFD pfd;
+    trace_result_t res = {0, 0, 0, false};
+
+    // Both in RX microseconds, the TX starts a third of an interval off
+    double const txInterval = cfg.interval * (1.0 + cfg.ppm / 1e6);
+    double const txStart = cfg.interval / 3.0;
+    uint32_t const halfTicks = cfg.interval * TICKS_PER_US / 2;
+    uint32_t const maxShift = cfg.interval / 4;
+
+    uint64_t timerTicks = 0; // time of the next timer event
+    bool isTick = false;
+    int32_t freqOffset = 0;
+    int32_t freqOffsetResidue = 0;
+    int32_t phaseShift = 0;
+    uint32_t packet = 0;
+    uint8_t nonce = 0;
+    double sumSq = 0;
+    uint32_t nSq = 0;
+
+    while (packet < cfg.packets)
+    {
+        // Deliver the packet if it arrives before the next timer event
+        double const pktTime = txStart + packet * txInterval;
+        if (pktTime * TICKS_PER_US < timerTicks)
+        {
+            if (lcg(seed) % 100 >= cfg.lossPct)
+            {
+                int32_t const jitter = (int32_t)(lcg(seed) % (2 * cfg.jitterUs + 1)) - (int32_t)cfg.jitterUs;
+                pfd.extEvent((uint32_t)(int64_t)pktTime + jitter);
+            }
+            ++packet;
+            continue;
+        }
+
+        // hwTimer::callback()
+        uint32_t now = timerTicks / TICKS_PER_US;
+        int32_t nextInterval = halfTicks + hwTimerFreqOffsetUnits(freqOffset, TICKS_PER_US, freqOffsetResidue);
+        if (!isTick)
+        {
+            nextInterval += phaseShift;
+            phaseShift = 0;
+        }
+        timerTicks += nextInterval;
+
+        if (isTick)
+        {
+            // HWtimerCallbackTick()
+            if (pfd.hasResult())
+            {
+                int32_t const rawOffset = pfd.calcResult();
+                int32_t shift = ctrl.update(rawOffset, packet > CONNECT_PACKETS, nonce, freqOffset);
+                shift = shift > (int32_t)maxShift ? maxShift : shift < -(int32_t)maxShift ? -maxShift : shift;
+                phaseShift = shift * TICKS_PER_US;
+
+                if (abs(rawOffset) > LOCK_ERR_US)
+                    res.lockPacket = packet;
+                if (packet > cfg.packets / 2)
+                {
+                    sumSq += (double)rawOffset * rawOffset;
+                    ++nSq;
+                    if (abs(rawOffset) > res.maxErr)
+                        res.maxErr = abs(rawOffset);
+                }
+            }
+            pfd.reset();
+            ++nonce;
+        }
+        else
+        {
+            // HWtimerCallbackTock()
+            pfd.intEvent(now);
+        }
+        isTick = !isTick;
+    }
+
+    res.rmsErr = sqrt(sumSq / nSq);
+    res.locked = ctrl.isLocked();
+    return res;
+}
+
+static void compareTrace(const char *name, trace_config_t const &cfg)
+{
+    BangBangController bb;
+    PhaseLockController pl;
+    trace_result_t const resBb = replayTrace(cfg, bb);
+    trace_result_t const resPl = replayTrace(cfg, pl);
+
+    printf("%-18s bang-bang: lock@%-5u rms=%5.2fus max=%3dus | PhaseLock: lock@%-5u rms=%5.2fus max=%3dus locked=%d\n",
+        name, resBb.lockPacket, resBb.rmsErr, resBb.maxErr, resPl.lockPacket, resPl.rmsErr, resPl.maxErr, resPl.locked);
+
+    TEST_ASSERT_TRUE(resPl.locked);
+    TEST_ASSERT_LESS_THAN(cfg.packets / 2, resPl.lockPacket);
+    TEST_ASSERT_LESS_OR_EQUAL(resBb.lockPacket, resPl.lockPacket);
+    TEST_ASSERT_LESS_THAN(resBb.rmsErr, resPl.rmsErr);
+    // This packet's jitter, what the last corrections picked up from earlier packets, and the 1us resolution
+    TEST_ASSERT_LESS_OR_EQUAL(2 * cfg.jitterUs + 2, resPl.maxErr);
+}
+
+void test_phaselock_trace_500hz(void)
+{
+    compareTrace("500Hz 80ppm", {2000, 80.0, 4, 5, 20000});
+}
+
+void test_phaselock_trace_500hz_noisy(void)
+{
+    compareTrace("500Hz -60ppm noisy", {2000, -60.0, 8, 25, 20000});
+}
+
+void test_phaselock_trace_50hz(void)
+{
+    compareTrace("50Hz -80ppm", {20000, -80.0, 4, 5, 4000});
+}
+
+void test_phaselock_trace_1000hz(void)
+{
+    compareTrace("1000Hz 25ppm", {1000, 25.0, 2, 5, 40000});
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_phaselock_zero_error_locks);
+    RUN_TEST(test_phaselock_direction);
+    RUN_TEST(test_phaselock_fractional_phase);
+    RUN_TEST(test_phaselock_freq_offset);
+    RUN_TEST(test_phaselock_no_windup);
+    RUN_TEST(test_phaselock_trace_500hz);
+    RUN_TEST(test_phaselock_trace_500hz_noisy);
+    RUN_TEST(test_phaselock_trace_50hz);
+    RUN_TEST(test_phaselock_trace_1000hz);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <unity.h>
+#include "SpectrumScan.h"
+
+#define TEST_CHANNELS 40
+#define TEST_SYNC     20
+
+static void fill(SpectrumScan &scan, int8_t rssi, uint8_t samples = SPECTRUM_SCAN_MIN_SAMPLES)
+{
+    for (uint8_t n = 0; n < samples; n++)
+        for (uint8_t ch = 0; ch < TEST_CHANNELS; ch++)
+            scan.addSample(ch, rssi);
+}
+
+static unsigned countBlacklisted(const uint8_t *blacklist)
+{
+    unsigned count = 0;
+    for (uint8_t ch = 0; ch < SPECTRUM_SCAN_MAX_CHANNELS; ch++)
+        count += FHSSisBlacklisted(blacklist, ch) ? 1 : 0;
+    return count;
+}
+
+void test_ready_after_min_samples(void)
+{
+    SpectrumScan scan;
+    scan.reset(TEST_CHANNELS);
+    TEST_ASSERT_FALSE(scan.isReady());
+    fill(scan, -100, SPECTRUM_SCAN_MIN_SAMPLES - 1);
+    TEST_ASSERT_FALSE(scan.isReady());
+    fill(scan, -100, 1);
+    TEST_ASSERT_TRUE(scan.isReady());
+
+    // Channels past the end are ignored
+    scan.addSample(TEST_CHANNELS, 0);
+    scan.reset(TEST_CHANNELS);
+    TEST_ASSERT_FALSE(scan.isReady());
+}
+
+void test_noise_average(void)
+{
+    SpectrumScan scan;
+    scan.reset(TEST_CHANNELS);
+    // The first sample is taken as it is, then it moves 1/8 of the way
+    scan.addSample(3, -100);
+    TEST_ASSERT_EQUAL(-100, scan.getNoise(3));
+    scan.addSample(3, -20);
+    TEST_ASSERT_EQUAL(-90, scan.getNoise(3));
+}
+
+void test_quiet_band_no_blacklist(void)
+{
+    SpectrumScan scan;
+    scan.reset(TEST_CHANNELS);
+    fill(scan, -100);
+    scan.addSample(5, -95);
+
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES] = {0};
+    TEST_ASSERT_EQUAL(0, scan.buildBlacklist(blacklist, 10, TEST_SYNC));
+    TEST_ASSERT_EQUAL(0, countBlacklisted(blacklist));
+}
+
+void test_noisiest_blacklisted_first(void)
+{
+    SpectrumScan scan;
+    scan.reset(TEST_CHANNELS);
+    fill(scan, -100);
+    // A wifi channel over 10..14, worst in the middle, and noise on the sync channel
+    for (uint8_t n = 0; n < 20; n++)
+    {
+        for (uint8_t ch = 10; ch <= 14; ch++)
+            scan.addSample(ch, (ch == 12) ? -40 : -60);
+        scan.addSample(TEST_SYNC, -30);
+    }
+
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES] = {0};
+    TEST_ASSERT_EQUAL(3, scan.buildBlacklist(blacklist, 3, TEST_SYNC));
+    TEST_ASSERT_TRUE(FHSSisBlacklisted(blacklist, 12));
+    TEST_ASSERT_FALSE(FHSSisBlacklisted(blacklist, TEST_SYNC));
+
+    TEST_ASSERT_EQUAL(5, scan.buildBlacklist(blacklist, 10, TEST_SYNC));
+    for (uint8_t ch = 10; ch <= 14; ch++)
+        TEST_ASSERT_TRUE(FHSSisBlacklisted(blacklist, ch));
+    TEST_ASSERT_EQUAL(5, countBlacklisted(blacklist));
+}
+
+void test_blacklist_hysteresis_and_decay(void)
+{
+    SpectrumScan scan;
+    scan.reset(TEST_CHANNELS);
+    fill(scan, -100);
+    for (uint8_t n = 0; n < 40; n++)
+        scan.addSample(7, -92);
+
+    // Not over the margin to go on
+    uint8_t blacklist[FHSS_BLACKLIST_BYTES] = {0};
+    TEST_ASSERT_EQUAL(0, scan.buildBlacklist(blacklist, 10, TEST_SYNC));
+
+    // On, then kept by the hysteresis while it is still being sampled
+    for (uint8_t n = 0; n < 40; n++)
+        scan.addSample(7, -80);
+    TEST_ASSERT_EQUAL(1, scan.buildBlacklist(blacklist, 10, TEST_SYNC));
+    for (uint8_t n = 0; n < 40; n++)
+        scan.addSample(7, -89);
+    TEST_ASSERT_EQUAL(1, scan.buildBlacklist(blacklist, 10, TEST_SYNC));
+    TEST_ASSERT_TRUE(FHSSisBlacklisted(blacklist, 7));
+
+    // Without any more samples it decays until it comes off
+    unsigned rounds = 0;
+    while (FHSSisBlacklisted(blacklist, 7) && rounds < 10)
+    {
+        scan.buildBlacklist(blacklist, 10, TEST_SYNC);
+        rounds++;
+    }
+    TEST_ASSERT_FALSE(FHSSisBlacklisted(blacklist, 7));
+    TEST_ASSERT_TRUE(rounds > 1);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ready_after_min_samples);
+    RUN_TEST(test_noise_average);
+    RUN_TEST(test_quiet_band_no_blacklist);
+    RUN_TEST(test_noisiest_blacklisted_first);
+    RUN_TEST(test_blacklist_hysteresis_and_decay);
+    UNITY_END();
+
+    return 0;
+}
@@ -0,0 +1,317 @@
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <unity.h>
+#include "SpscQueue.h"
+#include "SpscFIFO.h"
+#include "FIFO.h"
+
+typedef struct {
+    uint32_t seq;
+    uint8_t payload[12];
+} test_item_t;
+
+void test_spsc_queue_empty(void)
+{
+    SpscQueue<test_item_t, 4> q;
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_EQUAL(0, q.size());
+    TEST_ASSERT_NULL(q.front());
+}
+
+void test_spsc_queue_fill_and_drain(void)
+{
+    SpscQueue<test_item_t, 4> q;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        test_item_t item = {i};
+        TEST_ASSERT_TRUE(q.push(item));
+    }
+    TEST_ASSERT_TRUE(q.full());
+    TEST_ASSERT_NULL(q.reserve());
+    test_item_t extra = {99};
+    TEST_ASSERT_FALSE(q.push(extra));
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        test_item_t *item = q.front();
+        TEST_ASSERT_NOT_NULL(item);
+        TEST_ASSERT_EQUAL(i, item->seq);
+        q.pop();
+    }
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_spsc_queue_reserve_commit(void)
+{
+    SpscQueue<test_item_t, 2> q;
+    // Wrap the indexes around several times
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        test_item_t *slot = q.reserve();
+        TEST_ASSERT_NOT_NULL(slot);
+        slot->seq = i;
+        // Not visible until committed
+        TEST_ASSERT_NULL(q.front());
+        q.commit();
+
+        TEST_ASSERT_EQUAL(1, q.size());
+        TEST_ASSERT_EQUAL(i, q.front()->seq);
+        q.pop();
+    }
+}
+
+void test_spsc_queue_flush(void)
+{
+    SpscQueue<test_item_t, 8> q;
+    test_item_t item = {1};
+    q.push(item);
+    q.push(item);
+    q.flush();
+    TEST_ASSERT_TRUE(q.empty());
+    TEST_ASSERT_TRUE(q.push(item));
+    TEST_ASSERT_EQUAL(1, q.size());
+}
+
+void test_spsc_queue_threads(void)
+{
+    // Producer and consumer on different threads, every item must arrive
+    // once, in order, with its payload intact
+    static SpscQueue<test_item_t, 8> q;
+    const uint32_t count = 1000000;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; )
+        {
+            test_item_t *slot = q.reserve();
+            if (slot == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            slot->seq = i;
+            for (uint8_t j = 0; j < sizeof(slot->payload); j++)
+                slot->payload[j] = i + j;
+            q.commit();
+            i++;
+        }
+    });
+
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < count; )
+    {
+        test_item_t *item = q.front();
+        if (item == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        errors += item->seq != i;
+        for (uint8_t j = 0; j < sizeof(item->payload); j++)
+            errors += item->payload[j] != (uint8_t)(i + j);
+        q.pop();
+        i++;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_spsc_fifo_bytes(void)
+{
+    SpscFIFO<8> f;
+    TEST_ASSERT_EQUAL(0, f.size());
+    TEST_ASSERT_EQUAL(8, f.free());
+    TEST_ASSERT_EQUAL(0, f.pop());
+
+    TEST_ASSERT_TRUE(f.push(1));
+    TEST_ASSERT_TRUE(f.push(2));
+    TEST_ASSERT_EQUAL(2, f.size());
+    TEST_ASSERT_EQUAL(1, f.peek());
+    TEST_ASSERT_EQUAL(1, f.pop());
+    TEST_ASSERT_EQUAL(2, f.pop());
+    TEST_ASSERT_EQUAL(0, f.size());
+}
+
+void test_spsc_fifo_bulk_all_or_nothing(void)
+{
+    SpscFIFO<8> f;
+    uint8_t in[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t out[8] = {0};
+
+    TEST_ASSERT_TRUE(f.pushBytes(in, 6));
+    TEST_ASSERT_FALSE(f.pushBytes(in, 3));
+    TEST_ASSERT_EQUAL(6, f.size());
+    TEST_ASSERT_FALSE(f.popBytes(out, 7));
+    TEST_ASSERT_EQUAL(6, f.size());
+
+    TEST_ASSERT_TRUE(f.popBytes(out, 5));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, 5);
+
+    // This one wraps
+    TEST_ASSERT_TRUE(f.pushBytes(in, 7));
+    TEST_ASSERT_TRUE(f.popBytes(out, 1));
+    TEST_ASSERT_EQUAL(6, out[0]);
+    TEST_ASSERT_TRUE(f.popBytes(out, 7));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in, out, 7);
+    TEST_ASSERT_EQUAL(0, f.size());
+}
+
+void test_spsc_fifo_spans(void)
+{
+    SpscFIFO<8> f;
+    uint8_t in[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t skip[5];
+    f.pushBytes(in, 5);
+    f.popBytes(skip, 5);
+
+    // Free space wraps, the span only reaches the end of the buffer
+    uint8_t *wspan;
+    TEST_ASSERT_EQUAL(3, f.writeSpan(&wspan));
+    memcpy(wspan, in, 3);
+    f.commitWrite(3);
+    TEST_ASSERT_EQUAL(5, f.writeSpan(&wspan));
+    memcpy(wspan, in + 3, 4);
+    f.commitWrite(4);
+    TEST_ASSERT_EQUAL(7, f.size());
+
+    const uint8_t *rspan;
+    TEST_ASSERT_EQUAL(3, f.peekSpan(&rspan));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in, rspan, 3);
+    f.consume(3);
+    TEST_ASSERT_EQUAL(4, f.peekSpan(&rspan));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in + 3, rspan, 4);
+    f.consume(4);
+    TEST_ASSERT_EQUAL(0, f.peekSpan(&rspan));
+}
+
+void test_spsc_fifo_threads(void)
+{
+    // Variable sized chunks through a small FIFO so it wraps and fills
+    // constantly, the consumer checks the byte sequence is unbroken
+    static SpscFIFO<64> f;
+    const uint32_t count = 4000000;
+
+    std::thread producer([&]() {
+        uint8_t chunk[23];
+        uint32_t sent = 0;
+        while (sent < count)
+        {
+            uint16_t len = 1 + (sent % sizeof(chunk));
+            if (len > count - sent)
+                len = count - sent;
+            for (uint16_t i = 0; i < len; i++)
+                chunk[i] = (sent + i) * 7;
+            if (f.pushBytes(chunk, len))
+                sent += len;
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    while (received < count)
+    {
+        const uint8_t *span;
+        uint16_t len = f.peekSpan(&span);
+        if (len == 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (uint16_t i = 0; i < len; i++)
+            errors += span[i] != (uint8_t)((received + i) * 7);
+        f.consume(len);
+        received += len;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(count, received);
+    TEST_ASSERT_EQUAL(0, f.size());
+}
+
+template <typename F>
+static double benchMBps(F fn, uint32_t bytes)
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return elapsed ? bytes * 1000.0 / elapsed : 0;
+}
+
+void test_spsc_fifo_benchmark(void)
+{
+    // Only reports, single threaded push/pop of airport sized chunks.
+    // On native FIFO::lock() is a no-op so this is the best case for FIFO
+    static FIFO<64> fifo;
+    static SpscFIFO<64> spsc;
+    const uint32_t rounds = 1000000;
+    const uint8_t len = 13;
+    static uint8_t in[len], out[len];
+    volatile uint8_t sink = 0;
+
+    double fifoBulk = benchMBps([&]() {
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            in[0] = r;
+            fifo.lock();
+            fifo.pushBytes(in, len);
+            fifo.unlock();
+            fifo.lock();
+            fifo.popBytes(out, len);
+            fifo.unlock();
+            sink = sink + out[0];
+        }
+    }, rounds * len);
+    double spscBulk = benchMBps([&]() {
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            in[0] = r;
+            spsc.pushBytes(in, len);
+            spsc.popBytes(out, len);
+            sink = sink + out[0];
+        }
+    }, rounds * len);
+    double fifoByte = benchMBps([&]() {
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            fifo.push(r);
+            sink = sink + fifo.pop();
+        }
+    }, rounds);
+    double spscByte = benchMBps([&]() {
+        for (uint32_t r = 0; r < rounds; r++)
+        {
+            spsc.push(r);
+            sink = sink + spsc.pop();
+        }
+    }, rounds);
+
+    printf("MB/s %u byte chunks: FIFO %.0f, SpscFIFO %.0f. Single bytes: FIFO %.0f, SpscFIFO %.0f\n",
+        len, fifoBulk, spscBulk, fifoByte, spscByte);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_spsc_queue_empty);
+    RUN_TEST(test_spsc_queue_fill_and_drain);
+    RUN_TEST(test_spsc_queue_reserve_commit);
+    RUN_TEST(test_spsc_queue_flush);
+    RUN_TEST(test_spsc_queue_threads);
+    RUN_TEST(test_spsc_fifo_bytes);
+    RUN_TEST(test_spsc_fifo_bulk_all_or_nothing);
+    RUN_TEST(test_spsc_fifo_spans);
+    RUN_TEST(test_spsc_fifo_threads);
+    RUN_TEST(test_spsc_fifo_benchmark);
+    UNITY_END();
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include <cstdint>
 #include <iostream>
 #include <bitset>
+#include <cstdio>
+#include <cstring>
 #include <telemetry_protocol.h>
 #include <stubborn_sender.h>
 #include <stubborn_receiver.h>
@@ -332,6 +334,53 @@ void test_stubborn_link_multiple_packages(void)
 
 }
 
+void test_stubborn_link_queued_package(void)
+{
+    // The queued package starts on the ack of the last one, without the caller
+    uint8_t testSequence1[] = {1,2,3,4,5,6,7,8,9,10};
+    uint8_t testSequence2[] = {11,12,13,14,15,16,17};
+    uint8_t buffer[100];
+    uint8_t data[2];
+
+    receiver.setMaxPackageIndex(ELRS4_TELEMETRY_MAX_PACKAGES);
+    receiver.ResetState();
+    receiver.SetDataToReceive(buffer, sizeof(buffer));
+
+    sender.setMaxPackageIndex(ELRS4_TELEMETRY_MAX_PACKAGES);
+    sender.ResetState();
+    sender.QueueDataToTransmit(testSequence1, sizeof(testSequence1));
+    TEST_ASSERT_TRUE(sender.IsActive());
+    TEST_ASSERT_FALSE(sender.HasQueuedData());
+    sender.QueueDataToTransmit(testSequence2, sizeof(testSequence2));
+    TEST_ASSERT_TRUE(sender.HasQueuedData());
+
+    int sends = 0;
+    while (!receiver.HasFinishedData())
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+        sender.ConfirmCurrentPayload(receiver.GetCurrentConfirm());
+        ++sends;
+    }
+    TEST_ASSERT_EQUAL(5, sends);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence1, buffer, sizeof(testSequence1));
+    TEST_ASSERT_TRUE(sender.IsActive());
+    TEST_ASSERT_FALSE(sender.HasQueuedData());
+    receiver.Unlock();
+
+    sends = 0;
+    while (!receiver.HasFinishedData())
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+        sender.ConfirmCurrentPayload(receiver.GetCurrentConfirm());
+        ++sends;
+    }
+    TEST_ASSERT_EQUAL(4, sends);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence2, buffer, sizeof(testSequence2));
+    TEST_ASSERT_FALSE(sender.IsActive());
+}
+
 static void test_stubborn_link_resync_then_send(void)
 {
     uint8_t testSequence1[] = {1,2,3,4,5,6,7,8,9,10};
@@ -504,6 +553,304 @@ void test_stubborn_link_forlorn_receiver(void)
     receiver.Unlock();
 }
 
+/***
+ * Windowed transfers, as the MSP uplink in the full res modes
+ ***/
+static uint32_t lcgSeed;
+static uint32_t lcg()
+{
+    lcgSeed = lcgSeed * 1103515245 + 12345;
+    return (lcgSeed >> 8) & 0xFFFF;
+}
+
+static void windowSetup(uint8_t *buffer, uint8_t bufferLen)
+{
+    receiver.setMaxPackageIndex(ELRS_MSP_MAX_PACKAGES);
+    receiver.ResetState();
+    receiver.SetDataToReceive(buffer, bufferLen);
+    sender.setMaxPackageIndex(ELRS_MSP_MAX_PACKAGES);
+    sender.ResetState();
+    sender.SetWindowed(true);
+    // The receiver reports in idle before the first transfer
+    sender.ConfirmWindow(receiver.GetWindowAck());
+}
+
+void test_stubborn_window_sends_data(void)
+{
+    uint8_t testSequence[65];
+    for (unsigned i = 0; i < sizeof(testSequence); i++)
+        testSequence[i] = i + 1;
+    uint8_t buffer[ELRS_MSP_BUFFER];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetDataToTransmit(testSequence, sizeof(testSequence));
+
+    // A whole window goes before the first ack
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    for (uint8_t chunk = 1; chunk <= STUBBORN_WINDOW_SIZE; chunk++)
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        TEST_ASSERT_EQUAL(STUBBORN_WINDOWED_INDEX | chunk, packageIndex);
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+    }
+    sender.ConfirmWindow(receiver.GetWindowAck());
+    TEST_ASSERT_EQUAL(1 + STUBBORN_WINDOW_SIZE, STUBBORN_ACK_BASE(receiver.GetWindowAck()));
+
+    for (uint8_t chunk = 1 + STUBBORN_WINDOW_SIZE; chunk <= 7; chunk++)
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        TEST_ASSERT_EQUAL(STUBBORN_WINDOWED_INDEX | ((chunk == 7) ? STUBBORN_WINDOWED_LAST : 0) | chunk, packageIndex);
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+    }
+    TEST_ASSERT_TRUE(receiver.HasFinishedData());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence, buffer, sizeof(testSequence));
+    TEST_ASSERT_EQUAL(sizeof(buffer), receiver.GetReceivedLength());
+
+    TEST_ASSERT_TRUE(sender.IsActive());
+    sender.ConfirmWindow(receiver.GetWindowAck());
+    TEST_ASSERT_FALSE(sender.IsActive());
+}
+
+void test_stubborn_window_selective_repeat(void)
+{
+    uint8_t testSequence[40];
+    for (unsigned i = 0; i < sizeof(testSequence); i++)
+        testSequence[i] = 100 + i;
+    uint8_t buffer[ELRS_MSP_BUFFER];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetDataToTransmit(testSequence, sizeof(testSequence));
+
+    // Chunk 2 of 4 is lost
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    for (uint8_t chunk = 1; chunk <= 4; chunk++)
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        if (chunk != 2)
+            receiver.ReceiveData(packageIndex, data, sizeof(data));
+    }
+    TEST_ASSERT_FALSE(receiver.HasFinishedData());
+    uint8_t const ack = receiver.GetWindowAck();
+    TEST_ASSERT_EQUAL(2, STUBBORN_ACK_BASE(ack));
+    TEST_ASSERT_EQUAL(0b11, STUBBORN_ACK_MASK(ack));
+    sender.ConfirmWindow(ack);
+
+    // Only the lost chunk is sent again
+    uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+    TEST_ASSERT_EQUAL(STUBBORN_WINDOWED_INDEX | 2, packageIndex);
+    receiver.ReceiveData(packageIndex, data, sizeof(data));
+    TEST_ASSERT_TRUE(receiver.HasFinishedData());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence, buffer, sizeof(testSequence));
+    sender.ConfirmWindow(receiver.GetWindowAck());
+    TEST_ASSERT_FALSE(sender.IsActive());
+
+    // The next transfer goes without a resync once the receiver is unlocked
+    receiver.Unlock();
+    sender.SetDataToTransmit(testSequence, 5);
+    TEST_ASSERT_EQUAL(STUBBORN_WINDOWED_INDEX | STUBBORN_WINDOWED_LAST | 1, sender.GetCurrentPayload(data, sizeof(data)));
+}
+
+void test_stubborn_window_stubborn_without_ack(void)
+{
+    // With no acks the unacked chunks go round again
+    uint8_t testSequence[60] = {0};
+    uint8_t buffer[ELRS_MSP_BUFFER];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetDataToTransmit(testSequence, sizeof(testSequence));
+
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    for (uint8_t round = 0; round < 3; round++)
+    {
+        for (uint8_t chunk = 1; chunk <= STUBBORN_WINDOW_SIZE; chunk++)
+            TEST_ASSERT_EQUAL(STUBBORN_WINDOWED_INDEX | chunk, sender.GetCurrentPayload(data, sizeof(data)));
+    }
+}
+
+void test_stubborn_window_forlorn_receiver(void)
+{
+    uint8_t testSequence1[50];
+    uint8_t testSequence2[30];
+    memset(testSequence1, 0x11, sizeof(testSequence1));
+    memset(testSequence2, 0x22, sizeof(testSequence2));
+    uint8_t buffer[ELRS_MSP_BUFFER];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetDataToTransmit(testSequence1, sizeof(testSequence1));
+
+    // Part of the first transfer gets through
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+    }
+
+    // The sender reboots, it must not take the chunks the receiver has as its own
+    sender.setMaxPackageIndex(ELRS_MSP_MAX_PACKAGES);
+    sender.ResetState();
+    sender.SetWindowed(true);
+    sender.ConfirmWindow(receiver.GetWindowAck());
+    sender.SetDataToTransmit(testSequence2, sizeof(testSequence2));
+
+    int sends = 0;
+    while (sender.IsActive() && sends < 100)
+    {
+        uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+        sender.ConfirmWindow(receiver.GetWindowAck());
+        ++sends;
+    }
+    TEST_ASSERT_FALSE(sender.IsActive());
+    TEST_ASSERT_TRUE(receiver.HasFinishedData());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence2, buffer, sizeof(testSequence2));
+}
+
+void test_stubborn_window_mode_change_restarts(void)
+{
+    // The TX learns the RX takes windowed MSP part way through a classic transfer
+    uint8_t testSequence[40];
+    for (unsigned i = 0; i < sizeof(testSequence); i++)
+        testSequence[i] = i + 1;
+    uint8_t buffer[ELRS_MSP_BUFFER];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetWindowed(false);
+    sender.SetDataToTransmit(testSequence, sizeof(testSequence));
+
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    uint8_t packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+    TEST_ASSERT_EQUAL(1, packageIndex);
+    receiver.ReceiveData(packageIndex, data, sizeof(data));
+    sender.ConfirmCurrentPayload(receiver.GetCurrentConfirm());
+
+    sender.SetWindowed(true);
+    TEST_ASSERT_TRUE(sender.IsActive());
+    TEST_ASSERT_EQUAL(STUBBORN_WINDOWED_RESYNC, sender.GetCurrentPayload(data, sizeof(data)));
+
+    int sends = 0;
+    while (sender.IsActive() && sends < 100)
+    {
+        packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+        sender.ConfirmWindow(receiver.GetWindowAck());
+        ++sends;
+    }
+    TEST_ASSERT_FALSE(sender.IsActive());
+    TEST_ASSERT_TRUE(receiver.HasFinishedData());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence, buffer, sizeof(testSequence));
+}
+
+void test_stubborn_window_too_long(void)
+{
+    // One chunk more than the chunk number can hold goes stop-and-wait
+    uint8_t testSequence[ELRS8_MSP_BYTES_PER_CALL * STUBBORN_WINDOWED_MAX_CHUNKS + 5];
+    for (unsigned i = 0; i < sizeof(testSequence); i++)
+        testSequence[i] = i + 1;
+    uint8_t buffer[100];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetDataToTransmit(testSequence, sizeof(testSequence));
+
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    uint8_t packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+    TEST_ASSERT_EQUAL(ELRS_MSP_MAX_PACKAGES, packageIndex);
+    TEST_ASSERT_FALSE(sender.IsWindowed());
+
+    int sends = 0;
+    while (sender.IsActive() && sends < 100)
+    {
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+        // Both acks come in, as from the TX's LINKSTATS, only the stop-and-wait one counts
+        sender.ConfirmWindow(receiver.GetWindowAck());
+        sender.ConfirmCurrentPayload(receiver.GetCurrentConfirm());
+        packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        ++sends;
+    }
+    TEST_ASSERT_FALSE(sender.IsActive());
+    TEST_ASSERT_TRUE(receiver.HasFinishedData());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence, buffer, sizeof(testSequence));
+    receiver.Unlock();
+
+    // The next one that fits is windowed again, after a resync
+    sender.ConfirmWindow(receiver.GetWindowAck());
+    sender.SetDataToTransmit(testSequence, 30);
+    TEST_ASSERT_TRUE(sender.IsWindowed());
+    sends = 0;
+    while (sender.IsActive() && sends < 100)
+    {
+        packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+        TEST_ASSERT_TRUE(packageIndex & STUBBORN_WINDOWED_INDEX);
+        receiver.ReceiveData(packageIndex, data, sizeof(data));
+        sender.ConfirmWindow(receiver.GetWindowAck());
+        ++sends;
+    }
+    TEST_ASSERT_TRUE(receiver.HasFinishedData());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence, buffer, 30);
+}
+
+/***
+ * Nonces to send an MSP buffer the way tx_main does: MSP goes in every other uplink packet
+ * and every tlmDenom'th nonce is the RX's telemetry slot which carries the ack
+ ***/
+static void simulateMspTransfers(bool windowed, uint8_t tlmDenom, uint32_t lossPct, uint32_t &noncesPerTransfer)
+{
+    uint8_t testSequence[ELRS_MSP_BUFFER];
+    uint8_t buffer[ELRS_MSP_BUFFER];
+    uint8_t data[ELRS8_MSP_BYTES_PER_CALL];
+    windowSetup(buffer, sizeof(buffer));
+    sender.SetWindowed(windowed);
+    lcgSeed = 0x1234;
+
+    uint32_t nonce = 0;
+    bool nextIsMsp = false;
+    for (int transfer = 0; transfer < 100; transfer++)
+    {
+        for (unsigned i = 0; i < sizeof(testSequence); i++)
+            testSequence[i] = transfer + i;
+        sender.SetDataToTransmit(testSequence, sizeof(testSequence));
+        while (sender.IsActive())
+        {
+            if (nonce % tlmDenom == tlmDenom - 1)
+            {
+                if (lcg() % 100 >= lossPct)
+                {
+                    sender.ConfirmCurrentPayload(receiver.GetCurrentConfirm());
+                    sender.ConfirmWindow(receiver.GetWindowAck());
+                }
+            }
+            else
+            {
+                if (nextIsMsp)
+                {
+                    uint8_t const packageIndex = sender.GetCurrentPayload(data, sizeof(data));
+                    if (lcg() % 100 >= lossPct)
+                        receiver.ReceiveData(packageIndex, data, sizeof(data));
+                }
+                nextIsMsp = !nextIsMsp;
+            }
+            ++nonce;
+        }
+        TEST_ASSERT_TRUE(receiver.HasFinishedData());
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(testSequence, buffer, sizeof(testSequence));
+        receiver.Unlock();
+    }
+
+    noncesPerTransfer = nonce / 100;
+}
+
+void test_stubborn_window_throughput(void)
+{
+    // Stop-and-wait needs the 1:2 boost, windowed keeps the configured ratio
+    uint32_t boosted, classic8, windowed8, windowed4, boostedLossy, windowed8Lossy;
+    simulateMspTransfers(false, 2, 0, boosted);
+    simulateMspTransfers(false, 8, 0, classic8);
+    simulateMspTransfers(true, 8, 0, windowed8);
+    simulateMspTransfers(true, 4, 0, windowed4);
+    simulateMspTransfers(false, 2, 10, boostedLossy);
+    simulateMspTransfers(true, 8, 10, windowed8Lossy);
+    printf("nonces per %u byte MSP: stop-and-wait 1:2 %u 1:8 %u, windowed 1:8 %u 1:4 %u, 10%% loss: stop-and-wait 1:2 %u windowed 1:8 %u\n",
+        ELRS_MSP_BUFFER, boosted, classic8, windowed8, windowed4, boostedLossy, windowed8Lossy);
+
+    TEST_ASSERT_LESS_THAN(boosted, windowed8);
+    TEST_ASSERT_LESS_THAN(boosted, windowed4);
+    TEST_ASSERT_LESS_THAN(boostedLossy, windowed8Lossy);
+}
+
 // Unity setup/teardown
 void setUp() {}
 void tearDown() {}
@@ -520,10 +867,18 @@ int main(int argc, char **argv)
     RUN_TEST(test_stubborn_link_resyncs);
     RUN_TEST(test_stubborn_link_resyncs_during_last_confirm);
     RUN_TEST(test_stubborn_link_multiple_packages);
+    RUN_TEST(test_stubborn_link_queued_package);
     RUN_TEST(test_stubborn_link_resync_then_send);
     RUN_TEST(test_stubborn_link_variable_size_per_call);
     RUN_TEST(test_stubborn_link_premature_advance);
     RUN_TEST(test_stubborn_link_forlorn_receiver);
+    RUN_TEST(test_stubborn_window_sends_data);
+    RUN_TEST(test_stubborn_window_selective_repeat);
+    RUN_TEST(test_stubborn_window_stubborn_without_ack);
+    RUN_TEST(test_stubborn_window_forlorn_receiver);
+    RUN_TEST(test_stubborn_window_mode_change_restarts);
+    RUN_TEST(test_stubborn_window_too_long);
+    RUN_TEST(test_stubborn_window_throughput);
     UNITY_END();
 
     return 0;
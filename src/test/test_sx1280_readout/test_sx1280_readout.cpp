@@ -0,0 +1,270 @@
+/**
+ * This file is part of ExpressLRS
+ * See https://github.com/AlessandroAU/ExpressLRS
+ *
+ * The SPI transactions the SX1280 driver makes for each packet received, run
+ * against a mock of SX1280Hal which logs each one instead of talking to a radio
+ */
+#include <cstdint>
+#include <cstring>
+#include <unity.h>
+
+#include "SX1280_Regs.h"
+#include "SX1280_hal.h"
+#include "SX1280.h"
+#include "RFAMP_hal.h"
+
+extern SX1280Hal hal;
+static SX1280Driver Radio;
+
+/////////// Mock radio ///////////
+
+typedef struct {
+    uint8_t command;
+    SX12XX_Radio_Number_t radioNumber;
+} spi_transaction_t;
+
+static spi_transaction_t transactions[64];
+static unsigned transactionCount;
+
+static uint16_t mockIrqStatus;
+static uint8_t mockRxBufferAddr;
+static uint8_t mockPacket[RXBuffSize];
+static uint8_t mockPacketStatus[2];
+
+static void logTransaction(uint8_t command, SX12XX_Radio_Number_t radioNumber)
+{
+    if (transactionCount < sizeof(transactions) / sizeof(transactions[0]))
+    {
+        transactions[transactionCount] = {command, radioNumber};
+    }
+    ++transactionCount;
+}
+
+static unsigned countTransactions(uint8_t command)
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < transactionCount; ++i)
+    {
+        if (transactions[i].command == command)
+            ++count;
+    }
+    return count;
+}
+
+SX1280Hal *SX1280Hal::instance = nullptr;
+SX1280Hal::SX1280Hal() { instance = this; }
+void SX1280Hal::init() {}
+void SX1280Hal::end() {}
+void SX1280Hal::reset() {}
+
+void SX1280Hal::WriteCommand(SX1280_RadioCommands_t command, uint8_t val, SX12XX_Radio_Number_t radioNumber, uint32_t busyDelay)
+{
+    logTransaction(command, radioNumber);
+}
+
+void SX1280Hal::WriteCommand(SX1280_RadioCommands_t command, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber, uint32_t busyDelay)
+{
+    logTransaction(command, radioNumber);
+}
+
+void SX1280Hal::QueueCommand(SX1280_RadioCommands_t command, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber, uint32_t busyDelay)
+{
+    logTransaction(command, radioNumber);
+}
+
+void SX1280Hal::QueueBuffer(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    logTransaction(SX1280_RADIO_WRITE_BUFFER, radioNumber);
+}
+
+void SX1280Hal::WriteRegister(uint16_t address, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    logTransaction(SX1280_RADIO_WRITE_REGISTER, radioNumber);
+}
+
+void SX1280Hal::WriteRegister(uint16_t address, uint8_t value, SX12XX_Radio_Number_t radioNumber)
+{
+    logTransaction(SX1280_RADIO_WRITE_REGISTER, radioNumber);
+}
+
+uint8_t SX1280Hal::ReadRegister(uint16_t address, SX12XX_Radio_Number_t radioNumber)
+{
+    logTransaction(SX1280_RADIO_READ_REGISTER, radioNumber);
+    return 0;
+}
+
+void SX1280Hal::ReadCommand(SX1280_RadioCommands_t command, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    logTransaction(command, radioNumber);
+    memset(buffer, 0, size);
+    switch (command)
+    {
+    case SX1280_RADIO_GET_IRQSTATUS:
+        buffer[0] = mockIrqStatus >> 8;
+        buffer[1] = mockIrqStatus & 0xFF;
+        break;
+    case SX1280_RADIO_GET_RXBUFFERSTATUS:
+        buffer[0] = RXBuffSize;
+        buffer[1] = mockRxBufferAddr;
+        break;
+    case SX1280_RADIO_GET_PACKETSTATUS:
+        memcpy(buffer, mockPacketStatus, sizeof(mockPacketStatus));
+        break;
+    default:
+        break;
+    }
+}
+
+// Two transactions on the bus, the payload then the chained packet status
+void SX1280Hal::ReadBufferAndPacketStatus(uint8_t offset, uint8_t *buffer, uint8_t size, SX12XX_Radio_Number_t radioNumber)
+{
+    logTransaction(SX1280_RADIO_READ_BUFFER, radioNumber);
+    TEST_ASSERT_EQUAL(mockRxBufferAddr, offset);
+    memcpy(buffer, mockPacket, size);
+
+    uint8_t const idx = (radioNumber == SX12XX_Radio_1) ? 0 : 1;
+    logTransaction(SX1280_RADIO_GET_PACKETSTATUS, radioNumber);
+    memcpy(prefetchBuffer[idx] + 2, mockPacketStatus, sizeof(mockPacketStatus));
+    prefetchRadios |= radioNumber;
+}
+
+bool SX1280Hal::GetPrefetchedPacketStatus(uint8_t *status, SX12XX_Radio_Number_t radioNumber)
+{
+    if (!(prefetchRadios & radioNumber))
+    {
+        return false;
+    }
+
+    uint8_t const idx = (radioNumber == SX12XX_Radio_1) ? 0 : 1;
+    prefetchRadios &= ~radioNumber;
+    memcpy(status, prefetchBuffer[idx] + 2, 2);
+    return true;
+}
+
+RFAMP_hal::RFAMP_hal() {}
+void RFAMP_hal::init() {}
+void RFAMP_hal::TXenable(SX12XX_Radio_Number_t radioNumber) {}
+void RFAMP_hal::RXenable() {}
+void RFAMP_hal::TXRXdisable() {}
+
+/////////// Tests ///////////
+
+static bool RXdoneISR(SX12xxDriverCommon::rx_status const status)
+{
+    // As the RX does for a packet which passes
+    if (status == SX12xxDriverCommon::SX12XX_RX_OK)
+    {
+        Radio.GetLastPacketStats();
+    }
+    return status == SX12xxDriverCommon::SX12XX_RX_OK;
+}
+
+static void configRadio(bool flrc)
+{
+    Radio.Config(SX1280_LORA_BW_0800, SX1280_LORA_SF6, SX1280_LORA_CR_LI_4_8, 2400000000 / FREQ_STEP,
+                 12, false, 8, 0, 0, 0, flrc);
+    Radio.RXdoneCallback = &RXdoneISR;
+}
+
+static void receivePacket()
+{
+    transactionCount = 0;
+    Radio.isFirstRxIrq = true;
+    hal.IsrCallback_1();
+}
+
+void test_rx_packet_transactions()
+{
+    configRadio(false);
+    mockIrqStatus = SX1280_IRQ_RX_DONE;
+    mockRxBufferAddr = 0x80;
+    for (uint8_t i = 0; i < sizeof(mockPacket); ++i)
+        mockPacket[i] = i + 1;
+    mockPacketStatus[0] = 120; // -60dBm
+    mockPacketStatus[1] = 40;  // +10dB
+
+    // The first packet after Config() reads where the radio put it
+    receivePacket();
+    TEST_ASSERT_EQUAL(5, transactionCount);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_GET_IRQSTATUS, transactions[0].command);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_GET_RXBUFFERSTATUS, transactions[1].command);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_READ_BUFFER, transactions[2].command);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_GET_PACKETSTATUS, transactions[3].command);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_CLR_IRQSTATUS, transactions[4].command);
+    // Packet received, so the IRQ is cleared on both radios at once
+    TEST_ASSERT_EQUAL(SX12XX_Radio_All, transactions[4].radioNumber);
+
+    // It's always the same place, so after that it's four
+    for (unsigned n = 0; n < 3; ++n)
+    {
+        receivePacket();
+        TEST_ASSERT_EQUAL(4, transactionCount);
+        TEST_ASSERT_EQUAL(0, countTransactions(SX1280_RADIO_GET_RXBUFFERSTATUS));
+        TEST_ASSERT_EQUAL(1, countTransactions(SX1280_RADIO_GET_PACKETSTATUS));
+    }
+
+    // The data and stats came through
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(mockPacket, Radio.RXdataBuffer, 8);
+    TEST_ASSERT_EQUAL(-60, Radio.LastPacketRSSI);
+    TEST_ASSERT_EQUAL(10 * RADIO_SNR_SCALE, Radio.LastPacketSNRRaw);
+    TEST_ASSERT_EQUAL(SX12XX_Radio_1, Radio.GetLastSuccessfulPacketRadio());
+}
+
+void test_rx_config_rereads_buffer_addr()
+{
+    configRadio(false);
+    mockIrqStatus = SX1280_IRQ_RX_DONE;
+    mockRxBufferAddr = 0x00;
+    receivePacket();
+    receivePacket();
+    TEST_ASSERT_EQUAL(0, countTransactions(SX1280_RADIO_GET_RXBUFFERSTATUS));
+
+    configRadio(false);
+    mockRxBufferAddr = 0x40;
+    receivePacket();
+    TEST_ASSERT_EQUAL(1, countTransactions(SX1280_RADIO_GET_RXBUFFERSTATUS));
+    TEST_ASSERT_EQUAL(5, transactionCount);
+}
+
+void test_rx_crc_fail_skips_readout()
+{
+    configRadio(true);
+    mockIrqStatus = SX1280_IRQ_RX_DONE | SX1280_IRQ_SYNCWORD_VALID | SX1280_IRQ_CRC_ERROR;
+    receivePacket();
+    // Only the IRQ status is read, and cleared on the radio which raised it
+    TEST_ASSERT_EQUAL(2, transactionCount);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_GET_IRQSTATUS, transactions[0].command);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_CLR_IRQSTATUS, transactions[1].command);
+    TEST_ASSERT_EQUAL(SX12XX_Radio_1, transactions[1].radioNumber);
+}
+
+void test_rx_stats_without_prefetch()
+{
+    // Stats asked for outside of a packet readout are read from the radio
+    configRadio(false);
+    mockIrqStatus = SX1280_IRQ_RX_DONE;
+    receivePacket();
+    transactionCount = 0;
+    Radio.GetLastPacketStats();
+    TEST_ASSERT_EQUAL(1, transactionCount);
+    TEST_ASSERT_EQUAL(SX1280_RADIO_GET_PACKETSTATUS, transactions[0].command);
+}
+
+// Unity setup/teardown
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv)
+{
+    Radio.Begin(0, 0);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_rx_packet_transactions);
+    RUN_TEST(test_rx_config_rereads_buffer_addr);
+    RUN_TEST(test_rx_crc_fail_skips_readout);
+    RUN_TEST(test_rx_stats_without_prefetch);
+    UNITY_END();
+
+    return 0;
+}
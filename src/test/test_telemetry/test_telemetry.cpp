@@ -1,4 +1,6 @@
 #include <cstdint>
+#include <cstring>
+#include <cstdio>
 #include <telemetry.h>
 #include <unity.h>
 
@@ -41,7 +43,7 @@ void test_function_battery(void)
 
     uint8_t* data;
     uint8_t receivedLength;
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
     TEST_ASSERT_NOT_EQUAL(0, data);
     for (int i = 0; i < length; i++)
     {
@@ -51,14 +53,15 @@ void test_function_battery(void)
     // simulate sending done + send another message of the same type to make sure that the repeated sending of only one type works
 
     // this unlocks the data but does not send it again since it's not updated
-    TEST_ASSERT_EQUAL(false, telemetry.GetNextPayload(&receivedLength, &data));
+    TEST_ASSERT_EQUAL(false, telemetry.GetNextPayload(0, &receivedLength, &data));
 
     // update data
     sentLength = sendData(batterySequence2, length);
     TEST_ASSERT_EQUAL(length, sentLength);
 
-    // now it's ready to be sent
-    telemetry.GetNextPayload(&receivedLength, &data);
+    // now it's ready to be sent, once a battery interval has passed
+    TEST_ASSERT_EQUAL(false, telemetry.GetNextPayload(999, &receivedLength, &data));
+    telemetry.GetNextPayload(1000, &receivedLength, &data);
     TEST_ASSERT_NOT_EQUAL(0, data);
 
     for (int i = 0; i < length; i++)
@@ -81,7 +84,7 @@ void test_function_replace_old(void)
 
     uint8_t* data;
     uint8_t receivedLength;
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
     TEST_ASSERT_NOT_EQUAL(0, data);
     for (int i = 0; i < length; i++)
     {
@@ -98,7 +101,7 @@ void test_function_do_not_replace_old_locked(void)
     sendDataWithoutCheck(batterySequence, sizeof(batterySequence));
     uint8_t* data;
     uint8_t receivedLength;
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
     sendDataWithoutCheck(batterySequence2, sizeof(batterySequence2));
     TEST_ASSERT_EQUAL(1, telemetry.UpdatedPayloadCount());
     TEST_ASSERT_NOT_EQUAL(0, data);
@@ -124,9 +127,9 @@ void test_function_add_type(void)
 
     uint8_t* data;
     uint8_t receivedLength;
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
 
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
     TEST_ASSERT_NOT_EQUAL(0, data);
     for (int i = 0; i < length; i++)
     {
@@ -176,7 +179,7 @@ void test_function_store_unknown_type_two_slots(void)
 
     uint8_t* data;
     uint8_t receivedLength;
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
 
     sentLength = sendData(unknownSequence, length);
     TEST_ASSERT_EQUAL(length, sentLength);
@@ -229,7 +232,7 @@ void test_function_add_type_with_zero_crc(void)
 
     uint8_t* data;
     uint8_t receivedLength;
-    telemetry.GetNextPayload(&receivedLength, &data);
+    telemetry.GetNextPayload(0, &receivedLength, &data);
     TEST_ASSERT_NOT_EQUAL(0, data);
     for (int i = 0; i < sizeof(sequence); i++)
     {
@@ -237,6 +240,203 @@ void test_function_add_type_with_zero_crc(void)
     }
 }
 
+void test_function_batch(void)
+{
+    telemetry.ResetState();
+    uint8_t batterySequence[] = {0xEC,10, CRSF_FRAMETYPE_BATTERY_SENSOR,0,0,0,0,0,0,0,0,109};
+    uint8_t attitudeSequence[] = {0xEC,8, CRSF_FRAMETYPE_ATTITUDE,0,0,0,0,0,0,48};
+    sendData(batterySequence, sizeof(batterySequence));
+    sendData(attitudeSequence, sizeof(attitudeSequence));
+
+    uint8_t* data;
+    uint8_t receivedLength;
+    TEST_ASSERT_TRUE(telemetry.GetNextPayloadBatch(0, CRSF_MAX_PACKET_LEN, &receivedLength, &data));
+    TEST_ASSERT_EQUAL(sizeof(batterySequence) + sizeof(attitudeSequence), receivedLength);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(batterySequence, data, sizeof(batterySequence));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(attitudeSequence, data + sizeof(batterySequence), sizeof(attitudeSequence));
+
+    // Both frames were sent, and can be updated again straight away
+    TEST_ASSERT_EQUAL(0, telemetry.UpdatedPayloadCount());
+    TEST_ASSERT_FALSE(telemetry.GetNextPayloadBatch(0, CRSF_MAX_PACKET_LEN, &receivedLength, &data));
+    sendData(batterySequence, sizeof(batterySequence));
+    TEST_ASSERT_EQUAL(1, telemetry.UpdatedPayloadCount());
+}
+
+void test_function_batch_max_size(void)
+{
+    telemetry.ResetState();
+    uint8_t batterySequence[] = {0xEC,10, CRSF_FRAMETYPE_BATTERY_SENSOR,0,0,0,0,0,0,0,0,109};
+    uint8_t attitudeSequence[] = {0xEC,8, CRSF_FRAMETYPE_ATTITUDE,0,0,0,0,0,0,48};
+    sendData(batterySequence, sizeof(batterySequence));
+    sendData(attitudeSequence, sizeof(attitudeSequence));
+
+    // Only one fits at a time
+    uint8_t* data;
+    uint8_t receivedLength;
+    TEST_ASSERT_TRUE(telemetry.GetNextPayloadBatch(0, sizeof(batterySequence) + 1, &receivedLength, &data));
+    TEST_ASSERT_EQUAL(sizeof(batterySequence), receivedLength);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(batterySequence, data, sizeof(batterySequence));
+
+    TEST_ASSERT_TRUE(telemetry.GetNextPayloadBatch(0, sizeof(batterySequence) + 1, &receivedLength, &data));
+    TEST_ASSERT_EQUAL(sizeof(attitudeSequence), receivedLength);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(attitudeSequence, data, sizeof(attitudeSequence));
+}
+
+void test_function_batch_split(void)
+{
+    uint8_t batch[CRSF_MAX_PACKET_LEN] = {
+        0xEC,10, CRSF_FRAMETYPE_BATTERY_SENSOR,0,0,0,0,0,0,0,0,109,
+        0xEC,8, CRSF_FRAMETYPE_ATTITUDE,0,0,0,0,0,0,48,
+        0,0,0 // padding
+    };
+
+    TEST_ASSERT_EQUAL(12, TelemetryBatchFrameSize(batch, 25, 0));
+    TEST_ASSERT_EQUAL(10, TelemetryBatchFrameSize(batch, 25, 12));
+    TEST_ASSERT_EQUAL(0, TelemetryBatchFrameSize(batch, 25, 22));
+    // Exactly filled, no padding
+    TEST_ASSERT_EQUAL(10, TelemetryBatchFrameSize(batch, 22, 12));
+    TEST_ASSERT_EQUAL(0, TelemetryBatchFrameSize(batch, 22, 22));
+    // Frame truncated
+    TEST_ASSERT_EQUAL(0, TelemetryBatchFrameSize(batch, 21, 12));
+    // Nonsense length
+    batch[22] = 0xEC;
+    TEST_ASSERT_EQUAL(0, TelemetryBatchFrameSize(batch, 25, 22));
+}
+
+// A frame of the given type with a zero payload, the crc is not checked by AppendTelemetryPackage()
+static uint8_t *makeFrame(uint8_t *frame, uint8_t type, uint8_t payloadSize)
+{
+    memset(frame, 0, CRSF_FRAME_SIZE(payloadSize + 2));
+    frame[0] = CRSF_ADDRESS_CRSF_TRANSMITTER;
+    frame[CRSF_TELEMETRY_LENGTH_INDEX] = payloadSize + 2;
+    frame[CRSF_TELEMETRY_TYPE_INDEX] = type;
+    return frame;
+}
+
+void test_function_schedule_priority(void)
+{
+    telemetry.ResetState();
+    uint8_t passthroughSequence[] = {0xEC,0x04,CRSF_FRAMETYPE_ARDUPILOT_RESP,CRSF_AP_CUSTOM_TELEM_SINGLE_PACKET_PASSTHROUGH,0x6c,55};
+    uint8_t statusSequence[] = {0xEC,0x04,CRSF_FRAMETYPE_ARDUPILOT_RESP,CRSF_AP_CUSTOM_TELEM_STATUS_TEXT,0x6c,60};
+    uint8_t attitudeSequence[] = {0xEC,8, CRSF_FRAMETYPE_ATTITUDE,0,0,0,0,0,0,48};
+    uint8_t gps[CRSF_MAX_PACKET_LEN];
+    makeFrame(gps, CRSF_FRAMETYPE_GPS, CRSF_FRAME_GPS_PAYLOAD_SIZE);
+
+    telemetry.AppendTelemetryPackage(passthroughSequence);
+    telemetry.AppendTelemetryPackage(attitudeSequence);
+    telemetry.AppendTelemetryPackage(gps);
+    telemetry.AppendTelemetryPackage(statusSequence);
+
+    // Highest priority first, whatever the slot order
+    uint8_t* data;
+    uint8_t receivedLength;
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1000, &receivedLength, &data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(statusSequence, data, sizeof(statusSequence));
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1000, &receivedLength, &data));
+    TEST_ASSERT_EQUAL(CRSF_FRAMETYPE_GPS, data[CRSF_TELEMETRY_TYPE_INDEX]);
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1000, &receivedLength, &data));
+    TEST_ASSERT_EQUAL(CRSF_FRAMETYPE_ATTITUDE, data[CRSF_TELEMETRY_TYPE_INDEX]);
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1000, &receivedLength, &data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(passthroughSequence, data, sizeof(passthroughSequence));
+
+    // A new GPS frame is held back for its interval while something else is due
+    telemetry.AppendTelemetryPackage(gps);
+    telemetry.AppendTelemetryPackage(statusSequence);
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1010, &receivedLength, &data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(statusSequence, data, sizeof(statusSequence));
+    telemetry.AppendTelemetryPackage(passthroughSequence);
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1020, &receivedLength, &data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(passthroughSequence, data, sizeof(passthroughSequence));
+    // and even with nothing else to send it waits for its interval
+    TEST_ASSERT_FALSE(telemetry.GetNextPayload(1030, &receivedLength, &data));
+    TEST_ASSERT_FALSE(telemetry.GetNextPayload(1199, &receivedLength, &data));
+    TEST_ASSERT_TRUE(telemetry.GetNextPayload(1200, &receivedLength, &data));
+    TEST_ASSERT_EQUAL(CRSF_FRAMETYPE_GPS, data[CRSF_TELEMETRY_TYPE_INDEX]);
+    TEST_ASSERT_FALSE(telemetry.GetNextPayload(1210, &receivedLength, &data));
+}
+
+// last is UINT32_MAX until the first send, which is measured from the start for maxGap only
+static void recordGap(uint32_t now, uint32_t &last, uint32_t &minGap, uint32_t &maxGap)
+{
+    uint32_t const gap = now - (last == UINT32_MAX ? 0 : last);
+    if (last != UINT32_MAX && gap < minGap)
+        minGap = gap;
+    if (gap > maxGap)
+        maxGap = gap;
+    last = now;
+}
+
+void test_function_schedule_rates_under_flood(void)
+{
+    // The FC streams passthrough and attitude as fast as it can, far more than the link
+    // carries at one frame per 20ms. GPS, battery and attitude must still go at their rates
+    telemetry.ResetState();
+    uint8_t passthroughSequence[] = {0xEC,0x04,CRSF_FRAMETYPE_ARDUPILOT_RESP,CRSF_AP_CUSTOM_TELEM_SINGLE_PACKET_PASSTHROUGH,0x6c,55};
+    uint8_t statusSequence[] = {0xEC,0x04,CRSF_FRAMETYPE_ARDUPILOT_RESP,CRSF_AP_CUSTOM_TELEM_STATUS_TEXT,0x6c,60};
+    uint8_t gps[CRSF_MAX_PACKET_LEN];
+    uint8_t battery[CRSF_MAX_PACKET_LEN];
+    uint8_t attitude[CRSF_MAX_PACKET_LEN];
+    makeFrame(gps, CRSF_FRAMETYPE_GPS, CRSF_FRAME_GPS_PAYLOAD_SIZE);
+    makeFrame(battery, CRSF_FRAMETYPE_BATTERY_SENSOR, CRSF_FRAME_BATTERY_SENSOR_PAYLOAD_SIZE);
+    makeFrame(attitude, CRSF_FRAMETYPE_ATTITUDE, CRSF_FRAME_ATTITUDE_PAYLOAD_SIZE);
+
+    uint32_t lastGps = UINT32_MAX, lastBattery = UINT32_MAX, lastAttitude = UINT32_MAX;
+    uint32_t maxGapGps = 0, maxGapBattery = 0, maxGapAttitude = 0;
+    uint32_t minGapGps = UINT32_MAX, minGapBattery = UINT32_MAX, minGapAttitude = UINT32_MAX;
+    uint32_t passthroughSent = 0;
+    uint32_t statusQueued = 0, statusLatency = 0;
+    for (uint32_t now = 0; now < 10000; now += 20)
+    {
+        telemetry.AppendTelemetryPackage(passthroughSequence);
+        telemetry.AppendTelemetryPackage(attitude);
+        if (now % 100 == 0)
+            telemetry.AppendTelemetryPackage(gps);
+        if (now % 500 == 0)
+            telemetry.AppendTelemetryPackage(battery);
+        if (now % 3000 == 1000)
+        {
+            telemetry.AppendTelemetryPackage(statusSequence);
+            statusQueued = now;
+        }
+
+        uint8_t* data;
+        uint8_t receivedLength;
+        if (!telemetry.GetNextPayload(now, &receivedLength, &data))
+            continue;
+        switch (data[CRSF_TELEMETRY_TYPE_INDEX])
+        {
+        case CRSF_FRAMETYPE_GPS: recordGap(now, lastGps, minGapGps, maxGapGps); break;
+        case CRSF_FRAMETYPE_BATTERY_SENSOR: recordGap(now, lastBattery, minGapBattery, maxGapBattery); break;
+        case CRSF_FRAMETYPE_ATTITUDE: recordGap(now, lastAttitude, minGapAttitude, maxGapAttitude); break;
+        case CRSF_FRAMETYPE_ARDUPILOT_RESP:
+            if (data[CRSF_TELEMETRY_TYPE_INDEX + 1] == CRSF_AP_CUSTOM_TELEM_STATUS_TEXT)
+            {
+                if (now - statusQueued > statusLatency)
+                    statusLatency = now - statusQueued;
+            }
+            else
+            {
+                ++passthroughSent;
+            }
+            break;
+        }
+    }
+
+    // Each is sent on the first transfer after it is due
+    TEST_ASSERT_LESS_OR_EQUAL(200 + 20, maxGapGps);
+    TEST_ASSERT_LESS_OR_EQUAL(1000 + 20, maxGapBattery);
+    TEST_ASSERT_LESS_OR_EQUAL(100 + 20, maxGapAttitude);
+    // and no more often than their interval, however fast the FC sends them
+    TEST_ASSERT_GREATER_OR_EQUAL(200, minGapGps);
+    TEST_ASSERT_GREATER_OR_EQUAL(1000, minGapBattery);
+    TEST_ASSERT_GREATER_OR_EQUAL(100, minGapAttitude);
+    TEST_ASSERT_EQUAL(0, statusLatency);
+    // and the rest of the link is left for the passthrough, which can't be updated while
+    // it is being sent so goes at most every other transfer
+    printf("passthrough sent %u of %u transfers\n", passthroughSent, 10000 / 20);
+    TEST_ASSERT_GREATER_THAN(10000 / 20 / 3, passthroughSent);
+}
+
 // Unity setup/teardown
 void setUp() {}
 void tearDown() {}
@@ -255,6 +455,11 @@ int main(int argc, char **argv)
     RUN_TEST(test_function_store_unknown_type_two_slots);
     RUN_TEST(test_function_store_ardupilot_status_text);
     RUN_TEST(test_function_add_type_with_zero_crc);
+    RUN_TEST(test_function_batch);
+    RUN_TEST(test_function_batch_max_size);
+    RUN_TEST(test_function_batch_split);
+    RUN_TEST(test_function_schedule_priority);
+    RUN_TEST(test_function_schedule_rates_under_flood);
     UNITY_END();
 
     return 0;